@@ -0,0 +1,217 @@
+#if defined(__linux__)
+	#define _GNU_SOURCE	// sched_setaffinity
+#endif
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+	#include <sched.h>
+#endif
+
+#include "raylib.h"
+#include "timer.h"
+
+//----------------------------------------------------------------------------------
+// Harness
+//----------------------------------------------------------------------------------
+static int benchFailures = 0;
+
+static int CompareDoubles(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+bool IsBenchEnabled(const Bench *bench, const char *prefix)
+{
+	// Either the filter names something inside this group or the group itself
+	return bench->filter == NULL || strstr(prefix, bench->filter) != NULL || strstr(bench->filter, prefix) != NULL;
+}
+
+void RunBench(Bench *bench, const char *name, int items, BenchFunc func, void *user)
+{
+	if (bench->filter != NULL && strstr(name, bench->filter) == NULL) return;
+	if (bench->count == BENCH_MAX_RESULTS) return;
+
+	for (int i = 0; i < bench->warmup; i++) func(user);
+
+	double *samples = malloc(bench->reps*sizeof(double));
+	for (int i = 0; i < bench->reps; i++)
+	{
+		double start = GetTimerSeconds();
+		func(user);
+		samples[i] = (GetTimerSeconds() - start)*1e9/items;
+	}
+	qsort(samples, bench->reps, sizeof(double), CompareDoubles);
+
+	BenchResult *r = &bench->results[bench->count++];
+	snprintf(r->name, sizeof(r->name), "%s", name);
+	r->items = items;
+	r->minNs = samples[0];
+	r->medianNs = samples[bench->reps/2];
+	r->p99Ns = samples[bench->reps - 1 - (bench->reps - 1)/100];
+	free(samples);
+
+	printf("%-40s %12.2f ns/item  p99 %12.2f  %14.0f items/s\n", r->name, r->medianNs, r->p99Ns, 1e9/r->medianNs);
+	fflush(stdout);
+}
+
+void FailBench(const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	printf("BENCH: ");
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+	fflush(stdout);
+	benchFailures++;
+}
+
+static void PinToCpu(int cpu)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (sched_setaffinity(0, sizeof(set), &set) != 0) printf("BENCH: Could not pin to CPU %i\n", cpu);
+#else
+	(void)cpu;
+#endif
+}
+
+//----------------------------------------------------------------------------------
+// Results: one result per line so the baseline can be read back without a JSON library
+//----------------------------------------------------------------------------------
+static bool SaveResults(const Bench *bench, const char *fileName)
+{
+	FILE *file = fopen(fileName, "w");
+	if (file == NULL) return false;
+
+	fprintf(file, "{\n\t\"results\": [\n");
+	for (int i = 0; i < bench->count; i++)
+	{
+		const BenchResult *r = &bench->results[i];
+		fprintf(file, "\t\t{ \"name\": \"%s\", \"items\": %i, \"median_ns\": %.4f, \"p99_ns\": %.4f, \"min_ns\": %.4f }%s\n",
+			r->name, r->items, r->medianNs, r->p99Ns, r->minNs, (i + 1 < bench->count)? "," : "");
+	}
+	fprintf(file, "\t]\n}\n");
+
+	fclose(file);
+	return true;
+}
+
+static int LoadResults(const char *fileName, BenchResult *results, int capacity)
+{
+	FILE *file = fopen(fileName, "r");
+	if (file == NULL) return -1;
+
+	char line[512];
+	int count = 0;
+	while (count < capacity && fgets(line, sizeof(line), file) != NULL)
+	{
+		BenchResult r = { 0 };
+		const char *p = strstr(line, "\"name\": \"");
+		if (p == NULL) continue;
+		if (sscanf(p, "\"name\": \"%63[^\"]\", \"items\": %i, \"median_ns\": %lf, \"p99_ns\": %lf, \"min_ns\": %lf",
+			r.name, &r.items, &r.medianNs, &r.p99Ns, &r.minNs) == 5) results[count++] = r;
+	}
+
+	fclose(file);
+	return count;
+}
+
+// Returns the number of cases slower than the baseline by more than `tolerance`
+static int CompareResults(const Bench *bench, const char *baselineFile, double tolerance)
+{
+	static BenchResult baseline[BENCH_MAX_RESULTS];
+	int count = LoadResults(baselineFile, baseline, BENCH_MAX_RESULTS);
+	if (count < 0)
+	{
+		printf("BENCH: Baseline %s not found\n", baselineFile);
+		return 0;
+	}
+
+	int regressions = 0;
+	printf("\n%-40s %12s %12s %8s\n", "compared to baseline", "baseline", "current", "change");
+	for (int i = 0; i < bench->count; i++)
+	{
+		const BenchResult *r = &bench->results[i];
+		for (int j = 0; j < count; j++)
+		{
+			if (strcmp(baseline[j].name, r->name) != 0) continue;
+
+			double change = r->medianNs/baseline[j].medianNs - 1.0;
+			bool regressed = change > tolerance;
+			regressions += regressed;
+			printf("%-40s %12.2f %12.2f %+7.1f%%%s\n", r->name, baseline[j].medianNs, r->medianNs, change*100.0, regressed? "  REGRESSION" : "");
+			break;
+		}
+	}
+
+	return regressions;
+}
+
+//----------------------------------------------------------------------------------
+// Entry point
+//----------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+	Bench bench = { .warmup = 3, .reps = 31 };
+	const char *outFile = NULL;
+	const char *baselineFile = NULL;
+	double tolerance = 0.15;
+	int cpu = -1;	// Worker threads inherit the mask, pinning makes the *_jobs and *_parallel cases serial
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) bench.filter = argv[++i];
+		else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) bench.warmup = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) bench.reps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) outFile = argv[++i];
+		else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselineFile = argv[++i];
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+		else if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) cpu = atoi(argv[++i]);
+		else
+		{
+			printf("usage: %s [--filter text] [--warmup n] [--reps n] [--cpu n (not pinned by default)]\n"
+				"       [--out results.json] [--baseline bench/baseline.json] [--tolerance 0.15]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (bench.reps < 1) bench.reps = 1;
+
+	SetTraceLogLevel(LOG_WARNING);
+	if (cpu >= 0) PinToCpu(cpu);
+
+	RunCoreBenches(&bench);
+	RunQueueBenches(&bench);
+	RunAudioBenches(&bench);
+	RunMapGenBenches(&bench);
+	RunCollisionBenches(&bench);
+	RunBroadPhaseBenches(&bench);
+	RunLightingBenches(&bench);
+	RunFovBenches(&bench);
+	RunSwarmBenches(&bench);
+	RunPatternBenches(&bench);
+	RunBehaviourBenches(&bench);
+	RunEventBenches(&bench);
+	RunTextBenches(&bench);
+	RunDebugUiBenches(&bench);
+	RunPacingBenches(&bench);
+	RunParallaxBenches(&bench);
+	RunReloadBenches(&bench);
+
+	if (outFile != NULL && !SaveResults(&bench, outFile)) printf("BENCH: Could not write %s\n", outFile);
+
+	int regressions = (baselineFile != NULL)? CompareResults(&bench, baselineFile, tolerance) : 0;
+	if (regressions > 0) printf("\nBENCH: %i regression(s) over %.0f%% tolerance\n", regressions, tolerance*100.0);
+	if (benchFailures > 0) printf("\nBENCH: %i check(s) failed\n", benchFailures);
+
+	return (regressions > 0 || benchFailures > 0)? 1 : 0;
+}
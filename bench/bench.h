@@ -0,0 +1,59 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+
+#define BENCH_MAX_RESULTS 256
+
+typedef struct BenchResult {
+	char name[64];
+	int items;	// Work items per repetition, timings are reported per item
+	double medianNs;
+	double p99Ns;
+	double minNs;
+} BenchResult;
+
+typedef struct Bench {
+	const char *filter;	// Only run cases whose name contains this
+	int warmup;
+	int reps;
+	BenchResult results[BENCH_MAX_RESULTS];
+	int count;
+} Bench;
+
+typedef void (*BenchFunc)(void *user);
+
+// Times `func` `reps` times after `warmup` untimed calls; each call must do `items` units of work
+void RunBench(Bench *bench, const char *name, int items, BenchFunc func, void *user);
+bool IsBenchEnabled(const Bench *bench, const char *prefix);	// Lets suites skip expensive setup
+// Setup a case depends on that did not hold: prints "BENCH: <message>" and makes the run exit
+// non-zero. Behaviour is checked in tests/, cases over a time budget only print and speed
+// fails through the baseline.
+void FailBench(const char *format, ...);
+
+// Keeps the optimiser from deleting work whose result is otherwise unused
+static inline void BenchConsume(const void *p)
+{
+	__asm__ volatile("" : : "r"(p) : "memory");
+}
+
+// Suites, one per area of the game
+void RunCoreBenches(Bench *bench);
+void RunQueueBenches(Bench *bench);
+void RunAudioBenches(Bench *bench);
+void RunMapGenBenches(Bench *bench);
+void RunCollisionBenches(Bench *bench);
+void RunBroadPhaseBenches(Bench *bench);
+void RunLightingBenches(Bench *bench);
+void RunFovBenches(Bench *bench);
+void RunSwarmBenches(Bench *bench);
+void RunPatternBenches(Bench *bench);
+void RunBehaviourBenches(Bench *bench);
+void RunEventBenches(Bench *bench);
+void RunTextBenches(Bench *bench);
+void RunDebugUiBenches(Bench *bench);
+void RunPacingBenches(Bench *bench);
+void RunParallaxBenches(Bench *bench);
+void RunReloadBenches(Bench *bench);
+
+#endif
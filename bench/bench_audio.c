@@ -0,0 +1,217 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "mixer.h"
+#include "resample.h"
+
+#define AUDIO_VOICES MIXER_MAX_VOICES
+
+static const char *sfxFiles[] = { "res/sfx/boop.wav", "res/sfx/gun_fire.wav", "res/sfx/hurt.wav", "res/sfx/soft_boop.wav" };
+
+typedef struct AudioBench {
+	Mixer mixer;
+	MixerVoice voices[AUDIO_VOICES];	// Restored before every buffer so the voice count stays fixed
+	float out[MIXER_BUFFER_FRAMES*2];
+} AudioBench;
+
+static void BenchMixVoices(void *user)
+{
+	AudioBench *b = user;
+	memcpy(b->mixer.voices, b->voices, sizeof(b->voices));
+	b->mixer.voiceCount = AUDIO_VOICES;
+	MixAudio(&b->mixer, b->out, MIXER_BUFFER_FRAMES);
+	BenchConsume(b->out);
+}
+
+// What the callback would cost without pre-conversion: every voice steps through its
+// 44.1 kHz source at a fractional rate and interpolates, the cheapest resampler there is
+typedef struct ResampleOnPlayBench {
+	float *sources[4];	// Original 44.1 kHz clips
+	int frames[4];
+	double positions[128];
+	float out[MIXER_BUFFER_FRAMES*2];
+} ResampleOnPlayBench;
+
+static void BenchMixResampleOnPlay(void *user)
+{
+	ResampleOnPlayBench *b = user;
+	const double step = 44100.0/MIXER_DEFAULT_SAMPLE_RATE;
+	memset(b->out, 0, sizeof(b->out));
+
+	for (int v = 0; v < 128; v++)
+	{
+		const float *in = b->sources[v%4];
+		int frames = b->frames[v%4];
+		double position = b->positions[v];
+
+		for (int i = 0; i < MIXER_BUFFER_FRAMES; i++, position += step)
+		{
+			int p = (int)position;
+			if (p + 1 >= frames) position = 0.0, p = 0;	// Loop so the voice count stays fixed
+			float t = (float)(position - p);
+			float s = in[p] + (in[p + 1] - in[p])*t;
+			b->out[2*i] += s*0.2f;
+			b->out[2*i + 1] += s*0.3f;
+		}
+	}
+	BenchConsume(b->out);
+}
+
+static void BenchMix128Voices(void *user)
+{
+	AudioBench *b = user;
+	memcpy(b->mixer.voices, b->voices, 128*sizeof(MixerVoice));
+	b->mixer.voiceCount = 128;
+	MixAudio(&b->mixer, b->out, MIXER_BUFFER_FRAMES);
+	BenchConsume(b->out);
+}
+
+typedef struct ResampleBench {
+	float *in;
+	int frames;
+} ResampleBench;
+
+static void BenchResampleClip(void *user)
+{
+	ResampleBench *b = user;
+	int frames = 0;
+	free(ResampleAudio(b->in, b->frames, 44100, MIXER_DEFAULT_SAMPLE_RATE, &frames));
+}
+
+static void BenchMixTriggers(void *user)
+{
+	AudioBench *b = user;
+	// A burst of identical triggers, as from a shotgun or many enemies dying at once
+	for (int i = 0; i < AUDIO_VOICES; i++) PlayMixerClip(&b->mixer, i%b->mixer.clipCount, 0.5f, 0.0f);
+	b->mixer.voiceCount = 0;
+	MixAudio(&b->mixer, b->out, MIXER_BUFFER_FRAMES);
+	BenchConsume(b->out);
+}
+
+#define ADPCM_BENCH_BLOCKS 64
+#define ADPCM_SNR_FLOOR 22.0f	// The trellis encoder gets 23.9 dB on the synthesised tone and more on res/sfx, the greedy one got 16.8
+
+typedef struct AdpcmEncodeBench {
+	const float *samples;
+	int frames;
+} AdpcmEncodeBench;
+
+static void BenchAdpcmEncode(void *user)
+{
+	AdpcmEncodeBench *b = user;
+	UnloadAdpcm(EncodeAdpcm(b->samples, b->frames));
+}
+
+typedef struct AdpcmBench {
+	const unsigned char *blocks[ADPCM_BENCH_BLOCKS];
+	float *outs[ADPCM_BENCH_BLOCKS];
+	float samples[ADPCM_BENCH_BLOCKS][ADPCM_BLOCK_SAMPLES];
+} AdpcmBench;
+
+static void BenchAdpcmScalar(void *user)
+{
+	AdpcmBench *b = user;
+	for (int i = 0; i < ADPCM_BENCH_BLOCKS; i++) DecodeAdpcmBlock(b->blocks[i], b->outs[i]);
+	BenchConsume(b->samples);
+}
+
+static void BenchAdpcmLanes(void *user)
+{
+	AdpcmBench *b = user;
+	DecodeAdpcmBlocks(b->blocks, b->outs, ADPCM_BENCH_BLOCKS);
+	BenchConsume(b->samples);
+}
+
+// Loads res/sfx, or synthesises clips of similar length when run elsewhere
+static int LoadBenchClips(Mixer *mixer)
+{
+	for (int i = 0; i < (int)(sizeof(sfxFiles)/sizeof(sfxFiles[0])); i++)
+	{
+		Wave wave = FileExists(sfxFiles[i])? LoadWave(sfxFiles[i]) : (Wave){ 0 };
+
+		if (wave.data == NULL)
+		{
+			static short tone[8000];
+			for (int s = 0; s < 8000; s++) tone[s] = (short)((s%100 < 50)? 8000 : -8000);
+			wave = (Wave){ 8000, 44100, 16, 1, NULL };
+			wave.data = malloc(sizeof(tone));
+			memcpy(wave.data, tone, sizeof(tone));
+		}
+
+		LoadMixerClip(mixer, wave);
+		UnloadWave(wave);
+	}
+
+	return mixer->clipCount;
+}
+
+void RunAudioBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "audio/")) return;
+
+	AudioBench *b = calloc(1, sizeof(AudioBench));
+	InitMixer(&b->mixer, MIXER_DEFAULT_SAMPLE_RATE);
+	LoadBenchClips(&b->mixer);
+
+	// Staggered start positions so voices do not all end in the same buffer
+	for (int i = 0; i < AUDIO_VOICES; i++)
+	{
+		int clip = i%b->mixer.clipCount;
+		int frames = b->mixer.clips[clip].frames - MIXER_BUFFER_FRAMES;
+		b->voices[i] = (MixerVoice){ clip, ((i*997)%(frames > 4? frames : 4)) & ~3, 0.2f, 0.3f };
+	}
+
+	RunBench(bench, "audio/mix_256_voices_buffer", AUDIO_VOICES*MIXER_BUFFER_FRAMES, BenchMixVoices, b);
+	RunBench(bench, "audio/mix_256_triggers_merged", AUDIO_VOICES, BenchMixTriggers, b);
+	RunBench(bench, "audio/mix_128_voices_preconverted", 128*MIXER_BUFFER_FRAMES, BenchMix128Voices, b);
+
+	// The same 128 voices resampled from 44.1 kHz while mixing. Clips are rebuilt at
+	// their source rate by resampling back, which is close enough for timing.
+	ResampleOnPlayBench *r = calloc(1, sizeof(ResampleOnPlayBench));
+	for (int i = 0; i < 4; i++)
+	{
+		const MixerClip *clip = &b->mixer.clips[i%b->mixer.clipCount];
+		r->sources[i] = ResampleAudio(clip->samples, clip->frames, MIXER_DEFAULT_SAMPLE_RATE, 44100, &r->frames[i]);
+	}
+	for (int v = 0; v < 128; v++) r->positions[v] = (v*997)%(r->frames[v%4]/2);
+	RunBench(bench, "audio/mix_128_voices_resample_on_play", 128*MIXER_BUFFER_FRAMES, BenchMixResampleOnPlay, r);
+
+	ResampleBench rb = { r->sources[0], r->frames[0] };
+	RunBench(bench, "audio/resample_clip_44k1_to_48k", rb.frames, BenchResampleClip, &rb);
+
+	for (int i = 0; i < 4; i++) free(r->sources[i]);
+	free(r);
+
+	AdpcmEncodeBench encode = { b->mixer.clips[0].samples, b->mixer.clips[0].frames };
+	RunBench(bench, "audio/adpcm_encode_clip", encode.frames, BenchAdpcmEncode, &encode);
+
+	// Same voices again with every clip held as ADPCM and decoded per buffer
+	for (int i = 0; i < b->mixer.clipCount; i++)
+	{
+		CompressMixerClip(&b->mixer, i);
+		float snr = b->mixer.clips[i].adpcm.snr;
+		if (snr < ADPCM_SNR_FLOOR) FailBench("ADPCM clip %d encoded at %.1f dB SNR, under the %.1f dB floor", i, snr, ADPCM_SNR_FLOOR);
+	}
+	SetTraceLogLevel(LOG_INFO);
+	TraceMixerClips(&b->mixer);
+	SetTraceLogLevel(LOG_WARNING);
+	RunBench(bench, "audio/mix_128_voices_adpcm", 128*MIXER_BUFFER_FRAMES, BenchMix128Voices, b);
+	RunBench(bench, "audio/mix_256_voices_adpcm", AUDIO_VOICES*MIXER_BUFFER_FRAMES, BenchMixVoices, b);
+
+	AdpcmBench *a = calloc(1, sizeof(AdpcmBench));
+	const AdpcmClip *adpcm = &b->mixer.clips[0].adpcm;
+	for (int i = 0; i < ADPCM_BENCH_BLOCKS; i++)
+	{
+		a->blocks[i] = adpcm->blocks + (size_t)(i%adpcm->blockCount)*ADPCM_BLOCK_BYTES;
+		a->outs[i] = a->samples[i];
+	}
+	RunBench(bench, "audio/adpcm_decode_scalar", ADPCM_BENCH_BLOCKS*ADPCM_BLOCK_SAMPLES, BenchAdpcmScalar, a);
+	RunBench(bench, "audio/adpcm_decode_4_lanes", ADPCM_BENCH_BLOCKS*ADPCM_BLOCK_SAMPLES, BenchAdpcmLanes, a);
+	free(a);
+
+	UnloadMixer(&b->mixer);
+	free(b);
+}
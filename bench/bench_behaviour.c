@@ -0,0 +1,273 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "behaviour.h"
+#include "rng.h"
+
+#define BEHAVIOUR_SEED 45
+#define BEHAVIOUR_AGENTS 10000
+#define BEHAVIOUR_TREES 4
+#define BEHAVIOUR_WORLD_SIZE 4096.0f
+#define BEHAVIOUR_WARMUP_TICKS 100	// Batched ticks before timing, nodes per agent is averaged over them
+
+// Four enemy types over the same leaves
+static const char *treeSources[BEHAVIOUR_TREES] = {
+	// Grunt: shoots when close, chases from further out
+	"selector\n"
+	"	sequence\n"
+	"		low_health\n"
+	"		flee\n"
+	"	sequence\n"
+	"		player_near 300\n"
+	"		cooldown 20\n"
+	"			shoot\n"
+	"	sequence\n"
+	"		player_near 900\n"
+	"		chase\n"
+	"	wander\n",
+
+	// Sniper: keeps its distance
+	"selector\n"
+	"	sequence\n"
+	"		player_near 200\n"
+	"		flee\n"
+	"	sequence\n"
+	"		player_near 1200\n"
+	"		cooldown 45\n"
+	"			shoot\n"
+	"	wander\n",
+
+	// Berserker: never retreats
+	"selector\n"
+	"	sequence\n"
+	"		player_near 64\n"
+	"		shoot\n"
+	"	sequence\n"
+	"		invert\n"
+	"			low_health\n"
+	"		chase\n"
+	"	wander\n",
+
+	// Coward: only fights at full health
+	"selector\n"
+	"	sequence\n"
+	"		invert\n"
+	"			healthy\n"
+	"		flee\n"
+	"	sequence\n"
+	"		player_near 500\n"
+	"		cooldown 10\n"
+	"			shoot\n"
+	"		wander\n"
+	"	wander\n",
+};
+
+typedef struct BehaviourWorld {
+	float *posX;
+	float *posY;
+	float *health;
+	int *shots;
+	float playerX;
+	float playerY;
+	int tick;
+} BehaviourWorld;
+
+static float GetPlayerDistance2(const BehaviourWorld *w, int agent)
+{
+	float dx = w->posX[agent] - w->playerX, dy = w->posY[agent] - w->playerY;
+	return dx*dx + dy*dy;
+}
+
+static void MoveAgent(BehaviourWorld *w, int agent, float speed)
+{
+	float dx = w->playerX - w->posX[agent], dy = w->playerY - w->posY[agent];
+	float scale = speed/(1.0f + (dx < 0.0f? -dx : dx) + (dy < 0.0f? -dy : dy));
+	w->posX[agent] += dx*scale;
+	w->posY[agent] += dy*scale;
+}
+
+static BehaviourStatus LeafPlayerNear(void *context, int agent, float radius)
+{
+	return (GetPlayerDistance2(context, agent) < radius*radius)? BEHAVIOUR_SUCCESS : BEHAVIOUR_FAILURE;
+}
+
+static BehaviourStatus LeafLowHealth(void *context, int agent, float param)
+{
+	(void)param;
+	return (((BehaviourWorld *)context)->health[agent] < 30.0f)? BEHAVIOUR_SUCCESS : BEHAVIOUR_FAILURE;
+}
+
+static BehaviourStatus LeafHealthy(void *context, int agent, float param)
+{
+	(void)param;
+	return (((BehaviourWorld *)context)->health[agent] >= 90.0f)? BEHAVIOUR_SUCCESS : BEHAVIOUR_FAILURE;
+}
+
+static BehaviourStatus LeafShoot(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourWorld *w = context;
+	w->shots[agent]++;
+	w->health[agent] -= 5.0f;	// Shooting back gets you shot
+	return BEHAVIOUR_SUCCESS;
+}
+
+static BehaviourStatus LeafChase(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourWorld *w = context;
+	MoveAgent(w, agent, 3.0f);
+	return (GetPlayerDistance2(w, agent) < 48.0f*48.0f)? BEHAVIOUR_SUCCESS : BEHAVIOUR_RUNNING;
+}
+
+static BehaviourStatus LeafFlee(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourWorld *w = context;
+	MoveAgent(w, agent, -3.0f);
+	w->health[agent] += 1.0f;
+	return (w->health[agent] > 60.0f)? BEHAVIOUR_SUCCESS : BEHAVIOUR_RUNNING;
+}
+
+// Hashed from the agent and tick rather than drawn from a shared Rng, so the result
+// does not depend on the order agents are ticked in
+static BehaviourStatus LeafWander(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourWorld *w = context;
+	unsigned int h = (unsigned int)agent*0x9e3779b9u ^ (unsigned int)w->tick*0x85ebca6bu;
+	h ^= h >> 15;
+	h *= 0x2c1b3c6du;
+	h ^= h >> 12;
+	w->posX[agent] += (float)(h & 7) - 3.5f;
+	w->posY[agent] += (float)((h >> 3) & 7) - 3.5f;
+	if (w->health[agent] < 100.0f) w->health[agent] += 0.25f;
+	return BEHAVIOUR_SUCCESS;
+}
+
+static void RegisterBenchLeaves(BehaviourLibrary *library)
+{
+	RegisterBehaviourLeaf(library, "player_near", LeafPlayerNear);
+	RegisterBehaviourLeaf(library, "low_health", LeafLowHealth);
+	RegisterBehaviourLeaf(library, "healthy", LeafHealthy);
+	RegisterBehaviourLeaf(library, "shoot", LeafShoot);
+	RegisterBehaviourLeaf(library, "chase", LeafChase);
+	RegisterBehaviourLeaf(library, "flee", LeafFlee);
+	RegisterBehaviourLeaf(library, "wander", LeafWander);
+}
+
+typedef struct BehaviourBench {
+	BehaviourLibrary library;
+	BehaviourTree trees[BEHAVIOUR_TREES];
+	BehaviourBatch batches[BEHAVIOUR_TREES];
+	BehaviourWorld world;
+
+	// The same agents one at a time in spawn order, trees interleaved
+	int *mixedOrder;
+	int *mixedTree;
+	int *mixedStates;
+	int mixedStride;
+	int mixedTick;
+	long long mixedVisits;
+} BehaviourBench;
+
+static BehaviourWorld AllocBehaviourWorld(Rng *rng)
+{
+	BehaviourWorld w = { 0 };
+	w.posX = malloc(BEHAVIOUR_AGENTS*sizeof(float));
+	w.posY = malloc(BEHAVIOUR_AGENTS*sizeof(float));
+	w.health = malloc(BEHAVIOUR_AGENTS*sizeof(float));
+	w.shots = calloc(BEHAVIOUR_AGENTS, sizeof(int));
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++)
+	{
+		w.posX[i] = NextRngFloat(rng)*BEHAVIOUR_WORLD_SIZE;
+		w.posY[i] = NextRngFloat(rng)*BEHAVIOUR_WORLD_SIZE;
+		w.health[i] = 20.0f + NextRngFloat(rng)*80.0f;
+	}
+	return w;
+}
+
+static void FreeBehaviourWorld(BehaviourWorld *w)
+{
+	free(w->posX);
+	free(w->posY);
+	free(w->health);
+	free(w->shots);
+}
+
+// The player circles the middle of the world
+static void MoveBehaviourPlayer(BehaviourWorld *w)
+{
+	w->tick++;
+	w->playerX = BEHAVIOUR_WORLD_SIZE*0.5f + (float)((w->tick*7)%1024) - 512.0f;
+	w->playerY = BEHAVIOUR_WORLD_SIZE*0.5f + (float)((w->tick*3)%1024) - 512.0f;
+}
+
+static void BenchTickBatched(void *user)
+{
+	BehaviourBench *b = user;
+	MoveBehaviourPlayer(&b->world);
+	for (int i = 0; i < BEHAVIOUR_TREES; i++) TickBehaviourBatch(&b->batches[i], &b->library, &b->world);
+	BenchConsume(b->world.posX);
+}
+
+static void BenchTickMixed(void *user)
+{
+	BehaviourBench *b = user;
+	MoveBehaviourPlayer(&b->world);
+	b->mixedTick++;
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++)
+	{
+		int agent = b->mixedOrder[i];
+		const BehaviourTree *tree = &b->trees[b->mixedTree[agent]];
+		TickBehaviourAgent(tree, &b->library, &b->mixedStates[agent*b->mixedStride], agent, b->mixedTick, &b->world, &b->mixedVisits);
+	}
+	BenchConsume(b->world.posX);
+}
+
+void RunBehaviourBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "behaviour/")) return;
+
+	BehaviourBench *b = calloc(1, sizeof(BehaviourBench));
+	RegisterBenchLeaves(&b->library);
+	for (int i = 0; i < BEHAVIOUR_TREES; i++)
+	{
+		if (!CompileBehaviourTree(treeSources[i], &b->library, &b->trees[i])) FailBench("Behaviour tree %d does not compile", i);
+		b->batches[i] = LoadBehaviourBatch(&b->trees[i], BEHAVIOUR_AGENTS);
+		if (b->trees[i].stateSize > b->mixedStride) b->mixedStride = b->trees[i].stateSize;
+	}
+
+	Rng rng = SeedRng(BEHAVIOUR_SEED);
+	b->world = AllocBehaviourWorld(&rng);
+	b->mixedOrder = malloc(BEHAVIOUR_AGENTS*sizeof(int));
+	b->mixedTree = malloc(BEHAVIOUR_AGENTS*sizeof(int));
+	b->mixedStates = calloc((size_t)BEHAVIOUR_AGENTS*b->mixedStride, sizeof(int));
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++)
+	{
+		b->mixedOrder[i] = i;
+		b->mixedTree[i] = (int)(NextRng(&rng)%BEHAVIOUR_TREES);
+		AddBehaviourAgent(&b->batches[b->mixedTree[i]], i);
+	}
+
+	for (int t = 0; t < BEHAVIOUR_WARMUP_TICKS; t++) BenchTickBatched(b);
+	long long visits = b->batches[0].visits + b->batches[1].visits + b->batches[2].visits + b->batches[3].visits;
+	RunBench(bench, "behaviour/tick_10k_batched", BEHAVIOUR_AGENTS, BenchTickBatched, b);
+	double batchedNs = bench->results[bench->count - 1].medianNs;
+	RunBench(bench, "behaviour/tick_10k_mixed", BEHAVIOUR_AGENTS, BenchTickMixed, b);
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "BEHAVIOUR: %i agents over %i trees, %.1f nodes per agent, %.0f us per batched tick",
+		BEHAVIOUR_AGENTS, BEHAVIOUR_TREES, (double)visits/(BEHAVIOUR_AGENTS*BEHAVIOUR_WARMUP_TICKS), batchedNs*BEHAVIOUR_AGENTS/1000.0);
+	SetTraceLogLevel(LOG_WARNING);
+
+	for (int i = 0; i < BEHAVIOUR_TREES; i++) UnloadBehaviourBatch(&b->batches[i]);
+	FreeBehaviourWorld(&b->world);
+	free(b->mixedOrder);
+	free(b->mixedTree);
+	free(b->mixedStates);
+	free(b);
+}
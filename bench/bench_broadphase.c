@@ -0,0 +1,229 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "broadphase.h"
+#include "rng.h"
+
+#define BROADPHASE_SEED 39
+#define BROADPHASE_WORLD 8192.0f
+#define BROADPHASE_PROXIES 10000	// Most a scene holds
+#define BROADPHASE_QUERIES 1000
+#define BROADPHASE_CLUSTERS 48
+#define BROADPHASE_CLUSTER_RADIUS 768.0f
+#define BROADPHASE_CELL 64.0f
+#define BROADPHASE_MARGIN 8.0f
+#define BROADPHASE_MAX_HITS (1 << 20)
+#define BROADPHASE_KINDS 3	// Grid, tree, sweep and prune
+#define BROADPHASE_STAT_TICKS 60
+
+// How colliders are spread over the world
+typedef struct BroadPhaseScene {
+	const char *name;
+	int proxies;
+	int statics;	// The first ones, never moved: doors, triggers, props
+	float staticSize;	// Largest side
+	float dynamicSize;
+	int clusters;	// 0 for uniform
+	int formation;	// Dynamic proxies in square blocks of this many a side moving together, 0 for none
+	float speed;	// Fastest move per tick
+} BroadPhaseScene;
+
+static const BroadPhaseScene broadPhaseScenes[] = {
+	{ "uniform", 10000, 2000, 256.0f, 32.0f, 0, 0, 6.0f },
+	{ "clustered", 10000, 2000, 256.0f, 32.0f, BROADPHASE_CLUSTERS, 0, 6.0f },
+	{ "sparse", 1000, 200, 1024.0f, 256.0f, 0, 0, 6.0f },	// Few, irregularly sized: bosses and trigger zones
+	{ "formation", 4400, 400, 256.0f, 16.0f, 0, 10, 0.5f },	// Enemy formations shuffling along
+};
+
+typedef struct BroadPhaseBench {
+	const BroadPhaseScene *scene;
+	BroadPhase bp;
+	Rectangle recs[BROADPHASE_PROXIES];
+	Vector2 velocities[BROADPHASE_PROXIES];
+	int proxies[BROADPHASE_PROXIES];
+	Rectangle queries[BROADPHASE_QUERIES];
+	Vector2 origins[BROADPHASE_QUERIES];
+	Vector2 deltas[BROADPHASE_QUERIES];
+	BroadPhaseHit *hits;
+	BroadPhasePair *pairs;
+	int found;
+} BroadPhaseBench;
+
+static Vector2 GetBenchPoint(Rng *rng, const BroadPhaseScene *scene, const Vector2 *centres)
+{
+	// Kept clear of the far edges so every proxy lies within the grid's bounds
+	const float extent = BROADPHASE_WORLD - scene->staticSize;
+	if (scene->clusters == 0) return (Vector2){ NextRngFloat(rng)*extent, NextRngFloat(rng)*extent };
+
+	// Denser towards the middle of a cluster, like a fight around a boss
+	const Vector2 centre = centres[NextRng(rng)%scene->clusters];
+	float angle = NextRngFloat(rng)*2.0f*PI;
+	float distance = NextRngFloat(rng)*NextRngFloat(rng)*BROADPHASE_CLUSTER_RADIUS;
+	return (Vector2){
+		fminf(fmaxf(centre.x + cosf(angle)*distance, 0.0f), extent),
+		fminf(fmaxf(centre.y + sinf(angle)*distance, 0.0f), extent),
+	};
+}
+
+// All broad-phases of a scene are filled from the same seed, so their results must agree
+static void FillBroadPhaseBench(BroadPhaseBench *b, BroadPhase bp, const BroadPhaseScene *scene)
+{
+	Rng rng = SeedRng(BROADPHASE_SEED);
+	Vector2 centres[BROADPHASE_CLUSTERS];
+	for (int i = 0; i < BROADPHASE_CLUSTERS; i++)
+	{
+		centres[i] = (Vector2){ 512.0f + NextRngFloat(&rng)*(BROADPHASE_WORLD - 1024.0f), 512.0f + NextRngFloat(&rng)*(BROADPHASE_WORLD - 1024.0f) };
+	}
+
+	b->scene = scene;
+	b->bp = bp;
+	for (int i = 0; i < scene->proxies; i++)
+	{
+		Vector2 p = GetBenchPoint(&rng, scene, centres);
+		bool isStatic = i < scene->statics;
+		float size = isStatic? scene->staticSize : scene->dynamicSize;
+		float w = size*(0.125f + 0.875f*NextRngFloat(&rng));
+		float h = size*(0.125f + 0.875f*NextRngFloat(&rng));
+		float angle = NextRngFloat(&rng)*2.0f*PI;
+		float speed = isStatic? 0.0f : NextRngFloat(&rng)*scene->speed;
+
+		if (!isStatic && scene->formation > 0)
+		{
+			// Neighbours in a block overlap slightly and share the block's heading
+			int member = (i - scene->statics)%(scene->formation*scene->formation);
+			int block = (i - scene->statics)/(scene->formation*scene->formation);
+			float spacing = size*0.875f;
+			p.x = centres[block%BROADPHASE_CLUSTERS].x + (member%scene->formation)*spacing;
+			p.y = centres[block%BROADPHASE_CLUSTERS].y + (member/scene->formation)*spacing;
+			w = h = size;
+			angle = (float)block*2.4f;
+			speed = scene->speed;
+		}
+
+		b->recs[i] = (Rectangle){ p.x, p.y, w, h };
+		b->velocities[i] = (Vector2){ cosf(angle)*speed, sinf(angle)*speed };
+		b->proxies[i] = CreateBroadPhaseProxy(&b->bp, b->recs[i], i);
+	}
+
+	for (int i = 0; i < BROADPHASE_QUERIES; i++)
+	{
+		Vector2 p = GetBenchPoint(&rng, scene, centres);
+		float angle = NextRngFloat(&rng)*2.0f*PI;
+		b->queries[i] = (Rectangle){ p.x, p.y, 64.0f, 64.0f };
+		b->origins[i] = p;
+		b->deltas[i] = (Vector2){ cosf(angle)*512.0f, sinf(angle)*512.0f };
+	}
+}
+
+static void BenchMoveProxies(void *user)
+{
+	BroadPhaseBench *b = user;
+	for (int i = b->scene->statics; i < b->scene->proxies; i++)
+	{
+		Rectangle *rec = &b->recs[i];
+		Vector2 *v = &b->velocities[i];
+		if (rec->x + v->x < 0.0f || rec->x + rec->width + v->x > BROADPHASE_WORLD) v->x = -v->x;
+		if (rec->y + v->y < 0.0f || rec->y + rec->height + v->y > BROADPHASE_WORLD) v->y = -v->y;
+		rec->x += v->x;
+		rec->y += v->y;
+		MoveBroadPhaseProxy(&b->bp, b->proxies[i], *rec, *v);
+	}
+	BenchConsume(b->recs);
+}
+
+static void BenchQueryRecs(void *user)
+{
+	BroadPhaseBench *b = user;
+	b->found = b->bp.queryRecs(b->bp.data, b->queries, BROADPHASE_QUERIES, b->hits, BROADPHASE_MAX_HITS);
+	BenchConsume(b->hits);
+}
+
+static void BenchRaycasts(void *user)
+{
+	BroadPhaseBench *b = user;
+	b->found = b->bp.raycasts(b->bp.data, b->origins, b->deltas, BROADPHASE_QUERIES, b->hits, BROADPHASE_MAX_HITS);
+	BenchConsume(b->hits);
+}
+
+static void BenchFindPairs(void *user)
+{
+	BroadPhaseBench *b = user;
+	b->found = b->bp.findPairs(b->bp.data, b->pairs, BROADPHASE_MAX_HITS);
+	BenchConsume(b->pairs);
+}
+
+static void RunBroadPhaseCases(Bench *bench, BroadPhaseBench *b)
+{
+	const BroadPhaseScene *scene = b->scene;
+	const char *distribution = scene->name;
+	char name[64];
+	snprintf(name, sizeof(name), "broadphase/%s_%s_query", b->bp.name, distribution);
+	RunBench(bench, name, BROADPHASE_QUERIES, BenchQueryRecs, b);
+	snprintf(name, sizeof(name), "broadphase/%s_%s_raycast", b->bp.name, distribution);
+	RunBench(bench, name, BROADPHASE_QUERIES, BenchRaycasts, b);
+	snprintf(name, sizeof(name), "broadphase/%s_%s_pairs", b->bp.name, distribution);
+	RunBench(bench, name, scene->proxies, BenchFindPairs, b);
+	snprintf(name, sizeof(name), "broadphase/%s_%s_move", b->bp.name, distribution);
+	RunBench(bench, name, scene->proxies - scene->statics, BenchMoveProxies, b);
+}
+
+// How much of each tick's pair list the sweep and prune cache carries over from the last
+static void TraceSweepPruneCache(BroadPhaseBench *b)
+{
+	long long pairs = 0, added = 0, swaps = 0, updates = 0;
+	GetSweepPruneStats(&b->bp);
+	for (int tick = 0; tick < BROADPHASE_STAT_TICKS; tick++)
+	{
+		BenchMoveProxies(b);
+		BenchFindPairs(b);
+		SweepPruneStats stats = GetSweepPruneStats(&b->bp);
+		pairs += stats.pairs;
+		added += stats.added;
+		swaps += stats.swaps;
+		updates += stats.updates;
+	}
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "SAP: %s: %.2f%% pair cache hits, %lld pairs a tick, %.2f swaps per moved body",
+		b->scene->name, pairs? 100.0*(pairs - added)/pairs : 100.0, pairs/BROADPHASE_STAT_TICKS, updates? (double)swaps/updates : 0.0);
+	SetTraceLogLevel(LOG_WARNING);
+}
+
+void RunBroadPhaseBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "broadphase/")) return;
+
+	int sceneCount = sizeof(broadPhaseScenes)/sizeof(broadPhaseScenes[0]);
+	for (int s = 0; s < sceneCount; s++)
+	{
+		BroadPhaseBench *benches[BROADPHASE_KINDS];
+		Rectangle bounds = { 0.0f, 0.0f, BROADPHASE_WORLD, BROADPHASE_WORLD };
+		BroadPhase bps[BROADPHASE_KINDS] = {
+			CreateGridBroadPhase(bounds, BROADPHASE_CELL),
+			CreateTreeBroadPhase(BROADPHASE_MARGIN),
+			CreateSweepBroadPhase(),
+		};
+
+		for (int i = 0; i < BROADPHASE_KINDS; i++)
+		{
+			benches[i] = calloc(1, sizeof(BroadPhaseBench));
+			benches[i]->hits = malloc(BROADPHASE_MAX_HITS*sizeof(BroadPhaseHit));
+			benches[i]->pairs = malloc(BROADPHASE_MAX_HITS*sizeof(BroadPhasePair));
+			FillBroadPhaseBench(benches[i], bps[i], &broadPhaseScenes[s]);
+		}
+
+		for (int i = 0; i < BROADPHASE_KINDS; i++)
+		{
+			RunBroadPhaseCases(bench, benches[i]);
+			if (i == BROADPHASE_KINDS - 1) TraceSweepPruneCache(benches[i]);
+			UnloadBroadPhase(&benches[i]->bp);
+			free(benches[i]->hits);
+			free(benches[i]->pairs);
+			free(benches[i]);
+		}
+	}
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "tilemap.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define COLLISION_SEED 2024
+#define COLLISION_MAP_SIZE 4096
+#define SWEEP_BODIES 100000
+#define SWEEP_MAX_TILES 4.0f	// Longest move per tick, dashes and bullets at full speed
+
+typedef struct SweepBench {
+	const Tilemap *map;
+	Vector2 size;
+	float posX[SWEEP_BODIES];
+	float posY[SWEEP_BODIES];
+	float velX[SWEEP_BODIES];
+	float velY[SWEEP_BODIES];
+	TileSweep hits[SWEEP_BODIES];
+} SweepBench;
+
+static void BenchSweep(void *user)
+{
+	SweepBench *b = user;
+	SweepTilemapRecs(b->map, b->size, b->posX, b->posY, b->velX, b->velY, 1.0f, SWEEP_BODIES, b->hits);
+	BenchConsume(b->hits);
+}
+
+// What avoiding tunnelling costs without a sweep: discrete tests every body size along
+// the motion, stopping at the first overlap. Still only as precise as the step.
+static void BenchSubstep(void *user)
+{
+	SweepBench *b = user;
+	float step = fminf(b->size.x, b->size.y);
+
+	for (int i = 0; i < SWEEP_BODIES; i++)
+	{
+		float length = sqrtf(b->velX[i]*b->velX[i] + b->velY[i]*b->velY[i]);
+		int steps = (int)ceilf(length/step);
+		float time = 1.0f;
+
+		for (int s = 1; s <= steps; s++)
+		{
+			float t = (float)s/steps;
+			Rectangle rec = { b->posX[i] + b->velX[i]*t, b->posY[i] + b->velY[i]*t, b->size.x, b->size.y };
+			if (CheckCollisionTilemapRec(b->map, rec))
+			{
+				time = (float)(s - 1)/steps;
+				break;
+			}
+		}
+		b->hits[i].time = time;
+	}
+	BenchConsume(b->hits);
+}
+
+// Bodies start in open space with random headings and speeds up to SWEEP_MAX_TILES a tick
+static void PlaceSweepBodies(SweepBench *b, Rng *rng)
+{
+	float extent = (float)COLLISION_MAP_SIZE*TILE_SIZE;
+	for (int i = 0; i < SWEEP_BODIES; i++)
+	{
+		Rectangle rec;
+		do rec = (Rectangle){ NextRngFloat(rng)*extent, NextRngFloat(rng)*extent, b->size.x, b->size.y };
+		while (CheckCollisionTilemapRec(b->map, rec));
+
+		float angle = NextRngFloat(rng)*2.0f*PI;
+		float speed = NextRngFloat(rng)*SWEEP_MAX_TILES*TILE_SIZE;
+		b->posX[i] = rec.x;
+		b->posY[i] = rec.y;
+		b->velX[i] = cosf(angle)*speed;
+		b->velY[i] = sinf(angle)*speed;
+	}
+}
+
+void RunCollisionBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "collision/")) return;
+
+	Tilemap map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(COLLISION_MAP_SIZE, COLLISION_MAP_SIZE, COLLISION_SEED));
+	SweepBench *b = calloc(1, sizeof(SweepBench));
+	Rng rng = SeedRng(COLLISION_SEED);
+	b->map = &map;
+
+	b->size = (Vector2){ 6, 6 };	// Bullet
+	PlaceSweepBodies(b, &rng);
+	RunBench(bench, "collision/sweep_100k_bullets", SWEEP_BODIES, BenchSweep, b);
+	RunBench(bench, "collision/substep_100k_bullets", SWEEP_BODIES, BenchSubstep, b);
+
+	b->size = (Vector2){ 32, 32 };	// Player
+	PlaceSweepBodies(b, &rng);
+	RunBench(bench, "collision/sweep_100k_players", SWEEP_BODIES, BenchSweep, b);
+	RunBench(bench, "collision/substep_100k_players", SWEEP_BODIES, BenchSubstep, b);
+
+	free(b);
+	UnloadTilemap(map);
+}
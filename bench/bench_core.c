@@ -0,0 +1,268 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "game.h"
+#include "snapshot.h"
+#include "assets.h"
+#include "assetcache.h"
+#include "jobs.h"
+
+#define LOOKUPS 100000
+#define SNAPSHOT_ENTITIES 50000
+
+//----------------------------------------------------------------------------------
+// Tilemap
+//----------------------------------------------------------------------------------
+typedef struct TilemapBench {
+	Tilemap map;
+	int *coords;	// x, y pairs
+	Rectangle *recs;
+	int hits;
+} TilemapBench;
+
+static void BenchIsTileSolid(void *user)
+{
+	TilemapBench *b = user;
+	int hits = 0;
+	for (int i = 0; i < LOOKUPS; i++) hits += IsTileSolid(&b->map, b->coords[2*i], b->coords[2*i + 1]);
+	b->hits = hits;
+}
+
+static void BenchCollideRec(void *user)
+{
+	TilemapBench *b = user;
+	int hits = 0;
+	for (int i = 0; i < LOOKUPS; i++) hits += CheckCollisionTilemapRec(&b->map, b->recs[i]);
+	b->hits = hits;
+}
+
+static void RunTilemapBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "tilemap/")) return;
+
+	TilemapBench b = { .map = GenTilemapEmpty(1024, 1024) };
+	Rng rng = SeedRng(1);
+	int wall = AddTilemapColor(&b.map, ORANGE);
+	for (int i = 0; i < b.map.width*b.map.height; i++) b.map.tiles[i] = (NextRngFloat(&rng) < 0.3f)? wall : TILE_EMPTY;
+
+	b.coords = malloc(2*LOOKUPS*sizeof(int));
+	b.recs = malloc(LOOKUPS*sizeof(Rectangle));
+	for (int i = 0; i < LOOKUPS; i++)
+	{
+		b.coords[2*i] = (int)(NextRng(&rng)%1024);
+		b.coords[2*i + 1] = (int)(NextRng(&rng)%1024);
+		b.recs[i] = (Rectangle){ NextRngFloat(&rng)*1024*TILE_SIZE, NextRngFloat(&rng)*1024*TILE_SIZE, 32, 32 };
+	}
+
+	RunBench(bench, "tilemap/is_tile_solid", LOOKUPS, BenchIsTileSolid, &b);
+	RunBench(bench, "tilemap/collide_rec", LOOKUPS, BenchCollideRec, &b);
+	BenchConsume(&b.hits);
+
+	free(b.coords);
+	free(b.recs);
+	UnloadTilemap(b.map);
+}
+
+//----------------------------------------------------------------------------------
+// Entities and snapshots
+//----------------------------------------------------------------------------------
+typedef struct WorldBench {
+	World world;
+	Snapshot base;
+	Snapshot snapshot;
+	Snapshot decoded;
+} WorldBench;
+
+// Large open arena so nothing despawns between repetitions
+static World GenBenchWorld(EntityKind kind, int count)
+{
+	World world = { 0 };
+	world.map = GenTilemapEmpty(1024, 1024);
+	world.entities = AllocEntities(count);
+	world.rng = SeedRng(7);
+
+	for (int i = 0; i < count; i++)
+	{
+		Vector2 pos = { 4096 + NextRngFloat(&world.rng)*32768, 4096 + NextRngFloat(&world.rng)*32768 };
+		Vector2 vel = { (NextRngFloat(&world.rng) - 0.5f)*200, (NextRngFloat(&world.rng) - 0.5f)*200 };
+		SpawnEntity(&world.entities, kind, pos, vel);
+	}
+
+	return world;
+}
+
+static void BenchUpdateEntities(void *user)
+{
+	World *world = user;
+	UpdateEntities(&world->entities, &world->map, 1.0f/GAME_TICK_RATE);
+}
+
+static void BenchEncodeKeyframe(void *user)
+{
+	WorldBench *b = user;
+	EncodeSnapshot(&b->world, NULL, 0, &b->snapshot);
+}
+
+static void BenchEncodeDelta(void *user)
+{
+	WorldBench *b = user;
+	EncodeSnapshot(&b->world, &b->base, SNAPSHOT_DELTA, &b->snapshot);
+}
+
+static void BenchEncodeDeltaLz(void *user)
+{
+	WorldBench *b = user;
+	EncodeSnapshot(&b->world, &b->base, SNAPSHOT_DELTA | SNAPSHOT_LZ, &b->snapshot);
+}
+
+static void BenchDecodeDelta(void *user)
+{
+	WorldBench *b = user;
+	DecodeSnapshot(b->snapshot.data, b->snapshot.dataSize, &b->base, &b->decoded);
+}
+
+static void BenchApplySnapshot(void *user)
+{
+	WorldBench *b = user;
+	ApplySnapshot(&b->decoded, &b->world);
+}
+
+static void RunEntityBenches(Bench *bench)
+{
+	if (IsBenchEnabled(bench, "entities/"))
+	{
+		World bullets = GenBenchWorld(ENTITY_BULLET, 50000);
+		RunBench(bench, "entities/update_bullets_50k", bullets.entities.count, BenchUpdateEntities, &bullets);
+		UnloadWorld(&bullets);
+
+		World bodies = GenBenchWorld(ENTITY_ENEMY, 50000);
+		RunBench(bench, "entities/update_bodies_50k", bodies.entities.count, BenchUpdateEntities, &bodies);
+		UnloadWorld(&bodies);
+	}
+
+	if (IsBenchEnabled(bench, "snapshot/"))
+	{
+		WorldBench b = { .world = GenBenchWorld(ENTITY_ENEMY, SNAPSHOT_ENTITIES) };
+		EncodeSnapshot(&b.world, NULL, 0, &b.base);
+		// One tick of movement is the typical distance between rollback snapshots
+		UpdateEntities(&b.world.entities, &b.world.map, 1.0f/GAME_TICK_RATE);
+
+		RunBench(bench, "snapshot/encode_key_50k", SNAPSHOT_ENTITIES, BenchEncodeKeyframe, &b);
+		RunBench(bench, "snapshot/encode_delta_lz_50k", SNAPSHOT_ENTITIES, BenchEncodeDeltaLz, &b);
+		RunBench(bench, "snapshot/encode_delta_50k", SNAPSHOT_ENTITIES, BenchEncodeDelta, &b);
+		RunBench(bench, "snapshot/decode_delta_50k", SNAPSHOT_ENTITIES, BenchDecodeDelta, &b);
+		RunBench(bench, "snapshot/apply_50k", SNAPSHOT_ENTITIES, BenchApplySnapshot, &b);
+
+		UnloadSnapshot(&b.base);
+		UnloadSnapshot(&b.snapshot);
+		UnloadSnapshot(&b.decoded);
+		UnloadWorld(&b.world);
+	}
+}
+
+//----------------------------------------------------------------------------------
+// Asset decode, from memory so disk caching does not skew the numbers
+//----------------------------------------------------------------------------------
+typedef struct AssetBench {
+	const char *fileType;
+	unsigned char *data;
+	int size;
+} AssetBench;
+
+static void BenchDecodeImage(void *user)
+{
+	AssetBench *b = user;
+	Image image = LoadImageFromMemory(b->fileType, b->data, b->size);
+	UnloadImage(image);
+}
+
+static void BenchDecodeWave(void *user)
+{
+	AssetBench *b = user;
+	Wave wave = LoadWaveFromMemory(b->fileType, b->data, b->size);
+	UnloadWave(wave);
+}
+
+#define BENCH_CACHE_DIR "cache"
+
+static void BenchLoadImage(void *user)
+{
+	UnloadImage(LoadImage(user));
+}
+
+static void BenchLoadImageCached(void *user)
+{
+	UnloadImage(LoadImageCached(user, BENCH_CACHE_DIR, 0));
+}
+
+typedef struct StartupBench {
+	AssetLoad loads[8];
+	JobSystem *jobs;
+} StartupBench;
+
+static void BenchStartupDecode(void *user)
+{
+	StartupBench *b = user;
+	AssetBatch batch = { .loads = b->loads, .count = 8, .jobs = b->jobs };
+	LoadAssetsAsync(&batch);
+	WaitAssets(&batch);
+	UnloadAssetBatch(&batch);
+	UnloadAssetData(b->loads, 8);
+}
+
+static void RunAssetBenches(Bench *bench)
+{
+	static const struct { const char *name; const char *path; } assets[8] = {
+		{ "assets/decode_space_png", "res/sprites/space.png" },
+		{ "assets/decode_player_sprite_png", "res/sprites/player_sprite.png" },
+		{ "assets/decode_map01_png", "res/maps/map01.png" },
+		{ "assets/decode_map02_png", "res/maps/map02.png" },
+		{ "assets/decode_boop_wav", "res/sfx/boop.wav" },
+		{ "assets/decode_gun_fire_wav", "res/sfx/gun_fire.wav" },
+		{ "assets/decode_hurt_wav", "res/sfx/hurt.wav" },
+		{ "assets/decode_soft_boop_wav", "res/sfx/soft_boop.wav" },
+	};
+
+	if (!IsBenchEnabled(bench, "assets/")) return;
+
+	for (int i = 0; i < (int)(sizeof(assets)/sizeof(assets[0])); i++)
+	{
+		AssetBench b = { .fileType = GetFileExtension(assets[i].path) };
+		b.data = LoadFileData(assets[i].path, &b.size);
+		if (b.data == NULL) continue;	// Not run from the repository root
+
+		RunBench(bench, assets[i].name, 1, (strcmp(b.fileType, ".png") == 0)? BenchDecodeImage : BenchDecodeWave, &b);
+		UnloadFileData(b.data);
+	}
+
+	// Warm start of the largest image straight from disk, with and without the decoded pixel cache
+	const char *space = assets[0].path;
+	if (FileExists(space))
+	{
+		UnloadImage(LoadImageCached(space, BENCH_CACHE_DIR, 0));	// Make sure the entry is warm
+		RunBench(bench, "assets/space_png_load_image", 1, BenchLoadImage, (void *)space);
+		RunBench(bench, "assets/space_png_load_cached", 1, BenchLoadImageCached, (void *)space);
+	}
+
+	// Whole startup set read from disk, serially and spread over the job system
+	StartupBench startup = { 0 };
+	for (int i = 0; i < 8; i++)
+	{
+		startup.loads[i].fileName = assets[i].path;
+		startup.loads[i].kind = (strcmp(GetFileExtension(assets[i].path), ".png") == 0)? ASSET_IMAGE : ASSET_WAVE;
+	}
+	RunBench(bench, "assets/startup_decode_serial", 1, BenchStartupDecode, &startup);
+	startup.jobs = CreateJobSystem(0);
+	RunBench(bench, "assets/startup_decode_parallel", 1, BenchStartupDecode, &startup);
+	DestroyJobSystem(startup.jobs);
+}
+
+void RunCoreBenches(Bench *bench)
+{
+	RunTilemapBenches(bench);
+	RunEntityBenches(bench);
+	RunAssetBenches(bench);
+}
@@ -0,0 +1,132 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "debugui.h"
+
+#define DEBUGUI_WIDGETS 100
+#define DEBUGUI_SLIDERS 60
+#define DEBUGUI_INT_SLIDERS 20
+#define DEBUGUI_GRAPHS 2
+#define DEBUGUI_CHECKBOXES (DEBUGUI_WIDGETS - DEBUGUI_SLIDERS - DEBUGUI_INT_SLIDERS - DEBUGUI_GRAPHS)
+#define DEBUGUI_GRAPH_SAMPLES 120
+#define DEBUGUI_WIDTH 320.0f
+#define DEBUGUI_BUDGET_NS 200000.0	// Per frame
+
+// A fixed width font with a solid block in glyph 95 like raylib's default one, CPU side only
+typedef struct DebugUiFont {
+	Font font;
+	GlyphInfo glyphs[96];
+	Rectangle recs[96];
+} DebugUiFont;
+
+typedef struct DebugUiBench {
+	DebugUiFont font;
+	TextAtlas atlas;
+	TextCache cache;
+	SpriteBatch batch;
+	DebugUi ui;
+	char labels[DEBUGUI_WIDGETS][32];
+	float values[DEBUGUI_SLIDERS];
+	int ints[DEBUGUI_INT_SLIDERS];
+	bool flags[DEBUGUI_CHECKBOXES];
+	float frameMs[DEBUGUI_GRAPH_SAMPLES];
+	int frameHead;
+	int frame;
+	DebugUiInput input;
+	bool rebuildAll;
+} DebugUiBench;
+
+static void LoadBenchFont(DebugUiFont *f)
+{
+	for (int i = 0; i < 96; i++)
+	{
+		f->glyphs[i] = (GlyphInfo){ .value = TEXT_FIRST_CHAR + i, .advanceX = 6 };
+		f->recs[i] = (Rectangle){ (float)(1 + (i%16)*8), (float)(1 + (i/16)*12), 5.0f, 10.0f };
+	}
+	f->font = (Font){
+		.baseSize = 10, .glyphCount = 96, .glyphPadding = 1,
+		.texture = { .id = 1, .width = 128, .height = 128, .mipmaps = 1 },
+		.recs = f->recs, .glyphs = f->glyphs,
+	};
+}
+
+static void BuildPanel(DebugUiBench *b)
+{
+	if (b->rebuildAll) for (int i = 0; i < DEBUG_UI_MAX_WIDGETS; i++) b->ui.widgets[i].key = 0;
+
+	BeginTextFrame(&b->cache);
+	BeginSpriteBatch(&b->batch);
+	BeginDebugUi(&b->ui, b->input);
+
+	int w = 0;
+	for (int i = 0; i < DEBUGUI_GRAPHS; i++) DebugGraph(&b->ui, b->labels[w++], b->frameMs, DEBUGUI_GRAPH_SAMPLES, b->frameHead, 33.3f);
+	for (int i = 0; i < DEBUGUI_SLIDERS; i++) DebugSlider(&b->ui, b->labels[w++], &b->values[i], 0.0f, 10.0f);
+	for (int i = 0; i < DEBUGUI_INT_SLIDERS; i++) DebugSliderInt(&b->ui, b->labels[w++], &b->ints[i], 0, 256);
+	for (int i = 0; i < DEBUGUI_CHECKBOXES; i++) DebugCheckbox(&b->ui, b->labels[w++], &b->flags[i]);
+
+	EndDebugUi(&b->ui, &b->batch);
+	EndSpriteBatch(&b->batch);
+}
+
+// A frame time sample a frame, the mouse resting over one of the sliders
+static void BenchFrame(void *user)
+{
+	DebugUiBench *b = user;
+	b->frame++;
+	b->frameMs[b->frameHead] = 16.0f + (float)(b->frame%7)*0.3f;
+	b->frameHead = (b->frameHead + 1)%DEBUGUI_GRAPH_SAMPLES;
+	BuildPanel(b);
+	BenchConsume(b->batch.quads);
+}
+
+// A point t of the way along the control of a row below the graphs
+static Vector2 GetBenchTrackPoint(int row, float t)
+{
+	float rowWidth = DEBUGUI_WIDTH - 2.0f*DEBUG_UI_PADDING;
+	float x = DEBUG_UI_PADDING + rowWidth*DEBUG_UI_LABEL_WIDTH;
+	float y = DEBUG_UI_PADDING + (DEBUGUI_GRAPHS*DEBUG_UI_GRAPH_ROWS + row)*DEBUG_UI_ROW_HEIGHT + DEBUG_UI_ROW_HEIGHT/2.0f;
+	return (Vector2){ x + t*rowWidth*(1.0f - DEBUG_UI_LABEL_WIDTH), y };
+}
+
+void RunDebugUiBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "debugui/")) return;
+
+	DebugUiBench *b = calloc(1, sizeof(DebugUiBench));
+	LoadBenchFont(&b->font);
+	b->atlas = LoadTextAtlas(b->font.font);
+	b->cache = LoadTextCache(&b->atlas);
+	b->batch = LoadSpriteBatch(1024);
+	b->ui = LoadDebugUi(&b->cache, GetDefaultFontSolid(b->font.font), (Vector2){ 0.0f, 0.0f }, DEBUGUI_WIDTH);
+
+	for (int i = 0; i < DEBUGUI_WIDGETS; i++) snprintf(b->labels[i], sizeof(b->labels[i]), "tunable %d", i);
+	for (int i = 0; i < DEBUGUI_SLIDERS; i++) b->values[i] = (float)(i%10);
+	for (int i = 0; i < DEBUGUI_INT_SLIDERS; i++) b->ints[i] = i*8;
+	for (int i = 0; i < DEBUGUI_GRAPH_SAMPLES; i++) b->frameMs[i] = 16.6f;
+
+	// Left hovering a slider for the timed frames
+	b->input = (DebugUiInput){ GetBenchTrackPoint(4, 0.5f), false, false };
+	BuildPanel(b);
+
+	RunBench(bench, "debugui/frame_100_cached", DEBUGUI_WIDGETS, BenchFrame, b);
+	double cachedNs = bench->results[bench->count - 1].medianNs*DEBUGUI_WIDGETS;
+	int rebuilt = b->ui.stats.rebuilt, quads = b->ui.stats.quads, drawCalls = b->batch.last.drawCalls;
+	b->rebuildAll = true;
+	RunBench(bench, "debugui/frame_100_rebuilt", DEBUGUI_WIDGETS, BenchFrame, b);
+	double rebuiltNs = bench->results[bench->count - 1].medianNs*DEBUGUI_WIDGETS;
+	b->rebuildAll = false;
+
+	if (cachedNs > DEBUGUI_BUDGET_NS) printf("BENCH: Debug UI over its frame budget, %.3f ms for %d widgets\n", cachedNs/1e6, DEBUGUI_WIDGETS);
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "DEBUGUI: %i widgets, %i rebuilt, %i quads in %i draw calls, %.3f ms a frame cached vs %.3f ms building every widget",
+		DEBUGUI_WIDGETS, rebuilt, quads, drawCalls, cachedNs/1e6, rebuiltNs/1e6);
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadDebugUi(&b->ui);
+	UnloadSpriteBatch(&b->batch);
+	UnloadTextCache(&b->cache);
+	free(b);
+}
@@ -0,0 +1,125 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "events.h"
+#include "rng.h"
+
+#define EVENTS_SEED 46
+#define EVENTS_PER_TICK 4096
+#define EVENTS_PARTICLES 4096
+#define EVENTS_ENTITIES 10000
+
+// Stand-ins for the systems that listen: audio, muzzle flash particles and the HUD
+typedef struct EventConsumers {
+	float panSum;
+	int voices;
+	Vector2 particles[EVENTS_PARTICLES];
+	int particleCount;
+	int shots;
+} EventConsumers;
+
+typedef struct EventsBench {
+	EventBus bus;
+	EventConsumers consumers;
+	int shooters[EVENTS_PER_TICK];
+	Vector2 origins[EVENTS_PER_TICK];
+} EventsBench;
+
+static void ShotAudioHandler(void *user, const void *events, int count)
+{
+	EventConsumers *c = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) c->panSum += shots[i].origin.x*(1.0f/4096.0f)*2.0f - 1.0f;
+	c->voices += count;
+}
+
+static void MuzzleFlashHandler(void *user, const void *events, int count)
+{
+	EventConsumers *c = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) c->particles[(c->particleCount++)%EVENTS_PARTICLES] = shots[i].origin;
+}
+
+static void CountShots(void *user, const void *events, int count)
+{
+	(void)events;
+	((EventConsumers *)user)->shots += count;
+}
+
+static void AddBenchHandlers(EventBus *bus, EventConsumers *c)
+{
+	AddEventHandler(bus, EVENT_SHOT_FIRED, ShotAudioHandler, c);
+	AddEventHandler(bus, EVENT_SHOT_FIRED, MuzzleFlashHandler, c);
+	AddEventHandler(bus, EVENT_SHOT_FIRED, CountShots, c);
+}
+
+static void EmitBenchEvent(EventsBench *b, int i)
+{
+	EmitShotFired(&b->bus, (ShotFiredEvent){ b->shooters[i], b->origins[i], (Vector2){ 720.0f, 0.0f } });
+}
+
+static void BenchEmitShots(void *user)
+{
+	EventsBench *b = user;
+	for (int i = 0; i < EVENTS_PER_TICK; i++) EmitBenchEvent(b, i);
+	BenchConsume(b->bus.pending[EVENT_SHOT_FIRED].data);
+	b->bus.pending[EVENT_SHOT_FIRED].count = 0;
+}
+
+static void BenchEmitAndDispatch(void *user)
+{
+	EventsBench *b = user;
+	for (int i = 0; i < EVENTS_PER_TICK; i++) EmitBenchEvent(b, i);
+	DispatchEvents(&b->bus);
+	BenchConsume(&b->consumers);
+}
+
+// What calling straight into every system from gameplay code amounts to: each handler
+// runs once per event, interleaved with the others
+static void BenchInlineCalls(void *user)
+{
+	EventsBench *b = user;
+	EventBus *bus = &b->bus;
+	for (int i = 0; i < EVENTS_PER_TICK; i++)
+	{
+		EmitBenchEvent(b, i);
+		EventBuffer *buffer = &bus->pending[EVENT_SHOT_FIRED];
+		const void *event = buffer->data + (size_t)eventSizes[EVENT_SHOT_FIRED]*(buffer->count - 1);
+		for (int h = 0; h < bus->handlerCounts[EVENT_SHOT_FIRED]; h++) bus->handlers[EVENT_SHOT_FIRED][h](bus->handlerUsers[EVENT_SHOT_FIRED][h], event, 1);
+		buffer->count = 0;
+	}
+	BenchConsume(&b->consumers);
+}
+
+void RunEventBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "events/")) return;
+
+	EventsBench *b = calloc(1, sizeof(EventsBench));
+	b->bus = LoadEventBus();
+	AddBenchHandlers(&b->bus, &b->consumers);
+
+	// A tick's worth of shots from shooters spread over the map
+	Rng rng = SeedRng(EVENTS_SEED);
+	for (int i = 0; i < EVENTS_PER_TICK; i++)
+	{
+		b->shooters[i] = (int)(NextRng(&rng)%EVENTS_ENTITIES);
+		b->origins[i] = (Vector2){ NextRngFloat(&rng)*4096.0f, NextRngFloat(&rng)*4096.0f };
+	}
+
+	RunBench(bench, "events/emit_shot", EVENTS_PER_TICK, BenchEmitShots, b);
+	RunBench(bench, "events/emit_dispatch_batched", EVENTS_PER_TICK, BenchEmitAndDispatch, b);
+	double batchedNs = bench->results[bench->count - 1].medianNs;
+	RunBench(bench, "events/emit_dispatch_inline", EVENTS_PER_TICK, BenchInlineCalls, b);
+	double inlineNs = bench->results[bench->count - 1].medianNs;
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "EVENTS: %i events per tick, %.1f ns each batched vs %.1f ns calling handlers inline, %.0f M events/s",
+		EVENTS_PER_TICK, batchedNs, inlineNs, 1000.0/batchedNs);
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadEventBus(&b->bus);
+	free(b);
+}
@@ -0,0 +1,101 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fov.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define FOV_SEED 42
+#define FOV_MAP_SIZE 512
+#define FOV_RADIUS 16
+#define FOV_WALK_STEPS 4096	// One tile per step through open tiles
+#define FOV_BUDGET_NS 50000.0
+
+typedef struct FovBench {
+	Tilemap map;
+	FieldOfView fov;
+	int *walkX;
+	int *walkY;
+	int step;
+} FovBench;
+
+// A random walk one tile at a time, the way the player moves between updates
+static void GenFovWalk(FovBench *b, Rng *rng)
+{
+	static const int dirs[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	int x, y;
+	do
+	{
+		x = (int)(NextRng(rng)%FOV_MAP_SIZE);
+		y = (int)(NextRng(rng)%FOV_MAP_SIZE);
+	} while (IsTileSolid(&b->map, x, y));
+
+	for (int i = 0; i < FOV_WALK_STEPS; i++)
+	{
+		b->walkX[i] = x;
+		b->walkY[i] = y;
+		for (int tries = 0; tries < 16; tries++)
+		{
+			const int *d = dirs[NextRng(rng)%4];
+			if (IsTileSolid(&b->map, x + d[0], y + d[1])) continue;
+			x += d[0];
+			y += d[1];
+			break;
+		}
+	}
+}
+
+// Walks the path forwards then backwards so every step moves
+static void BenchFovWalk(void *user)
+{
+	FovBench *b = user;
+	int i = b->step%(2*FOV_WALK_STEPS - 2);
+	if (i >= FOV_WALK_STEPS) i = 2*FOV_WALK_STEPS - 2 - i;
+	b->step++;
+	UpdateFieldOfView(&b->fov, &b->map, b->walkX[i], b->walkY[i]);
+	BenchConsume(b->fov.visible);
+}
+
+static void BenchFovFull(void *user)
+{
+	FovBench *b = user;
+	FieldOfView fresh = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+	UpdateFieldOfView(&fresh, &b->map, b->walkX[0], b->walkY[0]);
+	BenchConsume(fresh.visible);
+	UnloadFieldOfView(&fresh);
+}
+
+void RunFovBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "fov/")) return;
+
+	FovBench *b = calloc(1, sizeof(FovBench));
+	b->map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_SEED));
+	b->fov = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+	b->walkX = malloc(FOV_WALK_STEPS*sizeof(int));
+	b->walkY = malloc(FOV_WALK_STEPS*sizeof(int));
+
+	Rng rng = SeedRng(FOV_SEED);
+	GenFovWalk(b, &rng);
+
+	RunBench(bench, "fov/update_walk_512", 1, BenchFovWalk, b);
+	double walkNs = bench->results[bench->count - 1].medianNs;
+	RunBench(bench, "fov/load_and_update_512", 1, BenchFovFull, b);
+
+	int visible = 0;
+	for (int y = 0; y < FOV_MAP_SIZE; y++) for (int x = 0; x < FOV_MAP_SIZE; x++) visible += IsTileVisible(&b->fov, x, y);
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "FOV: radius %i on %ix%i tiles, %i tiles in view, %.1f us per step", FOV_RADIUS,
+		FOV_MAP_SIZE, FOV_MAP_SIZE, visible, walkNs/1000.0);
+	SetTraceLogLevel(LOG_WARNING);
+	if (walkNs > FOV_BUDGET_NS) printf("BENCH: field of view update over budget, %.1f us\n", walkNs/1000.0);
+
+	UnloadFieldOfView(&b->fov);
+	UnloadTilemap(b->map);
+	free(b->walkX);
+	free(b->walkY);
+	free(b);
+}
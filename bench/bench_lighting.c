@@ -0,0 +1,83 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lighting.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define LIGHTING_SEED 41
+#define LIGHTING_MAP_SIZE 256
+#define LIGHTING_LIGHTS 64
+#define LIGHTING_MOVING 8	// Lights carried by moving things, the rest are fixtures
+#define LIGHTING_RADIUS (6.0f*TILE_SIZE)
+
+typedef struct LightingBench {
+	Tilemap map;
+	Lighting lighting;
+	int tick;
+} LightingBench;
+
+static void BenchExtractEdges(void *user)
+{
+	LightingBench *b = user;
+	UpdateLightingTiles(&b->lighting, &b->map, (Rectangle){ 0, 0, (float)b->map.width, (float)b->map.height });
+	BenchConsume(b->lighting.edges);
+}
+
+static void BenchAllPolygons(void *user)
+{
+	LightingBench *b = user;
+	for (int i = 0; i < b->lighting.lightCount; i++) b->lighting.lights[i].dirty = true;
+	UpdateLights(&b->lighting);
+	BenchConsume(b->lighting.lights);
+}
+
+// A typical tick: a few lights move a pixel, the rest keep their cached polygons
+static void BenchMovingPolygons(void *user)
+{
+	LightingBench *b = user;
+	float step = (b->tick++ & 1)? -1.0f : 1.0f;
+	for (int i = 0; i < LIGHTING_MOVING; i++)
+	{
+		Vector2 p = b->lighting.lights[i].position;
+		SetLightPosition(&b->lighting, i, (Vector2){ p.x + step, p.y });
+	}
+	UpdateLights(&b->lighting);
+	BenchConsume(b->lighting.lights);
+}
+
+void RunLightingBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "lighting/")) return;
+
+	LightingBench *b = calloc(1, sizeof(LightingBench));
+	b->map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(LIGHTING_MAP_SIZE, LIGHTING_MAP_SIZE, LIGHTING_SEED));
+	b->lighting = LoadLighting(&b->map);
+
+	// Fixtures sit in the middle of open tiles
+	Rng rng = SeedRng(LIGHTING_SEED);
+	while (b->lighting.lightCount < LIGHTING_LIGHTS)
+	{
+		int x = (int)(NextRng(&rng)%LIGHTING_MAP_SIZE), y = (int)(NextRng(&rng)%LIGHTING_MAP_SIZE);
+		if (IsTileSolid(&b->map, x, y)) continue;
+		AddLight(&b->lighting, (Vector2){ (x + 0.5f)*TILE_SIZE, (y + 0.5f)*TILE_SIZE }, LIGHTING_RADIUS, WHITE);
+	}
+	UpdateLights(&b->lighting);
+
+	int vertices = 0;
+	for (int i = 0; i < b->lighting.lightCount; i++) vertices += b->lighting.lights[i].vertexCount;
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "LIGHTING: %i merged edges on %ix%i tiles, %.1f vertices per polygon",
+		b->lighting.edgeCount, LIGHTING_MAP_SIZE, LIGHTING_MAP_SIZE, (float)vertices/b->lighting.lightCount);
+	SetTraceLogLevel(LOG_WARNING);
+
+	RunBench(bench, "lighting/extract_edges_256", LIGHTING_MAP_SIZE*LIGHTING_MAP_SIZE, BenchExtractEdges, b);
+	RunBench(bench, "lighting/polygons_64_lights", LIGHTING_LIGHTS, BenchAllPolygons, b);
+	RunBench(bench, "lighting/polygons_64_lights_8_moving", LIGHTING_LIGHTS, BenchMovingPolygons, b);
+
+	UnloadLighting(&b->lighting);
+	UnloadTilemap(b->map);
+	free(b);
+}
@@ -0,0 +1,38 @@
+#include "bench.h"
+
+#include <stdio.h>
+
+#include "mapgen.h"
+
+#define MAPGEN_SEED 2024
+
+typedef struct MapGenBench {
+	JobSystem *jobs;
+	MapGenParams params;
+} MapGenBench;
+
+static void BenchGenerate(void *user)
+{
+	MapGenBench *b = user;
+	Tilemap map = GenTilemapProcedural(b->jobs, b->params);
+	BenchConsume(map.tiles);
+	UnloadTilemap(map);
+}
+
+void RunMapGenBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "mapgen/")) return;
+
+	JobSystem *jobs = CreateJobSystem(0);
+
+	MapGenBench b = { NULL, GetDefaultMapGenParams(1024, 1024, MAPGEN_SEED) };
+	RunBench(bench, "mapgen/generate_1024_serial", 1024*1024, BenchGenerate, &b);
+	b.jobs = jobs;
+	RunBench(bench, "mapgen/generate_1024_jobs", 1024*1024, BenchGenerate, &b);
+
+	// Stress map size, the scale collision and chunk baking are benchmarked at
+	b.params = GetDefaultMapGenParams(4096, 4096, MAPGEN_SEED);
+	RunBench(bench, "mapgen/generate_4096_jobs", 4096*4096, BenchGenerate, &b);
+
+	DestroyJobSystem(jobs);
+}
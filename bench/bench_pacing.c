@@ -0,0 +1,130 @@
+#include "bench.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "framepacer.h"
+#include "rng.h"
+
+#define PACING_SEED 49
+#define PACING_FPS 60
+#define PACING_FRAMES 600
+#define PACING_WORK_MIN 0.003	// Seconds of update and draw
+#define PACING_WORK_MAX 0.006
+#define PACING_SLEEP_LATE 0.002	// Sleeps wake up to this late, a busy desktop scheduler
+#define PACING_READ_COST 0.5e-6	// Each clock read, so spinning moves the fake time on
+#define PACING_VBLANK (1001.0/60000.0)	// A 59.94 Hz display, a little slower than the target
+
+// Time only moves when the pacer reads or sleeps and when the "game" works or presents
+typedef struct FakeClock {
+	double time;
+	double vblank;	// Refresh period a present waits for, 0 without vsync
+	Rng rng;
+	double slept;
+} FakeClock;
+
+static double ReadFakeClock(void *user)
+{
+	FakeClock *c = user;
+	c->time += PACING_READ_COST;
+	return c->time;
+}
+
+static void SleepFakeClock(void *user, double seconds)
+{
+	FakeClock *c = user;
+	double late = NextRngFloat(&c->rng)*PACING_SLEEP_LATE;
+	c->time += seconds + late;
+	c->slept += seconds + late;
+}
+
+static void SwapFakeClock(FakeClock *c)
+{
+	if (c->vblank > 0.0) c->time = ceil(c->time/c->vblank)*c->vblank;
+	c->time += 20e-6;
+}
+
+static double GetWork(FakeClock *c)
+{
+	return PACING_WORK_MIN + NextRngFloat(&c->rng)*(PACING_WORK_MAX - PACING_WORK_MIN);
+}
+
+static void RunPacedFrame(FramePacer *pacer, FakeClock *c, double work)
+{
+	BeginPacedFrame(pacer);
+	c->time += work;	// Poll, update, draw
+	WaitPresentTime(pacer);
+	SwapFakeClock(c);
+	EndPacedFrame(pacer);
+}
+
+// EndDrawing(): present, wait out what is left of the frame, then poll for the next one
+static double GetEndDrawingLatency(FakeClock *c, int frames)
+{
+	double period = 1.0/PACING_FPS, start = c->time, latency = 0.0;
+	for (int i = 0; i < frames; i++)
+	{
+		double input = c->time;
+		c->time += GetWork(c);
+		SwapFakeClock(c);
+		latency += c->time - input;
+
+		double left = period - (c->time - start);
+		if (left > 0.0) c->time += left;
+		start = c->time;
+	}
+	return latency/frames;
+}
+
+typedef struct PacingBench {
+	FakeClock clock;
+	FramePacer pacer;
+} PacingBench;
+
+static void BenchPacedFrames(void *user)
+{
+	PacingBench *b = user;
+	for (int i = 0; i < PACING_FRAMES; i++) RunPacedFrame(&b->pacer, &b->clock, GetWork(&b->clock));
+	BenchConsume(&b->pacer);
+}
+
+static FramePacer LoadFakePacer(FakeClock *c, double vblank)
+{
+	*c = (FakeClock){ .time = 1000.0, .vblank = vblank, .rng = SeedRng(PACING_SEED) };
+	return LoadFramePacer((FrameClock){ ReadFakeClock, SleepFakeClock, c }, PACING_FPS);
+}
+
+// The figures the log line reports, the pacing/ tests check them
+static void MeasureFramePacer(double *pacedLatency, double *endDrawingLatency, FramePacerStats *freeRunning)
+{
+	FakeClock c;
+	FramePacer pacer = LoadFakePacer(&c, 0.0);
+	for (int i = 0; i < PACING_FRAMES; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	*freeRunning = GetFramePacerStats(&pacer);
+
+	pacer = LoadFakePacer(&c, PACING_VBLANK);
+	for (int i = 0; i < 2*PACING_FRAMES; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	*pacedLatency = GetFramePacerStats(&pacer).latencyMean;
+	*endDrawingLatency = GetEndDrawingLatency(&c, PACING_FRAMES);
+}
+
+void RunPacingBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "pacing/")) return;
+
+	double pacedLatency, endDrawingLatency;
+	FramePacerStats freeRunning;
+	MeasureFramePacer(&pacedLatency, &endDrawingLatency, &freeRunning);
+
+	PacingBench *b = calloc(1, sizeof(PacingBench));
+	b->pacer = LoadFakePacer(&b->clock, PACING_VBLANK);
+	RunBench(bench, "pacing/simulated_frames", PACING_FRAMES, BenchPacedFrames, b);
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "PACING: %.4f ms +- %.4f ms a frame with sleeps up to %.1f ms late; vsynced input latency %.2f ms paced vs %.2f ms in EndDrawing order",
+		freeRunning.frameMean*1000.0, freeRunning.frameStdDev*1000.0, PACING_SLEEP_LATE*1000.0, pacedLatency*1000.0, endDrawingLatency*1000.0);
+	SetTraceLogLevel(LOG_WARNING);
+
+	free(b);
+}
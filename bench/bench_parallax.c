@@ -0,0 +1,72 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "parallax.h"
+
+#define PARALLAX_FRAMES 1000
+#define PARALLAX_SCREEN_WIDTH 800.0f
+#define PARALLAX_SCREEN_HEIGHT 600.0f
+
+// Ids are all the batch looks at without a window, sizes match the game's layers
+static Parallax LoadBenchParallax(void)
+{
+	Parallax parallax = { 0 };
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 1, .width = 800, .height = 600 }, (Vector2){ 0.05f, 0.05f }, (Vector2){ -2.0f, 0.0f }, WHITE, true);
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 2, .width = 512, .height = 512 }, (Vector2){ 0.2f, 0.2f }, (Vector2){ -6.0f, 0.0f }, WHITE, false);
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 3, .width = 400, .height = 300 }, (Vector2){ 0.5f, 0.5f }, (Vector2){ -15.0f, 0.0f }, WHITE, false);
+	return parallax;
+}
+
+typedef struct ParallaxBench {
+	Parallax parallax;
+	SpriteBatch batch;
+} ParallaxBench;
+
+static void BenchParallaxFrames(void *user)
+{
+	ParallaxBench *b = user;
+	Rectangle screen = { 0.0f, 0.0f, PARALLAX_SCREEN_WIDTH, PARALLAX_SCREEN_HEIGHT };
+	for (int i = 0; i < PARALLAX_FRAMES; i++)
+	{
+		ScrollParallax(&b->parallax, 3.0, -1.5, 1.0/60.0);
+		BeginSpriteBatch(&b->batch);
+		DrawParallax(&b->parallax, &b->batch, screen);
+		EndSpriteBatch(&b->batch);
+	}
+	BenchConsume(&b->batch.last);
+}
+
+// DrawTexture() calls it takes to cover the screen from any offset, what tiling by hand costs
+static int GetTiledDraws(const Parallax *parallax)
+{
+	int draws = 0;
+	for (int i = 0; i < parallax->count; i++)
+	{
+		Texture2D t = parallax->layers[i].texture;
+		draws += ((int)ceilf(PARALLAX_SCREEN_WIDTH/t.width) + 1)*((int)ceilf(PARALLAX_SCREEN_HEIGHT/t.height) + 1);
+	}
+	return draws;
+}
+
+void RunParallaxBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "parallax/")) return;
+
+	ParallaxBench *b = calloc(1, sizeof(ParallaxBench));
+	b->parallax = LoadBenchParallax();
+	b->batch = LoadSpriteBatch(PARALLAX_MAX_LAYERS);
+	RunBench(bench, "parallax/scroll_draw_3_layers", PARALLAX_FRAMES, BenchParallaxFrames, b);
+	SpriteBatchStats stats = b->batch.last;
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "PARALLAX: %d layers in %d quads and %d draw calls a frame vs %d tiled DrawTexture() calls",
+		b->parallax.count, stats.quads, stats.drawCalls, GetTiledDraws(&b->parallax));
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadSpriteBatch(&b->batch);
+	free(b);
+}
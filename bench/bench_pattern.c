@@ -0,0 +1,125 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pattern.h"
+#include "rng.h"
+
+#define PATTERN_SEED 44
+#define PATTERN_EMITTERS 4000
+#define PATTERN_VM_EMITTERS 1000
+#define PATTERN_BULLETS 65536
+#define PATTERN_WARMUP_TICKS 120	// Past the first waits, so emitters are out of phase
+
+static const char *spiralSource =
+	"# Four arms turning\n"
+	"set angle 0\n"
+	"repeat\n"
+	"	ring 4 angle 180\n"
+	"	add angle angle 11\n"
+	"	wait 3\n"
+	"end\n";
+
+static const char *burstSource =
+	"# Three aimed fans, then a breather\n"
+	"repeat\n"
+	"	repeat 3\n"
+	"		burst 5 40 240\n"
+	"		wait 6\n"
+	"	end\n"
+	"	wait 60\n"
+	"end\n";
+
+static const char *flowerSource =
+	"set a 0\n"
+	"set speed 120\n"
+	"repeat\n"
+	"	repeat 12\n"
+	"		fire a speed\n"
+	"		add a a 30\n"
+	"		add speed speed 10\n"
+	"	end\n"
+	"	set speed 120\n"
+	"	add a a 7\n"
+	"	wait 10\n"
+	"end\n";
+
+// Arithmetic only, to measure dispatch without spawning
+static const char *arithmeticSource =
+	"set x 0\n"
+	"repeat\n"
+	"	repeat 250\n"
+	"		add x x 1\n"
+	"		mul y x 0.5\n"
+	"		sub x x y\n"
+	"	end\n"
+	"	wait 1\n"
+	"end\n";
+
+typedef struct PatternBench {
+	EmitterPool pool;
+	Entities bullets;
+	Vector2 target;
+} PatternBench;
+
+static void BenchStepEmitters(void *user)
+{
+	PatternBench *b = user;
+	b->bullets.count = 0;
+	StepEmitters(&b->pool, b->target, &b->bullets);
+	BenchConsume(b->bullets.posX);
+}
+
+void RunPatternBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "pattern/")) return;
+
+	static BulletPattern patterns[4];
+	const char *sources[4] = { spiralSource, burstSource, flowerSource, arithmeticSource };
+	for (int i = 0; i < 4; i++)
+	{
+		if (!CompileBulletPattern(sources[i], &patterns[i])) FailBench("Pattern %d does not compile", i);
+	}
+
+	PatternBench *b = calloc(1, sizeof(PatternBench));
+	b->bullets = AllocEntities(PATTERN_BULLETS);
+	b->target = (Vector2){ 2048.0f, 2048.0f };
+
+	// Emitters spread over a 4096 pixel square, staggered so they do not all fire at once
+	Rng rng = SeedRng(PATTERN_SEED);
+	b->pool = LoadEmitterPool(PATTERN_EMITTERS);
+	for (int i = 0; i < PATTERN_EMITTERS; i++)
+	{
+		int e = AddEmitter(&b->pool, &patterns[i%3], (Vector2){ NextRngFloat(&rng)*4096.0f, NextRngFloat(&rng)*4096.0f });
+		b->pool.wait[e] = 1 + (int)(NextRng(&rng)%60);
+	}
+	for (int t = 0; t < PATTERN_WARMUP_TICKS; t++) BenchStepEmitters(b);
+
+	long long spawned = b->pool.spawned, instructions = b->pool.instructions;
+	BenchStepEmitters(b);
+	spawned = b->pool.spawned - spawned;
+	instructions = b->pool.instructions - instructions;
+	RunBench(bench, "pattern/step_4000_emitters", PATTERN_EMITTERS, BenchStepEmitters, b);
+	double emitterNs = bench->results[bench->count - 1].medianNs;
+	if (b->pool.dropped > 0) FailBench("%lld pattern bullets did not fit", b->pool.dropped);
+	UnloadEmitterPool(&b->pool);
+
+	b->pool = LoadEmitterPool(PATTERN_VM_EMITTERS);
+	for (int i = 0; i < PATTERN_VM_EMITTERS; i++) AddEmitter(&b->pool, &patterns[3], (Vector2){ 0.0f, 0.0f });
+	BenchStepEmitters(b);
+	long long vmInstructions = b->pool.instructions;
+	BenchStepEmitters(b);
+	vmInstructions = b->pool.instructions - vmInstructions;
+	RunBench(bench, "pattern/vm_instructions", (int)vmInstructions, BenchStepEmitters, b);
+	double instructionNs = bench->results[bench->count - 1].medianNs;
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "PATTERN: %i emitters per tick in %.0f us (%lld instructions, %lld bullets), VM at %.0f M instructions/s",
+		PATTERN_EMITTERS, emitterNs*PATTERN_EMITTERS/1000.0, instructions, spawned, 1000.0/instructionNs);
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadEmitterPool(&b->pool);
+	FreeEntities(&b->bullets);
+	free(b);
+}
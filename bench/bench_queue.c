@@ -0,0 +1,99 @@
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "queue.h"
+
+#define QUEUE_MESSAGES 1000000
+#define MPSC_PRODUCERS 3
+
+// Only timed, the queue/ tests check nothing is lost, reordered or duplicated
+typedef struct QueueBench {
+	SpscQueue spsc;
+	MpscQueue mpsc;
+	unsigned int last;
+} QueueBench;
+
+typedef struct Message {
+	unsigned int producer;
+	unsigned int sequence;
+} Message;
+
+static void *SpscProducer(void *user)
+{
+	QueueBench *b = user;
+	for (unsigned int i = 0; i < QUEUE_MESSAGES; i++)
+	{
+		while (!PushSpsc(&b->spsc, &i)) sched_yield();
+	}
+	return NULL;
+}
+
+static void BenchSpscTransfer(void *user)
+{
+	QueueBench *b = user;
+	pthread_t thread;
+	pthread_create(&thread, NULL, SpscProducer, b);
+
+	for (unsigned int i = 0; i < QUEUE_MESSAGES; i++)
+	{
+		while (!PopSpsc(&b->spsc, &b->last)) sched_yield();
+	}
+
+	pthread_join(thread, NULL);
+}
+
+typedef struct ProducerArgs {
+	QueueBench *bench;
+	unsigned int id;
+} ProducerArgs;
+
+static void *MpscProducer(void *user)
+{
+	ProducerArgs *args = user;
+	for (unsigned int i = 0; i < QUEUE_MESSAGES/MPSC_PRODUCERS; i++)
+	{
+		Message message = { args->id, i };
+		while (!PushMpsc(&args->bench->mpsc, &message)) sched_yield();
+	}
+	return NULL;
+}
+
+static void BenchMpscTransfer(void *user)
+{
+	QueueBench *b = user;
+	pthread_t threads[MPSC_PRODUCERS];
+	ProducerArgs args[MPSC_PRODUCERS];
+
+	for (int i = 0; i < MPSC_PRODUCERS; i++)
+	{
+		args[i] = (ProducerArgs){ b, (unsigned int)i };
+		pthread_create(&threads[i], NULL, MpscProducer, &args[i]);
+	}
+
+	for (int received = 0; received < (QUEUE_MESSAGES/MPSC_PRODUCERS)*MPSC_PRODUCERS; received++)
+	{
+		Message message;
+		while (!PopMpsc(&b->mpsc, &message)) sched_yield();
+		b->last = message.sequence;
+	}
+
+	for (int i = 0; i < MPSC_PRODUCERS; i++) pthread_join(threads[i], NULL);
+}
+
+void RunQueueBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "queue/")) return;
+
+	QueueBench b = { 0 };
+	InitSpscQueue(&b.spsc, 1024, sizeof(unsigned int));
+	InitMpscQueue(&b.mpsc, 1024, sizeof(Message));
+
+	RunBench(bench, "queue/spsc_transfer", QUEUE_MESSAGES, BenchSpscTransfer, &b);
+	RunBench(bench, "queue/mpsc_transfer_3p", (QUEUE_MESSAGES/MPSC_PRODUCERS)*MPSC_PRODUCERS, BenchMpscTransfer, &b);
+	BenchConsume(&b.last);
+
+	FreeSpscQueue(&b.spsc);
+	FreeMpscQueue(&b.mpsc);
+}
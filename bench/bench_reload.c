@@ -0,0 +1,57 @@
+#include "bench.h"
+
+#include <stdio.h>
+
+#include "raylib.h"
+#include "gameplay.h"
+#include "module.h"
+
+#define RELOAD_SEED 2024
+
+#if defined(GAME_HOT_RELOAD)
+
+// That state survives the swaps is checked by the reload/ tests
+typedef struct ReloadBench {
+	GameModule module;
+	GameHost host;
+	GameState *state;
+	bool failed;
+} ReloadBench;
+
+static void BenchReloadModule(void *user)
+{
+	ReloadBench *b = user;
+	if (!ReloadGameModule(&b->module, b->state, &b->host)) b->failed = true;
+}
+
+void RunReloadBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "reload/")) return;
+
+	ReloadBench b = { .host = { .seed = RELOAD_SEED } };
+	if (!LoadGameModule(&b.module, GAMEPLAY_MODULE_PATH))
+	{
+		FailBench("Could not load %s", GAMEPLAY_MODULE_PATH);
+		return;
+	}
+
+	Arena arena = AllocArena(GAMEPLAY_ARENA_SIZE);
+	b.state = b.module.api->init(&arena, &b.host, GenTilemapEmpty(64, 64));
+
+	// Copy, dlopen and dlclose of one build, the fixed cost of every swap
+	RunBench(bench, "reload/module_swap", 1, BenchReloadModule, &b);
+	if (b.failed) FailBench("Module reload failed");
+
+	b.module.api->unload(b.state);
+	FreeArena(&arena);
+	UnloadGameModule(&b.module);
+}
+
+#else
+
+void RunReloadBenches(Bench *bench)
+{
+	(void)bench;
+}
+
+#endif
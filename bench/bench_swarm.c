@@ -0,0 +1,126 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "swarm.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define SWARM_SEED 43
+#define SWARM_MAP_SIZE 128
+#define SWARM_AGENTS 20000
+#define SWARM_DT (1.0f/60.0f)
+#define SWARM_WARMUP_TICKS 180	// Long enough for the crowd to bunch up along the corridors
+#define SWARM_CHECK_TICKS 60
+#define SWARM_BUDGET_NS (1e9/60.0)
+
+typedef struct SwarmBench {
+	Tilemap map;
+	Swarm swarm;
+	JobSystem *jobs;
+	float *start;	// Positions and velocities every timed tick starts from
+} SwarmBench;
+
+static void SaveSwarmState(const Swarm *swarm, float *state)
+{
+	memcpy(state, swarm->posX, swarm->count*sizeof(float));
+	memcpy(state + swarm->count, swarm->posY, swarm->count*sizeof(float));
+	memcpy(state + swarm->count*2, swarm->velX, swarm->count*sizeof(float));
+	memcpy(state + swarm->count*3, swarm->velY, swarm->count*sizeof(float));
+}
+
+static void LoadSwarmState(Swarm *swarm, const float *state)
+{
+	memcpy(swarm->posX, state, swarm->count*sizeof(float));
+	memcpy(swarm->posY, state + swarm->count, swarm->count*sizeof(float));
+	memcpy(swarm->velX, state + swarm->count*2, swarm->count*sizeof(float));
+	memcpy(swarm->velY, state + swarm->count*3, swarm->count*sizeof(float));
+}
+
+// Every timed tick starts from the same crowd, so the cost does not drift with run count
+static void BenchTick(void *user)
+{
+	SwarmBench *b = user;
+	LoadSwarmState(&b->swarm, b->start);
+	UpdateSwarm(&b->swarm, &b->map, b->jobs, SWARM_DT);
+	BenchConsume(b->swarm.posX);
+}
+
+static void BenchFlowField(void *user)
+{
+	SwarmBench *b = user;
+	int x = b->swarm.targetX, y = b->swarm.targetY;
+	b->swarm.targetX = -1;
+	SetSwarmTarget(&b->swarm, &b->map, x, y);
+	BenchConsume(b->swarm.flowX);
+}
+
+void RunSwarmBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "swarm/")) return;
+
+	SwarmBench *b = calloc(1, sizeof(SwarmBench));
+	b->map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(SWARM_MAP_SIZE, SWARM_MAP_SIZE, SWARM_SEED));
+	b->swarm = LoadSwarm(&b->map, SWARM_AGENTS, GetDefaultSwarmParams());
+	b->jobs = CreateJobSystem(0);
+	b->start = malloc((size_t)SWARM_AGENTS*4*sizeof(float));
+
+	// Spawned in open tiles all over the map, chasing one in the middle
+	Rng rng = SeedRng(SWARM_SEED);
+	while (b->swarm.count < SWARM_AGENTS)
+	{
+		int x = (int)(NextRng(&rng)%SWARM_MAP_SIZE), y = (int)(NextRng(&rng)%SWARM_MAP_SIZE);
+		if (IsTileSolid(&b->map, x, y)) continue;
+		AddSwarmAgent(&b->swarm, (Vector2){ (x + NextRngFloat(&rng))*TILE_SIZE, (y + NextRngFloat(&rng))*TILE_SIZE }, (Vector2){ 0.0f, 0.0f });
+	}
+	int targetX = SWARM_MAP_SIZE/2, targetY = SWARM_MAP_SIZE/2;
+	while (IsTileSolid(&b->map, targetX, targetY)) targetX++;
+	SetSwarmTarget(&b->swarm, &b->map, targetX, targetY);
+
+	for (int t = 0; t < SWARM_WARMUP_TICKS; t++) UpdateSwarm(&b->swarm, &b->map, b->jobs, SWARM_DT);
+	SaveSwarmState(&b->swarm, b->start);
+
+	RunBench(bench, "swarm/flow_field_128", SWARM_MAP_SIZE*SWARM_MAP_SIZE, BenchFlowField, b);
+	JobSystem *jobs = b->jobs;
+	b->jobs = NULL;
+	RunBench(bench, "swarm/tick_20k_serial", SWARM_AGENTS, BenchTick, b);
+	b->jobs = jobs;
+	RunBench(bench, "swarm/tick_20k_jobs", SWARM_AGENTS, BenchTick, b);
+	double tickNs = bench->results[bench->count - 1].medianNs*SWARM_AGENTS;
+	b->swarm.params.deterministic = true;
+	RunBench(bench, "swarm/tick_20k_jobs_deterministic", SWARM_AGENTS, BenchTick, b);
+	b->swarm.params.deterministic = false;
+
+	float neighbours = 0.0f;
+	for (int i = 0; i < b->swarm.count; i++)
+	{
+		float px = b->swarm.posX[i], py = b->swarm.posY[i];
+		float r2 = b->swarm.params.neighbourRadius*b->swarm.params.neighbourRadius;
+		int cell = b->swarm.agentCells[i], cx = cell%b->swarm.cellsX, cy = cell/b->swarm.cellsX;
+		for (int y = cy - 1; y <= cy + 1; y++)
+		{
+			for (int x = cx - 1; x <= cx + 1; x++)
+			{
+				if (x < 0 || y < 0 || x >= b->swarm.cellsX || y >= b->swarm.cellsY) continue;
+				for (int s = b->swarm.cellStarts[y*b->swarm.cellsX + x]; s < b->swarm.cellStarts[y*b->swarm.cellsX + x + 1]; s++)
+				{
+					float dx = b->swarm.sortedPosX[s] - px, dy = b->swarm.sortedPosY[s] - py;
+					if (dx*dx + dy*dy < r2) neighbours += 1.0f;
+				}
+			}
+		}
+	}
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "SWARM: %i agents on %ix%i tiles, %.1f neighbours each, %.2f ms per tick on %i threads",
+		SWARM_AGENTS, SWARM_MAP_SIZE, SWARM_MAP_SIZE, neighbours/SWARM_AGENTS - 1.0f, tickNs/1e6, GetJobThreadCount(b->jobs));
+	SetTraceLogLevel(LOG_WARNING);
+	if (tickNs > SWARM_BUDGET_NS) printf("BENCH: Swarm tick over the 60 Hz budget, %.2f ms\n", tickNs/1e6);
+
+	DestroyJobSystem(b->jobs);
+	UnloadSwarm(&b->swarm);
+	UnloadTilemap(b->map);
+	free(b->start);
+	free(b);
+}
@@ -0,0 +1,145 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "textcache.h"
+#include "spritebatch.h"
+
+#define TEXT_HUD_LINES 300
+#define TEXT_HUD_CHANGING 10	// One line in this many changes every frame
+#define TEXT_HUD_SIZE 20.0f
+#define TEXT_HUD_SPACING 2.0f
+#define TEXT_FONT_SIZE 10
+#define TEXT_FONT_ADVANCE 6
+#define TEXT_FONT_PADDING 1
+
+// A fixed width font laid out like raylib's default one, only the CPU side; the texture
+// never gets uploaded since the benches run without a window
+typedef struct TextFont {
+	Font font;
+	GlyphInfo glyphs[TEXT_CHAR_COUNT];
+	Rectangle recs[TEXT_CHAR_COUNT];
+} TextFont;
+
+typedef struct TextBench {
+	TextFont font;
+	TextAtlas atlas;
+	TextCache cache;
+	SpriteBatch batch;
+	char lines[TEXT_HUD_LINES][64];
+	int frame;
+} TextBench;
+
+static void LoadBenchFont(TextFont *f)
+{
+	for (int i = 0; i < TEXT_CHAR_COUNT; i++)
+	{
+		f->glyphs[i] = (GlyphInfo){ .value = TEXT_FIRST_CHAR + i, .offsetX = 0, .offsetY = 0, .advanceX = TEXT_FONT_ADVANCE };
+		f->recs[i] = (Rectangle){ (float)(1 + (i%16)*8), (float)(1 + (i/16)*12), (float)(TEXT_FONT_ADVANCE - 1), (float)TEXT_FONT_SIZE };
+	}
+	f->font = (Font){
+		.baseSize = TEXT_FONT_SIZE, .glyphCount = TEXT_CHAR_COUNT, .glyphPadding = TEXT_FONT_PADDING,
+		.texture = { .id = 1, .width = 128, .height = 128, .mipmaps = 1 },
+		.recs = f->recs, .glyphs = f->glyphs,
+	};
+}
+
+// A profiler overlay: most counters hold still from frame to frame, a tenth of them tick
+static void UpdateHudLines(TextBench *b)
+{
+	for (int i = 0; i < TEXT_HUD_LINES; i++)
+	{
+		if (b->frame > 0 && i%TEXT_HUD_CHANGING != b->frame%TEXT_HUD_CHANGING) continue;
+		snprintf(b->lines[i], sizeof(b->lines[i]), "zone %03d  calls %5d  %7.3f ms", i, (i*37)%1000, (float)((i + b->frame)%977)*0.013f);
+	}
+}
+
+static void DrawHudCached(TextBench *b)
+{
+	BeginTextFrame(&b->cache);
+	BeginSpriteBatch(&b->batch);
+	for (int i = 0; i < TEXT_HUD_LINES; i++)
+	{
+		DrawTextCached(&b->cache, &b->batch, b->lines[i], (Vector2){ 10.0f, 10.0f + i*(TEXT_HUD_SIZE + TEXT_LINE_SPACING) }, TEXT_HUD_SIZE, TEXT_HUD_SPACING, GREEN);
+	}
+	EndSpriteBatch(&b->batch);
+}
+
+// What DrawTextEx() does for every call: a glyph search and the quad maths per character
+static void DrawTextUncached(TextBench *b, const char *text, Vector2 position, float size, float spacing, Color color)
+{
+	Font font = b->font.font;
+	float scale = size/font.baseSize, padding = (float)font.glyphPadding;
+	float x = 0.0f, y = 0.0f;
+
+	for (const char *c = text; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			x = 0.0f;
+			y += size + TEXT_LINE_SPACING;
+			continue;
+		}
+
+		int index = GetGlyphIndex(font, *c);
+		Rectangle rec = font.recs[index];
+		if (*c != ' ' && *c != '\t')
+		{
+			Rectangle source = { rec.x - padding, rec.y - padding, rec.width + 2.0f*padding, rec.height + 2.0f*padding };
+			Rectangle dest = { position.x + x + (font.glyphs[index].offsetX - padding)*scale, position.y + y + (font.glyphs[index].offsetY - padding)*scale, source.width*scale, source.height*scale };
+			PushSpriteQuad(&b->batch, font.texture, source, dest, color);
+		}
+		x += ((font.glyphs[index].advanceX == 0)? rec.width : (float)font.glyphs[index].advanceX)*scale + spacing;
+	}
+}
+
+static void BenchHudCached(void *user)
+{
+	TextBench *b = user;
+	b->frame++;
+	UpdateHudLines(b);
+	DrawHudCached(b);
+	BenchConsume(b->batch.quads);
+}
+
+static void BenchHudUncached(void *user)
+{
+	TextBench *b = user;
+	b->frame++;
+	UpdateHudLines(b);
+	BeginSpriteBatch(&b->batch);
+	for (int i = 0; i < TEXT_HUD_LINES; i++)
+	{
+		DrawTextUncached(b, b->lines[i], (Vector2){ 10.0f, 10.0f + i*(TEXT_HUD_SIZE + TEXT_LINE_SPACING) }, TEXT_HUD_SIZE, TEXT_HUD_SPACING, GREEN);
+	}
+	EndSpriteBatch(&b->batch);
+	BenchConsume(b->batch.quads);
+}
+
+void RunTextBenches(Bench *bench)
+{
+	if (!IsBenchEnabled(bench, "text/")) return;
+
+	TextBench *b = calloc(1, sizeof(TextBench));
+	LoadBenchFont(&b->font);
+	b->atlas = LoadTextAtlas(b->font.font);
+	b->cache = LoadTextCache(&b->atlas);
+	b->batch = LoadSpriteBatch(1024);
+
+	UpdateHudLines(b);
+	RunBench(bench, "text/hud_300_cached", TEXT_HUD_LINES, BenchHudCached, b);
+	double cachedNs = bench->results[bench->count - 1].medianNs;
+	int hits = b->cache.stats.hits, misses = b->cache.stats.misses, quads = b->batch.last.quads, drawCalls = b->batch.last.drawCalls;
+	RunBench(bench, "text/hud_300_uncached", TEXT_HUD_LINES, BenchHudUncached, b);
+	double uncachedNs = bench->results[bench->count - 1].medianNs;
+
+	SetTraceLogLevel(LOG_INFO);
+	TraceLog(LOG_INFO, "TEXT: %i HUD lines, %i quads in %i draw calls, %i hits %i misses per frame, %.2f ms cached vs %.2f ms laid out every call",
+		TEXT_HUD_LINES, quads, drawCalls, hits, misses, cachedNs*TEXT_HUD_LINES/1e6, uncachedNs*TEXT_HUD_LINES/1e6);
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadSpriteBatch(&b->batch);
+	UnloadTextCache(&b->cache);
+	free(b);
+}
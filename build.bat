@@ -1,6 +1,7 @@
 @echo off
-gcc -g ^
--L./libs/raylib/lib/win_mingw64 -lraylib ^
--I./libs/raylib/include ^
-src/main.c ^
--o game.exe
\ No newline at end of file
+rem usage: build.bat [Debug, Release or RelWithDebInfo]
+set CONFIG=%1
+if "%CONFIG%"=="" set CONFIG=Release
+cmake -S . -B build/%CONFIG% -G "MinGW Makefiles" -DCMAKE_BUILD_TYPE=%CONFIG% || exit /b 1
+cmake --build build/%CONFIG% -j || exit /b 1
+copy /Y build\%CONFIG%\game.exe game.exe
\ No newline at end of file
@@ -1,7 +1,47 @@
 #!/bin/sh
+# usage: ./build.sh [debug|release|relwithdebinfo|native|lto|unity|pgo|tsan] [extra cmake args...]
+#
+# Every flavour gets its own build directory under build/ and the game binary is
+# copied to the repository root, where it finds res/.
+# pgo builds an instrumented game, trains it on a headless replay (PGO_REPLAY,
+# or the scripted demo when unset) and rebuilds with the recorded profile.
+# Other flavours load gameplay from build/<flavour>/libgameplay.so and pick up a
+# rebuild of it (cmake --build build/<flavour> --target gameplay) while running;
+# lto and pgo link it in, as shipped.
 
-gcc -g \
--L./libs/raylib/lib/linux_amd64 -lraylib \
--I./libs/raylib/include \
-src/main.c \
--o game.x86_64
\ No newline at end of file
+set -e
+
+FLAVOUR=${1:-release}
+[ $# -gt 0 ] && shift
+
+case "$FLAVOUR" in
+	debug) ARGS="-DCMAKE_BUILD_TYPE=Debug" ;;
+	release) ARGS="-DCMAKE_BUILD_TYPE=Release" ;;
+	relwithdebinfo) ARGS="-DCMAKE_BUILD_TYPE=RelWithDebInfo" ;;
+	native) ARGS="-DCMAKE_BUILD_TYPE=Release -DGAME_MARCH=native" ;;
+	lto) ARGS="-DCMAKE_BUILD_TYPE=Release -DGAME_MARCH=native -DGAME_LTO=ON -DGAME_HOT_RELOAD=OFF" ;;
+	unity) ARGS="-DCMAKE_BUILD_TYPE=Release -DGAME_UNITY=ON" ;;
+	pgo) ARGS="-DCMAKE_BUILD_TYPE=Release -DGAME_MARCH=native -DGAME_LTO=ON -DGAME_HOT_RELOAD=OFF" ;;
+	tsan) ARGS="-DCMAKE_BUILD_TYPE=RelWithDebInfo -DGAME_SANITIZE=thread" ;;
+	*) echo "unknown build flavour: $FLAVOUR"; exit 1 ;;
+esac
+
+DIR=build/$FLAVOUR
+
+if [ "$FLAVOUR" = "pgo" ]; then
+	rm -rf "$DIR/pgo"
+	cmake -S . -B "$DIR" $ARGS -DGAME_PGO=GENERATE "$@"
+	cmake --build "$DIR" -j
+	if [ -n "$PGO_REPLAY" ]; then
+		"$DIR/game.x86_64" --replay "$PGO_REPLAY"
+	else
+		"$DIR/game.x86_64" --headless 36000
+	fi
+	cmake -S . -B "$DIR" -DGAME_PGO=USE
+	cmake --build "$DIR" -j --clean-first
+else
+	cmake -S . -B "$DIR" $ARGS "$@"
+	cmake --build "$DIR" -j
+fi
+
+cp "$DIR/game.x86_64" game.x86_64
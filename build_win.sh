@@ -1,7 +1,7 @@
 #!/bin/sh
 
 gcc -g \
--L./libs/raylib/lib/win_mingw64 -lraylib \
 -I./libs/raylib/include \
-src/main.c \
--o game.exe
\ No newline at end of file
+src/*.c \
+-L./libs/raylib/lib/win_mingw64 -lraylib -lopengl32 -lgdi32 -lwinmm \
+-o game.exe
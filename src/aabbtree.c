@@ -0,0 +1,465 @@
+#include "broadphase.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// Dynamic AABB tree broad-phase. Leaves store a box fattened by a margin and stretched
+// along the last displacement, so small moves leave the tree untouched. Inserting
+// picks the sibling with the least added perimeter (the 2D surface area heuristic)
+// and every ancestor on the way back up tries the child/grandchild swaps that shrink
+// it, which keeps the tree shallow without explicit height balancing.
+
+#define TREE_NULL -1
+#define TREE_DISPLACEMENT_SCALE 2.0f	// How far ahead of a moving proxy its box reaches
+
+typedef struct Box {
+	float minX, minY, maxX, maxY;
+} Box;
+
+typedef struct TreeNode {
+	Box box;	// Fat for leaves
+	Rectangle rec;	// Leaves only, the proxy's own rectangle
+	int parent;	// Next free node while on the free list
+	int child1;	// TREE_NULL for leaves
+	int child2;
+	int height;	// 0 for leaves, -1 when free
+	int userData;
+} TreeNode;
+
+typedef struct AabbTree {
+	TreeNode *nodes;
+	int nodeCount;	// Allocated from the array so far
+	int capacity;
+	int freeList;
+	int root;
+	float margin;
+	int *stack;	// Traversal scratch
+	int stackCapacity;
+} AabbTree;
+
+static inline Box GetUnionBox(Box a, Box b)
+{
+	return (Box){ fminf(a.minX, b.minX), fminf(a.minY, b.minY), fmaxf(a.maxX, b.maxX), fmaxf(a.maxY, b.maxY) };
+}
+
+static inline float GetBoxPerimeter(Box b)
+{
+	return 2.0f*((b.maxX - b.minX) + (b.maxY - b.minY));
+}
+
+static inline bool OverlapBoxRec(Box b, Rectangle rec)
+{
+	return b.minX < rec.x + rec.width && rec.x < b.maxX && b.minY < rec.y + rec.height && rec.y < b.maxY;
+}
+
+static inline bool ContainsBoxRec(Box b, Rectangle rec)
+{
+	return b.minX <= rec.x && b.minY <= rec.y && rec.x + rec.width <= b.maxX && rec.y + rec.height <= b.maxY;
+}
+
+static inline Rectangle GetBoxRec(Box b)
+{
+	return (Rectangle){ b.minX, b.minY, b.maxX - b.minX, b.maxY - b.minY };
+}
+
+static inline bool IsTreeLeaf(const TreeNode *node)
+{
+	return node->child1 == TREE_NULL;
+}
+
+//----------------------------------------------------------------------------------
+// Nodes
+//----------------------------------------------------------------------------------
+
+static int AllocTreeNode(AabbTree *tree)
+{
+	if (tree->freeList == TREE_NULL)
+	{
+		if (tree->nodeCount == tree->capacity)
+		{
+			tree->capacity = tree->capacity? tree->capacity*2 : 256;
+			tree->nodes = realloc(tree->nodes, (size_t)tree->capacity*sizeof(TreeNode));
+		}
+		tree->nodes[tree->nodeCount].parent = TREE_NULL;
+		tree->freeList = tree->nodeCount++;
+	}
+
+	int index = tree->freeList;
+	tree->freeList = tree->nodes[index].parent;
+	tree->nodes[index] = (TreeNode){ .parent = TREE_NULL, .child1 = TREE_NULL, .child2 = TREE_NULL };
+	return index;
+}
+
+static void FreeTreeNode(AabbTree *tree, int index)
+{
+	tree->nodes[index].parent = tree->freeList;
+	tree->nodes[index].height = -1;
+	tree->freeList = index;
+}
+
+static int *GetTreeStack(AabbTree *tree)
+{
+	// A traversal never holds more than a node's depth plus one entry per level
+	int needed = 2*tree->nodeCount + 2;
+	if (tree->stackCapacity < needed)
+	{
+		tree->stackCapacity = needed;
+		tree->stack = realloc(tree->stack, (size_t)needed*sizeof(int));
+	}
+	return tree->stack;
+}
+
+static void RefitTreeNode(AabbTree *tree, int index)
+{
+	TreeNode *node = &tree->nodes[index];
+	const TreeNode *a = &tree->nodes[node->child1], *b = &tree->nodes[node->child2];
+	node->box = GetUnionBox(a->box, b->box);
+	node->height = 1 + ((a->height > b->height)? a->height : b->height);
+}
+
+// Exchanges two nodes that are not ancestors of each other, along with their subtrees
+static void SwapTreeNodes(AabbTree *tree, int x, int y)
+{
+	int px = tree->nodes[x].parent, py = tree->nodes[y].parent;
+	TreeNode *parentX = &tree->nodes[px], *parentY = &tree->nodes[py];
+
+	if (parentX->child1 == x) parentX->child1 = y;
+	else parentX->child2 = y;
+	if (parentY->child1 == y) parentY->child1 = x;
+	else parentY->child2 = x;
+
+	tree->nodes[x].parent = py;
+	tree->nodes[y].parent = px;
+}
+
+// Tries the swaps between A's children and grandchildren that shrink the summed
+// perimeter of A's children, the cost the surface area heuristic charges for A
+static void RotateTreeNode(AabbTree *tree, int a)
+{
+	TreeNode *nodes = tree->nodes;
+	int b = nodes[a].child1, c = nodes[a].child2;
+	bool leafB = IsTreeLeaf(&nodes[b]), leafC = IsTreeLeaf(&nodes[c]);
+	if (leafB && leafC) return;
+
+	Box boxB = nodes[b].box, boxC = nodes[c].box;
+	int swapX = TREE_NULL, swapY = TREE_NULL;
+	float best = 0.0f;
+
+	if (leafB)
+	{
+		// B with one of C's children, C is left with B and the other
+		int f = nodes[c].child1, g = nodes[c].child2;
+		float base = GetBoxPerimeter(boxC);
+		float costF = GetBoxPerimeter(GetUnionBox(boxB, nodes[g].box));
+		float costG = GetBoxPerimeter(GetUnionBox(boxB, nodes[f].box));
+		if (costF < base && costF <= costG) swapX = b, swapY = f;
+		else if (costG < base) swapX = b, swapY = g;
+	}
+	else if (leafC)
+	{
+		int d = nodes[b].child1, e = nodes[b].child2;
+		float base = GetBoxPerimeter(boxB);
+		float costD = GetBoxPerimeter(GetUnionBox(boxC, nodes[e].box));
+		float costE = GetBoxPerimeter(GetUnionBox(boxC, nodes[d].box));
+		if (costD < base && costD <= costE) swapX = c, swapY = d;
+		else if (costE < base) swapX = c, swapY = e;
+	}
+	else
+	{
+		int d = nodes[b].child1, e = nodes[b].child2, f = nodes[c].child1, g = nodes[c].child2;
+		Box boxD = nodes[d].box, boxE = nodes[e].box, boxF = nodes[f].box, boxG = nodes[g].box;
+		float areaB = GetBoxPerimeter(boxB), areaC = GetBoxPerimeter(boxC);
+		best = areaB + areaC;
+
+		struct { int x, y; float cost; } options[6] = {
+			{ b, f, areaB + GetBoxPerimeter(GetUnionBox(boxB, boxG)) },
+			{ b, g, areaB + GetBoxPerimeter(GetUnionBox(boxB, boxF)) },
+			{ c, d, areaC + GetBoxPerimeter(GetUnionBox(boxC, boxE)) },
+			{ c, e, areaC + GetBoxPerimeter(GetUnionBox(boxC, boxD)) },
+			{ d, f, GetBoxPerimeter(GetUnionBox(boxF, boxE)) + GetBoxPerimeter(GetUnionBox(boxD, boxG)) },
+			{ d, g, GetBoxPerimeter(GetUnionBox(boxG, boxE)) + GetBoxPerimeter(GetUnionBox(boxF, boxD)) },
+		};
+
+		for (int i = 0; i < 6; i++)
+		{
+			if (options[i].cost >= best) continue;
+			best = options[i].cost;
+			swapX = options[i].x;
+			swapY = options[i].y;
+		}
+	}
+
+	if (swapX == TREE_NULL) return;
+
+	SwapTreeNodes(tree, swapX, swapY);
+	if (!IsTreeLeaf(&nodes[nodes[a].child1])) RefitTreeNode(tree, nodes[a].child1);
+	if (!IsTreeLeaf(&nodes[nodes[a].child2])) RefitTreeNode(tree, nodes[a].child2);
+	RefitTreeNode(tree, a);
+}
+
+static void RefitTreeAncestors(AabbTree *tree, int index)
+{
+	while (index != TREE_NULL)
+	{
+		RefitTreeNode(tree, index);
+		RotateTreeNode(tree, index);
+		index = tree->nodes[index].parent;
+	}
+}
+
+static void InsertTreeLeaf(AabbTree *tree, int leaf)
+{
+	TreeNode *nodes = tree->nodes;
+	if (tree->root == TREE_NULL)
+	{
+		tree->root = leaf;
+		nodes[leaf].parent = TREE_NULL;
+		return;
+	}
+
+	// Descend towards the sibling that adds the least perimeter, counting what every
+	// ancestor on the way grows by (Box2D's insertion cost)
+	Box leafBox = nodes[leaf].box;
+	int index = tree->root;
+	while (!IsTreeLeaf(&nodes[index]))
+	{
+		const TreeNode *node = &nodes[index];
+		float area = GetBoxPerimeter(node->box);
+		float combined = GetBoxPerimeter(GetUnionBox(node->box, leafBox));
+		float cost = 2.0f*combined;
+		float inheritance = 2.0f*(combined - area);
+
+		float costs[2];
+		int children[2] = { node->child1, node->child2 };
+		for (int i = 0; i < 2; i++)
+		{
+			const TreeNode *child = &nodes[children[i]];
+			float grown = GetBoxPerimeter(GetUnionBox(child->box, leafBox));
+			costs[i] = (IsTreeLeaf(child)? grown : grown - GetBoxPerimeter(child->box)) + inheritance;
+		}
+
+		if (cost < costs[0] && cost < costs[1]) break;
+		index = (costs[0] < costs[1])? children[0] : children[1];
+	}
+
+	int sibling = index;
+	int oldParent = nodes[sibling].parent;
+	int parent = AllocTreeNode(tree);
+	nodes = tree->nodes;	// May have moved
+
+	nodes[parent].parent = oldParent;
+	nodes[parent].child1 = sibling;
+	nodes[parent].child2 = leaf;
+	nodes[sibling].parent = parent;
+	nodes[leaf].parent = parent;
+
+	if (oldParent == TREE_NULL) tree->root = parent;
+	else if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = parent;
+	else nodes[oldParent].child2 = parent;
+
+	RefitTreeAncestors(tree, parent);
+}
+
+static void RemoveTreeLeaf(AabbTree *tree, int leaf)
+{
+	TreeNode *nodes = tree->nodes;
+	if (leaf == tree->root)
+	{
+		tree->root = TREE_NULL;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandParent = nodes[parent].parent;
+	int sibling = (nodes[parent].child1 == leaf)? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent == TREE_NULL)
+	{
+		tree->root = sibling;
+		nodes[sibling].parent = TREE_NULL;
+	}
+	else
+	{
+		if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+		else nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		RefitTreeAncestors(tree, grandParent);
+	}
+
+	FreeTreeNode(tree, parent);
+}
+
+static Box GetFatBox(const AabbTree *tree, Rectangle rec, Vector2 displacement)
+{
+	Box box = { rec.x - tree->margin, rec.y - tree->margin, rec.x + rec.width + tree->margin, rec.y + rec.height + tree->margin };
+	float dx = displacement.x*TREE_DISPLACEMENT_SCALE, dy = displacement.y*TREE_DISPLACEMENT_SCALE;
+	if (dx < 0.0f) box.minX += dx;
+	else box.maxX += dx;
+	if (dy < 0.0f) box.minY += dy;
+	else box.maxY += dy;
+	return box;
+}
+
+//----------------------------------------------------------------------------------
+// Broad-phase entry points
+//----------------------------------------------------------------------------------
+
+static int CreateTreeProxy(void *data, Rectangle rec, int userData)
+{
+	AabbTree *tree = data;
+	int leaf = AllocTreeNode(tree);
+	tree->nodes[leaf].rec = rec;
+	tree->nodes[leaf].box = GetFatBox(tree, rec, (Vector2){ 0.0f, 0.0f });
+	tree->nodes[leaf].userData = userData;
+	InsertTreeLeaf(tree, leaf);
+	return leaf;
+}
+
+static void DestroyTreeProxy(void *data, int proxy)
+{
+	AabbTree *tree = data;
+	RemoveTreeLeaf(tree, proxy);
+	FreeTreeNode(tree, proxy);
+}
+
+static void MoveTreeProxy(void *data, int proxy, Rectangle rec, Vector2 displacement)
+{
+	AabbTree *tree = data;
+	tree->nodes[proxy].rec = rec;
+	if (ContainsBoxRec(tree->nodes[proxy].box, rec)) return;
+
+	RemoveTreeLeaf(tree, proxy);
+	tree->nodes[proxy].box = GetFatBox(tree, rec, displacement);
+	InsertTreeLeaf(tree, proxy);
+}
+
+static int QueryTreeRecs(void *data, const Rectangle *recs, int count, BroadPhaseHit *hits, int capacity)
+{
+	AabbTree *tree = data;
+	if (tree->root == TREE_NULL) return 0;
+
+	const TreeNode *nodes = tree->nodes;
+	int *stack = GetTreeStack(tree);
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		Rectangle rec = recs[q];
+		int top = 0;
+		stack[top++] = tree->root;
+
+		// Leaves are tested on their own rectangle, skipping the fat box
+		while (top > 0)
+		{
+			const TreeNode *node = &nodes[stack[--top]];
+			if (IsTreeLeaf(node))
+			{
+				if (!OverlapBroadPhaseRecs(node->rec, rec)) continue;
+				if (found < capacity) hits[found] = (BroadPhaseHit){ q, node->userData, 0.0f };
+				found++;
+			}
+			else if (OverlapBoxRec(node->box, rec))
+			{
+				stack[top++] = node->child1;
+				stack[top++] = node->child2;
+			}
+		}
+	}
+
+	return found;
+}
+
+static int RaycastTree(void *data, const Vector2 *origins, const Vector2 *deltas, int count, BroadPhaseHit *hits, int capacity)
+{
+	AabbTree *tree = data;
+	if (tree->root == TREE_NULL) return 0;
+
+	const TreeNode *nodes = tree->nodes;
+	int *stack = GetTreeStack(tree);
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		int top = 0;
+		stack[top++] = tree->root;
+
+		while (top > 0)
+		{
+			const TreeNode *node = &nodes[stack[--top]];
+			float time;
+			if (IsTreeLeaf(node))
+			{
+				if (!IntersectSegmentRec(origins[q], deltas[q], node->rec, &time)) continue;
+				if (found < capacity) hits[found] = (BroadPhaseHit){ q, node->userData, time };
+				found++;
+			}
+			else if (IntersectSegmentRec(origins[q], deltas[q], GetBoxRec(node->box), &time))
+			{
+				stack[top++] = node->child1;
+				stack[top++] = node->child2;
+			}
+		}
+	}
+
+	return found;
+}
+
+// Every leaf queries the tree with its own rectangle and keeps partners with a higher index
+static int FindTreePairs(void *data, BroadPhasePair *pairs, int capacity)
+{
+	AabbTree *tree = data;
+	if (tree->root == TREE_NULL) return 0;
+
+	const TreeNode *nodes = tree->nodes;
+	int *stack = GetTreeStack(tree);
+	int found = 0;
+
+	for (int leaf = 0; leaf < tree->nodeCount; leaf++)
+	{
+		if (nodes[leaf].height != 0) continue;
+		Rectangle rec = nodes[leaf].rec;
+		int top = 0;
+		stack[top++] = tree->root;
+
+		while (top > 0)
+		{
+			int index = stack[--top];
+			const TreeNode *node = &nodes[index];
+			if (IsTreeLeaf(node))
+			{
+				if (index <= leaf || !OverlapBroadPhaseRecs(node->rec, rec)) continue;
+				if (found < capacity) pairs[found] = (BroadPhasePair){ nodes[leaf].userData, node->userData };
+				found++;
+			}
+			else if (OverlapBoxRec(node->box, rec))
+			{
+				stack[top++] = node->child1;
+				stack[top++] = node->child2;
+			}
+		}
+	}
+
+	return found;
+}
+
+static void DestroyTree(void *data)
+{
+	AabbTree *tree = data;
+	free(tree->nodes);
+	free(tree->stack);
+	free(tree);
+}
+
+BroadPhase CreateTreeBroadPhase(float margin)
+{
+	AabbTree *tree = calloc(1, sizeof(AabbTree));
+	tree->freeList = TREE_NULL;
+	tree->root = TREE_NULL;
+	tree->margin = margin;
+
+	return (BroadPhase){
+		"tree", tree,
+		CreateTreeProxy, DestroyTreeProxy, MoveTreeProxy,
+		QueryTreeRecs, RaycastTree, FindTreePairs, DestroyTree,
+	};
+}
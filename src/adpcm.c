@@ -0,0 +1,238 @@
+#include "adpcm.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+// IMA ADPCM step sizes as X(index, step)
+#define ADPCM_STEPS(X) \
+	X(0, 7) X(1, 8) X(2, 9) X(3, 10) X(4, 11) X(5, 12) X(6, 13) X(7, 14) \
+	X(8, 16) X(9, 17) X(10, 19) X(11, 21) X(12, 23) X(13, 25) X(14, 28) X(15, 31) \
+	X(16, 34) X(17, 37) X(18, 41) X(19, 45) X(20, 50) X(21, 55) X(22, 60) X(23, 66) \
+	X(24, 73) X(25, 80) X(26, 88) X(27, 97) X(28, 107) X(29, 118) X(30, 130) X(31, 143) \
+	X(32, 157) X(33, 173) X(34, 190) X(35, 209) X(36, 230) X(37, 253) X(38, 279) X(39, 307) \
+	X(40, 337) X(41, 371) X(42, 408) X(43, 449) X(44, 494) X(45, 544) X(46, 598) X(47, 658) \
+	X(48, 724) X(49, 796) X(50, 876) X(51, 963) X(52, 1060) X(53, 1166) X(54, 1282) X(55, 1411) \
+	X(56, 1552) X(57, 1707) X(58, 1878) X(59, 2066) X(60, 2272) X(61, 2499) X(62, 2749) X(63, 3024) \
+	X(64, 3327) X(65, 3660) X(66, 4026) X(67, 4428) X(68, 4871) X(69, 5358) X(70, 5894) X(71, 6484) \
+	X(72, 7132) X(73, 7845) X(74, 8630) X(75, 9493) X(76, 10442) X(77, 11487) X(78, 12635) X(79, 13899) \
+	X(80, 15289) X(81, 16818) X(82, 18500) X(83, 20350) X(84, 22385) X(85, 24623) X(86, 27086) X(87, 29794) \
+	X(88, 32767)
+
+// What a nibble adds at a step size, and the step index it moves to: -1 for the small
+// magnitudes 0-3, then 2, 4, 6 and 8
+#define ADPCM_DIFF(step, n) (((n) & 8)? -ADPCM_MAGNITUDE(step, n) : ADPCM_MAGNITUDE(step, n))
+#define ADPCM_MAGNITUDE(step, n) (((step) >> 3) + (((n) & 4)? (step) : 0) + (((n) & 2)? (step) >> 1 : 0) + (((n) & 1)? (step) >> 2 : 0))
+#define ADPCM_INDEX_MOVE(n) ((((n) & 7) < 4)? -1 : (((n) & 7) - 3)*2)
+#define ADPCM_NEXT(index, n) (((index) + ADPCM_INDEX_MOVE(n) < 0)? 0 : ((index) + ADPCM_INDEX_MOVE(n) > 88)? 88 : (index) + ADPCM_INDEX_MOVE(n))
+
+#define ADPCM_DIFF_ROW(index, step) \
+	ADPCM_DIFF(step, 0), ADPCM_DIFF(step, 1), ADPCM_DIFF(step, 2), ADPCM_DIFF(step, 3), \
+	ADPCM_DIFF(step, 4), ADPCM_DIFF(step, 5), ADPCM_DIFF(step, 6), ADPCM_DIFF(step, 7), \
+	ADPCM_DIFF(step, 8), ADPCM_DIFF(step, 9), ADPCM_DIFF(step, 10), ADPCM_DIFF(step, 11), \
+	ADPCM_DIFF(step, 12), ADPCM_DIFF(step, 13), ADPCM_DIFF(step, 14), ADPCM_DIFF(step, 15),
+#define ADPCM_NEXT_ROW(index, step) \
+	ADPCM_NEXT(index, 0), ADPCM_NEXT(index, 1), ADPCM_NEXT(index, 2), ADPCM_NEXT(index, 3), \
+	ADPCM_NEXT(index, 4), ADPCM_NEXT(index, 5), ADPCM_NEXT(index, 6), ADPCM_NEXT(index, 7), \
+	ADPCM_NEXT(index, 8), ADPCM_NEXT(index, 9), ADPCM_NEXT(index, 10), ADPCM_NEXT(index, 11), \
+	ADPCM_NEXT(index, 12), ADPCM_NEXT(index, 13), ADPCM_NEXT(index, 14), ADPCM_NEXT(index, 15),
+
+// Every (step index, nibble) pair resolved at compile time, so decoding a sample is two
+// table loads, an add and a clamp instead of the reference bit-by-bit reconstruction.
+// Constant data, so any thread can decode any clip without the encoder running first.
+static const struct {
+	int diff[89*16];	// Up to 61436 at the top step, past a short
+	unsigned char next[89*16];
+} tables = {
+	{ ADPCM_STEPS(ADPCM_DIFF_ROW) },
+	{ ADPCM_STEPS(ADPCM_NEXT_ROW) },
+};
+
+static inline int ClampSample(int v)
+{
+	return (v < -32768)? -32768 : (v > 32767)? 32767 : v;
+}
+
+// The encoder searches each block for the nibbles that decode closest to the source instead
+// of quantising one sample at a time: IMA's step size lags the signal, and a nibble that is
+// best now can leave the step too small for a transient a few samples later. It is a trellis
+// over the 89 step indices, keeping the cheapest path into each one, and the block header lets
+// every block start from whichever index suits it.
+typedef struct AdpcmPath {
+	long long cost;	// Squared error so far, LLONG_MAX when no path reaches the index
+	int predictor;
+} AdpcmPath;
+
+// `targets` holds ADPCM_BLOCK_SAMPLES 16 bit samples, errors only count for the first `count`
+static void EncodeAdpcmBlock(const int *targets, int count, unsigned char *block)
+{
+	unsigned char parents[ADPCM_BLOCK_SAMPLES][89];
+	unsigned char nibbles[ADPCM_BLOCK_SAMPLES][89];
+	AdpcmPath paths[89], next[89];
+
+	for (int index = 0; index < 89; index++) paths[index] = (AdpcmPath){ 0, targets[0] };
+
+	for (int s = 0; s < ADPCM_BLOCK_SAMPLES; s++)
+	{
+		for (int index = 0; index < 89; index++) next[index].cost = LLONG_MAX;
+
+		for (int index = 0; index < 89; index++)
+		{
+			const AdpcmPath *path = &paths[index];
+			if (path->cost == LLONG_MAX) continue;
+
+			// A nibble of the other sign moves the predictor away from the target and adapts
+			// the step just like one of this sign, it is next to never the cheaper way forward
+			int sign = (targets[s] < path->predictor)? 8 : 0;
+			for (int nibble = sign; nibble < sign + 8; nibble++)
+			{
+				int state = index*16 + nibble;
+				int predictor = ClampSample(path->predictor + tables.diff[state]);
+				long long error = (s < count)? (long long)(targets[s] - predictor)*(targets[s] - predictor) : 0;
+				long long cost = path->cost + error;
+
+				AdpcmPath *to = &next[tables.next[state]];
+				if (to->cost <= cost) continue;
+				*to = (AdpcmPath){ cost, predictor };
+				parents[s][tables.next[state]] = (unsigned char)index;
+				nibbles[s][tables.next[state]] = (unsigned char)nibble;
+			}
+		}
+		memcpy(paths, next, sizeof(paths));
+	}
+
+	// Walk the cheapest path back to the index it started from
+	int best = 0;
+	for (int index = 1; index < 89; index++) if (paths[index].cost < paths[best].cost) best = index;
+	for (int s = ADPCM_BLOCK_SAMPLES - 1; s >= 0; s--)
+	{
+		block[4 + s/2] |= (unsigned char)((s & 1)? nibbles[s][best] << 4 : nibbles[s][best]);
+		best = parents[s][best];
+	}
+	block[0] = (unsigned char)(targets[0] & 0xff);
+	block[1] = (unsigned char)((targets[0] >> 8) & 0xff);
+	block[2] = (unsigned char)best;
+}
+
+AdpcmClip EncodeAdpcm(const float *samples, int frames)
+{
+	AdpcmClip clip = { 0 };
+	clip.frames = frames;
+	clip.blockCount = (frames + ADPCM_BLOCK_SAMPLES - 1)/ADPCM_BLOCK_SAMPLES;
+	clip.blocks = calloc(clip.blockCount? clip.blockCount : 1, ADPCM_BLOCK_BYTES);
+	if (clip.blocks == NULL) return clip;
+
+	double signal = 0.0, noise = 0.0;
+
+	for (int b = 0; b < clip.blockCount; b++)
+	{
+		unsigned char *block = clip.blocks + (size_t)b*ADPCM_BLOCK_BYTES;
+		const float *in = samples + b*ADPCM_BLOCK_SAMPLES;
+		int count = (frames - b*ADPCM_BLOCK_SAMPLES < ADPCM_BLOCK_SAMPLES)? frames - b*ADPCM_BLOCK_SAMPLES : ADPCM_BLOCK_SAMPLES;
+
+		// Same scale the decoder divides by
+		int targets[ADPCM_BLOCK_SAMPLES] = { 0 };
+		for (int s = 0; s < count; s++) targets[s] = ClampSample((int)lrintf(in[s]*32768.0f));
+		EncodeAdpcmBlock(targets, count, block);
+
+		// Measured on what the decoder will actually play
+		float decoded[ADPCM_BLOCK_SAMPLES];
+		DecodeAdpcmBlock(block, decoded);
+		for (int s = 0; s < count; s++)
+		{
+			double err = (double)decoded[s] - in[s];
+			signal += (double)in[s]*in[s];
+			noise += err*err;
+		}
+	}
+
+	clip.snr = (noise > 0.0)? (float)(10.0*log10(signal/noise)) : 99.0f;
+	return clip;
+}
+
+void UnloadAdpcm(AdpcmClip clip)
+{
+	free(clip.blocks);
+}
+
+static void ConvertPcm16(const short *in, float *out)
+{
+#if defined(__SSE2__)
+	const __m128 scale = _mm_set1_ps(1.0f/32768.0f);
+	for (int i = 0; i < ADPCM_BLOCK_SAMPLES; i += 8)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);	// Sign extend to 32 bits
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+#else
+	for (int i = 0; i < ADPCM_BLOCK_SAMPLES; i++) out[i] = in[i]*(1.0f/32768.0f);
+#endif
+}
+
+// Tables are built by the encoder, and every block that gets decoded was encoded first
+void DecodeAdpcmBlock(const unsigned char *block, float *out)
+{
+	short pcm[ADPCM_BLOCK_SAMPLES];
+	int predictor = (short)(block[0] | (block[1] << 8));
+	int state = block[2]*16;
+
+	for (int s = 0; s < ADPCM_BLOCK_SAMPLES; s++)
+	{
+		int nibble = (block[4 + s/2] >> ((s & 1)*4)) & 15;
+		predictor = ClampSample(predictor + tables.diff[state + nibble]);
+		state = tables.next[state + nibble]*16;
+		pcm[s] = (short)predictor;
+	}
+
+	ConvertPcm16(pcm, out);
+}
+
+// IMA's step adaptation makes every sample depend on the previous one, so a single
+// stream cannot be split across SIMD lanes. Four blocks are independent though:
+// interleaving them keeps four dependency chains in flight, and the int to float
+// conversion runs eight samples at a time.
+static void DecodeAdpcmBlocks4(const unsigned char *const *blocks, float *const *outs)
+{
+	short pcm[4][ADPCM_BLOCK_SAMPLES];
+	const unsigned char *b0 = blocks[0], *b1 = blocks[1], *b2 = blocks[2], *b3 = blocks[3];
+	int p0 = (short)(b0[0] | (b0[1] << 8)), t0 = b0[2]*16;
+	int p1 = (short)(b1[0] | (b1[1] << 8)), t1 = b1[2]*16;
+	int p2 = (short)(b2[0] | (b2[1] << 8)), t2 = b2[2]*16;
+	int p3 = (short)(b3[0] | (b3[1] << 8)), t3 = b3[2]*16;
+
+	for (int s = 0; s < ADPCM_BLOCK_SAMPLES; s++)
+	{
+		int shift = (s & 1)*4;
+		int n0 = (b0[4 + s/2] >> shift) & 15;
+		int n1 = (b1[4 + s/2] >> shift) & 15;
+		int n2 = (b2[4 + s/2] >> shift) & 15;
+		int n3 = (b3[4 + s/2] >> shift) & 15;
+
+		p0 = ClampSample(p0 + tables.diff[t0 + n0]); t0 = tables.next[t0 + n0]*16;
+		p1 = ClampSample(p1 + tables.diff[t1 + n1]); t1 = tables.next[t1 + n1]*16;
+		p2 = ClampSample(p2 + tables.diff[t2 + n2]); t2 = tables.next[t2 + n2]*16;
+		p3 = ClampSample(p3 + tables.diff[t3 + n3]); t3 = tables.next[t3 + n3]*16;
+
+		pcm[0][s] = (short)p0;
+		pcm[1][s] = (short)p1;
+		pcm[2][s] = (short)p2;
+		pcm[3][s] = (short)p3;
+	}
+
+	for (int i = 0; i < 4; i++) ConvertPcm16(pcm[i], outs[i]);
+}
+
+void DecodeAdpcmBlocks(const unsigned char *const *blocks, float *const *outs, int count)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4) DecodeAdpcmBlocks4(blocks + i, outs + i);
+	for (; i < count; i++) DecodeAdpcmBlock(blocks[i], outs[i]);
+}
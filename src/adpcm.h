@@ -0,0 +1,25 @@
+#ifndef ADPCM_H
+#define ADPCM_H
+
+// IMA-ADPCM, 4 bits per sample, in independent blocks so any block can be decoded
+// on its own. Block: int16 predictor and uint8 step index in effect before the
+// first sample, one pad byte, then ADPCM_BLOCK_SAMPLES nibbles (low nibble first).
+
+#define ADPCM_BLOCK_SAMPLES 256
+#define ADPCM_BLOCK_BYTES (4 + ADPCM_BLOCK_SAMPLES/2)
+
+typedef struct AdpcmClip {
+	unsigned char *blocks;
+	int blockCount;
+	int frames;
+	float snr;	// Signal to noise ratio of the encode in dB, for the memory report
+} AdpcmClip;
+
+AdpcmClip EncodeAdpcm(const float *samples, int frames);	// Searches every block for its best nibbles, a few us a sample
+void UnloadAdpcm(AdpcmClip clip);
+
+void DecodeAdpcmBlock(const unsigned char *block, float *out);	// ADPCM_BLOCK_SAMPLES floats
+// Decodes `count` blocks; runs four blocks at a time as independent lanes
+void DecodeAdpcmBlocks(const unsigned char *const *blocks, float *const *outs, int count);
+
+#endif
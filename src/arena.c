@@ -0,0 +1,33 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Arena AllocArena(size_t size)
+{
+	Arena arena = { 0 };
+	arena.base = calloc(1, size);
+	if (arena.base != NULL) arena.size = size;
+	return arena;
+}
+
+void FreeArena(Arena *arena)
+{
+	free(arena->base);
+	*arena = (Arena){ 0 };
+}
+
+void *PushArena(Arena *arena, size_t size)
+{
+	size_t start = (arena->used + 15) & ~(size_t)15;
+	if (start + size > arena->size) return NULL;
+
+	arena->used = start + size;
+	return arena->base + start;
+}
+
+void ResetArena(Arena *arena)
+{
+	memset(arena->base, 0, arena->used);
+	arena->used = 0;
+}
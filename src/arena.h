@@ -0,0 +1,19 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Linear allocator over one block owned by the host. The GameState header lives here so
+// it outlives the gameplay module being unloaded and swapped for a rebuilt one.
+typedef struct Arena {
+	unsigned char *base;
+	size_t size;
+	size_t used;
+} Arena;
+
+Arena AllocArena(size_t size);
+void FreeArena(Arena *arena);
+void *PushArena(Arena *arena, size_t size);	// Zeroed and 16 byte aligned, NULL when full
+void ResetArena(Arena *arena);
+
+#endif
@@ -0,0 +1,198 @@
+#include "assetcache.h"
+#include "resample.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+	#include <direct.h>
+	#define MakeDir(path) _mkdir(path)
+#else
+	#include <sys/stat.h>
+	#define MakeDir(path) mkdir(path, 0755)
+#endif
+
+#define CACHE_MAGIC_IMAGE 0x4943444b	// "KDCI"
+#define CACHE_MAGIC_SAMPLES 0x5343444b	// "KDCS"
+
+// Cache entry layout: converted data followed by this trailer.
+// Keeping the header at the end lets the loaded file buffer be used as the data as is.
+typedef struct CacheTrailer {
+	uint64_t sourceHash;
+	uint32_t dataSize;
+	int32_t params[4];	// Image: width, height, mipmaps, format. Samples: frames, sample rate.
+	uint16_t flags;
+	uint16_t version;
+	uint32_t magic;
+} CacheTrailer;
+
+unsigned long long HashBytes(const unsigned char *data, int size)
+{
+	uint64_t h = 0x9e3779b97f4a7c15ull ^ (uint64_t)size;
+	int i = 0;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		uint64_t w;
+		memcpy(&w, data + i, 8);
+		h = (h ^ (w*0xff51afd7ed558ccdull))*0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 29;
+	}
+	for (; i < size; i++) h = (h ^ data[i])*0x100000001b3ull;
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	return h;
+}
+
+static void GetCacheFileName(char *out, int size, const char *cacheDir, const char *fileName, const char *extension)
+{
+	int n = snprintf(out, size, "%s/", cacheDir);
+	for (const char *p = fileName; *p != '\0' && n < size - 8; p++) out[n++] = (*p == '/' || *p == '\\' || *p == ':')? '_' : *p;
+	snprintf(out + n, size - n, "%s", extension);
+}
+
+// Returns the entry's file buffer (data at offset 0) when it matches, NULL otherwise
+static unsigned char *LoadCacheEntry(const char *cacheFile, uint32_t magic, uint64_t hash, int flags, CacheTrailer *trailer)
+{
+	int size = 0;
+	unsigned char *data = FileExists(cacheFile)? LoadFileData(cacheFile, &size) : NULL;
+
+	if (data != NULL && size >= (int)sizeof(CacheTrailer))
+	{
+		memcpy(trailer, data + size - sizeof(CacheTrailer), sizeof(CacheTrailer));
+
+		if (trailer->magic == magic && trailer->version == ASSET_CACHE_VERSION && trailer->sourceHash == hash &&
+			trailer->flags == flags && (int64_t)trailer->dataSize + (int64_t)sizeof(CacheTrailer) == size) return data;
+	}
+
+	if (data != NULL) UnloadFileData(data);
+	return NULL;
+}
+
+static void SaveCacheEntry(const char *cacheFile, const char *cacheDir, const void *data, CacheTrailer trailer)
+{
+	if (!DirectoryExists(cacheDir)) MakeDir(cacheDir);
+
+	// A torn write leaves a size mismatch and is rebuilt on the next load
+	FILE *file = fopen(cacheFile, "wb");
+	if (file == NULL) return;
+	fwrite(data, 1, trailer.dataSize, file);
+	fwrite(&trailer, 1, sizeof(trailer), file);
+	fclose(file);
+}
+
+//----------------------------------------------------------------------------------
+// Images
+//----------------------------------------------------------------------------------
+static int GetImageDataSize(Image image)
+{
+	int size = 0;
+	int width = image.width, height = image.height;
+
+	for (int i = 0; i < image.mipmaps; i++)
+	{
+		size += GetPixelDataSize(width, height, image.format);
+		width = (width > 1)? width/2 : 1;
+		height = (height > 1)? height/2 : 1;
+	}
+
+	return size;
+}
+
+Image LoadImageCachedFromMemory(const char *fileName, const unsigned char *fileData, int dataSize, const char *cacheDir, int flags)
+{
+	uint64_t hash = HashBytes(fileData, dataSize);
+	char cacheFile[512];
+	GetCacheFileName(cacheFile, sizeof(cacheFile), cacheDir, fileName, ".img");
+
+	CacheTrailer trailer;
+	unsigned char *cached = LoadCacheEntry(cacheFile, CACHE_MAGIC_IMAGE, hash, flags, &trailer);
+	if (cached != NULL) return (Image){ cached, trailer.params[0], trailer.params[1], trailer.params[2], trailer.params[3] };
+
+	Image image = LoadImageFromMemory(GetFileExtension(fileName), fileData, dataSize);
+	if (image.data == NULL) return image;
+
+	if (flags & IMAGE_CACHE_PREMULTIPLY) ImageAlphaPremultiply(&image);
+	if (flags & IMAGE_CACHE_MIPMAPS) ImageMipmaps(&image);
+
+	trailer = (CacheTrailer){
+		.sourceHash = hash,
+		.dataSize = (uint32_t)GetImageDataSize(image),
+		.params = { image.width, image.height, image.mipmaps, image.format },
+		.flags = (uint16_t)flags,
+		.version = ASSET_CACHE_VERSION,
+		.magic = CACHE_MAGIC_IMAGE,
+	};
+	SaveCacheEntry(cacheFile, cacheDir, image.data, trailer);
+	return image;
+}
+
+Image LoadImageCached(const char *fileName, const char *cacheDir, int flags)
+{
+	int size = 0;
+	unsigned char *data = LoadFileData(fileName, &size);
+	if (data == NULL) return (Image){ 0 };
+
+	Image image = LoadImageCachedFromMemory(fileName, data, size, cacheDir, flags);
+	UnloadFileData(data);
+	return image;
+}
+
+//----------------------------------------------------------------------------------
+// Samples
+//----------------------------------------------------------------------------------
+float *LoadSamplesCachedFromMemory(const char *fileName, const unsigned char *fileData, int dataSize, const char *cacheDir, int sampleRate, int *frames)
+{
+	uint64_t hash = HashBytes(fileData, dataSize);
+	char cacheFile[512];
+	CacheTrailer trailer;
+	unsigned char *cached = NULL;
+	if (cacheDir != NULL)
+	{
+		char extension[32];
+		// The rate is part of the name so switching devices does not thrash a single entry
+		snprintf(extension, sizeof(extension), ".%i.pcm", sampleRate);
+		GetCacheFileName(cacheFile, sizeof(cacheFile), cacheDir, fileName, extension);
+		cached = LoadCacheEntry(cacheFile, CACHE_MAGIC_SAMPLES, hash, 0, &trailer);
+	}
+	if (cached != NULL)
+	{
+		// raylib's default allocator is malloc, so the file buffer can be handed out as is
+		*frames = trailer.params[0];
+		return (float *)cached;
+	}
+
+	Wave wave = LoadWaveFromMemory(GetFileExtension(fileName), fileData, dataSize);
+	if (wave.data == NULL) return NULL;
+
+	int count = (int)wave.frameCount;
+	float *samples = LoadWaveMonoSamples(wave.data, count, wave.sampleSize, wave.channels);
+
+	if (samples != NULL && (int)wave.sampleRate != sampleRate)
+	{
+		float *resampled = ResampleAudio(samples, count, wave.sampleRate, sampleRate, &count);
+		free(samples);
+		samples = resampled;
+	}
+	UnloadWave(wave);
+	if (samples == NULL) return NULL;
+
+	if (cacheDir != NULL)
+	{
+		trailer = (CacheTrailer){
+			.sourceHash = hash,
+			.dataSize = (uint32_t)(((count + 3) & ~3)*sizeof(float)),
+			.params = { count, sampleRate },
+			.version = ASSET_CACHE_VERSION,
+			.magic = CACHE_MAGIC_SAMPLES,
+		};
+		SaveCacheEntry(cacheFile, cacheDir, samples, trailer);
+	}
+
+	*frames = count;
+	return samples;
+}
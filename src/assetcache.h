@@ -0,0 +1,27 @@
+#ifndef ASSETCACHE_H
+#define ASSETCACHE_H
+
+#include "raylib.h"
+
+#define ASSET_CACHE_VERSION 2
+
+typedef enum ImageCacheFlags {
+	IMAGE_CACHE_MIPMAPS = 1 << 0,	// Store the full mip chain
+	IMAGE_CACHE_PREMULTIPLY = 1 << 1,	// Store premultiplied alpha, draw with BLEND_ALPHA_PREMULTIPLY
+} ImageCacheFlags;
+
+// Cache of converted assets in `cacheDir`. Entries are keyed by a hash of the source
+// file contents and rebuilt when it changes, so a warm start reads the (small) source
+// to hash it plus the converted data, but never decodes or converts anything.
+
+// Decoded pixels, a warm start never inflates the PNG
+Image LoadImageCached(const char *fileName, const char *cacheDir, int flags);
+Image LoadImageCachedFromMemory(const char *fileName, const unsigned char *fileData, int dataSize, const char *cacheDir, int flags);
+
+// Mono float samples resampled to `sampleRate` (see resample.h), padded to 4 frames. Free with free().
+// A NULL `cacheDir` decodes and resamples without touching the cache.
+float *LoadSamplesCachedFromMemory(const char *fileName, const unsigned char *fileData, int dataSize, const char *cacheDir, int sampleRate, int *frames);
+
+unsigned long long HashBytes(const unsigned char *data, int size);
+
+#endif
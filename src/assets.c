@@ -0,0 +1,101 @@
+#include "assets.h"
+#include "assetcache.h"
+#include "timer.h"
+
+#include <sched.h>
+
+static void LoadAsset(AssetLoad *load)
+{
+	double start = GetTimerSeconds();
+
+	// Read the whole file first and decode from memory, so the file handle is not
+	// held while inflating and the read can be swapped for batched I/O later
+	int size = 0;
+	unsigned char *data = LoadFileData(load->fileName, &size);
+
+	if (data != NULL)
+	{
+		const char *fileType = GetFileExtension(load->fileName);
+		if (load->kind == ASSET_IMAGE)
+		{
+			if (load->cacheDir != NULL) load->image = LoadImageCachedFromMemory(load->fileName, data, size, load->cacheDir, load->cacheFlags);
+			else load->image = LoadImageFromMemory(fileType, data, size);
+			load->loaded = load->image.data != NULL;
+		}
+		else if (load->sampleRate > 0)
+		{
+			load->samples = LoadSamplesCachedFromMemory(load->fileName, data, size, load->cacheDir, load->sampleRate, &load->sampleFrames);
+			load->loaded = load->samples != NULL;
+		}
+		else
+		{
+			load->wave = LoadWaveFromMemory(fileType, data, size);
+			load->loaded = load->wave.data != NULL;
+		}
+		UnloadFileData(data);
+	}
+
+	load->loadMs = (GetTimerSeconds() - start)*1000.0;
+}
+
+static void LoadAssetJob(void *user, int index)
+{
+	AssetBatch *batch = user;
+	LoadAsset(&batch->loads[index]);
+	// Cannot fail, the queue holds one slot per load
+	PushMpsc(&batch->completed, &index);
+}
+
+void LoadAssetsAsync(AssetBatch *batch)
+{
+	InitMpscQueue(&batch->completed, batch->count, sizeof(int));
+	batch->delivered = 0;
+
+	if (batch->jobs == NULL)
+	{
+		for (int i = 0; i < batch->count; i++) LoadAssetJob(batch, i);
+	}
+	else RunJobsAsync(batch->jobs, LoadAssetJob, batch, batch->count);
+}
+
+bool WaitNextAsset(AssetBatch *batch, int *index)
+{
+	if (batch->delivered == batch->count) return false;
+
+	while (!PopMpsc(&batch->completed, index))
+	{
+		// Rather than sleep, decode something ourselves
+		if (batch->jobs == NULL || !HelpJobs(batch->jobs)) sched_yield();
+	}
+
+	batch->delivered++;
+	return true;
+}
+
+void WaitAssets(AssetBatch *batch)
+{
+	int index;
+	while (WaitNextAsset(batch, &index)) { }
+}
+
+void UnloadAssetBatch(AssetBatch *batch)
+{
+	if (batch->jobs != NULL) WaitJobs(batch->jobs);
+	FreeMpscQueue(&batch->completed);
+}
+
+void LoadAssets(AssetLoad *loads, int count)
+{
+	for (int i = 0; i < count; i++) LoadAsset(&loads[i]);
+}
+
+void UnloadAssetData(AssetLoad *loads, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (!loads[i].loaded) continue;
+		if (loads[i].kind == ASSET_IMAGE) UnloadImage(loads[i].image);
+		else if (loads[i].wave.data != NULL) UnloadWave(loads[i].wave);
+		loads[i].loaded = false;
+	}
+}
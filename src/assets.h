@@ -0,0 +1,48 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+#include "jobs.h"
+#include "queue.h"
+
+typedef enum AssetKind {
+	ASSET_IMAGE,
+	ASSET_WAVE,
+} AssetKind;
+
+// One file to read and decode on the CPU. GPU and audio device uploads stay
+// on the main thread and happen as each load completes.
+typedef struct AssetLoad {
+	const char *fileName;
+	AssetKind kind;
+	const char *cacheDir;	// NULL always decodes and converts the source (see assetcache.h)
+	int cacheFlags;	// Images only
+	int sampleRate;	// Waves only: > 0 converts to mono float `samples` at this rate instead of a Wave
+	Image image;
+	Wave wave;
+	float *samples;
+	int sampleFrames;
+	bool loaded;
+	double loadMs;	// Read plus decode time on whichever thread picked it up
+} AssetLoad;
+
+// Loads run as jobs and report their index on `completed` when done, so the main
+// thread can upload each asset as soon as it is decoded instead of waiting for all.
+typedef struct AssetBatch {
+	AssetLoad *loads;
+	int count;
+	JobSystem *jobs;	// NULL loads serially inside LoadAssetsAsync()
+	MpscQueue completed;
+	int delivered;
+} AssetBatch;
+
+// The batch must stay at the same address until every load has been delivered
+void LoadAssetsAsync(AssetBatch *batch);
+bool WaitNextAsset(AssetBatch *batch, int *index);	// False once every load has been delivered
+void WaitAssets(AssetBatch *batch);	// Waits for all, completions are discarded
+void UnloadAssetBatch(AssetBatch *batch);
+
+void LoadAssets(AssetLoad *loads, int count);	// Serial reference path
+void UnloadAssetData(AssetLoad *loads, int count);	// Frees CPU copies once uploaded, `samples` are left to their new owner
+
+#endif
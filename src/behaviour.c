@@ -0,0 +1,280 @@
+#include "behaviour.h"
+#include "raylib.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BEHAVIOUR_MAX_DEPTH 32
+
+typedef struct BehaviourTicker {
+	const BehaviourNode *nodes;
+	const BehaviourLibrary *library;
+	int *state;
+	int agent;
+	int tick;
+	void *context;
+	long long visits;
+} BehaviourTicker;
+
+bool RegisterBehaviourLeaf(BehaviourLibrary *library, const char *name, BehaviourLeafFunc func)
+{
+	if (library->count == BEHAVIOUR_MAX_LEAVES) return false;
+	library->names[library->count] = name;
+	library->funcs[library->count] = func;
+	library->count++;
+	return true;
+}
+
+static bool BehaviourError(int line, const char *message, const char *token)
+{
+	TraceLog(LOG_WARNING, "BEHAVIOUR: Line %i: %s%s%s", line, message, token? " " : "", token? token : "");
+	return false;
+}
+
+// A node is closed once a line at its indent or less shows up, its subtree ends there
+static bool CloseBehaviourNode(BehaviourTree *tree, int node, int line)
+{
+	BehaviourNode *n = &tree->nodes[node];
+	n->next = (short)tree->nodeCount;
+	if (n->kind != BEHAVIOUR_LEAF && n->next == node + 1) return BehaviourError(line, "Node without children", NULL);
+	return true;
+}
+
+bool CompileBehaviourTree(const char *source, const BehaviourLibrary *library, BehaviourTree *tree)
+{
+	static const struct { const char *name; BehaviourKind kind; int stateSize; } keywords[] = {
+		{ "sequence", BEHAVIOUR_SEQUENCE, 2 },	// Running child and the tick it last ran
+		{ "selector", BEHAVIOUR_SELECTOR, 2 },
+		{ "invert", BEHAVIOUR_INVERT, 0 },
+		{ "cooldown", BEHAVIOUR_COOLDOWN, 1 },	// Tick it may run again
+	};
+
+	memset(tree, 0, sizeof(*tree));
+	int stack[BEHAVIOUR_MAX_DEPTH], indents[BEHAVIOUR_MAX_DEPTH], lines[BEHAVIOUR_MAX_DEPTH], children[BEHAVIOUR_MAX_DEPTH];
+	int depth = 0, lineNumber = 0;
+	bool ok = true;
+
+	const char *s = source;
+	while (ok && *s != '\0')
+	{
+		lineNumber++;
+		char line[256];
+		size_t length = strcspn(s, "\n");
+		if (length >= sizeof(line))
+		{
+			ok = BehaviourError(lineNumber, "Line too long", NULL);
+			break;
+		}
+		memcpy(line, s, length);
+		line[length] = '\0';
+		s += length + (s[length] == '\n');
+
+		char *comment = strchr(line, '#');
+		if (comment != NULL) *comment = '\0';
+		int indent = (int)strspn(line, " \t");
+		char *name = strtok(line + indent, " \t\r");
+		if (name == NULL) continue;
+		char *param = strtok(NULL, " \t\r");
+		if (strtok(NULL, " \t\r") != NULL)
+		{
+			ok = BehaviourError(lineNumber, "Too many operands for", name);
+			break;
+		}
+
+		while (ok && depth > 0 && indents[depth - 1] >= indent)
+		{
+			depth--;
+			ok = CloseBehaviourNode(tree, stack[depth], lines[depth]);
+		}
+		if (!ok) break;
+
+		if (depth == 0 && tree->nodeCount > 0) ok = BehaviourError(lineNumber, "More than one root at", name);
+		else if (depth > 0 && tree->nodes[stack[depth - 1]].kind == BEHAVIOUR_LEAF) ok = BehaviourError(lineNumber, "Leaves cannot have children, under", library->names[tree->nodes[stack[depth - 1]].leaf]);
+		else if (depth > 0 && tree->nodes[stack[depth - 1]].kind >= BEHAVIOUR_INVERT && children[depth - 1] > 0) ok = BehaviourError(lineNumber, "Decorators take one child, not", name);
+		else if (depth == BEHAVIOUR_MAX_DEPTH) ok = BehaviourError(lineNumber, "Tree too deep at", name);
+		else if (tree->nodeCount == BEHAVIOUR_MAX_NODES) ok = BehaviourError(lineNumber, "Too many nodes at", name);
+		if (!ok) break;
+
+		BehaviourNode node = { .kind = BEHAVIOUR_LEAF, .slot = -1 };
+		int stateSize = 0;
+		bool found = false;
+		for (int i = 0; i < (int)(sizeof(keywords)/sizeof(keywords[0])) && !found; i++)
+		{
+			if (strcmp(name, keywords[i].name) != 0) continue;
+			node.kind = (unsigned char)keywords[i].kind;
+			stateSize = keywords[i].stateSize;
+			found = true;
+		}
+		for (int i = 0; i < library->count && !found; i++)
+		{
+			if (strcmp(name, library->names[i]) != 0) continue;
+			node.leaf = (unsigned char)i;
+			found = true;
+		}
+		if (!found)
+		{
+			ok = BehaviourError(lineNumber, "Unknown node", name);
+			break;
+		}
+
+		if (param != NULL)
+		{
+			char *end;
+			node.param = strtof(param, &end);
+			if (end == param || *end != '\0' || (node.kind != BEHAVIOUR_LEAF && node.kind != BEHAVIOUR_COOLDOWN))
+			{
+				ok = BehaviourError(lineNumber, "Unexpected operand", param);
+				break;
+			}
+		}
+		else if (node.kind == BEHAVIOUR_COOLDOWN)
+		{
+			ok = BehaviourError(lineNumber, "cooldown needs a tick count", NULL);
+			break;
+		}
+
+		if (stateSize > 0)
+		{
+			node.slot = (short)tree->stateSize;
+			tree->stateSize += stateSize;
+		}
+
+		if (depth > 0) children[depth - 1]++;
+		stack[depth] = tree->nodeCount;
+		indents[depth] = indent;
+		lines[depth] = lineNumber;
+		children[depth] = 0;
+		depth++;
+		tree->nodes[tree->nodeCount++] = node;
+	}
+
+	while (ok && depth > 0)
+	{
+		depth--;
+		ok = CloseBehaviourNode(tree, stack[depth], lines[depth]);
+	}
+	if (ok && tree->nodeCount == 0) ok = BehaviourError(lineNumber, "Empty tree", NULL);
+
+	if (!ok) tree->nodeCount = 0;
+	return ok;
+}
+
+//----------------------------------------------------------------------------------
+// Ticking
+//----------------------------------------------------------------------------------
+
+static BehaviourStatus TickBehaviourNode(BehaviourTicker *t, int n)
+{
+	const BehaviourNode *node = &t->nodes[n];
+	t->visits++;
+
+	switch (node->kind)
+	{
+		case BEHAVIOUR_LEAF: return t->library->funcs[node->leaf](t->context, t->agent, node->param);
+		case BEHAVIOUR_SEQUENCE:
+		case BEHAVIOUR_SELECTOR:
+		{
+			// A sequence moves on while children succeed, a selector while they fail
+			BehaviourStatus carryOn = (node->kind == BEHAVIOUR_SEQUENCE)? BEHAVIOUR_SUCCESS : BEHAVIOUR_FAILURE;
+			int *slot = &t->state[node->slot];
+
+			// Resume the running child only if this node also ran last tick; otherwise
+			// another branch took over in between and it starts from the beginning
+			int child = (slot[1] == t->tick - 1 && slot[0] > n)? slot[0] : n + 1;
+			slot[1] = t->tick;
+
+			for (; child < node->next; child = t->nodes[child].next)
+			{
+				BehaviourStatus status = TickBehaviourNode(t, child);
+				if (status == carryOn) continue;
+
+				slot[0] = (status == BEHAVIOUR_RUNNING)? child : 0;
+				return status;
+			}
+			slot[0] = 0;
+			return carryOn;
+		}
+		case BEHAVIOUR_INVERT:
+		{
+			BehaviourStatus status = TickBehaviourNode(t, n + 1);
+			if (status == BEHAVIOUR_RUNNING) return status;
+			return (status == BEHAVIOUR_SUCCESS)? BEHAVIOUR_FAILURE : BEHAVIOUR_SUCCESS;
+		}
+		case BEHAVIOUR_COOLDOWN:
+		{
+			int *ready = &t->state[node->slot];
+			if (t->tick < *ready) return BEHAVIOUR_FAILURE;
+
+			BehaviourStatus status = TickBehaviourNode(t, n + 1);
+			if (status == BEHAVIOUR_SUCCESS) *ready = t->tick + (int)node->param;
+			return status;
+		}
+		default: return BEHAVIOUR_FAILURE;
+	}
+}
+
+BehaviourStatus TickBehaviourAgent(const BehaviourTree *tree, const BehaviourLibrary *library, int *state, int agent, int tick, void *context, long long *visits)
+{
+	BehaviourTicker t = { tree->nodes, library, state, agent, tick, context, 0 };
+	BehaviourStatus status = TickBehaviourNode(&t, 0);
+	if (visits != NULL) *visits += t.visits;
+	return status;
+}
+
+BehaviourBatch LoadBehaviourBatch(const BehaviourTree *tree, int capacity)
+{
+	BehaviourBatch batch = { 0 };
+	batch.tree = tree;
+	batch.capacity = capacity;
+	batch.agents = calloc(capacity, sizeof(int));
+	batch.states = calloc((size_t)capacity*(tree->stateSize > 0? tree->stateSize : 1), sizeof(int));
+	batch.status = calloc(capacity, sizeof(unsigned char));
+	return batch;
+}
+
+void UnloadBehaviourBatch(BehaviourBatch *batch)
+{
+	free(batch->agents);
+	free(batch->states);
+	free(batch->status);
+	memset(batch, 0, sizeof(*batch));
+}
+
+int AddBehaviourAgent(BehaviourBatch *batch, int agent)
+{
+	if (batch->count == batch->capacity) return -1;
+
+	int i = batch->count++;
+	batch->agents[i] = agent;
+	batch->status[i] = BEHAVIOUR_FAILURE;
+	memset(&batch->states[i*batch->tree->stateSize], 0, batch->tree->stateSize*sizeof(int));
+	return i;
+}
+
+void RemoveBehaviourAgent(BehaviourBatch *batch, int index)
+{
+	int last = --batch->count;
+	if (index == last) return;
+
+	int size = batch->tree->stateSize;
+	batch->agents[index] = batch->agents[last];
+	batch->status[index] = batch->status[last];
+	memcpy(&batch->states[index*size], &batch->states[last*size], size*sizeof(int));
+}
+
+void TickBehaviourBatch(BehaviourBatch *batch, const BehaviourLibrary *library, void *context)
+{
+	const BehaviourTree *tree = batch->tree;
+	if (tree->nodeCount == 0) return;
+
+	// Ticks start at 1, so fresh zeroed state never looks like it ran on the tick before
+	batch->tick++;
+	BehaviourTicker t = { tree->nodes, library, NULL, 0, batch->tick, context, 0 };
+	for (int i = 0; i < batch->count; i++)
+	{
+		t.state = &batch->states[i*tree->stateSize];
+		t.agent = batch->agents[i];
+		batch->status[i] = (unsigned char)TickBehaviourNode(&t, 0);
+	}
+	batch->visits += t.visits;
+}
@@ -0,0 +1,85 @@
+#ifndef BEHAVIOUR_H
+#define BEHAVIOUR_H
+
+#include <stdbool.h>
+
+// Behaviour trees written as indented text, one node per line, `#` starts a comment:
+//   selector            first child that does not fail
+//   	sequence          children in order until one does not succeed
+//   		player_near 256   leaves are functions registered by name, with an optional number
+//   		shoot
+//   	cooldown 30       runs its child at most once per 30 ticks after it succeeds
+//   		invert
+//   			low_health
+//   	wander
+// Lines come in preorder, so the nodes compile straight into a flat array where each one
+// knows where its subtree ends; ticking walks the array instead of chasing pointers.
+// Composites remember a running child and a cooldown its next tick in a per-agent state
+// block. Agents are ticked in batches that share one tree, so every agent takes the same
+// path through the same few nodes and the branches predict well.
+
+#define BEHAVIOUR_MAX_NODES 128
+#define BEHAVIOUR_MAX_LEAVES 64
+
+typedef enum BehaviourStatus {
+	BEHAVIOUR_SUCCESS = 0,
+	BEHAVIOUR_FAILURE,
+	BEHAVIOUR_RUNNING,
+} BehaviourStatus;
+
+typedef enum BehaviourKind {
+	BEHAVIOUR_LEAF = 0,
+	BEHAVIOUR_SEQUENCE,
+	BEHAVIOUR_SELECTOR,
+	BEHAVIOUR_INVERT,
+	BEHAVIOUR_COOLDOWN,
+} BehaviourKind;
+
+typedef BehaviourStatus (*BehaviourLeafFunc)(void *context, int agent, float param);
+
+typedef struct BehaviourLibrary {
+	const char *names[BEHAVIOUR_MAX_LEAVES];
+	BehaviourLeafFunc funcs[BEHAVIOUR_MAX_LEAVES];
+	int count;
+} BehaviourLibrary;
+
+typedef struct BehaviourNode {
+	unsigned char kind;
+	unsigned char leaf;	// Library index
+	short next;	// Index just past the subtree, where the next sibling starts
+	short slot;	// Offset in the agent state block, -1 without state
+	float param;
+} BehaviourNode;
+
+typedef struct BehaviourTree {
+	BehaviourNode nodes[BEHAVIOUR_MAX_NODES];	// Preorder, the root first
+	int nodeCount;
+	int stateSize;	// Ints per agent
+} BehaviourTree;
+
+// Agents running one tree, each with its state block
+typedef struct BehaviourBatch {
+	const BehaviourTree *tree;
+	int count;
+	int capacity;
+	int *agents;	// Host ids passed to the leaves
+	int *states;	// stateSize ints per agent
+	unsigned char *status;	// Root status of the last tick
+	int tick;
+	long long visits;	// Nodes ticked since the batch was loaded
+} BehaviourBatch;
+
+bool RegisterBehaviourLeaf(BehaviourLibrary *library, const char *name, BehaviourLeafFunc func);	// False when full
+bool CompileBehaviourTree(const char *source, const BehaviourLibrary *library, BehaviourTree *tree);	// Logs the line of the first error
+
+BehaviourBatch LoadBehaviourBatch(const BehaviourTree *tree, int capacity);
+void UnloadBehaviourBatch(BehaviourBatch *batch);
+int AddBehaviourAgent(BehaviourBatch *batch, int agent);	// Returns the batch index, -1 when full
+void RemoveBehaviourAgent(BehaviourBatch *batch, int index);	// Moves the last agent into its slot
+
+void TickBehaviourBatch(BehaviourBatch *batch, const BehaviourLibrary *library, void *context);
+// One agent on its own, for agents outside a batch; returns the root status and counts visited nodes.
+// tick has to go up by one per call, starting at 1.
+BehaviourStatus TickBehaviourAgent(const BehaviourTree *tree, const BehaviourLibrary *library, int *state, int agent, int tick, void *context, long long *visits);
+
+#endif
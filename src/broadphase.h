@@ -0,0 +1,99 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <stddef.h>
+
+#include "raylib.h"
+
+// Broad-phases for colliders that do not live on the tile grid (bosses, pickups,
+// triggers). Every implementation sits behind the same table of entry points so a
+// scene can pick whichever suits how its colliders are spread out.
+// Proxies are tracked by the id createProxy returns; results report each proxy's user data.
+
+typedef struct BroadPhaseHit {
+	int query;	// Index into the batch of queries
+	int userData;	// Of the proxy hit
+	float time;	// Raycasts: fraction of the segment where it enters the proxy, 0 for overlaps
+} BroadPhaseHit;
+
+typedef struct BroadPhasePair {
+	int userDataA;
+	int userDataB;
+} BroadPhasePair;
+
+typedef struct BroadPhase {
+	const char *name;
+	void *data;
+	int (*createProxy)(void *data, Rectangle rec, int userData);
+	void (*destroyProxy)(void *data, int proxy);
+	void (*moveProxy)(void *data, int proxy, Rectangle rec, Vector2 displacement);
+	// Batched queries fill up to `capacity` results and return how many were found, which may be more
+	int (*queryRecs)(void *data, const Rectangle *recs, int count, BroadPhaseHit *hits, int capacity);
+	int (*raycasts)(void *data, const Vector2 *origins, const Vector2 *deltas, int count, BroadPhaseHit *hits, int capacity);
+	int (*findPairs)(void *data, BroadPhasePair *pairs, int capacity);	// Every overlapping pair, once
+	void (*destroy)(void *data);
+} BroadPhase;
+
+// Cells of a fixed size over fixed bounds. Proxies outside the bounds are clamped onto the edge
+// cells, which keeps overlaps exact, but raycasts only see what lies within the bounds.
+BroadPhase CreateGridBroadPhase(Rectangle bounds, float cellSize);
+// Dynamic AABB tree: leaves hold proxies fattened by `margin`, rebalanced with surface area rotations
+BroadPhase CreateTreeBroadPhase(float margin);
+// Sweep and prune on both axes, re-sorted by insertion sort as proxies move and keeping a
+// cache of overlapping pairs, for scenes where most bodies move little between ticks
+BroadPhase CreateSweepBroadPhase(void);
+
+typedef struct SweepPruneStats {
+	int pairs;	// In the cache now
+	int added;	// Since the last call
+	int removed;
+	int swaps;	// Endpoint swaps made by the insertion sort
+	int updates;	// Proxies created, moved or destroyed
+} SweepPruneStats;
+
+SweepPruneStats GetSweepPruneStats(BroadPhase *bp);	// bp from CreateSweepBroadPhase(), resets the counts
+
+// Shared by the implementations. Touching edges do not overlap, as with CheckCollisionRecs().
+static inline bool OverlapBroadPhaseRecs(Rectangle a, Rectangle b)
+{
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// Slab test of the segment origin + delta*t, t in [0, 1]; entry time in *time
+static inline bool IntersectSegmentRec(Vector2 origin, Vector2 delta, Rectangle rec, float *time)
+{
+	float enter = 0.0f, exit = 1.0f;
+	float o[2] = { origin.x, origin.y }, d[2] = { delta.x, delta.y };
+	float lo[2] = { rec.x, rec.y }, hi[2] = { rec.x + rec.width, rec.y + rec.height };
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		if (d[axis] == 0.0f)
+		{
+			if (o[axis] < lo[axis] || o[axis] > hi[axis]) return false;
+			continue;
+		}
+
+		float inv = 1.0f/d[axis];
+		float t0 = (lo[axis] - o[axis])*inv, t1 = (hi[axis] - o[axis])*inv;
+		if (t0 > t1)
+		{
+			float t = t0;
+			t0 = t1;
+			t1 = t;
+		}
+		if (t0 > enter) enter = t0;
+		if (t1 < exit) exit = t1;
+		if (enter > exit) return false;
+	}
+
+	*time = enter;
+	return true;
+}
+
+static inline int CreateBroadPhaseProxy(BroadPhase *bp, Rectangle rec, int userData) { return bp->createProxy(bp->data, rec, userData); }
+static inline void DestroyBroadPhaseProxy(BroadPhase *bp, int proxy) { bp->destroyProxy(bp->data, proxy); }
+static inline void MoveBroadPhaseProxy(BroadPhase *bp, int proxy, Rectangle rec, Vector2 displacement) { bp->moveProxy(bp->data, proxy, rec, displacement); }
+static inline void UnloadBroadPhase(BroadPhase *bp) { bp->destroy(bp->data); bp->data = NULL; }
+
+#endif
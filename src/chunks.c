@@ -0,0 +1,372 @@
+#include "chunks.h"
+#include "queue.h"
+#include "timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sched.h>
+#include <pthread.h>
+
+typedef struct ChunkSlot {
+	int chunk;
+	unsigned int lastUsed;	// Frame the chunk was last within the load radius
+	Tilemap map;
+} ChunkSlot;
+
+typedef struct ChunkRequest {
+	int chunk;
+	int source;
+	double requestTime;
+} ChunkRequest;
+
+typedef struct ChunkResult {
+	int chunk;
+	bool failed;
+	double requestTime;
+	double decodeMs;
+	Tilemap map;
+} ChunkResult;
+
+struct ChunkStream {
+	int width;	// In chunks
+	int height;
+	int chunkWidth;	// In tiles
+	int chunkHeight;
+	char **files;
+	int fileCount;
+	unsigned short *sources;
+	int *states;	// Slot per chunk, CHUNK_NOT_RESIDENT or CHUNK_LOADING
+
+	ChunkSlot *slots;
+	int slotCount;
+	int budget;
+	int loadRadius;
+	unsigned int frame;
+	ChunkStreamStats stats;
+
+	// Requests go to the loader thread and decoded chunks come back, each queue has one
+	// producer and one consumer. Requests in flight never exceed the queue capacity.
+	SpscQueue requests;
+	SpscQueue results;
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t wake;
+	bool quit;
+};
+
+//----------------------------------------------------------------------------------
+// Loader thread
+//----------------------------------------------------------------------------------
+
+// Plain stdio rather than LoadFileData, which logs every file it reads
+static Image ReadChunkImage(const char *fileName)
+{
+	Image image = { 0 };
+	FILE *file = fopen(fileName, "rb");
+	if (file == NULL) return image;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	unsigned char *data = (size > 0)? malloc((size_t)size) : NULL;
+	if (data != NULL && fread(data, 1, (size_t)size, file) == (size_t)size)
+	{
+		image = LoadImageFromMemory(GetFileExtension(fileName), data, (int)size);
+	}
+
+	free(data);
+	fclose(file);
+	return image;
+}
+
+static ChunkResult LoadChunk(const ChunkStream *stream, ChunkRequest request)
+{
+	double start = GetTimerSeconds();
+	ChunkResult result = { request.chunk, false, request.requestTime, 0.0, { 0 } };
+
+	Image image = ReadChunkImage(stream->files[request.source]);
+	result.failed = (image.data == NULL);
+	Tilemap map = LoadTilemapFromImage(image);
+	UnloadImage(image);
+
+	// Every chunk has the same size so tile lookups stay a divide and an index
+	if (map.width != stream->chunkWidth || map.height != stream->chunkHeight)
+	{
+		Tilemap fitted = GenTilemapEmpty(stream->chunkWidth, stream->chunkHeight);
+		fitted.paletteCount = map.paletteCount;
+		memcpy(fitted.palette, map.palette, sizeof(map.palette));
+
+		int w = (map.width < fitted.width)? map.width : fitted.width;
+		for (int y = 0; y < map.height && y < fitted.height; y++) memcpy(fitted.tiles + y*fitted.width, map.tiles + y*map.width, (size_t)w);
+
+		UnloadTilemap(map);
+		map = fitted;
+	}
+
+	result.map = map;
+	result.decodeMs = (GetTimerSeconds() - start)*1000.0;
+	return result;
+}
+
+static void *ChunkLoaderThread(void *user)
+{
+	ChunkStream *stream = user;
+
+	while (true)
+	{
+		ChunkRequest request;
+		bool popped;
+
+		pthread_mutex_lock(&stream->mutex);
+		while (!(popped = PopSpsc(&stream->requests, &request)) && !stream->quit) pthread_cond_wait(&stream->wake, &stream->mutex);
+		pthread_mutex_unlock(&stream->mutex);
+		if (!popped) break;
+
+		ChunkResult result = LoadChunk(stream, request);
+		while (!PushSpsc(&stream->results, &result)) sched_yield();
+	}
+
+	return NULL;
+}
+
+//----------------------------------------------------------------------------------
+// Stream
+//----------------------------------------------------------------------------------
+
+ChunkStream *CreateChunkStream(const char **files, int fileCount, int width, int height,
+	const unsigned short *sources, int loadRadius, int budget)
+{
+	Image first = (fileCount > 0)? ReadChunkImage(files[0]) : (Image){ 0 };
+	if (first.data == NULL)
+	{
+		TraceLog(LOG_WARNING, "CHUNKS: Could not read the first chunk map");
+		return NULL;
+	}
+
+	ChunkStream *stream = calloc(1, sizeof(ChunkStream));
+	stream->width = width;
+	stream->height = height;
+	stream->chunkWidth = first.width;
+	stream->chunkHeight = first.height;
+	UnloadImage(first);
+
+	stream->files = calloc((size_t)fileCount, sizeof(char *));
+	for (int i = 0; i < fileCount; i++)
+	{
+		stream->files[i] = malloc(strlen(files[i]) + 1);
+		strcpy(stream->files[i], files[i]);
+	}
+	stream->fileCount = fileCount;
+
+	stream->sources = malloc((size_t)width*height*sizeof(unsigned short));
+	stream->states = malloc((size_t)width*height*sizeof(int));
+	for (int i = 0; i < width*height; i++)
+	{
+		stream->sources[i] = (sources[i] < fileCount)? sources[i] : 0;
+		stream->states[i] = CHUNK_NOT_RESIDENT;
+	}
+
+	// One ring of slack so chunks arriving at the edge never push out ones still needed
+	int side = 2*loadRadius + 2;
+	if (budget < side*side) budget = side*side;
+	stream->budget = budget;
+	stream->loadRadius = loadRadius;
+	stream->slots = calloc((size_t)budget, sizeof(ChunkSlot));
+
+	InitSpscQueue(&stream->requests, CHUNK_MAX_PENDING, sizeof(ChunkRequest));
+	InitSpscQueue(&stream->results, CHUNK_MAX_PENDING, sizeof(ChunkResult));
+	pthread_mutex_init(&stream->mutex, NULL);
+	pthread_cond_init(&stream->wake, NULL);
+	pthread_create(&stream->thread, NULL, ChunkLoaderThread, stream);
+
+	return stream;
+}
+
+void DestroyChunkStream(ChunkStream *stream)
+{
+	if (stream == NULL) return;
+
+	pthread_mutex_lock(&stream->mutex);
+	stream->quit = true;
+	pthread_cond_signal(&stream->wake);
+	pthread_mutex_unlock(&stream->mutex);
+	pthread_join(stream->thread, NULL);
+
+	// The loader finishes what was queued before it quits
+	ChunkResult result;
+	while (PopSpsc(&stream->results, &result)) UnloadTilemap(result.map);
+	for (int i = 0; i < stream->slotCount; i++) UnloadTilemap(stream->slots[i].map);
+
+	for (int i = 0; i < stream->fileCount; i++) free(stream->files[i]);
+	free(stream->files);
+	free(stream->sources);
+	free(stream->states);
+	free(stream->slots);
+	FreeSpscQueue(&stream->requests);
+	FreeSpscQueue(&stream->results);
+	pthread_mutex_destroy(&stream->mutex);
+	pthread_cond_destroy(&stream->wake);
+	free(stream);
+}
+
+static size_t GetChunkBytes(const ChunkStream *stream)
+{
+	return (size_t)stream->chunkWidth*stream->chunkHeight + sizeof(Tilemap);
+}
+
+static int GetFreeSlot(ChunkStream *stream)
+{
+	if (stream->slotCount < stream->budget) return stream->slotCount++;
+
+	int oldest = 0;
+	for (int i = 1; i < stream->slotCount; i++)
+	{
+		if (stream->slots[i].lastUsed < stream->slots[oldest].lastUsed) oldest = i;
+	}
+
+	ChunkSlot *slot = &stream->slots[oldest];
+	stream->states[slot->chunk] = CHUNK_NOT_RESIDENT;
+	UnloadTilemap(slot->map);
+	stream->stats.evictions++;
+	stream->stats.resident--;
+	stream->stats.residentBytes -= GetChunkBytes(stream);
+	return oldest;
+}
+
+static int PlaceChunk(ChunkStream *stream, int chunk, Tilemap map, unsigned int lastUsed)
+{
+	ChunkStreamStats *stats = &stream->stats;
+	int slot = GetFreeSlot(stream);
+	stream->slots[slot] = (ChunkSlot){ chunk, lastUsed, map };
+	stream->states[chunk] = slot;
+
+	stats->resident++;
+	stats->residentBytes += GetChunkBytes(stream);
+	if (stats->residentBytes > stats->peakResidentBytes) stats->peakResidentBytes = stats->residentBytes;
+	return slot;
+}
+
+static void InstallChunk(ChunkStream *stream, const ChunkResult *result, int focusX, int focusY)
+{
+	ChunkStreamStats *stats = &stream->stats;
+	double latencyMs = (GetTimerSeconds() - result->requestTime)*1000.0;
+
+	stats->pending--;
+
+	// A tile query got there first and loaded it itself
+	if (stream->states[result->chunk] >= 0)
+	{
+		UnloadTilemap(result->map);
+		return;
+	}
+
+	stats->loads++;
+	stats->totalLatencyMs += latencyMs;
+	if (latencyMs > stats->maxLatencyMs) stats->maxLatencyMs = latencyMs;
+	if (result->decodeMs > stats->maxDecodeMs) stats->maxDecodeMs = result->decodeMs;
+	if (result->failed)
+	{
+		stats->failures++;
+		TraceLog(LOG_WARNING, "CHUNKS: [%s] Could not load, chunk %i left empty",
+			stream->files[stream->sources[result->chunk]], result->chunk);
+	}
+
+	int x = result->chunk%stream->width, y = result->chunk/stream->width;
+	bool near = (abs(x - focusX) <= stream->loadRadius && abs(y - focusY) <= stream->loadRadius);
+
+	// A chunk the focus has already moved away from is first in line to go again
+	PlaceChunk(stream, result->chunk, result->map, near? stream->frame : stream->frame - 1);
+}
+
+void UpdateChunkStream(ChunkStream *stream, Vector2 focus)
+{
+	stream->frame++;
+	int focusX = (int)floorf(focus.x/(stream->chunkWidth*TILE_SIZE));
+	int focusY = (int)floorf(focus.y/(stream->chunkHeight*TILE_SIZE));
+
+	// Touch what is needed before installing, so eviction only ever picks chunks out of range
+	bool requested = false;
+	double now = GetTimerSeconds();
+
+	for (int d = 0; d <= stream->loadRadius; d++)
+	{
+		for (int y = focusY - d; y <= focusY + d; y++)
+		{
+			if (y < 0 || y >= stream->height) continue;
+
+			// Whole rows at the top and bottom of the ring, only its two ends in between
+			int step = (y == focusY - d || y == focusY + d || d == 0)? 1 : 2*d;
+			for (int x = focusX - d; x <= focusX + d; x += step)
+			{
+				if (x < 0 || x >= stream->width) continue;
+
+				int chunk = y*stream->width + x;
+				int state = stream->states[chunk];
+				if (state >= 0) stream->slots[state].lastUsed = stream->frame;
+				else if (state == CHUNK_NOT_RESIDENT && stream->stats.pending < CHUNK_MAX_PENDING)
+				{
+					ChunkRequest request = { chunk, stream->sources[chunk], now };
+					PushSpsc(&stream->requests, &request);
+					stream->states[chunk] = CHUNK_LOADING;
+					stream->stats.pending++;
+					requested = true;
+				}
+			}
+		}
+	}
+
+	if (requested)
+	{
+		pthread_mutex_lock(&stream->mutex);
+		pthread_cond_signal(&stream->wake);
+		pthread_mutex_unlock(&stream->mutex);
+	}
+
+	ChunkResult result;
+	while (PopSpsc(&stream->results, &result)) InstallChunk(stream, &result, focusX, focusY);
+}
+
+ChunkStreamStats GetChunkStreamStats(const ChunkStream *stream)
+{
+	return stream->stats;
+}
+
+int GetChunkStreamState(const ChunkStream *stream, int chunkX, int chunkY)
+{
+	if (chunkX < 0 || chunkY < 0 || chunkX >= stream->width || chunkY >= stream->height) return CHUNK_NOT_RESIDENT;
+	return stream->states[chunkY*stream->width + chunkX];
+}
+
+Rectangle GetChunkStreamBounds(const ChunkStream *stream)
+{
+	return (Rectangle){ 0, 0, (float)stream->width*stream->chunkWidth*TILE_SIZE, (float)stream->height*stream->chunkHeight*TILE_SIZE };
+}
+
+bool IsStreamTileSolid(ChunkStream *stream, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= stream->width*stream->chunkWidth || y >= stream->height*stream->chunkHeight) return true;
+
+	int chunk = (y/stream->chunkHeight)*stream->width + x/stream->chunkWidth;
+	int slot = stream->states[chunk];
+	if (slot >= 0) stream->slots[slot].lastUsed = stream->frame;
+	else
+	{
+		// Still queued or never requested, either way the caller cannot wait on the loader.
+		// A result still in flight is dropped when it arrives.
+		ChunkResult result = LoadChunk(stream, (ChunkRequest){ chunk, stream->sources[chunk], GetTimerSeconds() });
+		stream->stats.syncLoads++;
+		if (result.decodeMs > stream->stats.maxSyncLoadMs) stream->stats.maxSyncLoadMs = result.decodeMs;
+		if (result.failed)
+		{
+			stream->stats.failures++;
+			TraceLog(LOG_WARNING, "CHUNKS: [%s] Could not load, chunk %i left empty", stream->files[stream->sources[chunk]], chunk);
+		}
+		slot = PlaceChunk(stream, chunk, result.map, stream->frame);
+	}
+
+	const Tilemap *map = &stream->slots[slot].map;
+	return map->tiles[(y%stream->chunkHeight)*map->width + x%stream->chunkWidth] != TILE_EMPTY;
+}
@@ -0,0 +1,55 @@
+#ifndef CHUNKS_H
+#define CHUNKS_H
+
+#include <stddef.h>
+
+#include "raylib.h"
+#include "tilemap.h"
+
+// A large world made of map PNGs laid out on a grid, one map per chunk. Chunks around
+// a focus point are decoded on a background thread and kept within a fixed budget of
+// resident slots, least recently used first out. All calls come from one thread.
+// Tile queries load a missing chunk on the spot, so what they return never depends on
+// the loader's timing; the background loads only make that rare.
+// The game itself still plays on one Tilemap. Every system (collision, the swarm's flow
+// field, FOV, lighting, snapshots) takes a flat map and the game has no camera to scroll
+// a world larger than the window, so only the headless --stream-walk drives the stream.
+
+#define CHUNK_MAX_PENDING 64	// Requests in flight to the loader thread
+#define CHUNK_NOT_RESIDENT -1
+#define CHUNK_LOADING -2
+
+typedef struct ChunkStreamStats {
+	int resident;
+	int pending;
+	int loads;
+	int evictions;
+	int failures;
+	int syncLoads;	// Chunks a tile query had to load itself
+	size_t residentBytes;	// Tiles and palettes of resident chunks
+	size_t peakResidentBytes;
+	double maxLatencyMs;	// Request to resident, including time queued
+	double totalLatencyMs;
+	double maxDecodeMs;	// Read and decode on the loader thread alone
+	double maxSyncLoadMs;	// The hitch a tile query paid for a missing chunk
+} ChunkStreamStats;
+
+typedef struct ChunkStream ChunkStream;
+
+// `sources` holds an index into `files` per chunk, row by row, and is copied. Chunk size
+// comes from the first file; maps of another size are cropped or padded with empty tiles.
+// `budget` is raised to fit everything within `loadRadius` chunks of the focus.
+ChunkStream *CreateChunkStream(const char **files, int fileCount, int width, int height,
+	const unsigned short *sources, int loadRadius, int budget);
+void DestroyChunkStream(ChunkStream *stream);
+
+// Once per frame: installs finished chunks, requests missing ones nearest first and
+// evicts over budget. Never waits on the loader.
+void UpdateChunkStream(ChunkStream *stream, Vector2 focus);
+ChunkStreamStats GetChunkStreamStats(const ChunkStream *stream);
+
+int GetChunkStreamState(const ChunkStream *stream, int chunkX, int chunkY);	// Slot, CHUNK_NOT_RESIDENT or CHUNK_LOADING
+Rectangle GetChunkStreamBounds(const ChunkStream *stream);	// World size in pixels
+bool IsStreamTileSolid(ChunkStream *stream, int x, int y);	// In tiles, outside the world is wall
+
+#endif
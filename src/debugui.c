@@ -0,0 +1,296 @@
+#include "debugui.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DEBUG_UI_PANEL (Color){ 0, 0, 0, 170 }
+#define DEBUG_UI_TRACK (Color){ 60, 60, 68, 255 }
+#define DEBUG_UI_FILL (Color){ 80, 130, 210, 255 }
+#define DEBUG_UI_FILL_HOT (Color){ 120, 170, 250, 255 }
+#define DEBUG_UI_TEXT RAYWHITE
+#define DEBUG_UI_BAR (Color){ 90, 200, 120, 255 }
+#define DEBUG_UI_BAR_OVER (Color){ 230, 80, 70, 255 }
+
+typedef enum DebugWidgetKind {
+	DEBUG_WIDGET_SLIDER = 1,
+	DEBUG_WIDGET_SLIDER_INT,
+	DEBUG_WIDGET_CHECKBOX,
+	DEBUG_WIDGET_GRAPH,
+} DebugWidgetKind;
+
+Rectangle GetDefaultFontSolid(Font font)
+{
+	if (font.recs == NULL || font.glyphCount < 96) return (Rectangle){ 0 };
+	Rectangle rec = font.recs[95];
+	return (Rectangle){ rec.x + 1, rec.y + 1, rec.width - 2, rec.height - 2 };
+}
+
+DebugUi LoadDebugUi(TextCache *text, Rectangle solid, Vector2 position, float width)
+{
+	DebugUi ui = { 0 };
+	ui.text = text;
+	ui.solid = solid;
+	ui.bounds = (Rectangle){ position.x, position.y, width, 0.0f };
+	return ui;
+}
+
+void UnloadDebugUi(DebugUi *ui)
+{
+	for (int i = 0; i < DEBUG_UI_MAX_WIDGETS; i++) free(ui->widgets[i].quads);
+	memset(ui, 0, sizeof(*ui));
+}
+
+//------------------------------------------------------------------------------------
+// Retained quads
+//------------------------------------------------------------------------------------
+
+static unsigned int HashWidgetBytes(unsigned int hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+	for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i])*16777619u;
+	return hash;
+}
+
+static unsigned int HashLabel(const char *label)
+{
+	unsigned int hash = HashWidgetBytes(2166136261u, label, strlen(label));
+	return (hash != 0)? hash : 1;
+}
+
+// Everything the quads depend on besides the widget's own value
+static unsigned int WidgetKey(const DebugUi *ui, DebugWidgetKind kind, unsigned int label, Rectangle row, int state)
+{
+	unsigned int hash = HashWidgetBytes(2166136261u, &kind, sizeof(kind));
+	hash = HashWidgetBytes(hash, &label, sizeof(label));
+	hash = HashWidgetBytes(hash, &row, sizeof(row));
+	hash = HashWidgetBytes(hash, &ui->text->atlas->texture.id, sizeof(unsigned int));
+	return HashWidgetBytes(hash, &state, sizeof(state));
+}
+
+// The widget for this call, NULL when its quads from last frame are still good or the panel is full
+static DebugUiWidget *BeginWidget(DebugUi *ui, unsigned int key)
+{
+	if (ui->count == DEBUG_UI_MAX_WIDGETS) return NULL;
+	DebugUiWidget *widget = &ui->widgets[ui->count++];
+	ui->stats.widgets++;
+
+	if (key == 0) key = 1;
+	if (widget->key == key) return NULL;
+
+	widget->key = key;
+	widget->quadCount = 0;
+	ui->stats.rebuilt++;
+	return widget;
+}
+
+static SpriteQuad *AddWidgetQuads(DebugUiWidget *widget, int count)
+{
+	if (widget->quadCount + count > widget->quadCapacity)
+	{
+		int capacity = (widget->quadCapacity > 0)? widget->quadCapacity : 16;
+		while (capacity < widget->quadCount + count) capacity *= 2;
+		SpriteQuad *quads = realloc(widget->quads, (size_t)capacity*sizeof(SpriteQuad));
+		if (quads == NULL)
+		{
+			TraceLog(LOG_WARNING, "DEBUGUI: Out of memory, widget drawn incomplete");
+			return NULL;
+		}
+		widget->quads = quads;
+		widget->quadCapacity = capacity;
+	}
+
+	SpriteQuad *quads = widget->quads + widget->quadCount;
+	widget->quadCount += count;
+	return quads;
+}
+
+static SpriteQuad SolidQuad(const DebugUi *ui, Rectangle rec, Color color)
+{
+	Texture2D texture = ui->text->atlas->texture;
+	float w = (texture.width > 0)? (float)texture.width : 1.0f, h = (texture.height > 0)? (float)texture.height : 1.0f;
+	Rectangle s = ui->solid;
+	return (SpriteQuad){ rec, s.x/w, s.y/h, (s.x + s.width)/w, (s.y + s.height)/h, color };
+}
+
+static void AddRect(DebugUi *ui, DebugUiWidget *widget, Rectangle rec, Color color)
+{
+	SpriteQuad *quad = AddWidgetQuads(widget, 1);
+	if (quad != NULL) *quad = SolidQuad(ui, rec, color);
+}
+
+static void AddText(DebugUi *ui, DebugUiWidget *widget, const char *text, Vector2 position, Color color)
+{
+	const TextLayout *layout = GetTextLayout(ui->text, text, DEBUG_UI_FONT_SIZE, DEBUG_UI_FONT_SIZE/10.0f);
+	SpriteQuad *quads = AddWidgetQuads(widget, layout->quadCount);
+	if (quads == NULL) return;
+
+	for (int i = 0; i < layout->quadCount; i++)
+	{
+		quads[i] = layout->quads[i];
+		quads[i].dest.x += position.x;
+		quads[i].dest.y += position.y;
+		quads[i].color = color;
+	}
+}
+
+//------------------------------------------------------------------------------------
+// Panel
+//------------------------------------------------------------------------------------
+
+void BeginDebugUi(DebugUi *ui, DebugUiInput input)
+{
+	ui->input = input;
+	ui->count = 0;
+	ui->cursorY = ui->bounds.y + DEBUG_UI_PADDING;
+	ui->stats = (DebugUiStats){ 0 };
+}
+
+void EndDebugUi(DebugUi *ui, SpriteBatch *batch)
+{
+	Texture2D texture = ui->text->atlas->texture;
+	ui->bounds.height = ui->cursorY + DEBUG_UI_PADDING - ui->bounds.y;
+
+	SpriteQuad panel = SolidQuad(ui, ui->bounds, DEBUG_UI_PANEL);
+	PushSpriteQuads(batch, texture, &panel, 1, (Vector2){ 0.0f, 0.0f }, WHITE);
+	ui->stats.quads++;
+
+	for (int i = 0; i < ui->count; i++)
+	{
+		const DebugUiWidget *widget = &ui->widgets[i];
+		PushSpriteQuads(batch, texture, widget->quads, widget->quadCount, (Vector2){ 0.0f, 0.0f }, WHITE);
+		ui->stats.quads += widget->quadCount;
+	}
+
+	if (!ui->input.down) ui->active = 0;
+}
+
+static Rectangle NextRow(DebugUi *ui, int rows)
+{
+	Rectangle row = { ui->bounds.x + DEBUG_UI_PADDING, ui->cursorY, ui->bounds.width - 2.0f*DEBUG_UI_PADDING, rows*DEBUG_UI_ROW_HEIGHT };
+	ui->cursorY += row.height;
+	return row;
+}
+
+static Rectangle GetControlRec(Rectangle row)
+{
+	float labelWidth = row.width*DEBUG_UI_LABEL_WIDTH;
+	return (Rectangle){ row.x + labelWidth, row.y + 2.0f, row.width - labelWidth, row.height - 4.0f };
+}
+
+static Vector2 GetLabelPosition(Rectangle row)
+{
+	return (Vector2){ row.x, row.y + (DEBUG_UI_ROW_HEIGHT - DEBUG_UI_FONT_SIZE)/2.0f };
+}
+
+//------------------------------------------------------------------------------------
+// Widgets
+//------------------------------------------------------------------------------------
+
+static bool Slider(DebugUi *ui, DebugWidgetKind kind, const char *label, float *value, float min, float max)
+{
+	Rectangle row = NextRow(ui, 1);
+	Rectangle track = GetControlRec(row);
+	unsigned int id = HashLabel(label);
+	bool hot = CheckCollisionPointRec(ui->input.mouse, track);
+	if (hot && ui->input.pressed) ui->active = id;
+
+	// Follows the mouse anywhere while held, the release frame still counts
+	bool changed = false;
+	bool active = (ui->active == id);
+	if (active && track.width > 0.0f)
+	{
+		float t = fminf(fmaxf((ui->input.mouse.x - track.x)/track.width, 0.0f), 1.0f);
+		float next = min + t*(max - min);
+		if (kind == DEBUG_WIDGET_SLIDER_INT) next = roundf(next);
+		if (next != *value)
+		{
+			*value = next;
+			changed = true;
+		}
+	}
+
+	int state = (hot? 1 : 0) | (active? 2 : 0);
+	unsigned int key = WidgetKey(ui, kind, id, row, state);
+	key = HashWidgetBytes(key, value, sizeof(float));
+	key = HashWidgetBytes(key, &min, sizeof(float));
+	key = HashWidgetBytes(key, &max, sizeof(float));
+
+	DebugUiWidget *widget = BeginWidget(ui, key);
+	if (widget == NULL) return changed;
+
+	float t = (max > min)? fminf(fmaxf((*value - min)/(max - min), 0.0f), 1.0f) : 0.0f;
+	char text[32];
+	if (kind == DEBUG_WIDGET_SLIDER_INT) snprintf(text, sizeof(text), "%d", (int)*value);
+	else snprintf(text, sizeof(text), "%.3g", *value);
+
+	AddText(ui, widget, label, GetLabelPosition(row), DEBUG_UI_TEXT);
+	AddRect(ui, widget, track, DEBUG_UI_TRACK);
+	AddRect(ui, widget, (Rectangle){ track.x, track.y, track.width*t, track.height }, (hot || active)? DEBUG_UI_FILL_HOT : DEBUG_UI_FILL);
+	AddText(ui, widget, text, (Vector2){ track.x + 3.0f, track.y + (track.height - DEBUG_UI_FONT_SIZE)/2.0f }, DEBUG_UI_TEXT);
+	return changed;
+}
+
+bool DebugSlider(DebugUi *ui, const char *label, float *value, float min, float max)
+{
+	return Slider(ui, DEBUG_WIDGET_SLIDER, label, value, min, max);
+}
+
+bool DebugSliderInt(DebugUi *ui, const char *label, int *value, int min, int max)
+{
+	float v = (float)*value;
+	bool changed = Slider(ui, DEBUG_WIDGET_SLIDER_INT, label, &v, (float)min, (float)max);
+	*value = (int)v;
+	return changed;
+}
+
+bool DebugCheckbox(DebugUi *ui, const char *label, bool *value)
+{
+	Rectangle row = NextRow(ui, 1);
+	Rectangle control = GetControlRec(row);
+	bool hot = CheckCollisionPointRec(ui->input.mouse, row);
+	bool changed = (hot && ui->input.pressed);
+	if (changed) *value = !*value;
+
+	int state = (hot? 1 : 0) | (*value? 2 : 0);
+	DebugUiWidget *widget = BeginWidget(ui, WidgetKey(ui, DEBUG_WIDGET_CHECKBOX, HashLabel(label), row, state));
+	if (widget == NULL) return changed;
+
+	Rectangle box = { control.x, control.y, control.height, control.height };
+	AddText(ui, widget, label, GetLabelPosition(row), DEBUG_UI_TEXT);
+	AddRect(ui, widget, box, hot? DEBUG_UI_FILL : DEBUG_UI_TRACK);
+	if (*value) AddRect(ui, widget, (Rectangle){ box.x + 3.0f, box.y + 3.0f, box.width - 6.0f, box.height - 6.0f }, DEBUG_UI_FILL_HOT);
+	return changed;
+}
+
+void DebugGraph(DebugUi *ui, const char *label, const float *samples, int count, int oldest, float maxValue)
+{
+	Rectangle row = NextRow(ui, DEBUG_UI_GRAPH_ROWS);
+	Rectangle area = GetControlRec(row);
+
+	unsigned int key = WidgetKey(ui, DEBUG_WIDGET_GRAPH, HashLabel(label), row, oldest);
+	key = HashWidgetBytes(key, samples, (size_t)count*sizeof(float));
+	key = HashWidgetBytes(key, &maxValue, sizeof(float));
+
+	DebugUiWidget *widget = BeginWidget(ui, key);
+	if (widget == NULL || count <= 0) return;
+
+	AddText(ui, widget, label, GetLabelPosition(row), DEBUG_UI_TEXT);
+	AddRect(ui, widget, area, DEBUG_UI_TRACK);
+
+	float barWidth = area.width/count, scale = (maxValue > 0.0f)? area.height/maxValue : 0.0f;
+	SpriteQuad *bars = AddWidgetQuads(widget, count);
+	if (bars == NULL) return;
+	for (int i = 0; i < count; i++)
+	{
+		float v = samples[(oldest + i)%count];
+		float height = fminf(fmaxf(v*scale, 0.0f), area.height);
+		Rectangle bar = { area.x + i*barWidth, area.y + area.height - height, barWidth, height };
+		bars[i] = SolidQuad(ui, bar, (v > maxValue)? DEBUG_UI_BAR_OVER : DEBUG_UI_BAR);
+	}
+
+	char text[32];
+	snprintf(text, sizeof(text), "%.2f", samples[(oldest + count - 1)%count]);
+	AddText(ui, widget, text, (Vector2){ row.x, row.y + DEBUG_UI_ROW_HEIGHT }, DEBUG_UI_TEXT);
+}
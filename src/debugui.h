@@ -0,0 +1,70 @@
+#ifndef DEBUGUI_H
+#define DEBUGUI_H
+
+#include "raylib.h"
+#include "spritebatch.h"
+#include "textcache.h"
+
+// Tuning panel for live values, written immediate mode: every frame the game calls one
+// function per widget with a pointer to the value it edits, in the same order, and the
+// panel lays the rows out top to bottom. Each widget keeps the quads it built last frame
+// along with a hash of what went into them (label, value, position, hover); while that
+// stays the same the old quads go straight into the batch, so a panel full of values
+// nobody touches costs a hash and a copy per widget. Shapes use a solid white area of the
+// font texture, so the whole panel is one draw call.
+
+#define DEBUG_UI_MAX_WIDGETS 256
+#define DEBUG_UI_FONT_SIZE 10.0f
+#define DEBUG_UI_ROW_HEIGHT 16.0f
+#define DEBUG_UI_PADDING 6.0f
+#define DEBUG_UI_LABEL_WIDTH 0.45f	// Share of the row left of the controls
+#define DEBUG_UI_GRAPH_ROWS 3
+
+typedef struct DebugUiInput {
+	Vector2 mouse;
+	bool down;	// Left button held
+	bool pressed;	// Went down this frame
+} DebugUiInput;
+
+typedef struct DebugUiWidget {
+	unsigned int key;	// Hash of what the quads were built from, 0 before the first build
+	SpriteQuad *quads;
+	int quadCount;
+	int quadCapacity;
+} DebugUiWidget;
+
+typedef struct DebugUiStats {
+	int widgets;
+	int rebuilt;
+	int quads;
+} DebugUiStats;
+
+typedef struct DebugUi {
+	TextCache *text;	// Labels and values, shared with the rest of the HUD
+	Rectangle solid;	// Texels of a solid white area in the font texture
+	Rectangle bounds;	// Height follows the rows
+	DebugUiInput input;
+	unsigned int active;	// Label hash of the slider being dragged, 0 for none
+	DebugUiWidget widgets[DEBUG_UI_MAX_WIDGETS];	// In call order
+	int count;
+	float cursorY;
+	DebugUiStats stats;	// Since BeginDebugUi()
+} DebugUi;
+
+// raylib's default font has a solid block in its last glyph, this is the area it gives to the shapes module
+Rectangle GetDefaultFontSolid(Font font);
+
+DebugUi LoadDebugUi(TextCache *text, Rectangle solid, Vector2 position, float width);
+void UnloadDebugUi(DebugUi *ui);
+
+void BeginDebugUi(DebugUi *ui, DebugUiInput input);
+void EndDebugUi(DebugUi *ui, SpriteBatch *batch);	// Pushes the panel, call after the widgets
+
+// Widgets return true when the user changed the value this frame
+bool DebugSlider(DebugUi *ui, const char *label, float *value, float min, float max);
+bool DebugSliderInt(DebugUi *ui, const char *label, int *value, int min, int max);
+bool DebugCheckbox(DebugUi *ui, const char *label, bool *value);
+// samples is a ring of count values starting at the oldest, bars are scaled so maxValue fills the graph
+void DebugGraph(DebugUi *ui, const char *label, const float *samples, int count, int oldest, float maxValue);
+
+#endif
@@ -0,0 +1,112 @@
+#include "entities.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Entities AllocEntities(int capacity)
+{
+	Entities entities = { 0 };
+	entities.capacity = capacity;
+	entities.posX = calloc(capacity, sizeof(float));
+	entities.posY = calloc(capacity, sizeof(float));
+	entities.velX = calloc(capacity, sizeof(float));
+	entities.velY = calloc(capacity, sizeof(float));
+	entities.kind = calloc(capacity, sizeof(unsigned char));
+	entities.health = calloc(capacity, sizeof(short));
+	return entities;
+}
+
+void FreeEntities(Entities *entities)
+{
+	free(entities->posX);
+	free(entities->posY);
+	free(entities->velX);
+	free(entities->velY);
+	free(entities->kind);
+	free(entities->health);
+	memset(entities, 0, sizeof(*entities));
+}
+
+int SpawnEntity(Entities *entities, EntityKind kind, Vector2 position, Vector2 velocity)
+{
+	if (entities->count == entities->capacity) return -1;
+
+	int i = entities->count++;
+	entities->posX[i] = position.x;
+	entities->posY[i] = position.y;
+	entities->velX[i] = velocity.x;
+	entities->velY[i] = velocity.y;
+	entities->kind[i] = (unsigned char)kind;
+	entities->health[i] = (kind == ENTITY_BULLET)? 1 : 3;
+	return i;
+}
+
+void RemoveEntity(Entities *entities, int index)
+{
+	int last = --entities->count;
+	if (index == last) return;
+
+	entities->posX[index] = entities->posX[last];
+	entities->posY[index] = entities->posY[last];
+	entities->velX[index] = entities->velX[last];
+	entities->velY[index] = entities->velY[last];
+	entities->kind[index] = entities->kind[last];
+	entities->health[index] = entities->health[last];
+}
+
+Vector2 GetEntitySize(EntityKind kind)
+{
+	switch (kind)
+	{
+		case ENTITY_PLAYER: return (Vector2){ 32, 32 };
+		case ENTITY_BULLET: return (Vector2){ 6, 6 };
+		case ENTITY_ENEMY: return (Vector2){ 28, 28 };
+		default: return (Vector2){ 0, 0 };
+	}
+}
+
+Rectangle GetEntityRec(const Entities *entities, int index)
+{
+	Vector2 size = GetEntitySize(entities->kind[index]);
+	return (Rectangle){ entities->posX[index], entities->posY[index], size.x, size.y };
+}
+
+void UpdateEntities(Entities *entities, const Tilemap *map, float dt)
+{
+	for (int i = 0; i < entities->count; i++)
+	{
+		Rectangle rec = GetEntityRec(entities, i);
+
+		Vector2 delta = { entities->velX[i]*dt, entities->velY[i]*dt };
+
+		// Swept rather than tested at the end position, so fast bodies cannot skip a wall
+		if (entities->kind[i] == ENTITY_BULLET)
+		{
+			TileSweep hit = SweepTilemapRec(map, rec, delta);
+			if (hit.time < 1.0f)
+			{
+				RemoveEntity(entities, i--);
+				continue;
+			}
+			rec.x = hit.position.x;
+			rec.y = hit.position.y;
+		}
+		else
+		{
+			// Stop at the first wall, then spend the rest of the motion sliding along it
+			for (int pass = 0; pass < 2; pass++)
+			{
+				TileSweep hit = SweepTilemapRec(map, rec, delta);
+				rec.x = hit.position.x;
+				rec.y = hit.position.y;
+				if (hit.time >= 1.0f) break;
+
+				float rest = 1.0f - hit.time;
+				delta = (hit.normal.x != 0.0f)? (Vector2){ 0.0f, delta.y*rest } : (Vector2){ delta.x*rest, 0.0f };
+			}
+		}
+
+		entities->posX[i] = rec.x;
+		entities->posY[i] = rec.y;
+	}
+}
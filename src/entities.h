@@ -0,0 +1,38 @@
+#ifndef ENTITIES_H
+#define ENTITIES_H
+
+#include "raylib.h"
+#include "tilemap.h"
+
+typedef enum EntityKind {
+	ENTITY_NONE = 0,
+	ENTITY_PLAYER,
+	ENTITY_BULLET,
+	ENTITY_ENEMY,
+} EntityKind;
+
+// Struct-of-arrays so every system only touches the components it reads.
+// Entities are packed: removing one moves the last entity into its slot.
+typedef struct Entities {
+	int count;
+	int capacity;
+	float *posX;
+	float *posY;
+	float *velX;
+	float *velY;
+	unsigned char *kind;
+	short *health;
+} Entities;
+
+Entities AllocEntities(int capacity);
+void FreeEntities(Entities *entities);
+
+int SpawnEntity(Entities *entities, EntityKind kind, Vector2 position, Vector2 velocity);	// Returns -1 when full
+void RemoveEntity(Entities *entities, int index);
+
+Vector2 GetEntitySize(EntityKind kind);
+Rectangle GetEntityRec(const Entities *entities, int index);
+
+void UpdateEntities(Entities *entities, const Tilemap *map, float dt);
+
+#endif
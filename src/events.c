@@ -0,0 +1,82 @@
+#include "events.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define EVENT_MIN_CAPACITY 64
+
+const int eventSizes[EVENT_TYPE_COUNT] = {
+	[EVENT_SHOT_FIRED] = (int)sizeof(ShotFiredEvent),
+};
+
+EventBus LoadEventBus(void)
+{
+	EventBus bus = { 0 };
+	return bus;
+}
+
+void UnloadEventBus(EventBus *bus)
+{
+	for (int i = 0; i < EVENT_TYPE_COUNT; i++)
+	{
+		free(bus->pending[i].data);
+		free(bus->dispatching[i].data);
+	}
+	memset(bus, 0, sizeof(*bus));
+}
+
+bool AddEventHandler(EventBus *bus, EventType type, EventHandler handler, void *user)
+{
+	int i = bus->handlerCounts[type];
+	if (i == EVENT_MAX_HANDLERS)
+	{
+		TraceLog(LOG_WARNING, "EVENTS: Too many handlers for event type %i", (int)type);
+		return false;
+	}
+
+	bus->handlers[type][i] = handler;
+	bus->handlerUsers[type][i] = user;
+	bus->handlerCounts[type]++;
+	return true;
+}
+
+void *GrowEventBuffer(EventBuffer *buffer, int size)
+{
+	int capacity = (buffer->capacity > 0)? buffer->capacity*2 : EVENT_MIN_CAPACITY;
+	unsigned char *data = realloc(buffer->data, (size_t)capacity*size);
+	if (data == NULL)
+	{
+		TraceLog(LOG_WARNING, "EVENTS: Out of memory, event dropped");
+		return NULL;
+	}
+
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return buffer->data + (size_t)size*buffer->count++;
+}
+
+// Buffers keep their memory from tick to tick, so a steady game stops allocating
+int DispatchEvents(EventBus *bus)
+{
+	int delivered = 0;
+	for (int type = 0; type < EVENT_TYPE_COUNT; type++)
+	{
+		EventBuffer swap = bus->dispatching[type];
+		bus->dispatching[type] = bus->pending[type];
+		bus->pending[type] = swap;
+		bus->pending[type].count = 0;
+	}
+
+	for (int type = 0; type < EVENT_TYPE_COUNT; type++)
+	{
+		EventBuffer *buffer = &bus->dispatching[type];
+		if (buffer->count == 0) continue;
+
+		for (int h = 0; h < bus->handlerCounts[type]; h++) bus->handlers[type][h](bus->handlerUsers[type][h], buffer->data, buffer->count);
+		delivered += buffer->count;
+		buffer->count = 0;
+	}
+
+	bus->dispatched += delivered;
+	return delivered;
+}
@@ -0,0 +1,70 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stddef.h>
+
+#include "raylib.h"
+
+// Gameplay reports what happened as typed events instead of calling into audio, effects
+// and UI on the spot. Each type has its own contiguous buffer; once per tick
+// DispatchEvents() hands every handler the whole buffer of its type in one call, so each
+// consumer runs one tight loop over plain structs.
+// Events a handler emits while being dispatched are delivered on the next dispatch.
+// A type is added together with the gameplay code that emits it: a struct, an entry
+// in eventSizes[] and an Emit*() helper.
+
+#define EVENT_MAX_HANDLERS 8	// Per type
+
+typedef enum EventType {
+	EVENT_SHOT_FIRED = 0,
+	EVENT_TYPE_COUNT,
+} EventType;
+
+typedef struct ShotFiredEvent {
+	int shooter;	// Entity index
+	Vector2 origin;	// Pixels
+	Vector2 velocity;
+} ShotFiredEvent;
+
+// Gets every pending event of one type, `events` points at an array of that type's struct
+typedef void (*EventHandler)(void *user, const void *events, int count);
+
+typedef struct EventBuffer {
+	unsigned char *data;
+	int count;
+	int capacity;	// Events
+} EventBuffer;
+
+typedef struct EventBus {
+	EventBuffer pending[EVENT_TYPE_COUNT];
+	EventBuffer dispatching[EVENT_TYPE_COUNT];	// Swapped with pending while handlers run
+	EventHandler handlers[EVENT_TYPE_COUNT][EVENT_MAX_HANDLERS];
+	void *handlerUsers[EVENT_TYPE_COUNT][EVENT_MAX_HANDLERS];
+	int handlerCounts[EVENT_TYPE_COUNT];
+	long long dispatched;	// Events delivered since the bus was loaded
+} EventBus;
+
+extern const int eventSizes[EVENT_TYPE_COUNT];
+
+EventBus LoadEventBus(void);
+void UnloadEventBus(EventBus *bus);
+bool AddEventHandler(EventBus *bus, EventType type, EventHandler handler, void *user);	// Handlers run in the order added; false when full
+int DispatchEvents(EventBus *bus);	// Returns how many events were delivered
+
+void *GrowEventBuffer(EventBuffer *buffer, int size);	// Slow path of PushEvent()
+
+// A slot for one more event of the type, valid until the next push of that type; NULL when out of memory
+static inline void *PushEvent(EventBus *bus, EventType type)
+{
+	EventBuffer *buffer = &bus->pending[type];
+	if (buffer->count == buffer->capacity) return GrowEventBuffer(buffer, eventSizes[type]);
+	return buffer->data + (size_t)eventSizes[type]*buffer->count++;
+}
+
+static inline void EmitShotFired(EventBus *bus, ShotFiredEvent event)
+{
+	ShotFiredEvent *slot = PushEvent(bus, EVENT_SHOT_FIRED);
+	if (slot != NULL) *slot = event;
+}
+
+#endif
@@ -0,0 +1,193 @@
+#include "fov.h"
+
+#include <stdlib.h>
+
+// Octant transforms from the row/column the scan walks to map offsets
+static const int octants[8][4] = {
+	{ 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+	{ -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 },
+};
+
+FieldOfView LoadFieldOfView(int width, int height, int radius)
+{
+	FieldOfView fov = { 0 };
+	fov.width = width;
+	fov.height = height;
+	fov.radius = radius;
+	fov.wordsPerRow = (width + 63)/64;
+	fov.visible = calloc((size_t)fov.wordsPerRow*height, sizeof(unsigned long long));
+	fov.explored = calloc((size_t)fov.wordsPerRow*height, sizeof(unsigned long long));
+	fov.originX = -1;
+	fov.originY = -1;
+
+	fov.fog = malloc((size_t)width*height*2);
+	for (int i = 0; i < width*height; i++)
+	{
+		fov.fog[i*2] = 0;
+		fov.fog[i*2 + 1] = FOV_FOG_UNEXPLORED;
+	}
+	fov.fogDirtyTop = height;
+	fov.fogDirtyBottom = -1;
+	return fov;
+}
+
+void UnloadFieldOfView(FieldOfView *fov)
+{
+	free(fov->visible);
+	free(fov->explored);
+	free(fov->fog);
+	*fov = (FieldOfView){ 0 };
+}
+
+static inline void SetTileVisible(FieldOfView *fov, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= fov->width || y >= fov->height) return;
+	unsigned long long bit = 1ull << (x%64);
+	fov->visible[y*fov->wordsPerRow + x/64] |= bit;
+	fov->explored[y*fov->wordsPerRow + x/64] |= bit;
+}
+
+// Scans rows of one octant outwards, between two slopes still in view. A run of walls
+// narrows the view: what lies past it is scanned by a recursive call for the part
+// before the run, and this scan carries on from the far side of the run.
+static void CastOctant(FieldOfView *fov, const Tilemap *map, int cx, int cy, int row, float start, float end, const int *m)
+{
+	if (start < end) return;
+
+	int radius = fov->radius;
+	int reach = radius*radius + radius;	// Rounder edge than radius squared
+	float nextStart = start;
+
+	for (int j = row; j <= radius; j++)
+	{
+		bool blocked = false;
+		int dy = -j;
+
+		for (int dx = -j; dx <= 0; dx++)
+		{
+			float leftSlope = (dx - 0.5f)/(dy + 0.5f), rightSlope = (dx + 0.5f)/(dy - 0.5f);
+			if (start < rightSlope) continue;
+			if (end > leftSlope) break;
+
+			int x = cx + dx*m[0] + dy*m[1], y = cy + dx*m[2] + dy*m[3];
+			if (dx*dx + dy*dy <= reach) SetTileVisible(fov, x, y);
+
+			bool wall = IsTileSolid(map, x, y);
+			if (blocked)
+			{
+				if (wall) nextStart = rightSlope;
+				else
+				{
+					blocked = false;
+					start = nextStart;
+				}
+			}
+			else if (wall && j < radius)
+			{
+				blocked = true;
+				CastOctant(fov, map, cx, cy, j + 1, start, leftSlope, m);
+				nextStart = rightSlope;
+			}
+		}
+
+		if (blocked) break;
+	}
+}
+
+static void ClearVisibleRows(FieldOfView *fov, int x0, int y0, int x1, int y1)
+{
+	int w0 = x0/64, w1 = x1/64;
+	unsigned long long first = ~0ull << (x0%64), last = ~0ull >> (63 - x1%64);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		unsigned long long *row = &fov->visible[y*fov->wordsPerRow];
+		if (w0 == w1) row[w0] &= ~(first & last);
+		else
+		{
+			row[w0] &= ~first;
+			for (int w = w0 + 1; w < w1; w++) row[w] = 0;
+			row[w1] &= ~last;
+		}
+	}
+}
+
+bool UpdateFieldOfView(FieldOfView *fov, const Tilemap *map, int x, int y)
+{
+	if (x == fov->originX && y == fov->originY) return false;
+
+	// Everything the last update could have marked lies within its radius
+	int r = fov->radius;
+	int x0 = x - r, y0 = y - r, x1 = x + r, y1 = y + r;
+	if (fov->originX >= 0)
+	{
+		int ox0 = fov->originX - r, oy0 = fov->originY - r, ox1 = fov->originX + r, oy1 = fov->originY + r;
+		ox0 = (ox0 < 0)? 0 : ox0;
+		oy0 = (oy0 < 0)? 0 : oy0;
+		ox1 = (ox1 >= fov->width)? fov->width - 1 : ox1;
+		oy1 = (oy1 >= fov->height)? fov->height - 1 : oy1;
+		if (ox0 <= ox1 && oy0 <= oy1) ClearVisibleRows(fov, ox0, oy0, ox1, oy1);
+
+		x0 = (ox0 < x0)? ox0 : x0;
+		y0 = (oy0 < y0)? oy0 : y0;
+		x1 = (ox1 > x1)? ox1 : x1;
+		y1 = (oy1 > y1)? oy1 : y1;
+	}
+
+	fov->originX = x;
+	fov->originY = y;
+	SetTileVisible(fov, x, y);
+	for (int i = 0; i < 8; i++) CastOctant(fov, map, x, y, 1, 1.0f, 0.0f, octants[i]);
+
+	// Fog over both squares, the old one fades to explored and the new one clears
+	x0 = (x0 < 0)? 0 : x0;
+	y0 = (y0 < 0)? 0 : y0;
+	x1 = (x1 >= fov->width)? fov->width - 1 : x1;
+	y1 = (y1 >= fov->height)? fov->height - 1 : y1;
+
+	for (int ty = y0; ty <= y1; ty++)
+	{
+		unsigned char *fog = &fov->fog[(ty*fov->width + x0)*2];
+		for (int tx = x0; tx <= x1; tx++, fog += 2)
+		{
+			fog[1] = IsTileVisible(fov, tx, ty)? FOV_FOG_VISIBLE : IsTileExplored(fov, tx, ty)? FOV_FOG_EXPLORED : FOV_FOG_UNEXPLORED;
+		}
+	}
+
+	if (y0 < fov->fogDirtyTop) fov->fogDirtyTop = y0;
+	if (y1 > fov->fogDirtyBottom) fov->fogDirtyBottom = y1;
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Fog
+//----------------------------------------------------------------------------------
+
+Texture2D LoadFogTexture(const FieldOfView *fov)
+{
+	Image image = { fov->fog, fov->width, fov->height, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA };
+	Texture2D texture = LoadTextureFromImage(image);
+	SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+	SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
+	return texture;
+}
+
+// Whole rows are contiguous in the fog buffer, so the changed band goes up in one call
+void UpdateFogTexture(FieldOfView *fov, Texture2D texture)
+{
+	if (fov->fogDirtyTop > fov->fogDirtyBottom) return;
+
+	int rows = fov->fogDirtyBottom - fov->fogDirtyTop + 1;
+	Rectangle band = { 0.0f, (float)fov->fogDirtyTop, (float)fov->width, (float)rows };
+	UpdateTextureRec(texture, band, &fov->fog[fov->fogDirtyTop*fov->width*2]);
+
+	fov->fogDirtyTop = fov->height;
+	fov->fogDirtyBottom = -1;
+}
+
+void DrawFog(Texture2D texture)
+{
+	Rectangle source = { 0.0f, 0.0f, (float)texture.width, (float)texture.height };
+	Rectangle dest = { 0.0f, 0.0f, (float)texture.width*TILE_SIZE, (float)texture.height*TILE_SIZE };
+	DrawTexturePro(texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+}
@@ -0,0 +1,51 @@
+#ifndef FOV_H
+#define FOV_H
+
+#include "raylib.h"
+#include "tilemap.h"
+
+// Field of view over the tile grid by recursive shadowcasting, one pass per octant.
+// Tiles in view and tiles ever seen are kept as bitsets over the whole map, but an
+// update only touches the square around the old and new viewpoints, so its cost
+// depends on the radius and never on the map size.
+// Fog is one pixel per tile, drawn stretched over the map with bilinear filtering.
+
+#define FOV_FOG_UNEXPLORED 255	// Fog alpha per tile state
+#define FOV_FOG_EXPLORED 170
+#define FOV_FOG_VISIBLE 0
+
+typedef struct FieldOfView {
+	int width;
+	int height;
+	int radius;	// In tiles
+	int wordsPerRow;
+	unsigned long long *visible;	// One bit per tile, rows padded to whole words
+	unsigned long long *explored;
+	int originX;	// Of the last update, -1 before the first
+	int originY;
+	unsigned char *fog;	// Grey and alpha per tile, current as of the last update
+	int fogDirtyTop;	// Rows changed since the texture was last updated, empty when top > bottom
+	int fogDirtyBottom;
+} FieldOfView;
+
+FieldOfView LoadFieldOfView(int width, int height, int radius);
+void UnloadFieldOfView(FieldOfView *fov);
+bool UpdateFieldOfView(FieldOfView *fov, const Tilemap *map, int x, int y);	// False when the viewpoint did not move
+
+static inline bool IsTileVisible(const FieldOfView *fov, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= fov->width || y >= fov->height) return false;
+	return (fov->visible[y*fov->wordsPerRow + x/64] >> (x%64)) & 1;
+}
+
+static inline bool IsTileExplored(const FieldOfView *fov, int x, int y)
+{
+	if (x < 0 || y < 0 || x >= fov->width || y >= fov->height) return false;
+	return (fov->explored[y*fov->wordsPerRow + x/64] >> (x%64)) & 1;
+}
+
+Texture2D LoadFogTexture(const FieldOfView *fov);
+void UpdateFogTexture(FieldOfView *fov, Texture2D texture);	// Uploads only the rows changed since the last call
+void DrawFog(Texture2D texture);	// Over the map in world space, one texel per tile
+
+#endif
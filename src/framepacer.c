@@ -0,0 +1,125 @@
+#include "framepacer.h"
+#include "timer.h"
+
+#include <math.h>
+
+#define FRAME_PACER_SAFETY 0.0005	// Seconds kept in hand on top of the work estimate
+#define FRAME_PACER_RESYNC 0.001	// Presents this late move the schedule, a vsynced swap lands here
+#define FRAME_PACER_MIN_MARGIN 0.0002
+#define FRAME_PACER_MAX_MARGIN 0.004
+#define FRAME_PACER_MARGIN_DECAY 0.005
+
+static double GetSystemNow(void *user)
+{
+	(void)user;
+	return GetTimerSeconds();
+}
+
+static void SleepSystem(void *user, double seconds)
+{
+	(void)user;
+	WaitTimerSeconds(seconds);
+}
+
+FrameClock GetSystemFrameClock(void)
+{
+	return (FrameClock){ GetSystemNow, SleepSystem, NULL };
+}
+
+FramePacer LoadFramePacer(FrameClock clock, int fps)
+{
+	FramePacer pacer = { 0 };
+	pacer.clock = clock;
+	pacer.period = 1.0/((fps > 0)? fps : 60);
+	pacer.workEstimate = pacer.period/2.0;	// Cautious until real frames come in
+	for (int i = 0; i < FRAME_PACER_WORK_FRAMES; i++) pacer.works[i] = pacer.workEstimate;
+	pacer.sleepMargin = 0.002;	// A common scheduler wake up
+	return pacer;
+}
+
+void WaitFrameTime(FramePacer *pacer, double time)
+{
+	FrameClock *clock = &pacer->clock;
+	double now = clock->now(clock->user);
+	double sleep = time - now - pacer->sleepMargin;
+
+	if (sleep > 0.0)
+	{
+		clock->sleep(clock->user, sleep);
+		double woke = clock->now(clock->user);
+
+		// Jumps to cover a late wake with room to spare, creeps back while sleeps are punctual
+		double wanted = fmin(fmax((woke - now - sleep)*1.25, FRAME_PACER_MIN_MARGIN), FRAME_PACER_MAX_MARGIN);
+		if (wanted > pacer->sleepMargin) pacer->sleepMargin = wanted;
+		else pacer->sleepMargin += (wanted - pacer->sleepMargin)*FRAME_PACER_MARGIN_DECAY;
+		now = woke;
+	}
+
+	while (now < time) now = clock->now(clock->user);
+}
+
+void BeginPacedFrame(FramePacer *pacer)
+{
+	double now = pacer->clock.now(pacer->clock.user);
+	if (!pacer->started)
+	{
+		pacer->started = true;
+		pacer->deadline = now + pacer->period;
+		pacer->lastPresent = now;
+	}
+
+	double wake = pacer->deadline - pacer->workEstimate - FRAME_PACER_SAFETY;
+	if (wake > now) WaitFrameTime(pacer, wake);
+	pacer->inputTime = pacer->clock.now(pacer->clock.user);
+}
+
+void WaitPresentTime(FramePacer *pacer)
+{
+	pacer->works[pacer->count%FRAME_PACER_WORK_FRAMES] = pacer->clock.now(pacer->clock.user) - pacer->inputTime;
+	pacer->workEstimate = 0.0;
+	for (int i = 0; i < FRAME_PACER_WORK_FRAMES; i++) pacer->workEstimate = fmax(pacer->workEstimate, pacer->works[i]);
+
+	WaitFrameTime(pacer, pacer->deadline);
+}
+
+void EndPacedFrame(FramePacer *pacer)
+{
+	double present = pacer->clock.now(pacer->clock.user);
+
+	// Late frames move the schedule rather than rushing the next ones to catch up. It moves
+	// to a little before this present, so a vsynced swap keeps landing on the same refresh
+	double late = present - pacer->deadline;
+	if (late > pacer->period/2.0) pacer->missed++;
+	if (late > FRAME_PACER_RESYNC) pacer->deadline = present - FRAME_PACER_RESYNC/2.0;
+	pacer->deadline += pacer->period;
+
+	pacer->frameTime = present - pacer->lastPresent;
+	pacer->lastPresent = present;
+	pacer->frameTimes[pacer->count%FRAME_PACER_HISTORY] = pacer->frameTime;
+	pacer->latencies[pacer->count%FRAME_PACER_HISTORY] = present - pacer->inputTime;
+	pacer->count++;
+}
+
+FramePacerStats GetFramePacerStats(const FramePacer *pacer)
+{
+	FramePacerStats stats = { 0 };
+	stats.frames = (pacer->count < FRAME_PACER_HISTORY)? pacer->count : FRAME_PACER_HISTORY;
+	stats.missed = pacer->missed;
+	if (stats.frames == 0) return stats;
+
+	double frameSum = 0.0, latencySum = 0.0;
+	for (int i = 0; i < stats.frames; i++)
+	{
+		frameSum += pacer->frameTimes[i];
+		latencySum += pacer->latencies[i];
+		stats.frameMax = fmax(stats.frameMax, pacer->frameTimes[i]);
+		stats.latencyMax = fmax(stats.latencyMax, pacer->latencies[i]);
+	}
+	stats.frameMean = frameSum/stats.frames;
+	stats.latencyMean = latencySum/stats.frames;
+
+	double variance = 0.0;
+	for (int i = 0; i < stats.frames; i++) variance += (pacer->frameTimes[i] - stats.frameMean)*(pacer->frameTimes[i] - stats.frameMean);
+	stats.frameStdDev = sqrt(variance/stats.frames);
+	return stats;
+}
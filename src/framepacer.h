@@ -0,0 +1,64 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <stdbool.h>
+
+// Frame pacing for when the game drives raylib's frame by hand (SwapScreenBuffer() and
+// PollInputEvents() instead of EndDrawing()). EndDrawing() presents, waits out the rest of
+// the frame and only then polls, so with vsync the input a frame shows is as old as the
+// whole frame. Here the wait comes first: the pacer sleeps until just enough time is left
+// before the next present for the work it measured on recent frames, the game polls and
+// runs, and the pacer holds the present back to its deadline. Waits sleep most of the way
+// and spin the rest, with the spin margin following how late sleeps actually wake.
+// All timing goes through a FrameClock, so it runs against a fake clock as well.
+
+#define FRAME_PACER_HISTORY 240	// Frames the stats cover
+#define FRAME_PACER_WORK_FRAMES 60	// Frames the work estimate covers, a spike is forgotten after these
+
+typedef struct FrameClock {
+	double (*now)(void *user);	// Seconds, monotonic
+	void (*sleep)(void *user, double seconds);	// May wake late, never early
+	void *user;
+} FrameClock;
+
+typedef struct FramePacerStats {
+	int frames;
+	double frameMean;	// Seconds between presents
+	double frameStdDev;
+	double frameMax;
+	double latencyMean;	// From polling input to the present showing it
+	double latencyMax;
+	int missed;	// Presents past their deadline, since the pacer was loaded
+} FramePacerStats;
+
+typedef struct FramePacer {
+	FrameClock clock;
+	double period;
+	double deadline;	// Of the next present
+	double workEstimate;	// Slowest input to ready to present of the recent frames
+	double works[FRAME_PACER_WORK_FRAMES];
+	double sleepMargin;	// Left to spin after a sleep
+	double inputTime;	// Of this frame
+	double lastPresent;
+	double frameTime;	// Between the last two presents, what GetFrameTime() would give
+	bool started;
+	int missed;
+	double frameTimes[FRAME_PACER_HISTORY];
+	double latencies[FRAME_PACER_HISTORY];
+	int count;	// Total frames, the rings hold the last FRAME_PACER_HISTORY
+} FramePacer;
+
+FrameClock GetSystemFrameClock(void);	// GetTimerSeconds() and WaitTimerSeconds()
+
+FramePacer LoadFramePacer(FrameClock clock, int fps);
+void WaitFrameTime(FramePacer *pacer, double time);	// Sleeps, then spins the last sleepMargin
+
+// Per frame: BeginPacedFrame(), poll and read input, update and draw, WaitPresentTime(),
+// swap, EndPacedFrame()
+void BeginPacedFrame(FramePacer *pacer);	// Returns when it is time to read input
+void WaitPresentTime(FramePacer *pacer);
+void EndPacedFrame(FramePacer *pacer);	// Right after the swap returns
+
+FramePacerStats GetFramePacerStats(const FramePacer *pacer);
+
+#endif
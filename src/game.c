@@ -0,0 +1,139 @@
+#include "game.h"
+
+#include <math.h>
+
+#define SWARM_AGENT_SIZE 4	// Pixels
+
+World InitWorld(const char *mapFileName, unsigned int seed)
+{
+	return InitWorldFromTilemap(LoadTilemap(mapFileName), seed);
+}
+
+World InitWorldFromTilemap(Tilemap map, unsigned int seed)
+{
+	World world = { 0 };
+	world.map = map;
+	world.entities = AllocEntities(GAME_MAX_ENTITIES);
+	world.rng = SeedRng(seed);
+	world.facing = (Vector2){ 1, 0 };
+
+	// Drop the player on the first free tile, scanning row by row
+	Vector2 spawn = { 0 };
+	for (int i = 0; i < world.map.width*world.map.height; i++)
+	{
+		if (world.map.tiles[i] == TILE_EMPTY)
+		{
+			spawn.x = (float)(i%world.map.width)*TILE_SIZE + TILE_SIZE/4;
+			spawn.y = (float)(i/world.map.width)*TILE_SIZE + TILE_SIZE/4;
+			break;
+		}
+	}
+	SpawnEntity(&world.entities, ENTITY_PLAYER, spawn, (Vector2){ 0 });
+
+	return world;
+}
+
+void UnloadWorld(World *world)
+{
+	UnloadTilemap(world->map);
+	FreeEntities(&world->entities);
+	UnloadSwarm(&world->swarm);
+}
+
+void UpdateWorld(World *world, PlayerInput input)
+{
+	const float dt = 1.0f/GAME_TICK_RATE;
+	Entities *e = &world->entities;
+
+	float len = sqrtf(input.moveX*input.moveX + input.moveY*input.moveY);
+	if (len > 0.0f)
+	{
+		world->facing = (Vector2){ input.moveX/len, input.moveY/len };
+		// Diagonals should not be faster than straight moves
+		if (len > 1.0f)
+		{
+			input.moveX = world->facing.x;
+			input.moveY = world->facing.y;
+		}
+	}
+
+	e->velX[0] = input.moveX*PLAYER_SPEED;
+	e->velY[0] = input.moveY*PLAYER_SPEED;
+
+	if (world->fireCooldown > 0) world->fireCooldown--;
+	if (input.fire && world->fireCooldown == 0)
+	{
+		Vector2 size = GetEntitySize(ENTITY_PLAYER);
+		Vector2 origin = { e->posX[0] + size.x/2, e->posY[0] + size.y/2 };
+		// A little spread so bursts do not look like a laser
+		float spread = (NextRngFloat(&world->rng) - 0.5f)*0.1f;
+		float c = cosf(spread), s = sinf(spread);
+		Vector2 dir = { world->facing.x*c - world->facing.y*s, world->facing.x*s + world->facing.y*c };
+		Vector2 velocity = { dir.x*BULLET_SPEED, dir.y*BULLET_SPEED };
+		SpawnEntity(e, ENTITY_BULLET, origin, velocity);
+		world->fireCooldown = 6;
+		if (world->events != NULL) EmitShotFired(world->events, (ShotFiredEvent){ 0, origin, velocity });
+	}
+
+	UpdateEntities(e, &world->map, dt);
+
+	// Chases where the player ended up this tick, the flow field only rebuilds on a new tile
+	if (world->swarm.count > 0)
+	{
+		Rectangle player = GetEntityRec(e, 0);
+		SetSwarmTarget(&world->swarm, &world->map, (int)((player.x + player.width/2)/TILE_SIZE), (int)((player.y + player.height/2)/TILE_SIZE));
+		UpdateSwarm(&world->swarm, &world->map, world->jobs, dt);
+	}
+
+	world->frame++;
+}
+
+void DrawWorld(const World *world, Texture2D playerSprite)
+{
+	const Entities *e = &world->entities;
+
+	DrawTilemap(world->map);
+
+	for (int i = 0; i < e->count; i++)
+	{
+		Rectangle rec = GetEntityRec(e, i);
+		switch (e->kind[i])
+		{
+			case ENTITY_PLAYER:
+			{
+				Rectangle frame = { 0, 0, playerSprite.width/4.0f, playerSprite.height/4.0f };
+				DrawTexturePro(playerSprite, frame, rec, (Vector2){ 0 }, 0.0f, WHITE);
+			} break;
+			case ENTITY_BULLET: DrawRectangleRec(rec, YELLOW); break;
+			case ENTITY_ENEMY: DrawRectangleRec(rec, RED); break;
+			default: break;
+		}
+	}
+
+	const Swarm *swarm = &world->swarm;
+	for (int i = 0; i < swarm->count; i++)
+	{
+		DrawRectangle((int)swarm->posX[i] - SWARM_AGENT_SIZE/2, (int)swarm->posY[i] - SWARM_AGENT_SIZE/2, SWARM_AGENT_SIZE, SWARM_AGENT_SIZE, MAROON);
+	}
+}
+
+SwarmParams GetWorldSwarmParams(void)
+{
+	SwarmParams params = GetDefaultSwarmParams();
+	params.deterministic = true;
+	return params;
+}
+
+void LoadWorldSwarm(World *world, int count, unsigned int seed)
+{
+	UnloadSwarm(&world->swarm);
+	world->swarm = LoadSwarm(&world->map, count, GetWorldSwarmParams());
+
+	// A few tries per agent, a map with hardly any open tiles gets fewer
+	Rng rng = SeedRng(seed);
+	for (int tries = 0; world->swarm.count < count && tries < count*64; tries++)
+	{
+		int x = (int)(NextRng(&rng)%(unsigned int)world->map.width), y = (int)(NextRng(&rng)%(unsigned int)world->map.height);
+		if (!IsTileSolid(&world->map, x, y)) AddSwarmAgent(&world->swarm, (Vector2){ (x + 0.5f)*TILE_SIZE, (y + 0.5f)*TILE_SIZE }, (Vector2){ 0.0f, 0.0f });
+	}
+}
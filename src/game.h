@@ -0,0 +1,47 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include "raylib.h"
+#include "tilemap.h"
+#include "entities.h"
+#include "rng.h"
+#include "events.h"
+#include "swarm.h"
+
+#define GAME_TICK_RATE 60
+#define GAME_MAX_ENTITIES 65536
+
+#define PLAYER_SPEED 240.0f
+#define BULLET_SPEED 720.0f
+
+typedef struct PlayerInput {
+	float moveX;
+	float moveY;
+	bool fire;
+} PlayerInput;
+
+// Everything the simulation needs to reproduce a frame.
+// Entity 0 is always the player.
+typedef struct World {
+	Tilemap map;
+	Entities entities;
+	Rng rng;
+	unsigned int frame;
+	Vector2 facing;
+	int fireCooldown;
+	Swarm swarm;	// Flock chasing the player, stepped with every tick; empty unless LoadWorldSwarm() was called
+	EventBus *events;	// Output for audio/effects, not part of the simulated state; NULL emits nothing
+	JobSystem *jobs;	// Workers for the swarm, not part of the simulated state either; NULL steps it on the caller
+} World;
+
+World InitWorld(const char *mapFileName, unsigned int seed);
+World InitWorldFromTilemap(Tilemap map, unsigned int seed);	// Takes ownership of the map
+void UnloadWorld(World *world);
+void UpdateWorld(World *world, PlayerInput input);	// Advances exactly one fixed tick
+void DrawWorld(const World *world, Texture2D playerSprite);
+
+// The swarm steps in deterministic mode, so replays and snapshots play back the same on any CPU
+SwarmParams GetWorldSwarmParams(void);
+void LoadWorldSwarm(World *world, int count, unsigned int seed);	// Scatters `count` agents over open tiles
+
+#endif
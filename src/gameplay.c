@@ -0,0 +1,52 @@
+#include "gameplay.h"
+
+static GameState *InitGameplay(Arena *arena, const GameHost *host, Tilemap map)
+{
+	GameState *state = PushArena(arena, sizeof(GameState));
+	if (state == NULL)
+	{
+		TraceLog(LOG_WARNING, "GAMEPLAY: Arena too small for the game state");
+		UnloadTilemap(map);
+		return NULL;
+	}
+
+	state->layout = GetGameStateLayout();
+	state->world = InitWorldFromTilemap(map, host->seed);
+	return state;
+}
+
+static void ReloadGameplay(GameState *state, const GameHost *host)
+{
+	(void)host;
+	TraceLog(LOG_INFO, "GAMEPLAY: Module reloaded at frame %u, %i entities", state->world.frame, state->world.entities.count);
+}
+
+static void UpdateGameplay(GameState *state, PlayerInput input)
+{
+	UpdateWorld(&state->world, input);
+}
+
+static void DrawGameplay(const GameState *state, const GameHost *host)
+{
+	DrawWorld(&state->world, host->playerSprite);
+}
+
+static void UnloadGameplay(GameState *state)
+{
+	UnloadWorld(&state->world);
+}
+
+const GameplayApi *GetGameplayApi(void)
+{
+	static GameplayApi api = {
+		GAMEPLAY_API_VERSION,
+		0,
+		InitGameplay,
+		ReloadGameplay,
+		UpdateGameplay,
+		DrawGameplay,
+		UnloadGameplay,
+	};
+	api.layout = GetGameStateLayout();	// Not a constant expression
+	return &api;
+}
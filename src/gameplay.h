@@ -0,0 +1,67 @@
+#ifndef GAMEPLAY_H
+#define GAMEPLAY_H
+
+#include <stddef.h>
+
+#include "game.h"
+#include "arena.h"
+
+// The gameplay side of the game behind a table of entry points. With GAME_HOT_RELOAD
+// it is built as a shared library the host reloads whenever it is rebuilt; otherwise
+// the host calls GetGameplayApi() directly.
+
+#define GAMEPLAY_API_VERSION 2
+#define GAMEPLAY_LAYOUT_VERSION 1	// Bump for changes sizes and offsets do not show, like two fields of one type swapped
+#define GAMEPLAY_ARENA_SIZE (1 << 20)
+
+// Loaded once by the host and kept resident across reloads
+typedef struct GameHost {
+	Texture2D playerSprite;
+	unsigned int seed;
+} GameHost;
+
+// First allocation in the host's arena. Only this struct is in the arena: the world's
+// tiles, entities and swarm are malloc'd by host and module code alike. They survive a
+// reload because hot reload is POSIX only, where the module shares the host's libc heap.
+// Nothing in the state may point into the module's own code or static data, which go
+// away with it. The host reads the world for saves, replays and audio; only the module
+// changes it.
+typedef struct GameState {
+	unsigned int layout;	// GetGameStateLayout() in the module that created it
+	World world;
+} GameState;
+
+// Hash of the state's layout as this binary was compiled. The host and a module built
+// from different headers disagree on it, even where the sizes happen to match.
+static inline unsigned int GetGameStateLayout(void)
+{
+	const size_t layout[] = {
+		GAMEPLAY_LAYOUT_VERSION,
+		sizeof(GameState), offsetof(GameState, world),
+		sizeof(World), offsetof(World, map), offsetof(World, entities), offsetof(World, rng), offsetof(World, frame),
+		offsetof(World, facing), offsetof(World, fireCooldown), offsetof(World, swarm), offsetof(World, events), offsetof(World, jobs),
+		sizeof(Entities), offsetof(Entities, count), offsetof(Entities, capacity), offsetof(Entities, posX), offsetof(Entities, posY),
+		offsetof(Entities, velX), offsetof(Entities, velY), offsetof(Entities, kind), offsetof(Entities, health),
+		sizeof(Tilemap), offsetof(Tilemap, width), offsetof(Tilemap, height), offsetof(Tilemap, tiles),
+		offsetof(Tilemap, paletteCount), offsetof(Tilemap, palette),
+		sizeof(Rng), sizeof(Swarm),
+	};
+	unsigned int hash = 2166136261u;	// FNV-1a over the values
+	for (size_t i = 0; i < sizeof(layout)/sizeof(layout[0]); i++) hash = (hash ^ (unsigned int)layout[i])*16777619u;
+	return hash;
+}
+
+typedef struct GameplayApi {
+	int version;
+	unsigned int layout;	// GetGameStateLayout(), a module with a different layout cannot take over existing state
+	GameState *(*init)(Arena *arena, const GameHost *host, Tilemap map);	// Takes ownership of the map
+	void (*reload)(GameState *state, const GameHost *host);	// Called on a freshly swapped in module
+	void (*update)(GameState *state, PlayerInput input);
+	void (*draw)(const GameState *state, const GameHost *host);
+	void (*unload)(GameState *state);
+} GameplayApi;
+
+typedef const GameplayApi *(*GetGameplayApiFunc)(void);
+const GameplayApi *GetGameplayApi(void);
+
+#endif
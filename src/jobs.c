@@ -0,0 +1,179 @@
+#include "jobs.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#if !defined(_WIN32)
+	#include <unistd.h>
+#endif
+
+struct JobSystem {
+	pthread_t threads[JOBS_MAX_THREADS];
+	int threadCount;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t wake;
+	pthread_cond_t done;
+	unsigned int generation;	// Bumped for every batch, workers sleep until it changes
+	int busy;	// Workers that joined the current batch and have not left it yet
+	bool quit;
+
+	JobFunc func;
+	void *user;
+	int count;
+	atomic_int next;
+	atomic_int remaining;
+};
+
+int GetCpuCount(void)
+{
+#if defined(_WIN32)
+	return pthread_num_processors_np();
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0)? (int)count : 1;
+#endif
+}
+
+static void FinishJobs(JobSystem *jobs, int finished)
+{
+	if (finished > 0 && atomic_fetch_sub_explicit(&jobs->remaining, finished, memory_order_acq_rel) == finished)
+	{
+		pthread_mutex_lock(&jobs->mutex);
+		pthread_cond_broadcast(&jobs->done);
+		pthread_mutex_unlock(&jobs->mutex);
+	}
+}
+
+// Returns after the batch has no unclaimed items left
+static void DrainJobs(JobSystem *jobs)
+{
+	int finished = 0;
+
+	while (true)
+	{
+		int i = atomic_fetch_add_explicit(&jobs->next, 1, memory_order_relaxed);
+		if (i >= jobs->count) break;
+		jobs->func(jobs->user, i);
+		finished++;
+	}
+
+	FinishJobs(jobs, finished);
+}
+
+static void *WorkerMain(void *arg)
+{
+	JobSystem *jobs = arg;
+	unsigned int seen = 0;
+
+	pthread_mutex_lock(&jobs->mutex);
+	while (true)
+	{
+		while (jobs->generation == seen && !jobs->quit) pthread_cond_wait(&jobs->wake, &jobs->mutex);
+		if (jobs->quit) break;
+
+		seen = jobs->generation;
+		jobs->busy++;
+		pthread_mutex_unlock(&jobs->mutex);
+
+		DrainJobs(jobs);
+
+		pthread_mutex_lock(&jobs->mutex);
+		if (--jobs->busy == 0) pthread_cond_broadcast(&jobs->done);
+	}
+	pthread_mutex_unlock(&jobs->mutex);
+
+	return NULL;
+}
+
+JobSystem *CreateJobSystem(int threadCount)
+{
+	JobSystem *jobs = calloc(1, sizeof(JobSystem));
+	if (jobs == NULL) return NULL;
+
+	if (threadCount <= 0) threadCount = GetCpuCount() - 1;
+	if (threadCount > JOBS_MAX_THREADS) threadCount = JOBS_MAX_THREADS;
+
+	pthread_mutex_init(&jobs->mutex, NULL);
+	pthread_cond_init(&jobs->wake, NULL);
+	pthread_cond_init(&jobs->done, NULL);
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		if (pthread_create(&jobs->threads[jobs->threadCount], NULL, WorkerMain, jobs) != 0) break;
+		jobs->threadCount++;
+	}
+
+	return jobs;
+}
+
+void DestroyJobSystem(JobSystem *jobs)
+{
+	if (jobs == NULL) return;
+
+	WaitJobs(jobs);
+
+	pthread_mutex_lock(&jobs->mutex);
+	jobs->quit = true;
+	pthread_cond_broadcast(&jobs->wake);
+	pthread_mutex_unlock(&jobs->mutex);
+
+	for (int i = 0; i < jobs->threadCount; i++) pthread_join(jobs->threads[i], NULL);
+
+	pthread_cond_destroy(&jobs->done);
+	pthread_cond_destroy(&jobs->wake);
+	pthread_mutex_destroy(&jobs->mutex);
+	free(jobs);
+}
+
+int GetJobThreadCount(const JobSystem *jobs)
+{
+	return jobs->threadCount + 1;
+}
+
+void RunJobsAsync(JobSystem *jobs, JobFunc func, void *user, int count)
+{
+	WaitJobs(jobs);
+	if (count <= 0) return;
+
+	pthread_mutex_lock(&jobs->mutex);
+	// A worker may have joined the finished batch late; it must leave before the fields change
+	while (jobs->busy > 0) pthread_cond_wait(&jobs->done, &jobs->mutex);
+	jobs->func = func;
+	jobs->user = user;
+	jobs->count = count;
+	atomic_store(&jobs->next, 0);
+	atomic_store(&jobs->remaining, count);
+	jobs->generation++;
+	pthread_cond_broadcast(&jobs->wake);
+	pthread_mutex_unlock(&jobs->mutex);
+}
+
+void WaitJobs(JobSystem *jobs)
+{
+	DrainJobs(jobs);
+
+	pthread_mutex_lock(&jobs->mutex);
+	while (atomic_load(&jobs->remaining) > 0 || jobs->busy > 0) pthread_cond_wait(&jobs->done, &jobs->mutex);
+	pthread_mutex_unlock(&jobs->mutex);
+}
+
+bool HelpJobs(JobSystem *jobs)
+{
+	// Cheap check first so polling an idle batch does not keep bumping the counter
+	if (atomic_load_explicit(&jobs->next, memory_order_relaxed) >= jobs->count) return false;
+
+	int i = atomic_fetch_add_explicit(&jobs->next, 1, memory_order_relaxed);
+	if (i >= jobs->count) return false;
+
+	jobs->func(jobs->user, i);
+	FinishJobs(jobs, 1);
+	return true;
+}
+
+void RunJobs(JobSystem *jobs, JobFunc func, void *user, int count)
+{
+	RunJobsAsync(jobs, func, user, count);
+	WaitJobs(jobs);
+}
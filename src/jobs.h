@@ -0,0 +1,26 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+#define JOBS_MAX_THREADS 64
+
+typedef void (*JobFunc)(void *user, int index);
+
+typedef struct JobSystem JobSystem;
+
+// threadCount <= 0 uses one worker per CPU besides the calling thread
+JobSystem *CreateJobSystem(int threadCount);
+void DestroyJobSystem(JobSystem *jobs);
+int GetJobThreadCount(const JobSystem *jobs);	// Workers plus the calling thread
+
+// Parallel for: calls func(user, i) for every i in [0, count).
+// One batch is in flight at a time and batches must be issued from a single thread.
+void RunJobs(JobSystem *jobs, JobFunc func, void *user, int count);	// Caller helps, returns when done
+void RunJobsAsync(JobSystem *jobs, JobFunc func, void *user, int count);	// Returns immediately
+void WaitJobs(JobSystem *jobs);	// Caller helps with the remaining items
+bool HelpJobs(JobSystem *jobs);	// Runs one pending item on the caller, false if none were left
+
+int GetCpuCount(void);
+
+#endif
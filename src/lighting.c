@@ -0,0 +1,425 @@
+#include "lighting.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "rlgl.h"
+
+#define LIGHT_CELL_PIXELS (LIGHT_CELL_TILES*TILE_SIZE)
+#define LIGHT_SWEEP_NUDGE 1e-4f	// Turn of the ray, in radians, when breaking ties at an event
+
+//----------------------------------------------------------------------------------
+// Edges
+//----------------------------------------------------------------------------------
+
+static void PushLightEdge(Lighting *lighting, int *capacity, float ax, float ay, float bx, float by)
+{
+	if (lighting->edgeCount == *capacity)
+	{
+		*capacity = *capacity? *capacity*2 : 1024;
+		lighting->edges = realloc(lighting->edges, (size_t)*capacity*sizeof(LightEdge));
+	}
+	lighting->edges[lighting->edgeCount++] = (LightEdge){ { ax, ay }, { bx, by } };
+}
+
+static inline void GetEdgeCells(const Lighting *lighting, LightEdge e, int *x0, int *y0, int *x1, int *y1)
+{
+	*x0 = (int)(fminf(e.a.x, e.b.x)/LIGHT_CELL_PIXELS);
+	*y0 = (int)(fminf(e.a.y, e.b.y)/LIGHT_CELL_PIXELS);
+	*x1 = (int)(fmaxf(e.a.x, e.b.x)/LIGHT_CELL_PIXELS);
+	*y1 = (int)(fmaxf(e.a.y, e.b.y)/LIGHT_CELL_PIXELS);
+	if (*x1 >= lighting->cellsX) *x1 = lighting->cellsX - 1;
+	if (*y1 >= lighting->cellsY) *y1 = lighting->cellsY - 1;
+	if (*x0 > *x1) *x0 = *x1;
+	if (*y0 > *y1) *y0 = *y1;
+}
+
+// Faces between a solid and an empty tile, runs along a row or column merged into one edge.
+// A run also ends where the wall swaps sides, so edges only ever meet at their ends.
+// The map border counts as wall, as in IsTileSolid().
+static void ExtractLightEdges(Lighting *lighting, const Tilemap *map)
+{
+	int capacity = 0;
+	free(lighting->edges);
+	lighting->edges = NULL;
+	lighting->edgeCount = 0;
+
+	for (int y = 0; y <= map->height; y++)
+	{
+		int start = -1, run = 0;
+		for (int x = 0; x <= map->width; x++)
+		{
+			// 1 with the wall above, -1 below, 0 for no face
+			int face = (x < map->width)? IsTileSolid(map, x, y - 1) - IsTileSolid(map, x, y) : 0;
+			if (face == run) continue;
+			if (run != 0) PushLightEdge(lighting, &capacity, (float)start*TILE_SIZE, (float)y*TILE_SIZE, (float)x*TILE_SIZE, (float)y*TILE_SIZE);
+			start = x;
+			run = face;
+		}
+	}
+
+	for (int x = 0; x <= map->width; x++)
+	{
+		int start = -1, run = 0;
+		for (int y = 0; y <= map->height; y++)
+		{
+			int face = (y < map->height)? IsTileSolid(map, x - 1, y) - IsTileSolid(map, x, y) : 0;
+			if (face == run) continue;
+			if (run != 0) PushLightEdge(lighting, &capacity, (float)x*TILE_SIZE, (float)start*TILE_SIZE, (float)x*TILE_SIZE, (float)y*TILE_SIZE);
+			start = y;
+			run = face;
+		}
+	}
+
+	// Bucket into cells, counted first so each cell's edges end up contiguous
+	int cellCount = lighting->cellsX*lighting->cellsY;
+	lighting->cellStarts = realloc(lighting->cellStarts, (size_t)(cellCount + 1)*sizeof(int));
+	memset(lighting->cellStarts, 0, (size_t)(cellCount + 1)*sizeof(int));
+
+	for (int i = 0; i < lighting->edgeCount; i++)
+	{
+		int x0, y0, x1, y1;
+		GetEdgeCells(lighting, lighting->edges[i], &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++) lighting->cellStarts[y*lighting->cellsX + x + 1]++;
+		}
+	}
+	for (int i = 0; i < cellCount; i++) lighting->cellStarts[i + 1] += lighting->cellStarts[i];
+
+	int *fill = malloc((size_t)cellCount*sizeof(int));
+	memcpy(fill, lighting->cellStarts, (size_t)cellCount*sizeof(int));
+	lighting->cellEdges = realloc(lighting->cellEdges, (size_t)(lighting->cellStarts[cellCount] + 1)*sizeof(int));
+
+	for (int i = 0; i < lighting->edgeCount; i++)
+	{
+		int x0, y0, x1, y1;
+		GetEdgeCells(lighting, lighting->edges[i], &x0, &y0, &x1, &y1);
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++) lighting->cellEdges[fill[y*lighting->cellsX + x]++] = i;
+		}
+	}
+	free(fill);
+
+	lighting->edgeStamps = realloc(lighting->edgeStamps, (size_t)(lighting->edgeCount + 1)*sizeof(unsigned int));
+	memset(lighting->edgeStamps, 0, (size_t)(lighting->edgeCount + 1)*sizeof(unsigned int));
+	lighting->stamp = 0;
+}
+
+Lighting LoadLighting(const Tilemap *map)
+{
+	Lighting lighting = { 0 };
+	lighting.cellsX = (map->width + LIGHT_CELL_TILES - 1)/LIGHT_CELL_TILES;
+	lighting.cellsY = (map->height + LIGHT_CELL_TILES - 1)/LIGHT_CELL_TILES;
+	if (lighting.cellsX < 1) lighting.cellsX = 1;
+	if (lighting.cellsY < 1) lighting.cellsY = 1;
+	ExtractLightEdges(&lighting, map);
+	return lighting;
+}
+
+void UnloadLighting(Lighting *lighting)
+{
+	for (int i = 0; i < lighting->lightCount; i++) free(lighting->lights[i].polygon);
+	free(lighting->lights);
+	free(lighting->edges);
+	free(lighting->cellStarts);
+	free(lighting->cellEdges);
+	free(lighting->edgeStamps);
+	free(lighting->segments);
+	free(lighting->events);
+	free(lighting->active);
+	*lighting = (Lighting){ 0 };
+}
+
+void UpdateLightingTiles(Lighting *lighting, const Tilemap *map, Rectangle tiles)
+{
+	ExtractLightEdges(lighting, map);
+
+	// Faces on the border of the changed tiles move too
+	Rectangle changed = { (tiles.x - 1)*TILE_SIZE, (tiles.y - 1)*TILE_SIZE, (tiles.width + 2)*TILE_SIZE, (tiles.height + 2)*TILE_SIZE };
+	for (int i = 0; i < lighting->lightCount; i++)
+	{
+		Light *light = &lighting->lights[i];
+		Rectangle reach = { light->position.x - light->radius, light->position.y - light->radius, 2*light->radius, 2*light->radius };
+		if (CheckCollisionRecs(reach, changed)) light->dirty = true;
+	}
+}
+
+//----------------------------------------------------------------------------------
+// Lights
+//----------------------------------------------------------------------------------
+
+int AddLight(Lighting *lighting, Vector2 position, float radius, Color color)
+{
+	if (lighting->lightCount == lighting->lightCapacity)
+	{
+		lighting->lightCapacity = lighting->lightCapacity? lighting->lightCapacity*2 : 16;
+		lighting->lights = realloc(lighting->lights, (size_t)lighting->lightCapacity*sizeof(Light));
+	}
+
+	lighting->lights[lighting->lightCount] = (Light){ .position = position, .radius = radius, .color = color, .dirty = true };
+	return lighting->lightCount++;
+}
+
+void SetLightPosition(Lighting *lighting, int light, Vector2 position)
+{
+	Light *l = &lighting->lights[light];
+	if (l->position.x == position.x && l->position.y == position.y) return;
+	l->position = position;
+	l->dirty = true;
+}
+
+// Monotonic in atan2(d.y, d.x) over [0, 4), without the trigonometry
+static inline float GetPseudoAngle(Vector2 d)
+{
+	float p = d.y/(fabsf(d.x) + fabsf(d.y));
+	if (d.x < 0.0f) return 2.0f - p;
+	return (p < 0.0f)? p + 4.0f : p;
+}
+
+static inline float Cross2(Vector2 a, Vector2 b)
+{
+	return a.x*b.y - a.y*b.x;
+}
+
+// Insertion sort, a light only sees a few dozen edges
+static void SortLightEvents(LightEvent *events, int count)
+{
+	for (int i = 1; i < count; i++)
+	{
+		LightEvent e = events[i];
+		int j = i;
+		for (; j > 0 && events[j - 1].angle > e.angle; j--) events[j] = events[j - 1];
+		events[j] = e;
+	}
+}
+
+static inline float GetSegmentTime(LightEdge s, Vector2 origin, Vector2 dir)
+{
+	Vector2 e = { s.b.x - s.a.x, s.b.y - s.a.y };
+	float den = Cross2(dir, e);
+	if (den == 0.0f) return INFINITY;
+	return Cross2((Vector2){ s.a.x - origin.x, s.a.y - origin.y }, e)/den;
+}
+
+// Closest active segment along origin + dir*t
+static int FindNearestSegment(const Lighting *lighting, int activeCount, Vector2 origin, Vector2 dir)
+{
+	int nearest = -1;
+	float best = INFINITY;
+
+	for (int i = 0; i < activeCount; i++)
+	{
+		float t = GetSegmentTime(lighting->segments[lighting->active[i]], origin, dir);
+		if (t < best)
+		{
+			best = t;
+			nearest = lighting->active[i];
+		}
+	}
+	return nearest;
+}
+
+static void ReserveLightSegments(Lighting *lighting, int count)
+{
+	if (count <= lighting->segmentCapacity) return;
+	lighting->segmentCapacity = (lighting->segmentCapacity*2 > count)? lighting->segmentCapacity*2 : count;
+	lighting->segments = realloc(lighting->segments, (size_t)lighting->segmentCapacity*sizeof(LightEdge));
+	lighting->events = realloc(lighting->events, (size_t)lighting->segmentCapacity*2*sizeof(LightEvent));
+	lighting->active = realloc(lighting->active, (size_t)lighting->segmentCapacity*sizeof(int));
+}
+
+// Edges within reach of the light, and its bounding square so every ray ends somewhere
+static int GatherLightSegments(Lighting *lighting, const Light *light)
+{
+	Vector2 p = light->position;
+	float r = light->radius;
+	float left = p.x - r, top = p.y - r, right = p.x + r, bottom = p.y + r;
+	unsigned int stamp = ++lighting->stamp;
+	int count = 0;
+
+	int cx0 = (int)fmaxf(left/LIGHT_CELL_PIXELS, 0.0f), cy0 = (int)fmaxf(top/LIGHT_CELL_PIXELS, 0.0f);
+	int cx1 = (int)fminf(right/LIGHT_CELL_PIXELS, (float)lighting->cellsX - 1);
+	int cy1 = (int)fminf(bottom/LIGHT_CELL_PIXELS, (float)lighting->cellsY - 1);
+
+	for (int cy = cy0; cy <= cy1; cy++)
+	{
+		for (int cx = cx0; cx <= cx1; cx++)
+		{
+			int cell = cy*lighting->cellsX + cx;
+			for (int i = lighting->cellStarts[cell]; i < lighting->cellStarts[cell + 1]; i++)
+			{
+				int edge = lighting->cellEdges[i];
+				if (lighting->edgeStamps[edge] == stamp) continue;
+				lighting->edgeStamps[edge] = stamp;
+
+				// Edges are axis aligned, so clipping them to the square is a clamp. The sweep
+				// then never has to find where an edge crosses the square.
+				LightEdge e = lighting->edges[edge];
+				if (fmaxf(e.a.x, e.b.x) < left || fminf(e.a.x, e.b.x) > right || fmaxf(e.a.y, e.b.y) < top || fminf(e.a.y, e.b.y) > bottom) continue;
+				e.a = (Vector2){ fminf(fmaxf(e.a.x, left), right), fminf(fmaxf(e.a.y, top), bottom) };
+				e.b = (Vector2){ fminf(fmaxf(e.b.x, left), right), fminf(fmaxf(e.b.y, top), bottom) };
+				ReserveLightSegments(lighting, count + 1);
+				lighting->segments[count++] = e;
+			}
+		}
+	}
+
+	ReserveLightSegments(lighting, count + 4);
+	lighting->segments[count++] = (LightEdge){ { left, top }, { right, top } };
+	lighting->segments[count++] = (LightEdge){ { right, top }, { right, bottom } };
+	lighting->segments[count++] = (LightEdge){ { right, bottom }, { left, bottom } };
+	lighting->segments[count++] = (LightEdge){ { left, bottom }, { left, top } };
+	return count;
+}
+
+static void PushLightVertex(Light *light, Vector2 v)
+{
+	if (light->vertexCount == light->vertexCapacity)
+	{
+		light->vertexCapacity = light->vertexCapacity? light->vertexCapacity*2 : 64;
+		light->polygon = realloc(light->polygon, (size_t)light->vertexCapacity*sizeof(Vector2));
+	}
+	light->polygon[light->vertexCount++] = v;
+}
+
+// Sweeps a ray once around the light through the segment endpoints in angle order.
+// Between two endpoints the nearest segment cannot change, so the polygon only needs
+// a vertex where it does: on the old nearest segment and, if further or closer, the new one.
+static void ComputeLightPolygon(Lighting *lighting, Light *light)
+{
+	Vector2 p = light->position;
+	int segmentCount = GatherLightSegments(lighting, light);
+	int eventCount = 0, activeCount = 0;
+
+	for (int i = 0; i < segmentCount; i++)
+	{
+		LightEdge s = lighting->segments[i];
+		Vector2 a = { s.a.x - p.x, s.a.y - p.y }, b = { s.b.x - p.x, s.b.y - p.y };
+		float cross = Cross2(a, b);
+		if (cross == 0.0f) continue;	// Edge-on, hidden behind the faces meeting it
+
+		Vector2 first = (cross > 0.0f)? s.a : s.b, last = (cross > 0.0f)? s.b : s.a;
+		float begin = GetPseudoAngle((cross > 0.0f)? a : b), end = GetPseudoAngle((cross > 0.0f)? b : a);
+		if (begin == end) continue;
+
+		lighting->events[eventCount++] = (LightEvent){ begin, first, i, true };
+		lighting->events[eventCount++] = (LightEvent){ end, last, i, false };
+		if (begin > end) lighting->active[activeCount++] = i;	// Spans angle 0 where the sweep starts
+	}
+
+	SortLightEvents(lighting->events, eventCount);
+	light->vertexCount = 0;
+
+	for (int i = 0; i < eventCount;)
+	{
+		// Segments meeting at the event point tie along the ray itself, so the nearest is
+		// judged just before and just after it
+		float angle = lighting->events[i].angle;
+		Vector2 dir = { lighting->events[i].point.x - p.x, lighting->events[i].point.y - p.y };
+		Vector2 nudge = { -dir.y*LIGHT_SWEEP_NUDGE, dir.x*LIGHT_SWEEP_NUDGE };
+		int previous = FindNearestSegment(lighting, activeCount, p, (Vector2){ dir.x - nudge.x, dir.y - nudge.y });
+
+		for (; i < eventCount && lighting->events[i].angle == angle; i++)
+		{
+			const LightEvent *e = &lighting->events[i];
+			if (e->begin) lighting->active[activeCount++] = e->segment;
+			else
+			{
+				for (int j = 0; j < activeCount; j++)
+				{
+					if (lighting->active[j] != e->segment) continue;
+					lighting->active[j] = lighting->active[--activeCount];
+					break;
+				}
+			}
+		}
+
+		int next = FindNearestSegment(lighting, activeCount, p, (Vector2){ dir.x + nudge.x, dir.y + nudge.y });
+		if (previous == next || previous < 0 || next < 0) continue;
+
+		float before = GetSegmentTime(lighting->segments[previous], p, dir);
+		float after = GetSegmentTime(lighting->segments[next], p, dir);
+		if (isinf(before) || isinf(after)) continue;
+		PushLightVertex(light, (Vector2){ p.x + dir.x*before, p.y + dir.y*before });
+		if (fabsf(after - before) > 1e-5f) PushLightVertex(light, (Vector2){ p.x + dir.x*after, p.y + dir.y*after });
+	}
+}
+
+int UpdateLights(Lighting *lighting)
+{
+	int updated = 0;
+	for (int i = 0; i < lighting->lightCount; i++)
+	{
+		Light *light = &lighting->lights[i];
+		if (!light->dirty) continue;
+		ComputeLightPolygon(lighting, light);
+		light->dirty = false;
+		updated++;
+	}
+	return updated;
+}
+
+//----------------------------------------------------------------------------------
+// Drawing
+//----------------------------------------------------------------------------------
+
+Texture2D LoadLightFalloff(int size)
+{
+	Image image = GenImageGradientRadial(size, size, 0.0f, WHITE, (Color){ 255, 255, 255, 0 });
+	Texture2D texture = LoadTextureFromImage(image);
+	SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+	UnloadImage(image);
+	return texture;
+}
+
+void DrawLightMask(const Lighting *lighting, RenderTexture2D mask, Texture2D falloff, Color ambient, Camera2D camera)
+{
+	BeginTextureMode(mask);
+	ClearBackground(ambient);
+	BeginMode2D(camera);
+	BeginBlendMode(BLEND_ADDITIVE);
+
+	// Polygon vertices run clockwise on screen, so each fan triangle is emitted reversed
+	for (int i = 0; i < lighting->lightCount; i++)
+	{
+		const Light *light = &lighting->lights[i];
+		if (light->vertexCount < 3) continue;
+
+		Vector2 p = light->position;
+		float scale = 0.5f/light->radius;
+		rlCheckRenderBatchLimit(3*light->vertexCount);
+		rlSetTexture(falloff.id);
+		rlBegin(RL_TRIANGLES);
+		rlColor4ub(light->color.r, light->color.g, light->color.b, light->color.a);
+
+		for (int v = 0; v < light->vertexCount; v++)
+		{
+			Vector2 a = light->polygon[(v + 1)%light->vertexCount], b = light->polygon[v];
+			rlTexCoord2f(0.5f, 0.5f);
+			rlVertex2f(p.x, p.y);
+			rlTexCoord2f(0.5f + (a.x - p.x)*scale, 0.5f + (a.y - p.y)*scale);
+			rlVertex2f(a.x, a.y);
+			rlTexCoord2f(0.5f + (b.x - p.x)*scale, 0.5f + (b.y - p.y)*scale);
+			rlVertex2f(b.x, b.y);
+		}
+
+		rlEnd();
+		rlSetTexture(0);
+	}
+
+	EndBlendMode();
+	EndMode2D();
+	EndTextureMode();
+}
+
+void DrawLightMaskOver(RenderTexture2D mask)
+{
+	// Render textures come out upside down
+	Rectangle source = { 0.0f, 0.0f, (float)mask.texture.width, -(float)mask.texture.height };
+	BeginBlendMode(BLEND_MULTIPLIED);
+	DrawTextureRec(mask.texture, source, (Vector2){ 0.0f, 0.0f }, WHITE);
+	EndBlendMode();
+}
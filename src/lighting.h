@@ -0,0 +1,73 @@
+#ifndef LIGHTING_H
+#define LIGHTING_H
+
+#include "raylib.h"
+#include "tilemap.h"
+
+// Point lights blocked by the tile grid. Wall faces are merged into long edges once
+// per map; each light keeps its visibility polygon, found by sweeping the edges around
+// it in angle order, until it moves or the tiles near it change.
+// Drawing takes two passes however many lights there are: every polygon goes into one
+// batch on the light mask, then the mask is multiplied over the scene.
+
+#define LIGHT_CELL_TILES 8	// Edges are bucketed in cells of this many tiles a side
+
+typedef struct LightEdge {
+	Vector2 a;
+	Vector2 b;
+} LightEdge;
+
+typedef struct Light {
+	Vector2 position;
+	float radius;	// Reach in pixels, the polygon is clipped to the square around it
+	Color color;
+	Vector2 *polygon;	// Fan around position in increasing angle
+	int vertexCount;
+	int vertexCapacity;
+	bool dirty;
+} Light;
+
+// An edge entering or leaving the sweep, at the angle of one of its endpoints
+typedef struct LightEvent {
+	float angle;	// Pseudo-angle, ordered like atan2 but cheaper
+	Vector2 point;
+	int segment;
+	bool begin;
+} LightEvent;
+
+typedef struct Lighting {
+	LightEdge *edges;
+	int edgeCount;
+	int cellsX;
+	int cellsY;
+	int *cellStarts;	// Edge indices per cell, cellStarts[i]..cellStarts[i + 1] in cellEdges
+	int *cellEdges;
+
+	Light *lights;
+	int lightCount;
+	int lightCapacity;
+
+	// Sweep scratch, reused by every light
+	unsigned int *edgeStamps;
+	unsigned int stamp;
+	LightEdge *segments;	// Edges near the light plus its bounding square
+	int segmentCapacity;
+	LightEvent *events;
+	int *active;	// Segments crossing the sweep ray
+} Lighting;
+
+Lighting LoadLighting(const Tilemap *map);
+void UnloadLighting(Lighting *lighting);
+// Re-extracts the edges after tiles in the given tile rectangle changed and marks the lights reaching it
+void UpdateLightingTiles(Lighting *lighting, const Tilemap *map, Rectangle tiles);
+
+int AddLight(Lighting *lighting, Vector2 position, float radius, Color color);	// Returns the light id
+void SetLightPosition(Lighting *lighting, int light, Vector2 position);	// Only marks it when it actually moved
+int UpdateLights(Lighting *lighting);	// Recomputes the marked polygons, returns how many
+
+// The mask is cleared to `ambient` and lit additively with a radial falloff texture
+Texture2D LoadLightFalloff(int size);
+void DrawLightMask(const Lighting *lighting, RenderTexture2D mask, Texture2D falloff, Color ambient, Camera2D camera);
+void DrawLightMaskOver(RenderTexture2D mask);	// Multiplies the mask over whatever was drawn, in screen space
+
+#endif
@@ -0,0 +1,144 @@
+#include "lz.h"
+
+#include <string.h>
+#include <stdint.h>
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 14
+#define LZ_MAX_OFFSET 65535
+#define LZ_LAST_LITERALS 8	// The tail is always emitted as literals so matching never reads past the end
+
+static inline uint32_t Read32(const unsigned char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+static inline uint32_t HashLz(uint32_t v)
+{
+	return (v*2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static unsigned char *WriteLength(unsigned char *op, int length)
+{
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = (unsigned char)length;
+	return op;
+}
+
+int GetLzCompressBound(int size)
+{
+	return size + size/255 + 16;
+}
+
+int CompressLz(const unsigned char *in, int size, unsigned char *out)
+{
+	int table[1 << LZ_HASH_BITS];
+	memset(table, -1, sizeof(table));
+
+	const unsigned char *ip = in;
+	const unsigned char *anchor = in;
+	const unsigned char *end = in + size;
+	const unsigned char *matchLimit = (size > LZ_LAST_LITERALS)? end - LZ_LAST_LITERALS : in;
+	unsigned char *op = out;
+
+	while (ip + LZ_MIN_MATCH <= matchLimit)
+	{
+		uint32_t h = HashLz(Read32(ip));
+		int candidate = table[h];
+		table[h] = (int)(ip - in);
+
+		if (candidate < 0 || (ip - in) - candidate > LZ_MAX_OFFSET || Read32(in + candidate) != Read32(ip))
+		{
+			ip++;
+			continue;
+		}
+
+		const unsigned char *match = in + candidate;
+		int matchLength = LZ_MIN_MATCH;
+		while (ip + matchLength < matchLimit && ip[matchLength] == match[matchLength]) matchLength++;
+
+		int literalLength = (int)(ip - anchor);
+		unsigned char *token = op++;
+		*token = (unsigned char)(((literalLength < 15)? literalLength : 15) << 4);
+		if (literalLength >= 15) op = WriteLength(op, literalLength - 15);
+		memcpy(op, anchor, literalLength);
+		op += literalLength;
+
+		int offset = (int)(ip - match);
+		*op++ = (unsigned char)(offset & 0xff);
+		*op++ = (unsigned char)(offset >> 8);
+
+		int extra = matchLength - LZ_MIN_MATCH;
+		*token |= (unsigned char)((extra < 15)? extra : 15);
+		if (extra >= 15) op = WriteLength(op, extra - 15);
+
+		ip += matchLength;
+		anchor = ip;
+	}
+
+	int literalLength = (int)(end - anchor);
+	*op++ = (unsigned char)(((literalLength < 15)? literalLength : 15) << 4);
+	if (literalLength >= 15) op = WriteLength(op, literalLength - 15);
+	memcpy(op, anchor, literalLength);
+	op += literalLength;
+
+	return (int)(op - out);
+}
+
+static const unsigned char *ReadLength(const unsigned char *ip, const unsigned char *end, int *length)
+{
+	unsigned char b;
+	do
+	{
+		if (ip >= end) return NULL;
+		b = *ip++;
+		*length += b;
+	} while (b == 255);
+	return ip;
+}
+
+int DecompressLz(const unsigned char *in, int size, unsigned char *out, int outCapacity)
+{
+	const unsigned char *ip = in;
+	const unsigned char *end = in + size;
+	unsigned char *op = out;
+	unsigned char *outEnd = out + outCapacity;
+
+	while (ip < end)
+	{
+		unsigned char token = *ip++;
+
+		int literalLength = token >> 4;
+		if (literalLength == 15 && (ip = ReadLength(ip, end, &literalLength)) == NULL) return -1;
+		if (literalLength > end - ip || literalLength > outEnd - op) return -1;
+		memcpy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		if (ip == end) break;	// Final literal-only sequence
+
+		if (end - ip < 2) return -1;
+		int offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - out) return -1;
+
+		int matchLength = token & 15;
+		if (matchLength == 15 && (ip = ReadLength(ip, end, &matchLength)) == NULL) return -1;
+		matchLength += LZ_MIN_MATCH;
+		if (matchLength > outEnd - op) return -1;
+
+		// Overlapping copies are how runs are encoded, so copy forwards byte by byte
+		const unsigned char *match = op - offset;
+		if (offset >= matchLength) memcpy(op, match, matchLength);
+		else for (int i = 0; i < matchLength; i++) op[i] = match[i];
+		op += matchLength;
+	}
+
+	return (int)(op - out);
+}
@@ -0,0 +1,13 @@
+#ifndef LZ_H
+#define LZ_H
+
+// Small LZ4-style block codec. Far faster than DEFLATE on both ends and good enough
+// for data that is already delta coded, so it is used for snapshots and caches.
+
+int GetLzCompressBound(int size);
+// Returns the compressed size, `out` must hold GetLzCompressBound(size) bytes
+int CompressLz(const unsigned char *in, int size, unsigned char *out);
+// Returns the decompressed size, or -1 on malformed input or if `outCapacity` is too small
+int DecompressLz(const unsigned char *in, int size, unsigned char *out, int outCapacity);
+
+#endif
@@ -1,7 +1,550 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
-int main(void)
+#if !defined(_WIN32)
+	#include <sys/resource.h>
+#endif
+
+#include "raylib.h"
+#include "game.h"
+#include "gameplay.h"
+#include "module.h"
+#include "snapshot.h"
+#include "replay.h"
+#include "assets.h"
+#include "jobs.h"
+#include "mixer.h"
+#include "timer.h"
+#include "chunks.h"
+#include "mapgen.h"
+#include "lighting.h"
+#include "fov.h"
+#include "textcache.h"
+#include "debugui.h"
+#include "framepacer.h"
+#include "parallax.h"
+#include "rlgl.h"
+
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 600
+
+#define GAME_SEED 2024
+#define GAME_MAP "res/maps/map01.png"
+#define GAME_CACHE_DIR "cache"	// Converted images and sounds, safe to delete
+#define STREAM_WORLD_SIZE 64	// Chunks per side of the --stream-walk world
+#define STREAM_WALK_SPEED 2400.0f	// Pixels per second, several chunks a second
+#define MODULE_POLL_FRAMES 30	// How often to look for a rebuilt gameplay module (F6 forces it)
+#define PLAYER_LIGHT_RADIUS (6.0f*TILE_SIZE)
+#define LIGHT_AMBIENT (Color){ 40, 40, 56, 255 }
+#define PLAYER_VIEW_RADIUS 8	// Tiles, for --fog
+#define DEBUG_FRAME_SAMPLES 120	// Frame times in the tuning panel's graph
+
+// Startup assets, largest first so the longest decode starts earliest
+typedef enum StartupAsset {
+	ASSET_SPACE,
+	ASSET_PLAYER_SPRITE,
+	ASSET_MAP01,
+	ASSET_MAP02,
+	ASSET_SFX_BOOP,
+	ASSET_SFX_GUN_FIRE,
+	ASSET_SFX_HURT,
+	ASSET_SFX_SOFT_BOOP,
+	ASSET_COUNT,
+} StartupAsset;
+
+typedef struct Options {
+	int headlessTicks;	// > 0 runs the simulation without a window
+	const char *recordFile;
+	const char *replayFile;
+	bool serialLoad;	// Reference path for measuring the parallel startup
+	bool adpcmSfx;	// Keep sound effects as ADPCM, decoded while mixing
+	bool lighting;	// Shadows from a light carried by the player
+	bool fog;	// Hides tiles the player has not seen
+	int swarmAgents;	// > 0 spawns a flock that chases the player
+	bool lowLatency;	// Paces frames by hand and reads input just before it is needed
+	const char *modulePath;	// Gameplay library, with GAME_HOT_RELOAD
+	int streamTicks;	// > 0 walks a streamed chunk world in real time without a window
+	const char *genMapFile;	// Writes a procedural map PNG and exits
+	int genMapSize;
+	unsigned int genMapSeed;
+} Options;
+
+static Options ParseOptions(int argc, char **argv)
+{
+	Options options = { .genMapSize = 4096, .genMapSeed = GAME_SEED };
+#if defined(GAME_HOT_RELOAD)
+	options.modulePath = GAMEPLAY_MODULE_PATH;
+#endif
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) options.headlessTicks = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) options.recordFile = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) options.replayFile = argv[++i];
+		else if (strcmp(argv[i], "--serial-load") == 0) options.serialLoad = true;
+		else if (strcmp(argv[i], "--adpcm-sfx") == 0) options.adpcmSfx = true;
+		else if (strcmp(argv[i], "--lighting") == 0) options.lighting = true;
+		else if (strcmp(argv[i], "--fog") == 0) options.fog = true;
+		else if (strcmp(argv[i], "--swarm") == 0 && i + 1 < argc) options.swarmAgents = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--low-latency") == 0) options.lowLatency = true;
+		else if (strcmp(argv[i], "--module") == 0 && i + 1 < argc) options.modulePath = argv[++i];
+		else if (strcmp(argv[i], "--stream-walk") == 0 && i + 1 < argc) options.streamTicks = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--gen-map") == 0 && i + 1 < argc) options.genMapFile = argv[++i];
+		else if (strcmp(argv[i], "--gen-size") == 0 && i + 1 < argc) options.genMapSize = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--gen-seed") == 0 && i + 1 < argc) options.genMapSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else printf("usage: %s [--headless ticks] [--record file] [--replay file] [--serial-load] [--adpcm-sfx] [--lighting] [--fog] [--swarm count] [--low-latency]"
+			" [--module file] [--stream-walk ticks] [--gen-map file.png [--gen-size n] [--gen-seed n]]\n", argv[0]);
+	}
+
+	return options;
+}
+
+static PlayerInput ReadPlayerInput(void)
+{
+	PlayerInput input = { 0 };
+	input.moveX = (float)(IsKeyDown(KEY_RIGHT) - IsKeyDown(KEY_LEFT));
+	input.moveY = (float)(IsKeyDown(KEY_DOWN) - IsKeyDown(KEY_UP));
+	input.fire = IsKeyDown(KEY_SPACE);
+	return input;
+}
+
+typedef struct ShotAudio {
+	Mixer *mixer;
+	int clip;
+	float worldWidth;	// Pixels
+} ShotAudio;
+
+// Panned by where each shot came from
+static void PlayShotSounds(void *user, const void *events, int count)
+{
+	const ShotAudio *audio = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) PlayMixerClip(audio->mixer, audio->clip, 0.8f, shots[i].origin.x/audio->worldWidth*2.0f - 1.0f);
+}
+
+// EndDrawing() without its frame limiter and input polling, the pacer does those around the frame
+static void EndPacedDrawing(FramePacer *pacer)
+{
+	rlDrawRenderBatchActive();
+	WaitPresentTime(pacer);
+	SwapScreenBuffer();
+	EndPacedFrame(pacer);
+}
+
+static unsigned int HashWorld(const World *world)
+{
+	Snapshot snapshot = { 0 };
+	EncodeSnapshot(world, NULL, 0, &snapshot);
+
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < snapshot.rawSize; i++) hash = (hash ^ snapshot.raw[i])*16777619u;
+
+	UnloadSnapshot(&snapshot);
+	return hash;
+}
+
+// Plays a replay (or the scripted demo) as fast as possible, used for PGO training and profiling
+static int RunHeadless(Options options)
+{
+	SetTraceLogLevel(LOG_WARNING);
+
+	World world = InitWorld(GAME_MAP, GAME_SEED);
+	if (options.swarmAgents > 0) LoadWorldSwarm(&world, options.swarmAgents, GAME_SEED);
+	Replay replay = { 0 };
+	int ticks = options.headlessTicks;
+
+	if (options.replayFile != NULL)
+	{
+		if (!LoadReplay(options.replayFile, &replay) || !ApplySnapshot(&replay.start, &world))
+		{
+			UnloadWorld(&world);
+			return 1;
+		}
+		if (ticks <= 0 || ticks > replay.count) ticks = replay.count;
+	}
+
+	double start = GetTimerSeconds();
+	for (int i = 0; i < ticks; i++)
+	{
+		PlayerInput input = (replay.inputs != NULL)? replay.inputs[i] : GetScriptedInput(GAME_SEED, (unsigned int)i);
+		UpdateWorld(&world, input);
+	}
+	double elapsed = GetTimerSeconds() - start;
+
+	printf("HEADLESS: %i ticks in %.2f ms (%.3f us/tick), %i entities, %i swarm agents, state hash %08x\n",
+		ticks, elapsed*1000.0, elapsed*1e6/(ticks? ticks : 1), world.entities.count, world.swarm.count, HashWorld(&world));
+
+	UnloadReplay(&replay);
+	UnloadWorld(&world);
+	return 0;
+}
+
+static long GetPeakRssKb(void)
 {
-	printf("Hello, World!\n");
+#if !defined(_WIN32)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) return usage.ru_maxrss;
+#endif
+	return 0;
+}
+
+// Walks the scripted path through a world of thousands of map chunks at the game's tick
+// rate, so chunk loads race the walk the way they would in play
+static int RunStreamWalk(Options options)
+{
+	SetTraceLogLevel(LOG_WARNING);
+
+	const char *files[] = { "res/maps/map01.png", "res/maps/map02.png" };
+	unsigned short sources[STREAM_WORLD_SIZE*STREAM_WORLD_SIZE];
+	Rng rng = SeedRng(GAME_SEED);
+	for (int i = 0; i < STREAM_WORLD_SIZE*STREAM_WORLD_SIZE; i++) sources[i] = (unsigned short)(NextRng(&rng)%2);
+
+	ChunkStream *stream = CreateChunkStream(files, 2, STREAM_WORLD_SIZE, STREAM_WORLD_SIZE, sources, 2, 0);
+	if (stream == NULL) return 1;
+
+	Rectangle bounds = GetChunkStreamBounds(stream);
+	Vector2 focus = { bounds.width/2, bounds.height/2 };
+	const float step = STREAM_WALK_SPEED/GAME_TICK_RATE;
+	double maxUpdateMs = 0.0;
+	int solid = 0;
+	double start = GetTimerSeconds();
+
+	for (int i = 0; i < options.streamTicks; i++)
+	{
+		PlayerInput input = GetScriptedInput(GAME_SEED, (unsigned int)i);
+		focus.x = fminf(fmaxf(focus.x + input.moveX*step, 0.0f), bounds.width - 1);
+		focus.y = fminf(fmaxf(focus.y + input.moveY*step, 0.0f), bounds.height - 1);
+
+		double updateStart = GetTimerSeconds();
+		UpdateChunkStream(stream, focus);
+		double updateMs = (GetTimerSeconds() - updateStart)*1000.0;
+
+		// What collision would ask; a chunk the loader has not delivered yet is loaded on the spot
+		double queryStart = GetTimerSeconds();
+		solid += IsStreamTileSolid(stream, (int)(focus.x/TILE_SIZE), (int)(focus.y/TILE_SIZE));
+		double queryMs = (GetTimerSeconds() - queryStart)*1000.0;
+		if (updateMs + queryMs > maxUpdateMs) maxUpdateMs = updateMs + queryMs;
+
+		double next = start + (double)(i + 1)/GAME_TICK_RATE;
+		double now = GetTimerSeconds();
+		WaitTimerSeconds(next - now);
+	}
+
+	ChunkStreamStats stats = GetChunkStreamStats(stream);
+	printf("STREAM: %i ticks over %ix%i chunks: %i loads, %i evictions, %i failures, %i focus chunks loaded on the spot, %i ticks on a wall\n",
+		options.streamTicks, STREAM_WORLD_SIZE, STREAM_WORLD_SIZE, stats.loads, stats.evictions, stats.failures, stats.syncLoads, solid);
+	printf("STREAM: chunk latency max %.3f ms, mean %.3f ms, decode max %.3f ms, load on the spot max %.3f ms, update max %.3f ms\n",
+		stats.maxLatencyMs, stats.totalLatencyMs/(stats.loads? stats.loads : 1), stats.maxDecodeMs, stats.maxSyncLoadMs, maxUpdateMs);
+	printf("STREAM: peak resident chunks %zu bytes, peak RSS %li KB\n", stats.peakResidentBytes, GetPeakRssKb());
+
+	DestroyChunkStream(stream);
+	return 0;
+}
+
+// Stress maps for benchmarking, in the same format as res/maps
+static int RunGenMap(Options options)
+{
+	JobSystem *jobs = CreateJobSystem(0);
+	double start = GetTimerSeconds();
+	Tilemap map = GenTilemapProcedural(jobs, GetDefaultMapGenParams(options.genMapSize, options.genMapSize, options.genMapSeed));
+	double generated = GetTimerSeconds();
+
+	Image image = ExportTilemapImage(map);
+	bool saved = ExportImage(image, options.genMapFile);
+	printf("GENMAP: %ix%i seed %u on %i threads, generated in %.2f ms, written in %.2f ms\n", map.width, map.height,
+		options.genMapSeed, GetJobThreadCount(jobs), (generated - start)*1000.0, (GetTimerSeconds() - generated)*1000.0);
+
+	UnloadImage(image);
+	UnloadTilemap(map);
+	DestroyJobSystem(jobs);
+	return saved? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+	double startTime = GetTimerSeconds();
+
+	Options options = ParseOptions(argc, argv);
+	if (options.streamTicks > 0) return RunStreamWalk(options);
+	if (options.genMapFile != NULL) return RunGenMap(options);
+	if (options.headlessTicks > 0 || (options.replayFile != NULL && options.recordFile == NULL)) return RunHeadless(options);
+
+	// Decode on the workers while the main thread creates the window and audio device
+	AssetLoad loads[ASSET_COUNT] = {
+		[ASSET_SPACE] = { "res/sprites/space.png", ASSET_IMAGE, GAME_CACHE_DIR },
+		[ASSET_PLAYER_SPRITE] = { "res/sprites/player_sprite.png", ASSET_IMAGE, GAME_CACHE_DIR },
+		[ASSET_MAP01] = { "res/maps/map01.png", ASSET_IMAGE, GAME_CACHE_DIR },
+		[ASSET_MAP02] = { "res/maps/map02.png", ASSET_IMAGE, GAME_CACHE_DIR },
+		[ASSET_SFX_BOOP] = { "res/sfx/boop.wav", ASSET_WAVE, GAME_CACHE_DIR, .sampleRate = MIXER_DEFAULT_SAMPLE_RATE },
+		[ASSET_SFX_GUN_FIRE] = { "res/sfx/gun_fire.wav", ASSET_WAVE, GAME_CACHE_DIR, .sampleRate = MIXER_DEFAULT_SAMPLE_RATE },
+		[ASSET_SFX_HURT] = { "res/sfx/hurt.wav", ASSET_WAVE, GAME_CACHE_DIR, .sampleRate = MIXER_DEFAULT_SAMPLE_RATE },
+		[ASSET_SFX_SOFT_BOOP] = { "res/sfx/soft_boop.wav", ASSET_WAVE, GAME_CACHE_DIR, .sampleRate = MIXER_DEFAULT_SAMPLE_RATE },
+	};
+	JobSystem *jobs = CreateJobSystem(0);
+	AssetBatch batch = { .loads = loads, .count = ASSET_COUNT, .jobs = options.serialLoad? NULL : jobs };
+	LoadAssetsAsync(&batch);
+	double decodeQueued = GetTimerSeconds();
+
+	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "KulenDayz 2024");
+	InitAudioDevice();
+	SetTargetFPS(GAME_TICK_RATE);
+	double deviceReady = GetTimerSeconds();
+
+	// Upload in completion order, the small files go up while space.png is still inflating
+	Texture2D background = { 0 };
+	Texture2D playerSprite = { 0 };
+	int sfx[ASSET_COUNT - ASSET_SFX_BOOP] = { -1, -1, -1, -1 };	// Mixer clip ids
+	Tilemap map = { 0 };
+	Mixer mixer;
+	InitMixer(&mixer, MIXER_DEFAULT_SAMPLE_RATE);
+	double uploadTime = 0.0;
+	int index;
+
+	while (WaitNextAsset(&batch, &index))
+	{
+		double uploadStart = GetTimerSeconds();
+		AssetLoad *load = &loads[index];
+
+		if (!load->loaded) TraceLog(LOG_WARNING, "STARTUP: [%s] Failed to load", load->fileName);
+		else if (index == ASSET_SPACE) background = LoadTextureFromImage(load->image);
+		else if (index == ASSET_PLAYER_SPRITE) playerSprite = LoadTextureFromImage(load->image);
+		else if (index == ASSET_MAP01) map = LoadTilemapFromImage(load->image);
+		else if (load->kind == ASSET_WAVE) sfx[index - ASSET_SFX_BOOP] = LoadMixerClipSamples(&mixer, load->samples, load->sampleFrames);
+
+		UnloadAssetData(load, 1);
+		uploadTime += GetTimerSeconds() - uploadStart;
+	}
+	UnloadAssetBatch(&batch);
+	if (options.adpcmSfx) for (int i = 0; i < mixer.clipCount; i++) CompressMixerClip(&mixer, i);
+	TraceMixerClips(&mixer);
+	StartMixerStream(&mixer);	// Clips are read only from here on
+	double decodeDone = GetTimerSeconds();
+
+	// The host owns the gameplay state, so a reloaded module carries on with it
+#if defined(GAME_HOT_RELOAD)
+	GameModule module;
+	if (!LoadGameModule(&module, options.modulePath))
+	{
+		TraceLog(LOG_ERROR, "MODULE: [%s] Could not load gameplay, build the gameplay target", options.modulePath);
+		return 1;
+	}
+	const GameplayApi *api = module.api;
+#else
+	const GameplayApi *api = GetGameplayApi();
+#endif
+	GameHost host = { playerSprite, GAME_SEED };
+	Arena arena = AllocArena(GAMEPLAY_ARENA_SIZE);
+	GameState *state = api->init(&arena, &host, map);
+	if (state == NULL) return 1;
+	World *world = &state->world;
+
+	// Gameplay reports what happened, sounds and effects pick it up once per tick
+	EventBus events = LoadEventBus();
+	ShotAudio shotAudio = { &mixer, sfx[ASSET_SFX_GUN_FIRE - ASSET_SFX_BOOP], (float)world->map.width*TILE_SIZE };
+	AddEventHandler(&events, EVENT_SHOT_FIRED, PlayShotSounds, &shotAudio);
+	world->events = &events;
+	world->jobs = jobs;
+	if (options.swarmAgents > 0) LoadWorldSwarm(world, options.swarmAgents, GAME_SEED);
+
+	// Edges come from the map once, the player's light only re-sweeps when it moves
+	Lighting lighting = { 0 };
+	RenderTexture2D lightMask = { 0 };
+	Texture2D lightFalloff = { 0 };
+	if (options.lighting)
+	{
+		lighting = LoadLighting(&world->map);
+		AddLight(&lighting, (Vector2){ 0.0f, 0.0f }, PLAYER_LIGHT_RADIUS, (Color){ 255, 236, 200, 255 });
+		lightMask = LoadRenderTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+		lightFalloff = LoadLightFalloff(256);
+	}
+
+	FieldOfView fov = { 0 };
+	Texture2D fogTexture = { 0 };
+	if (options.fog)
+	{
+		fov = LoadFieldOfView(world->map.width, world->map.height, PLAYER_VIEW_RADIUS);
+		fogTexture = LoadFogTexture(&fov);
+	}
+
+	// HUD text lays each string out once and reuses the quads while it stays the same
+	TextAtlas hudAtlas = LoadTextAtlas(GetFontDefault());
+	TextCache hudText = LoadTextCache(&hudAtlas);
+	SpriteBatch hud = LoadSpriteBatch(256);
+
+	// F1 opens the tuning panel, it draws with the HUD in the same batch
+	DebugUi debugUi = LoadDebugUi(&hudText, GetDefaultFontSolid(GetFontDefault()), (Vector2){ SCREEN_WIDTH - 250.0f, 10.0f }, 240.0f);
+	bool showDebugUi = false, drawFog = true, drawLighting = true;
+	float frameMs[DEBUG_FRAME_SAMPLES] = { 0 };
+	int frameMsHead = 0;
+
+	// The backdrop and two star fields slide at their own rates as the player moves, a quad
+	// each. space.png does not tile, mirroring it hides the edge
+	Parallax parallax = { 0 };
+	SetTextureWrap(background, TEXTURE_WRAP_MIRROR_REPEAT);
+	AddParallaxLayer(&parallax, background, (Vector2){ 0.05f, 0.05f }, (Vector2){ -2.0f, 0.0f }, WHITE, true);
+	Image starImage = GenStarLayerImage(512, 512, 300, GAME_SEED, (Color){ 170, 180, 255, 255 });
+	Texture2D farStars = LoadTextureFromImage(starImage);
+	UnloadImage(starImage);
+	starImage = GenStarLayerImage(400, 300, 60, GAME_SEED + 1, WHITE);
+	Texture2D nearStars = LoadTextureFromImage(starImage);
+	UnloadImage(starImage);
+	SetTextureWrap(farStars, TEXTURE_WRAP_REPEAT);
+	SetTextureWrap(nearStars, TEXTURE_WRAP_REPEAT);
+	AddParallaxLayer(&parallax, farStars, (Vector2){ 0.2f, 0.2f }, (Vector2){ -6.0f, 0.0f }, WHITE, false);
+	AddParallaxLayer(&parallax, nearStars, (Vector2){ 0.5f, 0.5f }, (Vector2){ -15.0f, 0.0f }, WHITE, false);
+	SpriteBatch backdrop = LoadSpriteBatch(PARALLAX_MAX_LAYERS);
+	Rectangle parallaxCamera = GetEntityRec(&world->entities, 0);
+
+	Snapshot quickSave = { 0 };
+	Replay recording = { 0 };
+	if (options.recordFile != NULL) recording = BeginReplay(world);
+	bool firstFrame = true;
+	FramePacer pacer = LoadFramePacer(GetSystemFrameClock(), GAME_TICK_RATE);
+
+	while (!WindowShouldClose())
+	{
+		// EndDrawing() polls straight after its wait, a paced frame waits first and polls as late as it can
+		if (options.lowLatency)
+		{
+			BeginPacedFrame(&pacer);
+			PollInputEvents();
+		}
+		float frameTime = options.lowLatency? (float)pacer.frameTime : GetFrameTime();
+
+#if defined(GAME_HOT_RELOAD)
+		if ((IsKeyPressed(KEY_F6) || (world->frame%MODULE_POLL_FRAMES == 0 && IsGameModuleChanged(&module))) &&
+			ReloadGameModule(&module, state, &host)) api = module.api;
+#endif
+		if (IsKeyPressed(KEY_F5) && EncodeSnapshot(world, NULL, 0, &quickSave))
+		{
+			SaveSnapshotFile(&quickSave, "quicksave.bin");
+		}
+		// Loading would break the input stream of a recording
+		if (IsKeyPressed(KEY_F9) && quickSave.raw != NULL && options.recordFile == NULL) ApplySnapshot(&quickSave, world);
+		if (IsKeyPressed(KEY_F1)) showDebugUi = !showDebugUi;
+		frameMs[frameMsHead] = frameTime*1000.0f;
+		frameMsHead = (frameMsHead + 1)%DEBUG_FRAME_SAMPLES;
+
+		PlayerInput input = ReadPlayerInput();
+		if (options.recordFile != NULL) input = RecordReplayInput(&recording, input);
+		api->update(state, input);
+		DispatchEvents(&events);
+
+		if (options.lighting)
+		{
+			Rectangle player = GetEntityRec(&world->entities, 0);
+			SetLightPosition(&lighting, 0, (Vector2){ player.x + player.width/2, player.y + player.height/2 });
+			UpdateLights(&lighting);
+			DrawLightMask(&lighting, lightMask, lightFalloff, LIGHT_AMBIENT, (Camera2D){ .zoom = 1.0f });
+		}
+
+		// Only recast when the player steps onto another tile
+		if (options.fog)
+		{
+			Rectangle player = GetEntityRec(&world->entities, 0);
+			int tileX = (int)((player.x + player.width/2)/TILE_SIZE), tileY = (int)((player.y + player.height/2)/TILE_SIZE);
+			if (UpdateFieldOfView(&fov, &world->map, tileX, tileY)) UpdateFogTexture(&fov, fogTexture);
+		}
+
+		// Snapshot loads jump the player, the layers take any distance
+		Rectangle player = GetEntityRec(&world->entities, 0);
+		ScrollParallax(&parallax, (double)player.x - parallaxCamera.x, (double)player.y - parallaxCamera.y, frameTime);
+		parallaxCamera = player;
+
+		BeginDrawing();
+			ClearBackground(BLACK);
+			BeginSpriteBatch(&backdrop);
+			DrawParallax(&parallax, &backdrop, (Rectangle){ 0.0f, 0.0f, SCREEN_WIDTH, SCREEN_HEIGHT });
+			EndSpriteBatch(&backdrop);
+			api->draw(state, &host);
+			if (options.fog && drawFog) DrawFog(fogTexture);
+			if (options.lighting && drawLighting) DrawLightMaskOver(lightMask);
+
+			// Same text, size and colours as DrawFPS(), which has nothing to go on when EndDrawing() is skipped
+			FramePacerStats paceStats = GetFramePacerStats(&pacer);
+			int fps = GetFPS();
+			if (options.lowLatency) fps = (paceStats.frameMean > 0.0)? (int)(1.0/paceStats.frameMean + 0.5) : 0;
+			BeginTextFrame(&hudText);
+			BeginSpriteBatch(&hud);
+			DrawTextCached(&hudText, &hud, TextFormat("%2i FPS", fps), (Vector2){ 10.0f, 10.0f }, 20.0f, 2.0f, (fps < 15)? RED : (fps < 30)? ORANGE : LIME);
+			if (options.lowLatency)
+			{
+				DrawTextCached(&hudText, &hud, TextFormat("input %.1f ms, jitter %.2f ms", paceStats.latencyMean*1000.0, paceStats.frameStdDev*1000.0),
+					(Vector2){ 10.0f, 32.0f }, 10.0f, 1.0f, LIME);
+			}
+			if (showDebugUi)
+			{
+				BeginDebugUi(&debugUi, (DebugUiInput){ GetMousePosition(), IsMouseButtonDown(MOUSE_BUTTON_LEFT), IsMouseButtonPressed(MOUSE_BUTTON_LEFT) });
+				DebugGraph(&debugUi, "frame ms", frameMs, DEBUG_FRAME_SAMPLES, frameMsHead, 1000.0f/GAME_TICK_RATE);
+				int voiceLimit = atomic_load_explicit(&mixer.voiceLimit, memory_order_relaxed);
+				if (DebugSliderInt(&debugUi, "voice limit", &voiceLimit, 1, MIXER_MAX_VOICES)) atomic_store_explicit(&mixer.voiceLimit, voiceLimit, memory_order_relaxed);
+				// Tuning is not in the input stream, a recording would not play back
+				if (options.swarmAgents > 0 && options.recordFile == NULL)
+				{
+					DebugSlider(&debugUi, "swarm speed", &world->swarm.params.maxSpeed, 0.0f, 400.0f);
+					DebugSlider(&debugUi, "swarm separation", &world->swarm.params.separation, 0.0f, 4.0f);
+					DebugSlider(&debugUi, "swarm cohesion", &world->swarm.params.cohesion, 0.0f, 4.0f);
+				}
+				if (options.fog) DebugCheckbox(&debugUi, "fog", &drawFog);
+				if (options.lighting) DebugCheckbox(&debugUi, "lighting", &drawLighting);
+				EndDebugUi(&debugUi, &hud);
+			}
+			EndSpriteBatch(&hud);
+		if (options.lowLatency) EndPacedDrawing(&pacer);
+		else EndDrawing();
+
+		if (firstFrame)
+		{
+			double now = GetTimerSeconds();
+			TraceLog(LOG_INFO, "STARTUP: %s decode finished %.2f ms after device init (%.2f ms for window and audio),"
+				" uploads %.2f ms, first frame at %.2f ms", options.serialLoad? "serial" : "parallel",
+				(decodeDone - deviceReady)*1000.0, (deviceReady - decodeQueued)*1000.0,
+				uploadTime*1000.0, (now - startTime)*1000.0);
+			firstFrame = false;
+		}
+	}
+
+	if (options.recordFile != NULL) SaveReplay(&recording, options.recordFile);
+	if (options.lowLatency)
+	{
+		FramePacerStats stats = GetFramePacerStats(&pacer);
+		TraceLog(LOG_INFO, "PACING: Last %i frames %.3f ms +- %.3f ms (worst %.2f ms), input to present %.2f ms (worst %.2f ms), %i presents missed",
+			stats.frames, stats.frameMean*1000.0, stats.frameStdDev*1000.0, stats.frameMax*1000.0, stats.latencyMean*1000.0, stats.latencyMax*1000.0, stats.missed);
+	}
+
+	UnloadReplay(&recording);
+	UnloadSnapshot(&quickSave);
+	if (options.lighting)
+	{
+		UnloadLighting(&lighting);
+		UnloadRenderTexture(lightMask);
+		UnloadTexture(lightFalloff);
+	}
+	if (options.fog)
+	{
+		UnloadFieldOfView(&fov);
+		UnloadTexture(fogTexture);
+	}
+	UnloadDebugUi(&debugUi);
+	UnloadSpriteBatch(&hud);
+	UnloadSpriteBatch(&backdrop);
+	UnloadTexture(farStars);
+	UnloadTexture(nearStars);
+	UnloadTextCache(&hudText);
+	UnloadEventBus(&events);
+	api->unload(state);
+	FreeArena(&arena);
+#if defined(GAME_HOT_RELOAD)
+	UnloadGameModule(&module);
+#endif
+	UnloadMixer(&mixer);
+	UnloadTexture(playerSprite);
+	UnloadTexture(background);
+	CloseAudioDevice();
+	CloseWindow();
+	DestroyJobSystem(jobs);
+
 	return 0;
-}
\ No newline at end of file
+}
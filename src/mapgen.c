@@ -0,0 +1,213 @@
+#include "mapgen.h"
+#include "rng.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct MapGenRect {
+	int x;
+	int y;
+	int width;
+	int height;
+} MapGenRect;
+
+typedef struct MapGenJob {
+	const MapGenParams *params;
+	const unsigned char *src;
+	unsigned char *dst;
+	const MapGenRect *rects;
+	int rectCount;
+} MapGenJob;
+
+MapGenParams GetDefaultMapGenParams(int width, int height, unsigned int seed)
+{
+	return (MapGenParams){
+		.width = width,
+		.height = height,
+		.seed = seed,
+		.fillChance = 0.5f,
+		.caveSteps = 4,
+		.roomSpacing = 32,
+		.roomMinSize = 5,
+		.roomMaxSize = 14,
+		.wall = (Color){ 223, 113, 38, 255 },	// The orange of map02.png
+	};
+}
+
+// Stateless per tile noise, so bands can fill in any order on any thread
+static inline unsigned int HashTile(unsigned int seed, int x, int y)
+{
+	unsigned int h = seed ^ ((unsigned int)x*0x85ebca6bu) ^ ((unsigned int)y*0xc2b2ae35u);
+	h ^= h >> 16;
+	h *= 0x7feb352du;
+	h ^= h >> 15;
+	h *= 0x846ca68bu;
+	h ^= h >> 16;
+	return h;
+}
+
+static void FillBand(void *user, int band)
+{
+	MapGenJob *job = user;
+	const MapGenParams *p = job->params;
+	unsigned int threshold = (unsigned int)(p->fillChance*4294967295.0);
+	int y1 = (band + 1)*MAPGEN_BAND_ROWS;
+
+	for (int y = band*MAPGEN_BAND_ROWS; y < y1 && y < p->height; y++)
+	{
+		unsigned char *row = job->dst + (size_t)y*p->width;
+		for (int x = 0; x < p->width; x++) row[x] = (HashTile(p->seed, x, y) < threshold);
+
+		// A solid border so caves never open onto the edge of the map
+		row[0] = row[p->width - 1] = 1;
+		if (y == 0 || y == p->height - 1) memset(row, 1, (size_t)p->width);
+	}
+}
+
+// Wall when at least 5 of the 3x3 neighbourhood are wall, the usual cave smoothing rule
+static void StepBand(void *user, int band)
+{
+	MapGenJob *job = user;
+	const MapGenParams *p = job->params;
+	int w = p->width;
+	int y1 = (band + 1)*MAPGEN_BAND_ROWS;
+
+	for (int y = band*MAPGEN_BAND_ROWS; y < y1 && y < p->height; y++)
+	{
+		unsigned char *out = job->dst + (size_t)y*w;
+		if (y == 0 || y == p->height - 1)
+		{
+			memset(out, 1, (size_t)w);
+			continue;
+		}
+
+		const unsigned char *a = job->src + (size_t)(y - 1)*w;
+		const unsigned char *b = a + w;
+		const unsigned char *c = b + w;
+
+		out[0] = out[w - 1] = 1;
+		for (int x = 1; x < w - 1; x++)
+		{
+			int sum = a[x - 1] + a[x] + a[x + 1] + b[x - 1] + b[x] + b[x + 1] + c[x - 1] + c[x] + c[x + 1];
+			out[x] = (sum >= 5);
+		}
+	}
+}
+
+static void CarveBand(void *user, int band)
+{
+	MapGenJob *job = user;
+	const MapGenParams *p = job->params;
+	int y0 = band*MAPGEN_BAND_ROWS, y1 = y0 + MAPGEN_BAND_ROWS;
+
+	for (int i = 0; i < job->rectCount; i++)
+	{
+		// Clipped to the inside of the border
+		MapGenRect r = job->rects[i];
+		int top = (r.y > y0)? r.y : y0;
+		int bottom = (r.y + r.height < y1)? r.y + r.height : y1;
+		if (bottom > p->height - 1) bottom = p->height - 1;
+		int left = (r.x > 1)? r.x : 1;
+		int right = (r.x + r.width < p->width - 1)? r.x + r.width : p->width - 1;
+
+		for (int y = top; y < bottom && left < right; y++) memset(job->dst + (size_t)y*p->width + left, 0, (size_t)(right - left));
+	}
+}
+
+static void RunMapGenJobs(JobSystem *jobs, JobFunc func, MapGenJob *job, int bands)
+{
+	if (jobs != NULL) RunJobs(jobs, func, job, bands);
+	else for (int i = 0; i < bands; i++) func(job, i);
+}
+
+// Rooms on a jittered grid, each joined to its right and lower neighbour by an L shaped
+// corridor, so every room is reachable. Drawn from one Rng in a fixed order.
+static MapGenRect *GenRoomRects(const MapGenParams *p, int *count)
+{
+	*count = 0;
+	int spacing = p->roomSpacing;
+	if (spacing < 4 || p->width < spacing + 2 || p->height < spacing + 2) return NULL;
+
+	int maxSize = (p->roomMaxSize < spacing - 2)? p->roomMaxSize : spacing - 2;
+	int minSize = (p->roomMinSize < maxSize)? p->roomMinSize : maxSize;
+	if (minSize < 1) minSize = 1;
+
+	int cellsX = (p->width - 2)/spacing, cellsY = (p->height - 2)/spacing;
+	MapGenRect *rooms = malloc((size_t)cellsX*cellsY*sizeof(MapGenRect));
+	MapGenRect *rects = malloc((size_t)cellsX*cellsY*5*sizeof(MapGenRect));
+	Rng rng = SeedRng(p->seed ^ 0x5bd1e995u);
+
+	for (int cy = 0; cy < cellsY; cy++)
+	{
+		for (int cx = 0; cx < cellsX; cx++)
+		{
+			MapGenRect room;
+			room.width = minSize + (int)(NextRng(&rng)%(unsigned int)(maxSize - minSize + 1));
+			room.height = minSize + (int)(NextRng(&rng)%(unsigned int)(maxSize - minSize + 1));
+			room.x = 1 + cx*spacing + (int)(NextRng(&rng)%(unsigned int)(spacing - room.width));
+			room.y = 1 + cy*spacing + (int)(NextRng(&rng)%(unsigned int)(spacing - room.height));
+			rooms[cy*cellsX + cx] = room;
+			rects[(*count)++] = room;
+		}
+	}
+
+	for (int i = 0; i < cellsX*cellsY; i++)
+	{
+		MapGenRect a = rooms[i];
+		int ax = a.x + a.width/2, ay = a.y + a.height/2;
+		int neighbours[2] = { ((i + 1)%cellsX != 0)? i + 1 : -1, (i + cellsX < cellsX*cellsY)? i + cellsX : -1 };
+
+		for (int n = 0; n < 2; n++)
+		{
+			if (neighbours[n] < 0) continue;
+			MapGenRect b = rooms[neighbours[n]];
+			int bx = b.x + b.width/2, by = b.y + b.height/2;
+
+			// Two wide so entities bigger than a tile fit through
+			int left = (ax < bx)? ax : bx, right = (ax < bx)? bx : ax;
+			int top = (ay < by)? ay : by, bottom = (ay < by)? by : ay;
+			rects[(*count)++] = (MapGenRect){ left, ay, right - left + 2, 2 };
+			rects[(*count)++] = (MapGenRect){ bx, top, 2, bottom - top + 2 };
+		}
+	}
+
+	free(rooms);
+	return rects;
+}
+
+Tilemap GenTilemapProcedural(JobSystem *jobs, MapGenParams params)
+{
+	Tilemap map = GenTilemapEmpty(params.width, params.height);
+	int wall = AddTilemapColor(&map, params.wall);
+	if (map.tiles == NULL || params.width < 3 || params.height < 3) return map;
+
+	unsigned char *scratch = malloc((size_t)params.width*params.height);
+	int bands = (params.height + MAPGEN_BAND_ROWS - 1)/MAPGEN_BAND_ROWS;
+	MapGenJob job = { &params, NULL, map.tiles, NULL, 0 };
+
+	RunMapGenJobs(jobs, FillBand, &job, bands);
+
+	for (int i = 0; i < params.caveSteps; i++)
+	{
+		job.src = job.dst;
+		job.dst = (job.dst == map.tiles)? scratch : map.tiles;
+		RunMapGenJobs(jobs, StepBand, &job, bands);
+	}
+
+	MapGenRect *rects = GenRoomRects(&params, &job.rectCount);
+	job.rects = rects;
+	RunMapGenJobs(jobs, CarveBand, &job, bands);
+	free(rects);
+
+	// Generation works in 0/1, the wall is palette index 1 unless a caller changed that
+	if (job.dst != map.tiles)
+	{
+		free(map.tiles);
+		map.tiles = job.dst;
+	}
+	else free(scratch);
+
+	if (wall != 1) for (int i = 0; i < params.width*params.height; i++) map.tiles[i] = map.tiles[i]? (unsigned char)wall : TILE_EMPTY;
+
+	return map;
+}
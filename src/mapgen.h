@@ -0,0 +1,28 @@
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include "tilemap.h"
+#include "jobs.h"
+
+// Cave maps from cellular automata with rooms and corridors carved through them,
+// in the same format as res/maps/*.png (ExportTilemapImage() writes one out).
+// The result depends only on the parameters, never on the thread count.
+
+#define MAPGEN_BAND_ROWS 64	// Rows per job
+
+typedef struct MapGenParams {
+	int width;
+	int height;
+	unsigned int seed;
+	float fillChance;	// Initial chance of a tile being wall
+	int caveSteps;	// Cellular automaton smoothing passes
+	int roomSpacing;	// One room per cell of this many tiles, joined to its right and lower neighbours; 0 for none
+	int roomMinSize;
+	int roomMaxSize;	// At most roomSpacing - 2
+	Color wall;
+} MapGenParams;
+
+MapGenParams GetDefaultMapGenParams(int width, int height, unsigned int seed);
+Tilemap GenTilemapProcedural(JobSystem *jobs, MapGenParams params);	// jobs may be NULL to run on the caller
+
+#endif
@@ -0,0 +1,282 @@
+#include "mixer.h"
+#include "resample.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+bool InitMixer(Mixer *mixer, int sampleRate)
+{
+	memset(mixer, 0, sizeof(*mixer));
+	mixer->sampleRate = sampleRate;
+	mixer->masterGain = 1.0f;
+	atomic_store_explicit(&mixer->voiceLimit, MIXER_MAX_VOICES, memory_order_relaxed);
+	return InitSpscQueue(&mixer->commands, MIXER_COMMAND_CAPACITY, sizeof(MixerCommand));
+}
+
+void UnloadMixer(Mixer *mixer)
+{
+	StopMixerStream(mixer);
+	for (int i = 0; i < mixer->clipCount; i++)
+	{
+		free(mixer->clips[i].samples);
+		UnloadAdpcm(mixer->clips[i].adpcm);
+	}
+	free(mixer->scratch);
+	FreeSpscQueue(&mixer->commands);
+	memset(mixer, 0, sizeof(*mixer));
+}
+
+int LoadMixerClip(Mixer *mixer, Wave wave)
+{
+	if (wave.data == NULL) return -1;
+
+	int frames = (int)wave.frameCount;
+	float *samples = LoadWaveMonoSamples(wave.data, frames, wave.sampleSize, wave.channels);
+
+	if (samples != NULL && (int)wave.sampleRate != mixer->sampleRate)
+	{
+		float *resampled = ResampleAudio(samples, frames, wave.sampleRate, mixer->sampleRate, &frames);
+		free(samples);
+		samples = resampled;
+	}
+
+	return LoadMixerClipSamples(mixer, samples, frames);
+}
+
+int LoadMixerClipSamples(Mixer *mixer, float *samples, int frames)
+{
+	if (samples == NULL) return -1;
+	if (mixer->clipCount == MIXER_MAX_CLIPS)
+	{
+		free(samples);
+		return -1;
+	}
+
+	mixer->clips[mixer->clipCount] = (MixerClip){ .samples = samples, .frames = frames };
+	return mixer->clipCount++;
+}
+
+bool CompressMixerClip(Mixer *mixer, int clip)
+{
+	if (clip < 0 || clip >= mixer->clipCount || mixer->clips[clip].samples == NULL) return false;
+
+	if (mixer->scratch == NULL)
+	{
+		mixer->scratch = malloc(sizeof(MixerDecodeScratch));
+		if (mixer->scratch == NULL) return false;
+	}
+
+	MixerClip *c = &mixer->clips[clip];
+	c->adpcm = EncodeAdpcm(c->samples, c->frames);
+	if (c->adpcm.blocks == NULL) return false;
+
+	free(c->samples);
+	c->samples = NULL;
+	return true;
+}
+
+int GetMixerClipMemory(const Mixer *mixer, int clip)
+{
+	const MixerClip *c = &mixer->clips[clip];
+	if (c->samples != NULL) return ((c->frames + 3) & ~3)*(int)sizeof(float);
+	return c->adpcm.blockCount*ADPCM_BLOCK_BYTES;
+}
+
+void TraceMixerClips(const Mixer *mixer)
+{
+	int total = 0;
+	for (int i = 0; i < mixer->clipCount; i++)
+	{
+		const MixerClip *c = &mixer->clips[i];
+		int bytes = GetMixerClipMemory(mixer, i);
+		total += bytes;
+
+		if (c->samples != NULL) TraceLog(LOG_INFO, "MIXER: Clip %i: %i frames, %i bytes float PCM", i, c->frames, bytes);
+		else TraceLog(LOG_INFO, "MIXER: Clip %i: %i frames, %i bytes ADPCM (%.2f:1 vs 16 bit PCM), SNR %.1f dB",
+			i, c->frames, bytes, c->frames*2.0f/bytes, c->adpcm.snr);
+	}
+	TraceLog(LOG_INFO, "MIXER: %i clips, %i bytes total", mixer->clipCount, total);
+}
+
+void PlayMixerClip(Mixer *mixer, int clip, float gain, float pan)
+{
+	MixerCommand command = { clip, gain, pan };
+	if (!PushSpsc(&mixer->commands, &command)) atomic_fetch_add_explicit(&mixer->droppedTriggers, 1, memory_order_relaxed);
+}
+
+// Constant power pan
+static void GetPanGains(MixerCommand command, float *left, float *right)
+{
+	float angle = (fminf(fmaxf(command.pan, -1.0f), 1.0f) + 1.0f)*PI/4.0f;
+	*left = command.gain*cosf(angle);
+	*right = command.gain*sinf(angle);
+}
+
+static void StartVoices(Mixer *mixer)
+{
+	MixerCommand command;
+	int firstNew = mixer->voiceCount;
+	int voiceLimit = atomic_load_explicit(&mixer->voiceLimit, memory_order_relaxed);
+	if (voiceLimit > MIXER_MAX_VOICES) voiceLimit = MIXER_MAX_VOICES;
+
+	while (PopSpsc(&mixer->commands, &command))
+	{
+		if (command.clip < 0 || command.clip >= mixer->clipCount) continue;
+
+		float left, right;
+		GetPanGains(command, &left, &right);
+
+		// Identical clips starting on the same sample only add up to clipping, keep the loudest
+		bool merged = false;
+		for (int i = firstNew; i < mixer->voiceCount && !merged; i++)
+		{
+			MixerVoice *v = &mixer->voices[i];
+			if (v->clip != command.clip) continue;
+
+			v->gainLeft = fmaxf(v->gainLeft, left);
+			v->gainRight = fmaxf(v->gainRight, right);
+			merged = true;
+		}
+
+		if (merged) atomic_fetch_add_explicit(&mixer->mergedTriggers, 1, memory_order_relaxed);
+		else if (mixer->voiceCount >= voiceLimit) atomic_fetch_add_explicit(&mixer->droppedTriggers, 1, memory_order_relaxed);
+		else mixer->voices[mixer->voiceCount++] = (MixerVoice){ command.clip, 0, left, right };
+	}
+}
+
+// Adds `frames` mono samples to interleaved stereo output, 4 at a time with a scalar tail
+static void MixVoice(float *out, const float *in, int frames, float gainLeft, float gainRight)
+{
+	int i = 0;
+#if defined(__SSE2__)
+	__m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+
+	for (; i + 4 <= frames; i += 4)
+	{
+		__m128 s = _mm_loadu_ps(in + i);
+		__m128 lo = _mm_unpacklo_ps(s, s);	// s0 s0 s1 s1
+		__m128 hi = _mm_unpackhi_ps(s, s);	// s2 s2 s3 s3
+		float *o = out + 2*i;
+		_mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_mul_ps(lo, gains)));
+		_mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(hi, gains)));
+	}
+#endif
+	for (; i < frames; i++)
+	{
+		out[2*i] += in[i]*gainLeft;
+		out[2*i + 1] += in[i]*gainRight;
+	}
+}
+
+// Frames a voice contributes to a buffer of `frames`
+static inline int GetVoiceFrames(const MixerVoice *voice, const MixerClip *clip, int frames)
+{
+	int remaining = clip->frames - voice->position;
+	return (remaining < frames)? remaining : frames;
+}
+
+// Decodes the blocks every compressed voice needs for this buffer, all voices in one batch
+static void DecodeVoices(Mixer *mixer, int frames, const float **sources)
+{
+	MixerDecodeScratch *scratch = mixer->scratch;
+	int count = 0;
+
+	for (int v = 0; v < mixer->voiceCount; v++)
+	{
+		const MixerVoice *voice = &mixer->voices[v];
+		const MixerClip *clip = &mixer->clips[voice->clip];
+		if (clip->samples != NULL) continue;
+
+		int first = voice->position/ADPCM_BLOCK_SAMPLES;
+		int last = (voice->position + GetVoiceFrames(voice, clip, frames) - 1)/ADPCM_BLOCK_SAMPLES;
+		if (last >= clip->adpcm.blockCount) last = clip->adpcm.blockCount - 1;
+
+		for (int b = first; b <= last; b++)
+		{
+			scratch->blocks[count] = clip->adpcm.blocks + (size_t)b*ADPCM_BLOCK_BYTES;
+			scratch->outs[count] = scratch->samples[v] + (b - first)*ADPCM_BLOCK_SAMPLES;
+			count++;
+		}
+		sources[v] = scratch->samples[v] + voice->position%ADPCM_BLOCK_SAMPLES;
+	}
+
+	DecodeAdpcmBlocks(scratch->blocks, scratch->outs, count);
+}
+
+static void MixChunk(Mixer *mixer, float *out, int frames)
+{
+	const float *sources[MIXER_MAX_VOICES];
+	memset(out, 0, (size_t)frames*2*sizeof(float));
+
+	if (mixer->scratch != NULL) DecodeVoices(mixer, frames, sources);
+
+	for (int v = 0; v < mixer->voiceCount; v++)
+	{
+		MixerVoice *voice = &mixer->voices[v];
+		const MixerClip *clip = &mixer->clips[voice->clip];
+
+		int count = GetVoiceFrames(voice, clip, frames);
+		const float *in = (clip->samples != NULL)? clip->samples + voice->position : sources[v];
+		MixVoice(out, in, count, voice->gainLeft*mixer->masterGain, voice->gainRight*mixer->masterGain);
+		voice->position += count;
+
+		if (voice->position >= clip->frames)
+		{
+			// Keep the decoded source with its voice when the last voice moves into this slot
+			sources[v] = sources[mixer->voiceCount - 1];
+			mixer->voices[v--] = mixer->voices[--mixer->voiceCount];
+		}
+	}
+
+	// Hard clip, the device expects [-1, 1]
+	for (int i = 0; i < frames*2; i++) out[i] = fminf(fmaxf(out[i], -1.0f), 1.0f);
+}
+
+void MixAudio(Mixer *mixer, float *out, int frames)
+{
+	StartVoices(mixer);
+
+	// Compressed voices decode into per buffer scratch, so work in buffer sized chunks
+	for (int done = 0; done < frames; done += MIXER_BUFFER_FRAMES)
+	{
+		int chunk = (frames - done < MIXER_BUFFER_FRAMES)? frames - done : MIXER_BUFFER_FRAMES;
+		MixChunk(mixer, out + 2*done, chunk);
+	}
+
+	atomic_store_explicit(&mixer->activeVoices, mixer->voiceCount, memory_order_relaxed);
+}
+
+//----------------------------------------------------------------------------------
+// raylib stream glue
+//----------------------------------------------------------------------------------
+static Mixer *streamMixer = NULL;
+
+static void MixerStreamCallback(void *buffer, unsigned int frames)
+{
+	if (streamMixer != NULL) MixAudio(streamMixer, buffer, (int)frames);
+	else memset(buffer, 0, (size_t)frames*2*sizeof(float));
+}
+
+void StartMixerStream(Mixer *mixer)
+{
+	SetAudioStreamBufferSizeDefault(MIXER_BUFFER_FRAMES);
+	mixer->stream = LoadAudioStream(mixer->sampleRate, 32, 2);
+	streamMixer = mixer;
+	SetAudioStreamCallback(mixer->stream, MixerStreamCallback);
+	PlayAudioStream(mixer->stream);
+}
+
+void StopMixerStream(Mixer *mixer)
+{
+	if (!IsAudioStreamReady(mixer->stream)) return;
+
+	StopAudioStream(mixer->stream);
+	UnloadAudioStream(mixer->stream);
+	mixer->stream = (AudioStream){ 0 };
+	if (streamMixer == mixer) streamMixer = NULL;
+}
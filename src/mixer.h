@@ -0,0 +1,88 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdatomic.h>
+
+#include "raylib.h"
+#include "queue.h"
+#include "adpcm.h"
+
+// Most output devices run at 48 kHz natively; mixing at the device rate means
+// raylib's stream never has to resample on the audio thread
+#define MIXER_DEFAULT_SAMPLE_RATE 48000
+#define MIXER_BUFFER_FRAMES 512
+#define MIXER_MAX_VOICES 256
+#define MIXER_MAX_CLIPS 64
+#define MIXER_COMMAND_CAPACITY 256
+
+// Mono at the mixer's sample rate, either float PCM padded with silence to a multiple
+// of 4 frames (see resample.h), or IMA-ADPCM blocks that are decoded per buffer at a
+// quarter of the 16 bit memory cost.
+typedef struct MixerClip {
+	float *samples;	// NULL when compressed
+	AdpcmClip adpcm;
+	int frames;
+} MixerClip;
+
+// Per buffer decode space for compressed voices, only allocated once a clip is compressed
+#define MIXER_DECODE_BLOCKS (MIXER_BUFFER_FRAMES/ADPCM_BLOCK_SAMPLES + 1)
+
+typedef struct MixerDecodeScratch {
+	float samples[MIXER_MAX_VOICES][MIXER_DECODE_BLOCKS*ADPCM_BLOCK_SAMPLES];
+	const unsigned char *blocks[MIXER_MAX_VOICES*MIXER_DECODE_BLOCKS];
+	float *outs[MIXER_MAX_VOICES*MIXER_DECODE_BLOCKS];
+} MixerDecodeScratch;
+
+typedef struct MixerVoice {
+	int clip;
+	int position;
+	float gainLeft;
+	float gainRight;
+} MixerVoice;
+
+typedef struct MixerCommand {
+	int clip;
+	float gain;
+	float pan;	// -1 left, 0 centre, 1 right
+} MixerCommand;
+
+// Software mixer producing interleaved stereo float. The game thread only pushes
+// commands; voices are owned by whoever calls MixAudio(), normally raylib's audio thread.
+typedef struct Mixer {
+	int sampleRate;
+	MixerClip clips[MIXER_MAX_CLIPS];	// Read only once the stream runs
+	int clipCount;
+
+	MixerVoice voices[MIXER_MAX_VOICES];	// Packed, [0, voiceCount) are playing
+	int voiceCount;
+	SpscQueue commands;
+	float masterGain;
+	MixerDecodeScratch *scratch;
+	atomic_int voiceLimit;	// New voices allowed while this many play, at most MIXER_MAX_VOICES; tunable from the game thread
+
+	// Stats for overlays, written by the mixing thread
+	atomic_int activeVoices;
+	atomic_uint droppedTriggers;	// No free voice or command queue full
+	atomic_uint mergedTriggers;	// Same clip triggered twice within one buffer
+
+	AudioStream stream;
+} Mixer;
+
+bool InitMixer(Mixer *mixer, int sampleRate);
+void UnloadMixer(Mixer *mixer);
+// Both return the clip id, -1 on failure
+int LoadMixerClip(Mixer *mixer, Wave wave);	// Converts and resamples as needed
+int LoadMixerClipSamples(Mixer *mixer, float *samples, int frames);	// Takes ownership of already converted samples
+bool CompressMixerClip(Mixer *mixer, int clip);	// Re-encodes a loaded clip as ADPCM, before the stream starts
+int GetMixerClipMemory(const Mixer *mixer, int clip);	// Bytes held for the clip's audio data
+void TraceMixerClips(const Mixer *mixer);	// Memory report, one log line per clip
+
+void PlayMixerClip(Mixer *mixer, int clip, float gain, float pan);	// Game thread
+void MixAudio(Mixer *mixer, float *out, int frames);	// Mixing thread, `out` is frames*2 floats
+
+// Routes the mixer into a raylib AudioStream callback. raylib callbacks carry no
+// user pointer, so only one mixer can be attached at a time.
+void StartMixerStream(Mixer *mixer);
+void StopMixerStream(Mixer *mixer);
+
+#endif
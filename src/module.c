@@ -0,0 +1,128 @@
+#include "module.h"
+
+#if !defined(_WIN32)
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <dlfcn.h>
+
+static long long GetModTimeNs(const char *path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0) return -1;
+	return (long long)st.st_mtim.tv_sec*1000000000LL + st.st_mtim.tv_nsec;
+}
+
+static bool CopyModuleFile(const char *from, const char *to)
+{
+	FILE *in = fopen(from, "rb");
+	if (in == NULL) return false;
+	FILE *out = fopen(to, "wb");
+	if (out == NULL)
+	{
+		fclose(in);
+		return false;
+	}
+
+	char buffer[1 << 16];
+	size_t n;
+	bool ok = true;
+	while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) ok &= (fwrite(buffer, 1, n, out) == n);
+	ok &= !ferror(in);
+
+	fclose(in);
+	return (fclose(out) == 0) && ok;
+}
+
+// Opens a private copy of the current build and checks its entry point
+static bool OpenModule(GameModule *module, void **handle, const GameplayApi **api)
+{
+	char copy[1024];
+	snprintf(copy, sizeof(copy), "%s.live%i", module->path, module->generation++);
+	// Remembered even if the build turns out broken, so it is not retried on every poll
+	module->modTime = GetModTimeNs(module->path);
+	module->pendingModTime = module->modTime;
+
+	if (!CopyModuleFile(module->path, copy))
+	{
+		TraceLog(LOG_WARNING, "MODULE: [%s] Could not copy to %s", module->path, copy);
+		return false;
+	}
+
+	*handle = dlopen(copy, RTLD_NOW | RTLD_LOCAL);
+	remove(copy);	// The mapping stays valid after the file is gone
+	if (*handle == NULL)
+	{
+		TraceLog(LOG_WARNING, "MODULE: [%s] %s", module->path, dlerror());
+		return false;
+	}
+
+	GetGameplayApiFunc getApi = (GetGameplayApiFunc)dlsym(*handle, "GetGameplayApi");
+	*api = (getApi != NULL)? getApi() : NULL;
+	if (*api == NULL || (*api)->version != GAMEPLAY_API_VERSION)
+	{
+		TraceLog(LOG_WARNING, "MODULE: [%s] Missing GetGameplayApi or API version mismatch", module->path);
+		dlclose(*handle);
+		return false;
+	}
+
+	// The host reads the world for saves, replays and audio, so it has to agree on the layout too
+	if ((*api)->layout != GetGameStateLayout())
+	{
+		TraceLog(LOG_WARNING, "MODULE: [%s] GameState layout %08x, host has %08x, restart to pick it up", module->path, (*api)->layout, GetGameStateLayout());
+		dlclose(*handle);
+		return false;
+	}
+
+	return true;
+}
+
+bool LoadGameModule(GameModule *module, const char *path)
+{
+	*module = (GameModule){ .path = path };
+	return OpenModule(module, &module->handle, &module->api);
+}
+
+void UnloadGameModule(GameModule *module)
+{
+	if (module->handle != NULL) dlclose(module->handle);
+	module->handle = NULL;
+	module->api = NULL;
+}
+
+bool IsGameModuleChanged(GameModule *module)
+{
+	long long modTime = GetModTimeNs(module->path);
+	if (modTime < 0 || modTime == module->modTime) return false;
+
+	bool settled = (modTime == module->pendingModTime);
+	module->pendingModTime = modTime;
+	return settled;
+}
+
+bool ReloadGameModule(GameModule *module, GameState *state, const GameHost *host)
+{
+	long long oldModTime = module->modTime;
+	void *handle;
+	const GameplayApi *api;
+	if (!OpenModule(module, &handle, &api)) return false;
+
+	// The state was created by an earlier module, a rebuilt one changing its layout needs a restart
+	if (api->layout != state->layout)
+	{
+		TraceLog(LOG_WARNING, "MODULE: [%s] GameState layout changed (%08x -> %08x), restart to pick it up",
+			module->path, state->layout, api->layout);
+		dlclose(handle);
+		return false;
+	}
+
+	dlclose(module->handle);
+	module->handle = handle;
+	module->api = api;
+	api->reload(state, host);
+
+	TraceLog(LOG_INFO, "MODULE: [%s] Reloaded (build %.3f s newer)", module->path, (module->modTime - oldModTime)/1e9);
+	return true;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef MODULE_H
+#define MODULE_H
+
+#include "gameplay.h"
+
+// Host side of the hot reloadable gameplay library (POSIX only). Each load dlopens
+// a private copy of the built file, so the linker can overwrite the original while
+// the game is running and the loader never caches a stale image.
+typedef struct GameModule {
+	void *handle;
+	const GameplayApi *api;
+	const char *path;	// The module as the build writes it
+	long long modTime;	// Of the loaded build, in ns
+	long long pendingModTime;	// A newer build seen on the last poll
+	int generation;	// Loads so far, names the private copy
+} GameModule;
+
+bool LoadGameModule(GameModule *module, const char *path);
+void UnloadGameModule(GameModule *module);
+// True once a newer build has stayed unchanged for two polls, so a half written file is never loaded
+bool IsGameModuleChanged(GameModule *module);
+// Swaps in the current build and hands it the existing state. Keeps the old module on any failure.
+bool ReloadGameModule(GameModule *module, GameState *state, const GameHost *host);
+
+#endif
@@ -0,0 +1,75 @@
+#include "parallax.h"
+#include "rng.h"
+
+#include <math.h>
+
+int AddParallaxLayer(Parallax *parallax, Texture2D texture, Vector2 factor, Vector2 drift, Color tint, bool mirrored)
+{
+	if (parallax->count == PARALLAX_MAX_LAYERS)
+	{
+		TraceLog(LOG_WARNING, "PARALLAX: Too many layers");
+		return -1;
+	}
+
+	parallax->layers[parallax->count] = (ParallaxLayer){ texture, factor, drift, tint, mirrored, 0.0, 0.0 };
+	return parallax->count++;
+}
+
+// Into [0, period), fmod() keeps the sign of its first argument
+static double WrapOffset(double offset, double period)
+{
+	if (period <= 0.0) return 0.0;
+	offset = fmod(offset, period);
+	return (offset < 0.0)? offset + period : offset;
+}
+
+void ScrollParallax(Parallax *parallax, double cameraDeltaX, double cameraDeltaY, double deltaTime)
+{
+	for (int i = 0; i < parallax->count; i++)
+	{
+		ParallaxLayer *layer = &parallax->layers[i];
+		double periodX = (double)layer->texture.width*(layer->mirrored? 2 : 1);
+		double periodY = (double)layer->texture.height*(layer->mirrored? 2 : 1);
+		layer->offsetX = WrapOffset(layer->offsetX + cameraDeltaX*layer->factor.x + layer->drift.x*deltaTime, periodX);
+		layer->offsetY = WrapOffset(layer->offsetY + cameraDeltaY*layer->factor.y + layer->drift.y*deltaTime, periodY);
+	}
+}
+
+void DrawParallax(const Parallax *parallax, SpriteBatch *batch, Rectangle screen)
+{
+	for (int i = 0; i < parallax->count; i++)
+	{
+		const ParallaxLayer *layer = &parallax->layers[i];
+		if (layer->texture.width <= 0 || layer->texture.height <= 0) continue;
+
+		float w = (float)layer->texture.width, h = (float)layer->texture.height;
+		Rectangle uv = { (float)(layer->offsetX/w), (float)(layer->offsetY/h), screen.width/w, screen.height/h };
+		PushSpriteQuadUV(batch, layer->texture, screen, uv, layer->tint);
+	}
+}
+
+Image GenStarLayerImage(int width, int height, int stars, unsigned int seed, Color color)
+{
+	Image image = GenImageColor(width, height, BLANK);
+	Color *pixels = image.data;
+	Rng rng = SeedRng(seed);
+
+	for (int i = 0; i < stars; i++)
+	{
+		int x = (int)(NextRng(&rng)%(unsigned int)width), y = (int)(NextRng(&rng)%(unsigned int)height);
+		float brightness = 0.35f + 0.65f*NextRngFloat(&rng);
+		Color star = { (unsigned char)(color.r*brightness), (unsigned char)(color.g*brightness), (unsigned char)(color.b*brightness), color.a };
+		pixels[y*width + x] = star;
+
+		// One in eight is bigger, its other pixels wrap around like the texture will
+		if (NextRng(&rng)%8 == 0)
+		{
+			int x1 = (x + 1)%width, y1 = (y + 1)%height;
+			pixels[y*width + x1] = star;
+			pixels[y1*width + x] = star;
+			pixels[y1*width + x1] = star;
+		}
+	}
+
+	return image;
+}
@@ -0,0 +1,38 @@
+#ifndef PARALLAX_H
+#define PARALLAX_H
+
+#include "raylib.h"
+#include "spritebatch.h"
+
+// Backdrop layers that scroll at their own share of the camera's movement. Each layer is
+// one quad over the whole screen whose texture coordinates run past the texture's edge,
+// so the GPU repeats it instead of the game drawing it tile by tile. Offsets only ever
+// move by deltas and are wrapped to the texture as they go, so however far the camera
+// travels the coordinates handed to the GPU stay small and exact.
+// Textures need a repeating wrap mode, mirrored for images that do not tile by themselves.
+
+#define PARALLAX_MAX_LAYERS 8
+
+typedef struct ParallaxLayer {
+	Texture2D texture;
+	Vector2 factor;	// Of the camera's movement, 0 stays put, 1 moves with the world
+	Vector2 drift;	// Pixels per second of its own
+	Color tint;
+	bool mirrored;	// Wrapped with TEXTURE_WRAP_MIRROR_REPEAT, which repeats every two sizes
+	double offsetX;	// Pixels into the texture, within one wrap period
+	double offsetY;
+} ParallaxLayer;
+
+typedef struct Parallax {
+	ParallaxLayer layers[PARALLAX_MAX_LAYERS];	// Back to front
+	int count;
+} Parallax;
+
+int AddParallaxLayer(Parallax *parallax, Texture2D texture, Vector2 factor, Vector2 drift, Color tint, bool mirrored);	// -1 when full
+void ScrollParallax(Parallax *parallax, double cameraDeltaX, double cameraDeltaY, double deltaTime);
+void DrawParallax(const Parallax *parallax, SpriteBatch *batch, Rectangle screen);	// One quad per layer
+
+// Single and double pixel stars on transparent black, wrapping at the edges so the image tiles
+Image GenStarLayerImage(int width, int height, int stars, unsigned int seed, Color color);
+
+#endif
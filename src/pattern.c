@@ -0,0 +1,403 @@
+#include "pattern.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PATTERN_AIM_REGISTER 0
+#define PATTERN_MAX_TOKENS 6
+#define PATTERN_MAX_NAME 31
+
+typedef struct PatternCompiler {
+	BulletPattern *pattern;
+	char names[PATTERN_REGISTERS][PATTERN_MAX_NAME + 1];	// Empty for counters and constants
+	bool constant[PATTERN_REGISTERS];
+	int loopStarts[PATTERN_MAX_DEPTH];
+	int loopCounters[PATTERN_MAX_DEPTH];	// -1 for forever
+	int depth;
+	int line;
+} PatternCompiler;
+
+static bool PatternError(PatternCompiler *c, const char *message, const char *token)
+{
+	TraceLog(LOG_WARNING, "PATTERN: Line %i: %s%s%s", c->line, message, token? " " : "", token? token : "");
+	return false;
+}
+
+static int AddPatternRegister(PatternCompiler *c, const char *name, float value, bool constant)
+{
+	BulletPattern *p = c->pattern;
+	if (p->registerCount == PATTERN_REGISTERS) return -1;
+
+	int r = p->registerCount++;
+	snprintf(c->names[r], sizeof(c->names[r]), "%s", name);
+	c->constant[r] = constant;
+	p->initial[r] = value;
+	return r;
+}
+
+static int FindPatternVariable(const PatternCompiler *c, const char *name)
+{
+	for (int r = 0; r < c->pattern->registerCount; r++)
+	{
+		if (!c->constant[r] && c->names[r][0] != '\0' && strcmp(c->names[r], name) == 0) return r;
+	}
+	return -1;
+}
+
+// A number becomes a constant register, shared by every use of the same value
+static bool ReadPatternOperand(PatternCompiler *c, const char *token, int *r)
+{
+	char *end;
+	float value = strtof(token, &end);
+	if (end != token && *end == '\0')
+	{
+		for (int i = 0; i < c->pattern->registerCount; i++)
+		{
+			if (c->constant[i] && memcmp(&c->pattern->initial[i], &value, sizeof(float)) == 0)
+			{
+				*r = i;
+				return true;
+			}
+		}
+		*r = AddPatternRegister(c, "", value, true);
+		return (*r >= 0)? true : PatternError(c, "Too many registers at", token);
+	}
+
+	*r = FindPatternVariable(c, token);
+	return (*r >= 0)? true : PatternError(c, "Unknown variable", token);
+}
+
+static bool ReadPatternTarget(PatternCompiler *c, const char *token, int *r)
+{
+	if (strcmp(token, "aim") == 0) return PatternError(c, "aim is read only", NULL);
+	if (strlen(token) > PATTERN_MAX_NAME || !((*token >= 'a' && *token <= 'z') || (*token >= 'A' && *token <= 'Z') || *token == '_'))
+	{
+		return PatternError(c, "Bad variable name", token);
+	}
+
+	*r = FindPatternVariable(c, token);
+	if (*r < 0) *r = AddPatternRegister(c, token, 0.0f, false);
+	return (*r >= 0)? true : PatternError(c, "Too many registers at", token);
+}
+
+static bool EmitPattern(PatternCompiler *c, PatternOp op, int a, int b, int d)
+{
+	BulletPattern *p = c->pattern;
+	if (p->codeCount == PATTERN_MAX_CODE) return PatternError(c, "Pattern too long", NULL);
+	p->code[p->codeCount++] = (unsigned int)op | (unsigned int)a << 8 | (unsigned int)b << 16 | (unsigned int)d << 24;
+	return true;
+}
+
+static bool EmitPatternJump(PatternCompiler *c, PatternOp op, int a, int target)
+{
+	return EmitPattern(c, op, a, target & 255, target >> 8);
+}
+
+static bool CompilePatternLine(PatternCompiler *c, char **tokens, int count)
+{
+	static const struct { const char *name; PatternOp op; int operands; bool target; } statements[] = {
+		{ "set", PATTERN_OP_MOVE, 2, true },
+		{ "add", PATTERN_OP_ADD, 3, true },
+		{ "sub", PATTERN_OP_SUB, 3, true },
+		{ "mul", PATTERN_OP_MUL, 3, true },
+		{ "fire", PATTERN_OP_FIRE, 2, false },
+		{ "ring", PATTERN_OP_RING, 3, false },
+		{ "burst", PATTERN_OP_BURST, 3, false },
+		{ "wait", PATTERN_OP_WAIT, 1, false },
+	};
+
+	if (strcmp(tokens[0], "repeat") == 0)
+	{
+		if (count > 2) return PatternError(c, "repeat takes at most one count", NULL);
+		if (c->depth == PATTERN_MAX_DEPTH) return PatternError(c, "Repeats nested too deep", NULL);
+
+		int counter = -1;
+		if (count == 2)
+		{
+			int n;
+			if (!ReadPatternOperand(c, tokens[1], &n)) return false;
+			counter = AddPatternRegister(c, "", 0.0f, false);
+			if (counter < 0) return PatternError(c, "Too many registers at", tokens[0]);
+			if (!EmitPattern(c, PATTERN_OP_MOVE, counter, n, 0)) return false;
+		}
+		c->loopStarts[c->depth] = c->pattern->codeCount;
+		c->loopCounters[c->depth++] = counter;
+		return true;
+	}
+
+	if (strcmp(tokens[0], "end") == 0)
+	{
+		if (count > 1) return PatternError(c, "end takes nothing", NULL);
+		if (c->depth == 0) return PatternError(c, "end without repeat", NULL);
+
+		c->depth--;
+		int counter = c->loopCounters[c->depth];
+		if (counter < 0) return EmitPatternJump(c, PATTERN_OP_JUMP, 0, c->loopStarts[c->depth]);
+		return EmitPatternJump(c, PATTERN_OP_LOOP, counter, c->loopStarts[c->depth]);
+	}
+
+	for (int i = 0; i < (int)(sizeof(statements)/sizeof(statements[0])); i++)
+	{
+		if (strcmp(tokens[0], statements[i].name) != 0) continue;
+		if (count - 1 != statements[i].operands) return PatternError(c, "Wrong operand count for", tokens[0]);
+
+		// Sources first, so `add x x 1` reads x before the target could declare it
+		int r[3] = { 0 };
+		int first = statements[i].target? 1 : 0;
+		for (int o = first; o < statements[i].operands; o++)
+		{
+			if (!ReadPatternOperand(c, tokens[1 + o], &r[o])) return false;
+		}
+		if (statements[i].target && !ReadPatternTarget(c, tokens[1], &r[0])) return false;
+
+		if (statements[i].op == PATTERN_OP_BURST) c->pattern->usesAim = true;
+		for (int o = first; o < statements[i].operands; o++)
+		{
+			if (r[o] == PATTERN_AIM_REGISTER) c->pattern->usesAim = true;
+		}
+		return EmitPattern(c, statements[i].op, r[0], r[1], r[2]);
+	}
+
+	return PatternError(c, "Unknown statement", tokens[0]);
+}
+
+bool CompileBulletPattern(const char *source, BulletPattern *pattern)
+{
+	memset(pattern, 0, sizeof(*pattern));
+	PatternCompiler c = { .pattern = pattern };
+	AddPatternRegister(&c, "aim", 0.0f, false);
+
+	const char *s = source;
+	while (*s != '\0')
+	{
+		c.line++;
+		char line[256];
+		size_t length = strcspn(s, "\n");
+		if (length >= sizeof(line))
+		{
+			pattern->codeCount = 0;
+			return PatternError(&c, "Line too long", NULL);
+		}
+		memcpy(line, s, length);
+		line[length] = '\0';
+		s += length + (s[length] == '\n');
+
+		char *comment = strchr(line, '#');
+		if (comment != NULL) *comment = '\0';
+
+		char *tokens[PATTERN_MAX_TOKENS];
+		int count = 0;
+		for (char *t = strtok(line, " \t\r"); t != NULL; t = strtok(NULL, " \t\r"))
+		{
+			if (count == PATTERN_MAX_TOKENS) break;
+			tokens[count++] = t;
+		}
+
+		if (count == PATTERN_MAX_TOKENS) PatternError(&c, "Too many operands", NULL);
+		if (count == PATTERN_MAX_TOKENS || (count > 0 && !CompilePatternLine(&c, tokens, count)))
+		{
+			pattern->codeCount = 0;
+			return false;
+		}
+	}
+
+	if (c.depth > 0)
+	{
+		pattern->codeCount = 0;
+		return PatternError(&c, "repeat without end", NULL);
+	}
+	if (!EmitPattern(&c, PATTERN_OP_HALT, 0, 0, 0))
+	{
+		pattern->codeCount = 0;
+		return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// Emitters
+//----------------------------------------------------------------------------------
+
+EmitterPool LoadEmitterPool(int capacity)
+{
+	EmitterPool pool = { 0 };
+	pool.capacity = capacity;
+	pool.patterns = calloc(capacity, sizeof(BulletPattern *));
+	pool.posX = calloc(capacity, sizeof(float));
+	pool.posY = calloc(capacity, sizeof(float));
+	pool.pc = calloc(capacity, sizeof(int));
+	pool.wait = calloc(capacity, sizeof(int));
+	pool.registers = calloc((size_t)capacity*PATTERN_REGISTERS, sizeof(float));
+	return pool;
+}
+
+void UnloadEmitterPool(EmitterPool *pool)
+{
+	free(pool->patterns);
+	free(pool->posX);
+	free(pool->posY);
+	free(pool->pc);
+	free(pool->wait);
+	free(pool->registers);
+	memset(pool, 0, sizeof(*pool));
+}
+
+int AddEmitter(EmitterPool *pool, const BulletPattern *pattern, Vector2 position)
+{
+	if (pool->count == pool->capacity || pattern->codeCount == 0) return -1;
+
+	int i = pool->count++;
+	pool->patterns[i] = pattern;
+	pool->posX[i] = position.x;
+	pool->posY[i] = position.y;
+	pool->pc[i] = 0;
+	pool->wait[i] = 0;
+	memcpy(&pool->registers[i*PATTERN_REGISTERS], pattern->initial, sizeof(pattern->initial));
+	return i;
+}
+
+void RemoveEmitter(EmitterPool *pool, int index)
+{
+	int last = --pool->count;
+	if (index == last) return;
+
+	pool->patterns[index] = pool->patterns[last];
+	pool->posX[index] = pool->posX[last];
+	pool->posY[index] = pool->posY[last];
+	pool->pc[index] = pool->pc[last];
+	pool->wait[index] = pool->wait[last];
+	memcpy(&pool->registers[index*PATTERN_REGISTERS], &pool->registers[last*PATTERN_REGISTERS], PATTERN_REGISTERS*sizeof(float));
+}
+
+static inline void SpawnPatternBullet(EmitterPool *pool, Entities *bullets, float x, float y, float degrees, float speed)
+{
+	float radians = degrees*DEG2RAD;
+	int i = SpawnEntity(bullets, ENTITY_BULLET, (Vector2){ x, y }, (Vector2){ cosf(radians)*speed, sinf(radians)*speed });
+	if (i < 0) pool->dropped++;
+	else pool->spawned++;
+}
+
+static inline int GetSpreadCount(float count)
+{
+	return (count < 1.0f)? 0 : (count > PATTERN_MAX_SPREAD)? PATTERN_MAX_SPREAD : (int)count;
+}
+
+// Runs one emitter until it waits or halts, returns the instructions it ran
+static int RunEmitter(EmitterPool *pool, int e, Entities *bullets, float x, float y)
+{
+	const unsigned int *code = pool->patterns[e]->code;
+	float *r = &pool->registers[e*PATTERN_REGISTERS];
+	int pc = pool->pc[e];
+	int budget = PATTERN_MAX_STEP;
+	int executed = 0;
+	unsigned int ins;
+
+#define PATTERN_A ((ins >> 8) & 255)
+#define PATTERN_B ((ins >> 16) & 255)
+#define PATTERN_C (ins >> 24)
+#define PATTERN_TARGET (ins >> 16)
+
+#if defined(__GNUC__)
+	static const void *labels[PATTERN_OP_COUNT] = {
+		[PATTERN_OP_HALT] = &&op_HALT, [PATTERN_OP_MOVE] = &&op_MOVE, [PATTERN_OP_ADD] = &&op_ADD,
+		[PATTERN_OP_SUB] = &&op_SUB, [PATTERN_OP_MUL] = &&op_MUL, [PATTERN_OP_FIRE] = &&op_FIRE,
+		[PATTERN_OP_RING] = &&op_RING, [PATTERN_OP_BURST] = &&op_BURST, [PATTERN_OP_WAIT] = &&op_WAIT,
+		[PATTERN_OP_LOOP] = &&op_LOOP, [PATTERN_OP_JUMP] = &&op_JUMP,
+	};
+	#define PATTERN_CASE(op) op_##op
+	#define PATTERN_NEXT() do { ins = code[pc++]; executed++; goto *labels[ins & 255]; } while (0)
+	PATTERN_NEXT();
+#else
+	#define PATTERN_CASE(op) case PATTERN_OP_##op
+	#define PATTERN_NEXT() goto dispatch
+dispatch:
+	ins = code[pc++];
+	executed++;
+	switch (ins & 255)
+#endif
+	{
+		PATTERN_CASE(MOVE):
+			r[PATTERN_A] = r[PATTERN_B];
+			PATTERN_NEXT();
+		PATTERN_CASE(ADD):
+			r[PATTERN_A] = r[PATTERN_B] + r[PATTERN_C];
+			PATTERN_NEXT();
+		PATTERN_CASE(SUB):
+			r[PATTERN_A] = r[PATTERN_B] - r[PATTERN_C];
+			PATTERN_NEXT();
+		PATTERN_CASE(MUL):
+			r[PATTERN_A] = r[PATTERN_B]*r[PATTERN_C];
+			PATTERN_NEXT();
+		PATTERN_CASE(FIRE):
+			SpawnPatternBullet(pool, bullets, x, y, r[PATTERN_A], r[PATTERN_B]);
+			PATTERN_NEXT();
+		PATTERN_CASE(RING):
+		{
+			int count = GetSpreadCount(r[PATTERN_A]);
+			float step = (count > 0)? 360.0f/count : 0.0f;
+			for (int i = 0; i < count; i++) SpawnPatternBullet(pool, bullets, x, y, r[PATTERN_B] + step*i, r[PATTERN_C]);
+			PATTERN_NEXT();
+		}
+		PATTERN_CASE(BURST):
+		{
+			int count = GetSpreadCount(r[PATTERN_A]);
+			float step = (count > 1)? r[PATTERN_B]/(count - 1) : 0.0f;
+			float first = r[PATTERN_AIM_REGISTER] - step*(count - 1)*0.5f;
+			for (int i = 0; i < count; i++) SpawnPatternBullet(pool, bullets, x, y, first + step*i, r[PATTERN_C]);
+			PATTERN_NEXT();
+		}
+		PATTERN_CASE(WAIT):
+			pool->wait[e] = (r[PATTERN_A] < 1.0f)? 1 : (int)r[PATTERN_A];
+			pool->pc[e] = pc;
+			return executed;
+		PATTERN_CASE(LOOP):
+			if (--r[PATTERN_A] > 0.0f) pc = (int)PATTERN_TARGET;
+			if (--budget == 0) goto yield;
+			PATTERN_NEXT();
+		PATTERN_CASE(JUMP):
+			pc = (int)PATTERN_TARGET;
+			if (--budget == 0) goto yield;
+			PATTERN_NEXT();
+		PATTERN_CASE(HALT):
+#if !defined(__GNUC__)
+		default:
+#endif
+			pool->pc[e] = -1;
+			return executed;
+	}
+
+	// Out of budget on a backward jump, carries on next tick
+yield:
+	pool->wait[e] = 1;
+	pool->pc[e] = pc;
+	return executed;
+
+#undef PATTERN_A
+#undef PATTERN_B
+#undef PATTERN_C
+#undef PATTERN_TARGET
+#undef PATTERN_CASE
+#undef PATTERN_NEXT
+}
+
+void StepEmitters(EmitterPool *pool, Vector2 target, Entities *bullets)
+{
+	Vector2 half = GetEntitySize(ENTITY_BULLET);
+	half.x *= 0.5f;
+	half.y *= 0.5f;
+	long long executed = 0;
+
+	for (int e = 0; e < pool->count; e++)
+	{
+		if (pool->pc[e] < 0) continue;
+		if (pool->wait[e] > 0 && --pool->wait[e] > 0) continue;
+
+		float x = pool->posX[e], y = pool->posY[e];
+		if (pool->patterns[e]->usesAim) pool->registers[e*PATTERN_REGISTERS + PATTERN_AIM_REGISTER] = atan2f(target.y - y, target.x - x)*RAD2DEG;
+		executed += RunEmitter(pool, e, bullets, x - half.x, y - half.y);
+	}
+
+	pool->instructions += executed;
+}
@@ -0,0 +1,79 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include "raylib.h"
+#include "entities.h"
+
+// Bullet patterns written as small scripts, one statement per line, `#` starts a comment:
+//   set x v             x = v, declaring x on first use
+//   add x a b           x = a + b, likewise sub and mul
+//   fire angle speed    one bullet, angles in degrees
+//   ring count angle speed       count bullets spread evenly around a circle
+//   burst count width speed      count bullets fanned over width degrees, centred on aim
+//   wait ticks
+//   repeat [n] ... end  n times (at least once), forever without n
+// Operands are numbers or variables; `aim` is the angle to the target, refreshed
+// whenever the emitter wakes up.
+// Scripts compile to register bytecode. Constants live in registers of their own, copied
+// in with the variables when an emitter starts, so no instruction has to tell a constant
+// from a register. The interpreter jumps straight from one handler to the next through a
+// table of label addresses where the compiler allows it.
+
+#define PATTERN_MAX_CODE 256
+#define PATTERN_REGISTERS 32	// Variables, loop counters and constants together
+#define PATTERN_MAX_DEPTH 8	// Nested repeats
+#define PATTERN_MAX_STEP 1024	// Instructions one emitter may run per tick, so a loop without a wait cannot hang
+#define PATTERN_MAX_SPREAD 256	// Bullets per ring or burst
+
+typedef enum PatternOp {
+	PATTERN_OP_HALT = 0,
+	PATTERN_OP_MOVE,	// a = b
+	PATTERN_OP_ADD,	// a = b + c
+	PATTERN_OP_SUB,
+	PATTERN_OP_MUL,
+	PATTERN_OP_FIRE,	// angle a, speed b
+	PATTERN_OP_RING,	// count a, angle b, speed c
+	PATTERN_OP_BURST,	// count a, width b, speed c around aim
+	PATTERN_OP_WAIT,	// a ticks
+	PATTERN_OP_LOOP,	// Decrements a and jumps to the 16 bit target while it stays above zero
+	PATTERN_OP_JUMP,
+	PATTERN_OP_COUNT,
+} PatternOp;
+
+// Instructions are op | a << 8 | b << 16 | c << 24, or op | a << 8 | target << 16 for jumps
+typedef struct BulletPattern {
+	unsigned int code[PATTERN_MAX_CODE];
+	int codeCount;
+	float initial[PATTERN_REGISTERS];	// Register values an emitter starts with, constants included
+	int registerCount;
+	bool usesAim;
+} BulletPattern;
+
+// Emitter state lives in preallocated arrays, nothing is allocated while they run
+typedef struct EmitterPool {
+	int count;
+	int capacity;
+	const BulletPattern **patterns;
+	float *posX;
+	float *posY;
+	int *pc;	// -1 once halted
+	int *wait;	// Ticks left before running again
+	float *registers;	// PATTERN_REGISTERS per emitter
+
+	// Totals since the pool was loaded
+	long long instructions;
+	long long spawned;
+	long long dropped;	// Bullets that did not fit in the entities
+} EmitterPool;
+
+bool CompileBulletPattern(const char *source, BulletPattern *pattern);	// Logs the line of the first error
+
+EmitterPool LoadEmitterPool(int capacity);
+void UnloadEmitterPool(EmitterPool *pool);
+int AddEmitter(EmitterPool *pool, const BulletPattern *pattern, Vector2 position);	// Returns -1 when full
+void RemoveEmitter(EmitterPool *pool, int index);	// Moves the last emitter into its slot
+
+// Runs every emitter that is due and spawns its bullets as ENTITY_BULLET centred on the emitter
+void StepEmitters(EmitterPool *pool, Vector2 target, Entities *bullets);
+
+#endif
@@ -0,0 +1,129 @@
+#include "queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int RoundUpPow2(int value)
+{
+	unsigned int n = 1;
+	while (n < (unsigned int)value) n <<= 1;
+	return n;
+}
+
+//----------------------------------------------------------------------------------
+// SPSC
+//----------------------------------------------------------------------------------
+bool InitSpscQueue(SpscQueue *queue, int capacity, int elementSize)
+{
+	memset(queue, 0, sizeof(*queue));
+	unsigned int size = RoundUpPow2(capacity);
+	queue->buffer = malloc((size_t)size*elementSize);
+	if (queue->buffer == NULL) return false;
+
+	queue->mask = size - 1;
+	queue->elementSize = elementSize;
+	return true;
+}
+
+void FreeSpscQueue(SpscQueue *queue)
+{
+	free(queue->buffer);
+	queue->buffer = NULL;
+}
+
+bool PushSpsc(SpscQueue *queue, const void *element)
+{
+	unsigned int tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+	if (tail - queue->cachedHead > queue->mask)
+	{
+		queue->cachedHead = atomic_load_explicit(&queue->head, memory_order_acquire);
+		if (tail - queue->cachedHead > queue->mask) return false;
+	}
+
+	memcpy(queue->buffer + (size_t)(tail & queue->mask)*queue->elementSize, element, queue->elementSize);
+	atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+bool PopSpsc(SpscQueue *queue, void *element)
+{
+	unsigned int head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+	if (head == queue->cachedTail)
+	{
+		queue->cachedTail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+		if (head == queue->cachedTail) return false;
+	}
+
+	memcpy(element, queue->buffer + (size_t)(head & queue->mask)*queue->elementSize, queue->elementSize);
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+	return true;
+}
+
+//----------------------------------------------------------------------------------
+// MPSC
+//----------------------------------------------------------------------------------
+static inline atomic_uint *GetSlotSequence(MpscQueue *queue, unsigned int index)
+{
+	return (atomic_uint *)(queue->slots + (size_t)(index & queue->mask)*queue->stride);
+}
+
+bool InitMpscQueue(MpscQueue *queue, int capacity, int elementSize)
+{
+	memset(queue, 0, sizeof(*queue));
+	unsigned int size = RoundUpPow2(capacity);
+	queue->stride = (int)((sizeof(atomic_uint) + elementSize + 7) & ~7u);
+	queue->slots = malloc((size_t)size*queue->stride);
+	if (queue->slots == NULL) return false;
+
+	queue->mask = size - 1;
+	queue->elementSize = elementSize;
+	// A slot is free for the producer whose position equals its sequence
+	for (unsigned int i = 0; i < size; i++) atomic_init(GetSlotSequence(queue, i), i);
+	return true;
+}
+
+void FreeMpscQueue(MpscQueue *queue)
+{
+	free(queue->slots);
+	queue->slots = NULL;
+}
+
+bool PushMpsc(MpscQueue *queue, const void *element)
+{
+	unsigned int pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+	while (true)
+	{
+		atomic_uint *sequence = GetSlotSequence(queue, pos);
+		int diff = (int)(atomic_load_explicit(sequence, memory_order_acquire) - pos);
+
+		if (diff == 0)
+		{
+			if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+			{
+				memcpy((unsigned char *)sequence + sizeof(atomic_uint), element, queue->elementSize);
+				atomic_store_explicit(sequence, pos + 1, memory_order_release);
+				return true;
+			}
+			// pos was reloaded by the failed CAS
+		}
+		else if (diff < 0) return false;	// The consumer has not freed this slot yet: full
+		else pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	}
+}
+
+bool PopMpsc(MpscQueue *queue, void *element)
+{
+	unsigned int pos = queue->head;
+	atomic_uint *sequence = GetSlotSequence(queue, pos);
+
+	if (atomic_load_explicit(sequence, memory_order_acquire) != pos + 1) return false;
+
+	memcpy(element, (unsigned char *)sequence + sizeof(atomic_uint), queue->elementSize);
+	// Hand the slot to the producer that will reach it one lap later
+	atomic_store_explicit(sequence, pos + queue->mask + 1, memory_order_release);
+	queue->head = pos + 1;
+	return true;
+}
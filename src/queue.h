@@ -0,0 +1,45 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define QUEUE_CACHE_LINE 64
+
+// Bounded lock-free ring queues of fixed-size elements. Capacity is rounded up
+// to a power of two. Push fails when full and pop fails when empty, neither blocks.
+
+// Single producer, single consumer. Each side keeps a private copy of the other
+// side's index and only rereads the shared one when the copy says full/empty.
+typedef struct SpscQueue {
+	_Alignas(QUEUE_CACHE_LINE) atomic_uint head;	// Next slot to pop, written by the consumer
+	unsigned int cachedTail;	// Consumer's view of tail
+	_Alignas(QUEUE_CACHE_LINE) atomic_uint tail;	// Next slot to push, written by the producer
+	unsigned int cachedHead;	// Producer's view of head
+	_Alignas(QUEUE_CACHE_LINE) unsigned int mask;
+	int elementSize;
+	unsigned char *buffer;
+} SpscQueue;
+
+bool InitSpscQueue(SpscQueue *queue, int capacity, int elementSize);
+void FreeSpscQueue(SpscQueue *queue);
+bool PushSpsc(SpscQueue *queue, const void *element);
+bool PopSpsc(SpscQueue *queue, void *element);
+
+// Multiple producers, single consumer, with a sequence number per slot so
+// producers only contend on the tail counter (Vyukov's bounded queue).
+typedef struct MpscQueue {
+	_Alignas(QUEUE_CACHE_LINE) atomic_uint tail;	// Claimed by producers with a CAS
+	_Alignas(QUEUE_CACHE_LINE) unsigned int head;	// Consumer only
+	_Alignas(QUEUE_CACHE_LINE) unsigned int mask;
+	int elementSize;
+	int stride;	// Slot size: sequence number plus element, rounded to 8 bytes
+	unsigned char *slots;
+} MpscQueue;
+
+bool InitMpscQueue(MpscQueue *queue, int capacity, int elementSize);
+void FreeMpscQueue(MpscQueue *queue);
+bool PushMpsc(MpscQueue *queue, const void *element);
+bool PopMpsc(MpscQueue *queue, void *element);
+
+#endif
@@ -0,0 +1,129 @@
+#include "replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// File layout: magic, version, tick count, snapshot size, snapshot bytes,
+// then 3 bytes per tick (moveX and moveY as signed 1/127 steps, fire flag)
+
+typedef struct ReplayFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t snapshotSize;
+} ReplayFileHeader;
+
+static signed char QuantizeAxis(float v)
+{
+	if (v > 1.0f) v = 1.0f;
+	if (v < -1.0f) v = -1.0f;
+	return (signed char)(v*127.0f + ((v < 0)? -0.5f : 0.5f));
+}
+
+Replay BeginReplay(const World *world)
+{
+	Replay replay = { 0 };
+	EncodeSnapshot(world, NULL, SNAPSHOT_LZ, &replay.start);
+	return replay;
+}
+
+PlayerInput RecordReplayInput(Replay *replay, PlayerInput input)
+{
+	// Snap to what the file can represent so recording and playback simulate the same thing
+	input.moveX = QuantizeAxis(input.moveX)/127.0f;
+	input.moveY = QuantizeAxis(input.moveY)/127.0f;
+
+	if (replay->count == replay->capacity)
+	{
+		int capacity = replay->capacity? replay->capacity*2 : 1024;
+		PlayerInput *inputs = realloc(replay->inputs, capacity*sizeof(PlayerInput));
+		if (inputs == NULL) return input;
+		replay->inputs = inputs;
+		replay->capacity = capacity;
+	}
+
+	replay->inputs[replay->count++] = input;
+	return input;
+}
+
+bool SaveReplay(const Replay *replay, const char *fileName)
+{
+	ReplayFileHeader header = { REPLAY_MAGIC, REPLAY_VERSION, (uint32_t)replay->count, (uint32_t)replay->start.dataSize };
+	int size = (int)sizeof(header) + replay->start.dataSize + 3*replay->count;
+	unsigned char *data = malloc(size);
+	if (data == NULL) return false;
+
+	unsigned char *p = data;
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	memcpy(p, replay->start.data, replay->start.dataSize);
+	p += replay->start.dataSize;
+
+	for (int i = 0; i < replay->count; i++)
+	{
+		*p++ = (unsigned char)QuantizeAxis(replay->inputs[i].moveX);
+		*p++ = (unsigned char)QuantizeAxis(replay->inputs[i].moveY);
+		*p++ = replay->inputs[i].fire;
+	}
+
+	bool ok = SaveFileData(fileName, data, size);
+	free(data);
+	return ok;
+}
+
+bool LoadReplay(const char *fileName, Replay *replay)
+{
+	int size = 0;
+	unsigned char *data = LoadFileData(fileName, &size);
+	if (data == NULL) return false;
+
+	ReplayFileHeader header = { 0 };
+	if (size >= (int)sizeof(header)) memcpy(&header, data, sizeof(header));
+
+	if (header.magic != REPLAY_MAGIC || header.version != REPLAY_VERSION ||
+		(long long)sizeof(header) + header.snapshotSize + 3LL*header.count > size)
+	{
+		TraceLog(LOG_WARNING, "REPLAY: [%s] Not a valid replay file", fileName);
+		UnloadFileData(data);
+		return false;
+	}
+
+	*replay = (Replay){ 0 };
+	const unsigned char *p = data + sizeof(header);
+	bool ok = DecodeSnapshot(p, (int)header.snapshotSize, NULL, &replay->start);
+	p += header.snapshotSize;
+
+	replay->inputs = malloc((header.count? header.count : 1)*sizeof(PlayerInput));
+	replay->count = replay->capacity = (int)header.count;
+	for (int i = 0; ok && i < replay->count; i++, p += 3)
+	{
+		replay->inputs[i].moveX = (signed char)p[0]/127.0f;
+		replay->inputs[i].moveY = (signed char)p[1]/127.0f;
+		replay->inputs[i].fire = p[2] != 0;
+	}
+
+	UnloadFileData(data);
+	if (!ok) UnloadReplay(replay);
+	return ok;
+}
+
+void UnloadReplay(Replay *replay)
+{
+	UnloadSnapshot(&replay->start);
+	free(replay->inputs);
+	memset(replay, 0, sizeof(*replay));
+}
+
+PlayerInput GetScriptedInput(unsigned int seed, unsigned int tick)
+{
+	static const float dirs[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+
+	// New heading and trigger state twice a second, derived from the tick so any tick can be sampled
+	Rng rng = SeedRng(seed ^ ((tick/30 + 1)*0x9e3779b9u));
+	NextRng(&rng);
+	int dir = (int)(NextRng(&rng)%8);
+	bool firing = (NextRng(&rng)&1) != 0;
+
+	return (PlayerInput){ dirs[dir][0], dirs[dir][1], firing };
+}
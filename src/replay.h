@@ -0,0 +1,28 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "game.h"
+#include "snapshot.h"
+
+#define REPLAY_MAGIC 0x50524b44	// "DKRP"
+#define REPLAY_VERSION 1
+
+// A keyframe snapshot plus one input per tick. Since the simulation is
+// deterministic that is enough to reproduce a whole session headlessly.
+typedef struct Replay {
+	Snapshot start;
+	PlayerInput *inputs;
+	int count;
+	int capacity;
+} Replay;
+
+Replay BeginReplay(const World *world);
+PlayerInput RecordReplayInput(Replay *replay, PlayerInput input);	// Returns the input as it will play back
+bool SaveReplay(const Replay *replay, const char *fileName);
+bool LoadReplay(const char *fileName, Replay *replay);
+void UnloadReplay(Replay *replay);
+
+// Deterministic wandering and shooting, used when there is no recording to play back
+PlayerInput GetScriptedInput(unsigned int seed, unsigned int tick);
+
+#endif
@@ -0,0 +1,118 @@
+#include "resample.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RESAMPLE_PI 3.14159265358979323846
+
+#define RESAMPLE_TAPS 32	// Per phase, half on each side of the output position
+#define RESAMPLE_MAX_PHASES 1024	// Rates with a huge ratio get their phase quantised to this
+
+static int Gcd(int a, int b)
+{
+	while (b != 0)
+	{
+		int t = a%b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static double Sinc(double x)
+{
+	return (fabs(x) < 1e-9)? 1.0 : sin(RESAMPLE_PI*x)/(RESAMPLE_PI*x);
+}
+
+float *ResampleAudio(const float *in, int frames, int inRate, int outRate, int *outFrames)
+{
+	int g = Gcd(inRate, outRate);
+	int up = outRate/g;	// L: output positions per input step
+	int down = inRate/g;	// M
+	int phases = (up < RESAMPLE_MAX_PHASES)? up : RESAMPLE_MAX_PHASES;
+
+	int count = (int)(((long long)frames*up + down - 1)/down);
+	int padded = (count + 3) & ~3;
+	float *out = calloc(padded, sizeof(float));
+	float *bank = malloc((size_t)phases*RESAMPLE_TAPS*sizeof(float));
+	if (out == NULL || bank == NULL)
+	{
+		free(out);
+		free(bank);
+		return NULL;
+	}
+
+	// Lowpass at the lower of the two Nyquist rates to avoid aliasing when downsampling
+	double cutoff = (up < down)? (double)up/down : 1.0;
+	cutoff *= 0.95;	// Leave room for the transition band
+
+	for (int p = 0; p < phases; p++)
+	{
+		double frac = (double)p/phases;
+		double sum = 0.0;
+		float *h = bank + p*RESAMPLE_TAPS;
+
+		for (int k = 0; k < RESAMPLE_TAPS; k++)
+		{
+			double x = (k - (RESAMPLE_TAPS/2 - 1)) - frac;	// Distance of tap k from the output position
+			double w = 0.42 + 0.5*cos(RESAMPLE_PI*x/(RESAMPLE_TAPS/2)) + 0.08*cos(2.0*RESAMPLE_PI*x/(RESAMPLE_TAPS/2));	// Blackman
+			double v = cutoff*Sinc(cutoff*x)*((fabs(x) < RESAMPLE_TAPS/2)? w : 0.0);
+			h[k] = (float)v;
+			sum += v;
+		}
+		// Unity DC gain for every phase, otherwise the phase pattern becomes audible as a tone
+		for (int k = 0; k < RESAMPLE_TAPS; k++) h[k] = (float)(h[k]/sum);
+	}
+
+	for (int n = 0; n < count; n++)
+	{
+		long long position = (long long)n*down;
+		int base = (int)(position/up);
+		int phase = (int)((position%up)*phases/up);
+		const float *h = bank + phase*RESAMPLE_TAPS;
+		int first = base - (RESAMPLE_TAPS/2 - 1);
+		float acc = 0.0f;
+
+		if (first >= 0 && first + RESAMPLE_TAPS <= frames)
+		{
+			for (int k = 0; k < RESAMPLE_TAPS; k++) acc += in[first + k]*h[k];
+		}
+		else
+		{
+			// Edges: treat samples outside the clip as silence
+			for (int k = 0; k < RESAMPLE_TAPS; k++)
+			{
+				int i = first + k;
+				if (i >= 0 && i < frames) acc += in[i]*h[k];
+			}
+		}
+		out[n] = acc;
+	}
+
+	free(bank);
+	*outFrames = count;
+	return out;
+}
+
+float *LoadWaveMonoSamples(const void *waveData, int frames, int sampleSize, int channels)
+{
+	float *out = calloc((frames + 3) & ~3, sizeof(float));
+	if (out == NULL) return NULL;
+
+	float scale = 1.0f/channels;
+	for (int i = 0; i < frames; i++)
+	{
+		float sum = 0.0f;
+		for (int c = 0; c < channels; c++)
+		{
+			int s = i*channels + c;
+			if (sampleSize == 8) sum += (((const unsigned char *)waveData)[s] - 128)/128.0f;
+			else if (sampleSize == 16) sum += ((const short *)waveData)[s]/32768.0f;
+			else sum += ((const float *)waveData)[s];
+		}
+		out[i] = sum*scale;
+	}
+
+	return out;
+}
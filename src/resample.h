@@ -0,0 +1,12 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+
+// Offline sample rate conversion with a polyphase windowed-sinc filter, meant for
+// converting clips once at import so nothing resamples on the audio thread.
+// Returns malloc'd mono samples padded with silence to a multiple of 4 frames.
+float *ResampleAudio(const float *in, int frames, int inRate, int outRate, int *outFrames);
+
+// Mono float samples from any 8/16/32 bit wave, downmixing extra channels. Free with free().
+float *LoadWaveMonoSamples(const void *waveData, int frames, int sampleSize, int channels);
+
+#endif
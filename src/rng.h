@@ -0,0 +1,28 @@
+#ifndef RNG_H
+#define RNG_H
+
+// xorshift32, small enough to snapshot and replay bit-exactly
+typedef struct Rng {
+	unsigned int state;
+} Rng;
+
+static inline Rng SeedRng(unsigned int seed)
+{
+	return (Rng){ seed? seed : 0x9e3779b9u };
+}
+
+static inline unsigned int NextRng(Rng *rng)
+{
+	unsigned int x = rng->state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return rng->state = x;
+}
+
+static inline float NextRngFloat(Rng *rng)
+{
+	return (NextRng(rng) >> 8)*(1.0f/16777216.0f);
+}
+
+#endif
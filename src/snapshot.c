@@ -0,0 +1,485 @@
+#include "snapshot.h"
+#include "lz.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Encoded layout:
+//   SnapshotFileHeader
+//   payload: tokens of [varint zeroWords][u16 literalWords][literalWords*8 bytes]
+// The token stream runs over the raw layout XORed with the base snapshot (or with
+// zero for keyframes), so unchanged components collapse into a few bytes.
+// With SNAPSHOT_LZ the token stream is LZ compressed as a whole.
+//
+// Raw layout, every section padded to 8 bytes:
+//   SnapshotRawHeader, tiles, posX, posY, velX, velY, health, kind,
+//   swarm posX, posY, velX, velY
+
+typedef struct SnapshotFileHeader {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t flags;
+	uint32_t frame;
+	uint32_t baseFrame;
+	uint32_t rawSize;
+	uint32_t payloadSize;
+} SnapshotFileHeader;
+
+typedef struct SnapshotRawHeader {
+	uint32_t frame;
+	uint32_t rng;
+	uint32_t entityCount;
+	uint16_t mapWidth;
+	uint16_t mapHeight;
+	float facingX;
+	float facingY;
+	int32_t fireCooldown;
+	uint32_t swarmCount;
+} SnapshotRawHeader;
+
+enum {
+	SECTION_HEADER, SECTION_TILES, SECTION_POS_X, SECTION_POS_Y, SECTION_VEL_X, SECTION_VEL_Y, SECTION_HEALTH, SECTION_KIND,
+	SECTION_SWARM_POS_X, SECTION_SWARM_POS_Y, SECTION_SWARM_VEL_X, SECTION_SWARM_VEL_Y, SECTION_COUNT
+};
+
+typedef struct SnapshotLayout {
+	int offset[SECTION_COUNT];
+	int size[SECTION_COUNT];	// Padded size
+	int total;
+} SnapshotLayout;
+
+#define PAD8(x) (((x) + 7) & ~7)
+
+// Sizes come from files too, so they are added up in 64 bits; total is -1 when the layout
+// would be larger than SNAPSHOT_MAX_RAW_SIZE
+static SnapshotLayout GetSnapshotLayout(long long mapWidth, long long mapHeight, long long entityCount, long long swarmCount)
+{
+	SnapshotLayout layout = { .total = -1 };
+	if (entityCount > SNAPSHOT_MAX_RAW_SIZE || swarmCount > SNAPSHOT_MAX_RAW_SIZE) return layout;
+
+	long long sizes[SECTION_COUNT] = {
+		sizeof(SnapshotRawHeader),
+		mapWidth*mapHeight,
+		entityCount*(long long)sizeof(float),
+		entityCount*(long long)sizeof(float),
+		entityCount*(long long)sizeof(float),
+		entityCount*(long long)sizeof(float),
+		entityCount*(long long)sizeof(short),
+		entityCount,
+		swarmCount*(long long)sizeof(float),
+		swarmCount*(long long)sizeof(float),
+		swarmCount*(long long)sizeof(float),
+		swarmCount*(long long)sizeof(float),
+	};
+
+	long long total = 0;
+	for (int i = 0; i < SECTION_COUNT; i++) total += PAD8(sizes[i]);
+	if (total > SNAPSHOT_MAX_RAW_SIZE) return layout;
+
+	layout.total = 0;
+	for (int i = 0; i < SECTION_COUNT; i++)
+	{
+		layout.offset[i] = layout.total;
+		layout.size[i] = (int)PAD8(sizes[i]);
+		layout.total += layout.size[i];
+	}
+	return layout;
+}
+
+static SnapshotLayout GetRawLayout(const unsigned char *raw)
+{
+	SnapshotRawHeader header;
+	memcpy(&header, raw, sizeof(header));
+	return GetSnapshotLayout(header.mapWidth, header.mapHeight, header.entityCount, header.swarmCount);
+}
+
+static bool Reserve(unsigned char **buffer, int *capacity, int size)
+{
+	if (*capacity >= size) return true;
+
+	unsigned char *grown = realloc(*buffer, size);
+	if (grown == NULL) return false;
+	*buffer = grown;
+	*capacity = size;
+	return true;
+}
+
+static void WriteSection(unsigned char *raw, const SnapshotLayout *layout, int section, const void *src, int size)
+{
+	unsigned char *dst = raw + layout->offset[section];
+	memcpy(dst, src, size);
+	memset(dst + size, 0, layout->size[section] - size);
+}
+
+//----------------------------------------------------------------------------------
+// Zero-word run length coding
+//----------------------------------------------------------------------------------
+typedef struct RleWriter {
+	unsigned char *out;
+	int pos;
+	unsigned int zeroWords;
+	int literalHeader;	// Position of the open token's u16 literal count, -1 when none is open
+	int literalWords;
+} RleWriter;
+
+static void WriteVarint(RleWriter *w, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		w->out[w->pos++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	w->out[w->pos++] = (unsigned char)value;
+}
+
+static void CloseLiteral(RleWriter *w)
+{
+	if (w->literalHeader < 0) return;
+	w->out[w->literalHeader] = (unsigned char)(w->literalWords & 0xff);
+	w->out[w->literalHeader + 1] = (unsigned char)(w->literalWords >> 8);
+	w->literalHeader = -1;
+	w->literalWords = 0;
+}
+
+static inline void PushWord(RleWriter *w, uint64_t word)
+{
+	if (word == 0)
+	{
+		CloseLiteral(w);
+		w->zeroWords++;
+		return;
+	}
+
+	if (w->literalHeader < 0 || w->literalWords == 0xffff)
+	{
+		CloseLiteral(w);
+		WriteVarint(w, w->zeroWords);
+		w->zeroWords = 0;
+		w->literalHeader = w->pos;
+		w->pos += 2;
+	}
+
+	memcpy(w->out + w->pos, &word, 8);
+	w->pos += 8;
+	w->literalWords++;
+}
+
+static void FinishRle(RleWriter *w)
+{
+	CloseLiteral(w);
+	if (w->zeroWords > 0)
+	{
+		WriteVarint(w, w->zeroWords);
+		w->out[w->pos++] = 0;
+		w->out[w->pos++] = 0;
+	}
+}
+
+// XOR `cur` against `base` (zero beyond the base length) and feed the result to the writer
+static void PushDeltaSection(RleWriter *w, const unsigned char *cur, int size, const unsigned char *base, int baseSize)
+{
+	int common = (base != NULL)? ((size < baseSize)? size : baseSize) : 0;
+	int i = 0;
+
+	for (; i < common; i += 8)
+	{
+		uint64_t a, b;
+		memcpy(&a, cur + i, 8);
+		memcpy(&b, base + i, 8);
+		PushWord(w, a ^ b);
+	}
+	for (; i < size; i += 8)
+	{
+		uint64_t a;
+		memcpy(&a, cur + i, 8);
+		PushWord(w, a);
+	}
+}
+
+static bool ReadRle(const unsigned char *in, int inSize, unsigned char *out, int outSize)
+{
+	int pos = 0, o = 0;
+
+	while (pos < inSize)
+	{
+		unsigned int zeroWords = 0;
+		int shift = 0;
+		while (true)
+		{
+			if (pos >= inSize || shift > 28) return false;
+			unsigned char b = in[pos++];
+			zeroWords |= (unsigned int)(b & 0x7f) << shift;
+			if (!(b & 0x80)) break;
+			shift += 7;
+		}
+		if (pos + 2 > inSize) return false;
+		int literalWords = in[pos] | (in[pos + 1] << 8);
+		pos += 2;
+
+		if ((long long)o + 8LL*zeroWords + 8LL*literalWords > outSize || pos + 8*literalWords > inSize) return false;
+		memset(out + o, 0, 8*(size_t)zeroWords);
+		o += 8*zeroWords;
+		memcpy(out + o, in + pos, 8*(size_t)literalWords);
+		o += 8*literalWords;
+		pos += 8*literalWords;
+	}
+
+	// Trailing zero words may be omitted entirely
+	memset(out + o, 0, outSize - o);
+	return true;
+}
+
+static void XorSection(unsigned char *cur, int size, const unsigned char *base, int baseSize)
+{
+	int common = (size < baseSize)? size : baseSize;
+	for (int i = 0; i < common; i += 8)
+	{
+		uint64_t a, b;
+		memcpy(&a, cur + i, 8);
+		memcpy(&b, base + i, 8);
+		a ^= b;
+		memcpy(cur + i, &a, 8);
+	}
+}
+
+//----------------------------------------------------------------------------------
+// Public API
+//----------------------------------------------------------------------------------
+bool EncodeSnapshot(const World *world, const Snapshot *base, int flags, Snapshot *out)
+{
+	const Entities *e = &world->entities;
+	const Swarm *swarm = &world->swarm;
+	SnapshotLayout layout = GetSnapshotLayout(world->map.width, world->map.height, e->count, swarm->count);
+
+	if (layout.total < 0 || !Reserve(&out->raw, &out->rawCapacity, layout.total)) return false;
+	out->rawSize = layout.total;
+	out->frame = world->frame;
+
+	SnapshotRawHeader header = {
+		.frame = world->frame,
+		.rng = world->rng.state,
+		.entityCount = (uint32_t)e->count,
+		.mapWidth = (uint16_t)world->map.width,
+		.mapHeight = (uint16_t)world->map.height,
+		.facingX = world->facing.x,
+		.facingY = world->facing.y,
+		.fireCooldown = world->fireCooldown,
+		.swarmCount = (uint32_t)swarm->count,
+	};
+	WriteSection(out->raw, &layout, SECTION_HEADER, &header, sizeof(header));
+	WriteSection(out->raw, &layout, SECTION_TILES, world->map.tiles, world->map.width*world->map.height);
+	WriteSection(out->raw, &layout, SECTION_POS_X, e->posX, e->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_POS_Y, e->posY, e->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_VEL_X, e->velX, e->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_VEL_Y, e->velY, e->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_HEALTH, e->health, e->count*sizeof(short));
+	WriteSection(out->raw, &layout, SECTION_KIND, e->kind, e->count);
+	WriteSection(out->raw, &layout, SECTION_SWARM_POS_X, swarm->posX, swarm->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_SWARM_POS_Y, swarm->posY, swarm->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_SWARM_VEL_X, swarm->velX, swarm->count*sizeof(float));
+	WriteSection(out->raw, &layout, SECTION_SWARM_VEL_Y, swarm->velY, swarm->count*sizeof(float));
+
+	bool delta = (base != NULL) && (base->raw != NULL) && (flags & SNAPSHOT_DELTA);
+	if (!delta) flags &= ~SNAPSHOT_DELTA;
+
+	// Worst case is all literals: one 3 byte token header per 65535 words
+	int bound = (int)sizeof(SnapshotFileHeader) + layout.total + layout.total/(8*0xffff)*3 + 16;
+	if (!Reserve(&out->data, &out->dataCapacity, bound)) return false;
+
+	RleWriter writer = { .out = out->data, .pos = sizeof(SnapshotFileHeader), .literalHeader = -1 };
+	SnapshotLayout baseLayout = delta? GetRawLayout(base->raw) : (SnapshotLayout){ 0 };
+
+	for (int s = 0; s < SECTION_COUNT; s++)
+	{
+		PushDeltaSection(&writer, out->raw + layout.offset[s], layout.size[s],
+			delta? base->raw + baseLayout.offset[s] : NULL, baseLayout.size[s]);
+	}
+	FinishRle(&writer);
+
+	int payloadSize = writer.pos - (int)sizeof(SnapshotFileHeader);
+
+	if (flags & SNAPSHOT_LZ)
+	{
+		// Compress into the space behind the token stream, then slide it down over it
+		int lzOffset = (int)sizeof(SnapshotFileHeader) + payloadSize;
+		if (!Reserve(&out->data, &out->dataCapacity, lzOffset + GetLzCompressBound(payloadSize))) return false;
+		int compressedSize = CompressLz(out->data + sizeof(SnapshotFileHeader), payloadSize, out->data + lzOffset);
+		memmove(out->data + sizeof(SnapshotFileHeader), out->data + lzOffset, compressedSize);
+		payloadSize = compressedSize;
+	}
+
+	SnapshotFileHeader fileHeader = {
+		.magic = SNAPSHOT_MAGIC,
+		.version = SNAPSHOT_VERSION,
+		.flags = (uint16_t)flags,
+		.frame = world->frame,
+		.baseFrame = delta? base->frame : 0,
+		.rawSize = (uint32_t)layout.total,
+		.payloadSize = (uint32_t)payloadSize,
+	};
+	memcpy(out->data, &fileHeader, sizeof(fileHeader));
+	out->dataSize = (int)sizeof(fileHeader) + payloadSize;
+
+	return true;
+}
+
+bool DecodeSnapshot(const unsigned char *data, int dataSize, const Snapshot *base, Snapshot *out)
+{
+	SnapshotFileHeader fileHeader;
+	if (dataSize < (int)sizeof(fileHeader)) return false;
+	memcpy(&fileHeader, data, sizeof(fileHeader));
+
+	if (fileHeader.magic != SNAPSHOT_MAGIC || fileHeader.version != SNAPSHOT_VERSION)
+	{
+		TraceLog(LOG_WARNING, "SNAPSHOT: Unknown format or version %i", fileHeader.version);
+		return false;
+	}
+	if ((long long)sizeof(fileHeader) + fileHeader.payloadSize > dataSize) return false;
+	if (fileHeader.rawSize < sizeof(SnapshotRawHeader) || fileHeader.rawSize > SNAPSHOT_MAX_RAW_SIZE)
+	{
+		TraceLog(LOG_WARNING, "SNAPSHOT: Unpacked size of %u bytes is out of range", fileHeader.rawSize);
+		return false;
+	}
+
+	bool delta = (fileHeader.flags & SNAPSHOT_DELTA) != 0;
+	if (delta && (base == NULL || base->raw == NULL || base->frame != fileHeader.baseFrame))
+	{
+		TraceLog(LOG_WARNING, "SNAPSHOT: Delta against frame %u needs its base snapshot", fileHeader.baseFrame);
+		return false;
+	}
+
+	const unsigned char *payload = data + sizeof(fileHeader);
+	int payloadSize = (int)fileHeader.payloadSize;
+	unsigned char *unpacked = NULL;
+
+	if (fileHeader.flags & SNAPSHOT_LZ)
+	{
+		int capacity = (int)fileHeader.rawSize + (int)fileHeader.rawSize/(8*0xffff)*3 + 16;
+		unpacked = malloc(capacity);
+		if (unpacked == NULL) return false;
+		payloadSize = DecompressLz(payload, payloadSize, unpacked, capacity);
+		payload = unpacked;
+		if (payloadSize < 0)
+		{
+			free(unpacked);
+			return false;
+		}
+	}
+
+	bool ok = Reserve(&out->raw, &out->rawCapacity, (int)fileHeader.rawSize) &&
+		ReadRle(payload, payloadSize, out->raw, (int)fileHeader.rawSize);
+	free(unpacked);
+	if (!ok) return false;
+
+	// The header section comes first and is needed to locate everything else
+	SnapshotLayout baseLayout = { 0 };
+	if (delta)
+	{
+		baseLayout = GetRawLayout(base->raw);
+		XorSection(out->raw, PAD8((int)sizeof(SnapshotRawHeader)), base->raw, baseLayout.size[SECTION_HEADER]);
+	}
+
+	SnapshotLayout layout = GetRawLayout(out->raw);
+	if (layout.total != (int)fileHeader.rawSize) return false;
+
+	if (delta)
+	{
+		for (int s = SECTION_HEADER + 1; s < SECTION_COUNT; s++)
+		{
+			XorSection(out->raw + layout.offset[s], layout.size[s], base->raw + baseLayout.offset[s], baseLayout.size[s]);
+		}
+	}
+
+	out->rawSize = layout.total;
+	out->frame = fileHeader.frame;
+
+	// Keep the encoded form too so the decoded snapshot can be written straight back out
+	if (!Reserve(&out->data, &out->dataCapacity, dataSize)) return false;
+	if (out->data != data) memmove(out->data, data, dataSize);
+	out->dataSize = dataSize;
+
+	return true;
+}
+
+bool ApplySnapshot(const Snapshot *snapshot, World *world)
+{
+	if (snapshot->raw == NULL || snapshot->rawSize < (int)sizeof(SnapshotRawHeader)) return false;
+
+	SnapshotRawHeader header;
+	memcpy(&header, snapshot->raw, sizeof(header));
+	SnapshotLayout layout = GetRawLayout(snapshot->raw);
+	const unsigned char *raw = snapshot->raw;
+	Entities *e = &world->entities;
+
+	if (layout.total < 0 || layout.total > snapshot->rawSize || header.entityCount > (uint32_t)e->capacity) return false;
+
+	if (header.mapWidth != world->map.width || header.mapHeight != world->map.height)
+	{
+		unsigned char *tiles = realloc(world->map.tiles, (size_t)header.mapWidth*header.mapHeight);
+		if (tiles == NULL) return false;
+		world->map.tiles = tiles;
+		world->map.width = header.mapWidth;
+		world->map.height = header.mapHeight;
+	}
+
+	int n = (int)header.entityCount;
+	memcpy(world->map.tiles, raw + layout.offset[SECTION_TILES], (size_t)world->map.width*world->map.height);
+	memcpy(e->posX, raw + layout.offset[SECTION_POS_X], n*sizeof(float));
+	memcpy(e->posY, raw + layout.offset[SECTION_POS_Y], n*sizeof(float));
+	memcpy(e->velX, raw + layout.offset[SECTION_VEL_X], n*sizeof(float));
+	memcpy(e->velY, raw + layout.offset[SECTION_VEL_Y], n*sizeof(float));
+	memcpy(e->health, raw + layout.offset[SECTION_HEALTH], n*sizeof(short));
+	memcpy(e->kind, raw + layout.offset[SECTION_KIND], n);
+	e->count = n;
+
+	// The flow field and grid are derived state, rebuilt from the restored map on the next tick
+	Swarm *swarm = &world->swarm;
+	int agents = (int)header.swarmCount;
+	if (agents > swarm->capacity || (agents > 0 && (swarm->mapWidth != world->map.width || swarm->mapHeight != world->map.height)))
+	{
+		SwarmParams params = (swarm->capacity > 0)? swarm->params : GetWorldSwarmParams();
+		UnloadSwarm(swarm);
+		*swarm = LoadSwarm(&world->map, agents, params);
+	}
+	if (agents > swarm->capacity) return false;
+	if (agents > 0)
+	{
+		memcpy(swarm->posX, raw + layout.offset[SECTION_SWARM_POS_X], agents*sizeof(float));
+		memcpy(swarm->posY, raw + layout.offset[SECTION_SWARM_POS_Y], agents*sizeof(float));
+		memcpy(swarm->velX, raw + layout.offset[SECTION_SWARM_VEL_X], agents*sizeof(float));
+		memcpy(swarm->velY, raw + layout.offset[SECTION_SWARM_VEL_Y], agents*sizeof(float));
+		SetSwarmTarget(swarm, &world->map, -1, -1);
+	}
+	swarm->count = agents;
+
+	world->frame = header.frame;
+	world->rng.state = header.rng;
+	world->facing = (Vector2){ header.facingX, header.facingY };
+	world->fireCooldown = header.fireCooldown;
+
+	return true;
+}
+
+void UnloadSnapshot(Snapshot *snapshot)
+{
+	free(snapshot->raw);
+	free(snapshot->data);
+	memset(snapshot, 0, sizeof(*snapshot));
+}
+
+bool SaveSnapshotFile(const Snapshot *snapshot, const char *fileName)
+{
+	return SaveFileData(fileName, snapshot->data, snapshot->dataSize);
+}
+
+bool LoadSnapshotFile(const char *fileName, const Snapshot *base, Snapshot *out)
+{
+	int size = 0;
+	unsigned char *data = LoadFileData(fileName, &size);
+	if (data == NULL) return false;
+
+	bool ok = DecodeSnapshot(data, size, base, out);
+	UnloadFileData(data);
+	return ok;
+}
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game.h"
+
+#define SNAPSHOT_MAGIC 0x5353444b	// "KDSS"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_MAX_RAW_SIZE (1 << 28)	// Bytes; files that claim more are taken as corrupt
+
+typedef enum SnapshotFlags {
+	SNAPSHOT_DELTA = 1 << 0,	// Payload is XORed per component against the base snapshot
+	SNAPSHOT_LZ = 1 << 1,	// Payload is additionally LZ compressed, see lz.h
+} SnapshotFlags;
+
+// A captured world state.
+// `raw` is the flat component layout and is what deltas are computed against,
+// `data` is the encoded form that goes to disk, into a replay or over the wire.
+// Buffers are kept between encodes so a ring of snapshots (rollback) never reallocates.
+typedef struct Snapshot {
+	unsigned int frame;
+	unsigned char *raw;
+	int rawSize;
+	int rawCapacity;
+	unsigned char *data;
+	int dataSize;
+	int dataCapacity;
+} Snapshot;
+
+// Pass a NULL base for a keyframe
+bool EncodeSnapshot(const World *world, const Snapshot *base, int flags, Snapshot *out);
+// `base` must be the same snapshot the data was encoded against (checked by frame number)
+bool DecodeSnapshot(const unsigned char *data, int dataSize, const Snapshot *base, Snapshot *out);
+bool ApplySnapshot(const Snapshot *snapshot, World *world);
+void UnloadSnapshot(Snapshot *snapshot);
+
+bool SaveSnapshotFile(const Snapshot *snapshot, const char *fileName);
+bool LoadSnapshotFile(const char *fileName, const Snapshot *base, Snapshot *out);
+
+#endif
@@ -0,0 +1,297 @@
+#include "broadphase.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+// Uniform grid broad-phase: each proxy is listed in every cell its rectangle covers.
+// A stamp per proxy skips the copies found through neighbouring cells.
+
+typedef struct GridProxy {
+	Rectangle rec;
+	int userData;
+	int x0, y0, x1, y1;	// Cells covered, -1 in x0 when the slot is free
+	unsigned int stamp;
+} GridProxy;
+
+typedef struct GridCell {
+	int *items;
+	int count;
+	int capacity;
+} GridCell;
+
+typedef struct SpatialGrid {
+	Rectangle bounds;
+	float invCellSize;
+	int width;
+	int height;
+	GridCell *cells;
+	GridProxy *proxies;
+	int proxyCount;
+	int proxyCapacity;
+	int *freeProxies;
+	int freeCount;
+	unsigned int stamp;
+} SpatialGrid;
+
+static inline int GetGridColumn(const SpatialGrid *grid, float x)
+{
+	int c = (int)floorf((x - grid->bounds.x)*grid->invCellSize);
+	return (c < 0)? 0 : (c >= grid->width)? grid->width - 1 : c;
+}
+
+static inline int GetGridRow(const SpatialGrid *grid, float y)
+{
+	int r = (int)floorf((y - grid->bounds.y)*grid->invCellSize);
+	return (r < 0)? 0 : (r >= grid->height)? grid->height - 1 : r;
+}
+
+static void AddToGridCells(SpatialGrid *grid, int proxy)
+{
+	GridProxy *p = &grid->proxies[proxy];
+	for (int y = p->y0; y <= p->y1; y++)
+	{
+		for (int x = p->x0; x <= p->x1; x++)
+		{
+			GridCell *cell = &grid->cells[y*grid->width + x];
+			if (cell->count == cell->capacity)
+			{
+				cell->capacity = cell->capacity? cell->capacity*2 : 4;
+				cell->items = realloc(cell->items, (size_t)cell->capacity*sizeof(int));
+			}
+			cell->items[cell->count++] = proxy;
+		}
+	}
+}
+
+static void RemoveFromGridCells(SpatialGrid *grid, int proxy)
+{
+	GridProxy *p = &grid->proxies[proxy];
+	for (int y = p->y0; y <= p->y1; y++)
+	{
+		for (int x = p->x0; x <= p->x1; x++)
+		{
+			GridCell *cell = &grid->cells[y*grid->width + x];
+			for (int i = 0; i < cell->count; i++)
+			{
+				if (cell->items[i] != proxy) continue;
+				cell->items[i] = cell->items[--cell->count];
+				break;
+			}
+		}
+	}
+}
+
+static void SetGridProxyCells(SpatialGrid *grid, GridProxy *p)
+{
+	p->x0 = GetGridColumn(grid, p->rec.x);
+	p->y0 = GetGridRow(grid, p->rec.y);
+	p->x1 = GetGridColumn(grid, p->rec.x + p->rec.width);
+	p->y1 = GetGridRow(grid, p->rec.y + p->rec.height);
+}
+
+static int CreateGridProxy(void *data, Rectangle rec, int userData)
+{
+	SpatialGrid *grid = data;
+	int proxy;
+
+	if (grid->freeCount > 0) proxy = grid->freeProxies[--grid->freeCount];
+	else
+	{
+		if (grid->proxyCount == grid->proxyCapacity)
+		{
+			grid->proxyCapacity = grid->proxyCapacity? grid->proxyCapacity*2 : 256;
+			grid->proxies = realloc(grid->proxies, (size_t)grid->proxyCapacity*sizeof(GridProxy));
+			grid->freeProxies = realloc(grid->freeProxies, (size_t)grid->proxyCapacity*sizeof(int));
+		}
+		proxy = grid->proxyCount++;
+	}
+
+	GridProxy *p = &grid->proxies[proxy];
+	*p = (GridProxy){ .rec = rec, .userData = userData };
+	SetGridProxyCells(grid, p);
+	AddToGridCells(grid, proxy);
+	return proxy;
+}
+
+static void DestroyGridProxy(void *data, int proxy)
+{
+	SpatialGrid *grid = data;
+	RemoveFromGridCells(grid, proxy);
+	grid->proxies[proxy].x0 = -1;
+	grid->freeProxies[grid->freeCount++] = proxy;
+}
+
+static void MoveGridProxy(void *data, int proxy, Rectangle rec, Vector2 displacement)
+{
+	(void)displacement;
+	SpatialGrid *grid = data;
+	GridProxy *p = &grid->proxies[proxy];
+	GridProxy moved = *p;
+	moved.rec = rec;
+	SetGridProxyCells(grid, &moved);
+
+	// Most moves stay within the same cells and only update the rectangle
+	if (moved.x0 != p->x0 || moved.y0 != p->y0 || moved.x1 != p->x1 || moved.y1 != p->y1)
+	{
+		RemoveFromGridCells(grid, proxy);
+		*p = moved;
+		AddToGridCells(grid, proxy);
+	}
+	else p->rec = rec;
+}
+
+static int QueryGridRecs(void *data, const Rectangle *recs, int count, BroadPhaseHit *hits, int capacity)
+{
+	SpatialGrid *grid = data;
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		Rectangle rec = recs[q];
+		unsigned int stamp = ++grid->stamp;
+		int x0 = GetGridColumn(grid, rec.x), x1 = GetGridColumn(grid, rec.x + rec.width);
+		int y0 = GetGridRow(grid, rec.y), y1 = GetGridRow(grid, rec.y + rec.height);
+
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				const GridCell *cell = &grid->cells[y*grid->width + x];
+				for (int i = 0; i < cell->count; i++)
+				{
+					GridProxy *p = &grid->proxies[cell->items[i]];
+					if (p->stamp == stamp) continue;
+					p->stamp = stamp;
+
+					if (!OverlapBroadPhaseRecs(p->rec, rec)) continue;
+					if (found < capacity) hits[found] = (BroadPhaseHit){ q, p->userData, 0.0f };
+					found++;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+// Walks the cells along each segment in order (Amanatides-Woo) after clipping it to the bounds
+static int RaycastGrid(void *data, const Vector2 *origins, const Vector2 *deltas, int count, BroadPhaseHit *hits, int capacity)
+{
+	SpatialGrid *grid = data;
+	float cellSize = 1.0f/grid->invCellSize;
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		Vector2 o = origins[q], d = deltas[q];
+		float enter;
+		if (!IntersectSegmentRec(o, d, grid->bounds, &enter)) continue;
+
+		unsigned int stamp = ++grid->stamp;
+		Vector2 start = { o.x + d.x*enter, o.y + d.y*enter };
+		int x = GetGridColumn(grid, start.x), y = GetGridRow(grid, start.y);
+		int stepX = (d.x > 0.0f) - (d.x < 0.0f), stepY = (d.y > 0.0f) - (d.y < 0.0f);
+
+		float tMaxX = 2.0f, tMaxY = 2.0f, tDeltaX = 0.0f, tDeltaY = 0.0f;
+		if (stepX != 0)
+		{
+			float edge = grid->bounds.x + (float)(x + (stepX > 0))*cellSize;
+			tMaxX = (edge - o.x)/d.x;
+			tDeltaX = cellSize/fabsf(d.x);
+		}
+		if (stepY != 0)
+		{
+			float edge = grid->bounds.y + (float)(y + (stepY > 0))*cellSize;
+			tMaxY = (edge - o.y)/d.y;
+			tDeltaY = cellSize/fabsf(d.y);
+		}
+
+		while (x >= 0 && y >= 0 && x < grid->width && y < grid->height)
+		{
+			const GridCell *cell = &grid->cells[y*grid->width + x];
+			for (int i = 0; i < cell->count; i++)
+			{
+				GridProxy *p = &grid->proxies[cell->items[i]];
+				if (p->stamp == stamp) continue;
+				p->stamp = stamp;
+
+				float time;
+				if (!IntersectSegmentRec(o, d, p->rec, &time)) continue;
+				if (found < capacity) hits[found] = (BroadPhaseHit){ q, p->userData, time };
+				found++;
+			}
+
+			if (tMaxX > 1.0f && tMaxY > 1.0f) break;
+			if (tMaxX < tMaxY)
+			{
+				x += stepX;
+				tMaxX += tDeltaX;
+			}
+			else
+			{
+				y += stepY;
+				tMaxY += tDeltaY;
+			}
+		}
+	}
+
+	return found;
+}
+
+// A pair sharing several cells is reported by the one holding the top left of their overlap
+static int FindGridPairs(void *data, BroadPhasePair *pairs, int capacity)
+{
+	SpatialGrid *grid = data;
+	int found = 0;
+
+	for (int y = 0; y < grid->height; y++)
+	{
+		for (int x = 0; x < grid->width; x++)
+		{
+			const GridCell *cell = &grid->cells[y*grid->width + x];
+			for (int i = 0; i < cell->count; i++)
+			{
+				const GridProxy *a = &grid->proxies[cell->items[i]];
+				for (int j = i + 1; j < cell->count; j++)
+				{
+					const GridProxy *b = &grid->proxies[cell->items[j]];
+					if (!OverlapBroadPhaseRecs(a->rec, b->rec)) continue;
+					if (GetGridColumn(grid, fmaxf(a->rec.x, b->rec.x)) != x || GetGridRow(grid, fmaxf(a->rec.y, b->rec.y)) != y) continue;
+
+					if (found < capacity) pairs[found] = (BroadPhasePair){ a->userData, b->userData };
+					found++;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+static void DestroyGrid(void *data)
+{
+	SpatialGrid *grid = data;
+	for (int i = 0; i < grid->width*grid->height; i++) free(grid->cells[i].items);
+	free(grid->cells);
+	free(grid->proxies);
+	free(grid->freeProxies);
+	free(grid);
+}
+
+BroadPhase CreateGridBroadPhase(Rectangle bounds, float cellSize)
+{
+	SpatialGrid *grid = calloc(1, sizeof(SpatialGrid));
+	grid->bounds = bounds;
+	grid->invCellSize = 1.0f/cellSize;
+	grid->width = (int)ceilf(bounds.width/cellSize);
+	grid->height = (int)ceilf(bounds.height/cellSize);
+	if (grid->width < 1) grid->width = 1;
+	if (grid->height < 1) grid->height = 1;
+	grid->cells = calloc((size_t)grid->width*grid->height, sizeof(GridCell));
+
+	return (BroadPhase){
+		"grid", grid,
+		CreateGridProxy, DestroyGridProxy, MoveGridProxy,
+		QueryGridRecs, RaycastGrid, FindGridPairs, DestroyGrid,
+	};
+}
@@ -0,0 +1,131 @@
+#include "spritebatch.h"
+#include "rlgl.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+SpriteBatch LoadSpriteBatch(int capacity)
+{
+	SpriteBatch batch = { 0 };
+	batch.capacity = (capacity > 0)? capacity : 1;
+	batch.quads = malloc((size_t)batch.capacity*sizeof(SpriteQuad));
+	return batch;
+}
+
+void UnloadSpriteBatch(SpriteBatch *batch)
+{
+	free(batch->quads);
+	memset(batch, 0, sizeof(*batch));
+}
+
+void BeginSpriteBatch(SpriteBatch *batch)
+{
+	batch->count = 0;
+	batch->stats = (SpriteBatchStats){ 0 };
+}
+
+void EndSpriteBatch(SpriteBatch *batch)
+{
+	FlushSpriteBatch(batch);
+	batch->last = batch->stats;
+}
+
+void FlushSpriteBatch(SpriteBatch *batch)
+{
+	if (batch->count == 0) return;
+
+	batch->stats.flushes++;
+	batch->stats.drawCalls += (batch->count + SPRITE_BATCH_DRAW_QUADS - 1)/SPRITE_BATCH_DRAW_QUADS;
+
+	if (IsWindowReady())
+	{
+		rlSetTexture(batch->texture.id);
+		rlBegin(RL_QUADS);
+		for (int i = 0; i < batch->count; i++)
+		{
+			const SpriteQuad *q = &batch->quads[i];
+			float x1 = q->dest.x + q->dest.width, y1 = q->dest.y + q->dest.height;
+
+			// rlgl flushes its own buffer when a quad would not fit
+			rlCheckRenderBatchLimit(4);
+			rlColor4ub(q->color.r, q->color.g, q->color.b, q->color.a);
+			rlNormal3f(0.0f, 0.0f, 1.0f);
+			rlTexCoord2f(q->u0, q->v0);
+			rlVertex2f(q->dest.x, q->dest.y);
+			rlTexCoord2f(q->u0, q->v1);
+			rlVertex2f(q->dest.x, y1);
+			rlTexCoord2f(q->u1, q->v1);
+			rlVertex2f(x1, y1);
+			rlTexCoord2f(q->u1, q->v0);
+			rlVertex2f(x1, q->dest.y);
+		}
+		rlEnd();
+		rlSetTexture(0);
+	}
+
+	batch->count = 0;
+}
+
+static bool ReserveSpriteQuads(SpriteBatch *batch, int count)
+{
+	if (batch->count + count <= batch->capacity) return true;
+
+	int capacity = batch->capacity;
+	while (capacity < batch->count + count) capacity *= 2;
+	SpriteQuad *quads = realloc(batch->quads, (size_t)capacity*sizeof(SpriteQuad));
+	if (quads == NULL)
+	{
+		TraceLog(LOG_WARNING, "SPRITEBATCH: Out of memory, flushing early");
+		FlushSpriteBatch(batch);
+		return (count <= batch->capacity);
+	}
+
+	batch->quads = quads;
+	batch->capacity = capacity;
+	return true;
+}
+
+void PushSpriteQuadUV(SpriteBatch *batch, Texture2D texture, Rectangle dest, Rectangle uv, Color color)
+{
+	if (texture.id != batch->texture.id) FlushSpriteBatch(batch);
+	batch->texture = texture;
+
+	if (!ReserveSpriteQuads(batch, 1)) return;
+
+	batch->quads[batch->count++] = (SpriteQuad){ dest, uv.x, uv.y, uv.x + uv.width, uv.y + uv.height, color };
+	batch->stats.quads++;
+}
+
+void PushSpriteQuad(SpriteBatch *batch, Texture2D texture, Rectangle source, Rectangle dest, Color color)
+{
+	float w = (texture.width > 0)? (float)texture.width : 1.0f, h = (texture.height > 0)? (float)texture.height : 1.0f;
+	PushSpriteQuadUV(batch, texture, dest, (Rectangle){ source.x/w, source.y/h, source.width/w, source.height/h }, color);
+}
+
+static inline unsigned char TintChannel(unsigned char a, unsigned char b)
+{
+	return (unsigned char)((a*b + 127)/255);
+}
+
+void PushSpriteQuads(SpriteBatch *batch, Texture2D texture, const SpriteQuad *quads, int count, Vector2 offset, Color tint)
+{
+	if (texture.id != batch->texture.id) FlushSpriteBatch(batch);
+	batch->texture = texture;
+	if (!ReserveSpriteQuads(batch, count)) return;
+
+	bool white = (tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255);
+	SpriteQuad *out = batch->quads + batch->count;
+	for (int i = 0; i < count; i++)
+	{
+		out[i] = quads[i];
+		out[i].dest.x += offset.x;
+		out[i].dest.y += offset.y;
+		if (!white)
+		{
+			Color c = quads[i].color;
+			out[i].color = (Color){ TintChannel(c.r, tint.r), TintChannel(c.g, tint.g), TintChannel(c.b, tint.b), TintChannel(c.a, tint.a) };
+		}
+	}
+	batch->count += count;
+	batch->stats.quads += count;
+}
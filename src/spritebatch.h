@@ -0,0 +1,48 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "raylib.h"
+
+// Axis aligned textured quads collected on the CPU and handed to rlgl per run of the
+// same texture, so a HUD or a stack of backdrop layers costs a draw call per texture
+// rather than per sprite. Without a window nothing is submitted but the stats are still
+// counted, which is how headless runs measure what a frame would draw.
+
+#define SPRITE_BATCH_DRAW_QUADS 8192	// rlgl's default batch size, it flushes with a draw call when full
+
+typedef struct SpriteQuad {
+	Rectangle dest;
+	float u0;	// Texture coordinates, outside 0..1 to repeat a wrapped texture
+	float v0;
+	float u1;
+	float v1;
+	Color color;
+} SpriteQuad;
+
+typedef struct SpriteBatchStats {
+	int quads;
+	int drawCalls;	// Texture runs, plus one per rlgl batch they fill
+	int flushes;
+} SpriteBatchStats;
+
+typedef struct SpriteBatch {
+	SpriteQuad *quads;	// Pending, all with `texture`
+	int count;
+	int capacity;
+	Texture2D texture;
+	SpriteBatchStats stats;	// Since BeginSpriteBatch()
+	SpriteBatchStats last;	// Of the last finished batch
+} SpriteBatch;
+
+SpriteBatch LoadSpriteBatch(int capacity);
+void UnloadSpriteBatch(SpriteBatch *batch);
+
+void BeginSpriteBatch(SpriteBatch *batch);
+void EndSpriteBatch(SpriteBatch *batch);	// Flushes and keeps the stats in `last`
+void FlushSpriteBatch(SpriteBatch *batch);	// Before drawing anything else over the pending quads
+
+void PushSpriteQuad(SpriteBatch *batch, Texture2D texture, Rectangle source, Rectangle dest, Color color);	// source in texels
+void PushSpriteQuadUV(SpriteBatch *batch, Texture2D texture, Rectangle dest, Rectangle uv, Color color);	// uv as x, y, width, height in texture space
+void PushSpriteQuads(SpriteBatch *batch, Texture2D texture, const SpriteQuad *quads, int count, Vector2 offset, Color tint);	// Prebuilt quads moved by offset, colours multiplied by tint
+
+#endif
@@ -0,0 +1,433 @@
+#include "swarm.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
+
+#define SWARM_PAD 4	// One vector past the last sorted agent
+
+typedef struct SwarmSums {
+	float offsetX;	// Sum of offsets to the neighbours, their centre relative to the agent
+	float offsetY;
+	float velX;
+	float velY;
+	float count;
+	float separationX;	// Away from close neighbours, stronger the closer they are
+	float separationY;
+} SwarmSums;
+
+typedef struct SwarmJob {
+	Swarm *swarm;
+	const Tilemap *map;
+	float dt;
+} SwarmJob;
+
+SwarmParams GetDefaultSwarmParams(void)
+{
+	return (SwarmParams){
+		.neighbourRadius = 48.0f,
+		.separationRadius = 20.0f,
+		.maxSpeed = 160.0f,
+		.maxForce = 480.0f,
+		.separation = 1.5f,
+		.alignment = 1.0f,
+		.cohesion = 1.0f,
+		.seek = 1.2f,
+		.avoidance = 2.0f,
+		.lookAhead = 0.25f,
+		.deterministic = false,
+	};
+}
+
+Swarm LoadSwarm(const Tilemap *map, int capacity, SwarmParams params)
+{
+	Swarm swarm = { 0 };
+	swarm.params = params;
+	swarm.capacity = capacity;
+	swarm.posX = calloc(capacity, sizeof(float));
+	swarm.posY = calloc(capacity, sizeof(float));
+	swarm.velX = calloc(capacity, sizeof(float));
+	swarm.velY = calloc(capacity, sizeof(float));
+
+	swarm.mapWidth = map->width;
+	swarm.mapHeight = map->height;
+	swarm.targetX = -1;
+	swarm.targetY = -1;
+	swarm.flowDistance = malloc((size_t)map->width*map->height*sizeof(int));
+	swarm.flowX = calloc((size_t)map->width*map->height, sizeof(float));
+	swarm.flowY = calloc((size_t)map->width*map->height, sizeof(float));
+
+	swarm.cellsX = (int)ceilf(map->width*TILE_SIZE/params.neighbourRadius);
+	swarm.cellsY = (int)ceilf(map->height*TILE_SIZE/params.neighbourRadius);
+	swarm.cellStarts = calloc((size_t)swarm.cellsX*swarm.cellsY + 1, sizeof(int));
+	swarm.agentCells = calloc(capacity, sizeof(int));
+	swarm.sortedIds = calloc(capacity, sizeof(int));
+	swarm.sortedPosX = calloc(capacity + SWARM_PAD, sizeof(float));
+	swarm.sortedPosY = calloc(capacity + SWARM_PAD, sizeof(float));
+	swarm.sortedVelX = calloc(capacity + SWARM_PAD, sizeof(float));
+	swarm.sortedVelY = calloc(capacity + SWARM_PAD, sizeof(float));
+
+	if (swarm.posX == NULL || swarm.posY == NULL || swarm.velX == NULL || swarm.velY == NULL ||
+		swarm.flowDistance == NULL || swarm.flowX == NULL || swarm.flowY == NULL || swarm.cellStarts == NULL || swarm.agentCells == NULL ||
+		swarm.sortedIds == NULL || swarm.sortedPosX == NULL || swarm.sortedPosY == NULL || swarm.sortedVelX == NULL || swarm.sortedVelY == NULL)
+	{
+		TraceLog(LOG_WARNING, "SWARM: Out of memory for %i agents", capacity);
+		UnloadSwarm(&swarm);	// Leaves a swarm with no capacity
+		return swarm;
+	}
+
+	for (int i = 0; i < map->width*map->height; i++) swarm.flowDistance[i] = SWARM_UNREACHABLE;
+	return swarm;
+}
+
+void UnloadSwarm(Swarm *swarm)
+{
+	free(swarm->posX);
+	free(swarm->posY);
+	free(swarm->velX);
+	free(swarm->velY);
+	free(swarm->flowDistance);
+	free(swarm->flowX);
+	free(swarm->flowY);
+	free(swarm->cellStarts);
+	free(swarm->agentCells);
+	free(swarm->sortedIds);
+	free(swarm->sortedPosX);
+	free(swarm->sortedPosY);
+	free(swarm->sortedVelX);
+	free(swarm->sortedVelY);
+	memset(swarm, 0, sizeof(*swarm));
+}
+
+int AddSwarmAgent(Swarm *swarm, Vector2 position, Vector2 velocity)
+{
+	if (swarm->count == swarm->capacity) return -1;
+
+	int i = swarm->count++;
+	swarm->posX[i] = position.x;
+	swarm->posY[i] = position.y;
+	swarm->velX[i] = velocity.x;
+	swarm->velY[i] = velocity.y;
+	return i;
+}
+
+void RemoveSwarmAgent(Swarm *swarm, int index)
+{
+	int last = --swarm->count;
+	swarm->posX[index] = swarm->posX[last];
+	swarm->posY[index] = swarm->posY[last];
+	swarm->velX[index] = swarm->velX[last];
+	swarm->velY[index] = swarm->velY[last];
+}
+
+//----------------------------------------------------------------------------------
+// Flow field
+//----------------------------------------------------------------------------------
+
+// Breadth first from the target over open tiles, then every tile points at its nearest
+// neighbour; diagonals only when both tiles beside them are open, so no corner is cut
+void SetSwarmTarget(Swarm *swarm, const Tilemap *map, int tileX, int tileY)
+{
+	if (tileX == swarm->targetX && tileY == swarm->targetY) return;
+	swarm->targetX = tileX;
+	swarm->targetY = tileY;
+
+	int w = swarm->mapWidth, h = swarm->mapHeight;
+	int *distance = swarm->flowDistance;
+	for (int i = 0; i < w*h; i++) distance[i] = SWARM_UNREACHABLE;
+	memset(swarm->flowX, 0, (size_t)w*h*sizeof(float));
+	memset(swarm->flowY, 0, (size_t)w*h*sizeof(float));
+	if (tileX < 0 || tileY < 0 || tileX >= w || tileY >= h) return;
+
+	int *queue = malloc((size_t)w*h*sizeof(int));
+	int head = 0, tail = 0;
+	distance[tileY*w + tileX] = 0;
+	queue[tail++] = tileY*w + tileX;
+
+	static const int steps[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+	while (head < tail)
+	{
+		int t = queue[head++];
+		int x = t%w, y = t/w;
+		for (int i = 0; i < 4; i++)
+		{
+			int nx = x + steps[i][0], ny = y + steps[i][1];
+			if (IsTileSolid(map, nx, ny) || distance[ny*w + nx] != SWARM_UNREACHABLE) continue;
+			distance[ny*w + nx] = distance[t] + 1;
+			queue[tail++] = ny*w + nx;
+		}
+	}
+
+	for (int i = 0; i < tail; i++)
+	{
+		int t = queue[i];
+		int x = t%w, y = t/w;
+		int best = distance[t], bestX = 0, bestY = 0;
+
+		for (int dy = -1; dy <= 1; dy++)
+		{
+			for (int dx = -1; dx <= 1; dx++)
+			{
+				if (IsTileSolid(map, x + dx, y + dy)) continue;
+				if (dx != 0 && dy != 0 && (IsTileSolid(map, x + dx, y) || IsTileSolid(map, x, y + dy))) continue;
+
+				int d = distance[(y + dy)*w + x + dx];
+				if (d != SWARM_UNREACHABLE && d < best)
+				{
+					best = d;
+					bestX = dx;
+					bestY = dy;
+				}
+			}
+		}
+
+		float scale = (bestX != 0 && bestY != 0)? 0.70710678f : 1.0f;
+		swarm->flowX[t] = bestX*scale;
+		swarm->flowY[t] = bestY*scale;
+	}
+
+	free(queue);
+}
+
+//----------------------------------------------------------------------------------
+// Steering
+//----------------------------------------------------------------------------------
+
+// Counting sort by cell; stable, so the neighbour order only depends on the agent order
+static void SortSwarmAgents(Swarm *swarm)
+{
+	int cells = swarm->cellsX*swarm->cellsY;
+	float cellSize = swarm->params.neighbourRadius;
+	int *starts = swarm->cellStarts;
+	memset(starts, 0, (size_t)(cells + 1)*sizeof(int));
+
+	for (int i = 0; i < swarm->count; i++)
+	{
+		int cx = (int)(swarm->posX[i]/cellSize), cy = (int)(swarm->posY[i]/cellSize);
+		cx = (cx < 0)? 0 : (cx >= swarm->cellsX)? swarm->cellsX - 1 : cx;
+		cy = (cy < 0)? 0 : (cy >= swarm->cellsY)? swarm->cellsY - 1 : cy;
+		swarm->agentCells[i] = cy*swarm->cellsX + cx;
+		starts[swarm->agentCells[i] + 1]++;
+	}
+	for (int c = 0; c < cells; c++) starts[c + 1] += starts[c];
+
+	// Scattering advances each start to the next cell's, shifted back afterwards
+	for (int i = 0; i < swarm->count; i++)
+	{
+		int s = starts[swarm->agentCells[i]]++;
+		swarm->sortedIds[s] = i;
+		swarm->sortedPosX[s] = swarm->posX[i];
+		swarm->sortedPosY[s] = swarm->posY[i];
+		swarm->sortedVelX[s] = swarm->velX[i];
+		swarm->sortedVelY[s] = swarm->velY[i];
+	}
+	memmove(starts + 1, starts, (size_t)cells*sizeof(int));
+	starts[0] = 0;
+}
+
+// Neighbours come from the 3x3 cells around the agent, each row of three one run of the
+// sorted arrays. The scalar path keeps four partial sums like the vector lanes do, so
+// both add in the same order and give the same bits.
+static SwarmSums GatherNeighbours(const Swarm *swarm, int cell, float px, float py)
+{
+	int cx = cell%swarm->cellsX, cy = cell/swarm->cellsX;
+	int x0 = (cx > 0)? cx - 1 : 0, x1 = (cx < swarm->cellsX - 1)? cx + 1 : cx;
+	int y0 = (cy > 0)? cy - 1 : 0, y1 = (cy < swarm->cellsY - 1)? cy + 1 : cy;
+	float radius2 = swarm->params.neighbourRadius*swarm->params.neighbourRadius;
+	float separation2 = swarm->params.separationRadius*swarm->params.separationRadius;
+	float lanes[7][4] = { 0 };
+
+#if defined(__SSE2__)
+	bool exact = swarm->params.deterministic;
+	const __m128 x = _mm_set1_ps(px), y = _mm_set1_ps(py);
+	const __m128 r2 = _mm_set1_ps(radius2), s2 = _mm_set1_ps(separation2);
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+	const __m128i laneIndex = _mm_setr_epi32(0, 1, 2, 3);
+	__m128 offX = zero, offY = zero, velX = zero, velY = zero, count = zero, sepX = zero, sepY = zero;
+
+	for (int row = y0; row <= y1; row++)
+	{
+		int start = swarm->cellStarts[row*swarm->cellsX + x0], end = swarm->cellStarts[row*swarm->cellsX + x1 + 1];
+		const __m128i last = _mm_set1_epi32(end);
+
+		for (int j = start; j < end; j += 4)
+		{
+			__m128 valid = _mm_castsi128_ps(_mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(j), laneIndex), last));
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(swarm->sortedPosX + j), x);
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(swarm->sortedPosY + j), y);
+			__m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+			// The agent itself and anything stacked on it are at distance 0 and left out
+			__m128 near = _mm_and_ps(valid, _mm_and_ps(_mm_cmplt_ps(d2, r2), _mm_cmpgt_ps(d2, zero)));
+			offX = _mm_add_ps(offX, _mm_and_ps(near, dx));
+			offY = _mm_add_ps(offY, _mm_and_ps(near, dy));
+			velX = _mm_add_ps(velX, _mm_and_ps(near, _mm_loadu_ps(swarm->sortedVelX + j)));
+			velY = _mm_add_ps(velY, _mm_and_ps(near, _mm_loadu_ps(swarm->sortedVelY + j)));
+			count = _mm_add_ps(count, _mm_and_ps(near, one));
+
+			__m128 close = _mm_and_ps(near, _mm_cmplt_ps(d2, s2));
+			__m128 inv;
+			if (exact) inv = _mm_div_ps(one, d2);
+			else
+			{
+				inv = _mm_rcp_ps(d2);
+				inv = _mm_mul_ps(inv, _mm_sub_ps(two, _mm_mul_ps(d2, inv)));	// One Newton step
+			}
+			sepX = _mm_sub_ps(sepX, _mm_and_ps(close, _mm_mul_ps(dx, inv)));
+			sepY = _mm_sub_ps(sepY, _mm_and_ps(close, _mm_mul_ps(dy, inv)));
+		}
+	}
+
+	_mm_storeu_ps(lanes[0], offX);
+	_mm_storeu_ps(lanes[1], offY);
+	_mm_storeu_ps(lanes[2], velX);
+	_mm_storeu_ps(lanes[3], velY);
+	_mm_storeu_ps(lanes[4], count);
+	_mm_storeu_ps(lanes[5], sepX);
+	_mm_storeu_ps(lanes[6], sepY);
+#else
+	for (int row = y0; row <= y1; row++)
+	{
+		int start = swarm->cellStarts[row*swarm->cellsX + x0], end = swarm->cellStarts[row*swarm->cellsX + x1 + 1];
+		for (int j = start; j < end; j++)
+		{
+			int lane = (j - start) & 3;
+			float dx = swarm->sortedPosX[j] - px, dy = swarm->sortedPosY[j] - py;
+			float d2 = dx*dx + dy*dy;
+			if (!(d2 < radius2 && d2 > 0.0f)) continue;
+
+			lanes[0][lane] += dx;
+			lanes[1][lane] += dy;
+			lanes[2][lane] += swarm->sortedVelX[j];
+			lanes[3][lane] += swarm->sortedVelY[j];
+			lanes[4][lane] += 1.0f;
+			if (d2 < separation2)
+			{
+				float inv = 1.0f/d2;
+				lanes[5][lane] -= dx*inv;
+				lanes[6][lane] -= dy*inv;
+			}
+		}
+	}
+#endif
+
+	float sums[7];
+	for (int i = 0; i < 7; i++) sums[i] = (lanes[i][0] + lanes[i][1]) + (lanes[i][2] + lanes[i][3]);
+	return (SwarmSums){ sums[0], sums[1], sums[2], sums[3], sums[4], sums[5], sums[6] };
+}
+
+static inline float GetInvLength(float x, float y, bool exact)
+{
+	float d2 = x*x + y*y;
+	if (d2 <= 0.0f) return 0.0f;
+#if defined(__SSE2__)
+	if (!exact)
+	{
+		float r = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(d2)));
+		return r*(1.5f - 0.5f*d2*r*r);
+	}
+#endif
+	return 1.0f/sqrtf(d2);
+}
+
+// Reynolds steering: turn the current velocity toward a desired one at full speed
+static inline void AddSteering(float *steerX, float *steerY, float weight, float dirX, float dirY, float velX, float velY, const SwarmParams *p)
+{
+	float scale = GetInvLength(dirX, dirY, p->deterministic)*p->maxSpeed;
+	if (scale == 0.0f) return;
+	*steerX += weight*(dirX*scale - velX);
+	*steerY += weight*(dirY*scale - velY);
+}
+
+static void SteerBlock(void *user, int block)
+{
+	SwarmJob *job = user;
+	Swarm *swarm = job->swarm;
+	const SwarmParams *p = &swarm->params;
+	const Tilemap *map = job->map;
+	float dt = job->dt;
+	int end = (block + 1)*SWARM_BLOCK_AGENTS;
+	if (end > swarm->count) end = swarm->count;
+
+	for (int s = block*SWARM_BLOCK_AGENTS; s < end; s++)
+	{
+		int id = swarm->sortedIds[s];
+		float px = swarm->sortedPosX[s], py = swarm->sortedPosY[s];
+		float vx = swarm->sortedVelX[s], vy = swarm->sortedVelY[s];
+		SwarmSums n = GatherNeighbours(swarm, swarm->agentCells[id], px, py);
+		float steerX = 0.0f, steerY = 0.0f;
+
+		if (n.count > 0.0f)
+		{
+			AddSteering(&steerX, &steerY, p->alignment, n.velX, n.velY, vx, vy, p);
+			AddSteering(&steerX, &steerY, p->cohesion, n.offsetX, n.offsetY, vx, vy, p);
+			AddSteering(&steerX, &steerY, p->separation, n.separationX, n.separationY, vx, vy, p);
+		}
+
+		int tx = (int)floorf(px/TILE_SIZE), ty = (int)floorf(py/TILE_SIZE);
+		if (tx >= 0 && ty >= 0 && tx < swarm->mapWidth && ty < swarm->mapHeight)
+		{
+			int t = ty*swarm->mapWidth + tx;
+			AddSteering(&steerX, &steerY, p->seek, swarm->flowX[t], swarm->flowY[t], vx, vy, p);
+		}
+
+		// Away from the centre of a wall tile about to be entered
+		float aheadX = px + vx*p->lookAhead, aheadY = py + vy*p->lookAhead;
+		int ax = (int)floorf(aheadX/TILE_SIZE), ay = (int)floorf(aheadY/TILE_SIZE);
+		if ((ax != tx || ay != ty) && IsTileSolid(map, ax, ay))
+		{
+			AddSteering(&steerX, &steerY, p->avoidance, px - (ax + 0.5f)*TILE_SIZE, py - (ay + 0.5f)*TILE_SIZE, vx, vy, p);
+		}
+
+		float force = 1.0f/GetInvLength(steerX, steerY, p->deterministic);
+		if (force > p->maxForce)
+		{
+			steerX *= p->maxForce/force;
+			steerY *= p->maxForce/force;
+		}
+		vx += steerX*dt;
+		vy += steerY*dt;
+
+		float speed = 1.0f/GetInvLength(vx, vy, p->deterministic);
+		if (speed > p->maxSpeed)
+		{
+			vx *= p->maxSpeed/speed;
+			vy *= p->maxSpeed/speed;
+		}
+
+		// Points slide along walls one axis at a time
+		float nx = px + vx*dt, ny = py + vy*dt;
+		if (IsTileSolid(map, (int)floorf(nx/TILE_SIZE), ty))
+		{
+			nx = px;
+			vx = 0.0f;
+		}
+		if (IsTileSolid(map, (int)floorf(nx/TILE_SIZE), (int)floorf(ny/TILE_SIZE)))
+		{
+			ny = py;
+			vy = 0.0f;
+		}
+
+		swarm->posX[id] = nx;
+		swarm->posY[id] = ny;
+		swarm->velX[id] = vx;
+		swarm->velY[id] = vy;
+	}
+}
+
+void UpdateSwarm(Swarm *swarm, const Tilemap *map, JobSystem *jobs, float dt)
+{
+	if (swarm->count == 0) return;
+
+	SortSwarmAgents(swarm);
+
+	// Blocks read only the sorted copies and write only their own agents
+	SwarmJob job = { swarm, map, dt };
+	int blocks = (swarm->count + SWARM_BLOCK_AGENTS - 1)/SWARM_BLOCK_AGENTS;
+	if (jobs != NULL) RunJobs(jobs, SteerBlock, &job, blocks);
+	else for (int i = 0; i < blocks; i++) SteerBlock(&job, i);
+}
@@ -0,0 +1,74 @@
+#ifndef SWARM_H
+#define SWARM_H
+
+#include "raylib.h"
+#include "tilemap.h"
+#include "jobs.h"
+
+// Flocking agents for enemy swarms: separation, alignment and cohesion between
+// neighbours, seeking along a flow field toward a target tile and steering clear of walls.
+// Agents are points kept as struct-of-arrays. Every tick they are counting-sorted into
+// a uniform grid of neighbour radius cells, so the neighbours of an agent sit in three
+// contiguous runs of the sorted arrays, scanned four at a time with SSE.
+// Each agent only reads last tick's state, so the result never depends on the thread
+// count. Deterministic mode also avoids the approximate reciprocals, which differ
+// between CPU vendors, so a replay steers the same everywhere.
+
+#define SWARM_BLOCK_AGENTS 1024	// Agents per job
+#define SWARM_UNREACHABLE -1	// Flow distance of walls and tiles cut off from the target
+
+typedef struct SwarmParams {
+	float neighbourRadius;	// Pixels, also the grid cell size
+	float separationRadius;
+	float maxSpeed;	// Pixels per second
+	float maxForce;	// Pixels per second squared
+	float separation;	// Weights of each behaviour
+	float alignment;
+	float cohesion;
+	float seek;
+	float avoidance;
+	float lookAhead;	// Seconds of travel checked for walls
+	bool deterministic;
+} SwarmParams;
+
+typedef struct Swarm {
+	SwarmParams params;
+	int count;
+	int capacity;
+	float *posX;
+	float *posY;
+	float *velX;
+	float *velY;
+
+	// Flow field toward the target, a unit direction per tile
+	int mapWidth;
+	int mapHeight;
+	int targetX;	// Tile, -1 before the first SetSwarmTarget()
+	int targetY;
+	int *flowDistance;	// Steps to the target, SWARM_UNREACHABLE for walls and cut off tiles
+	float *flowX;
+	float *flowY;
+
+	// Grid, rebuilt every tick; sorted arrays are padded by a vector so loads can overrun
+	int cellsX;
+	int cellsY;
+	int *cellStarts;	// Agents of cell i are cellStarts[i]..cellStarts[i + 1] in sorted order
+	int *agentCells;
+	int *sortedIds;
+	float *sortedPosX;
+	float *sortedPosY;
+	float *sortedVelX;
+	float *sortedVelY;
+} Swarm;
+
+SwarmParams GetDefaultSwarmParams(void);
+Swarm LoadSwarm(const Tilemap *map, int capacity, SwarmParams params);
+void UnloadSwarm(Swarm *swarm);
+
+int AddSwarmAgent(Swarm *swarm, Vector2 position, Vector2 velocity);	// Returns -1 when full
+void RemoveSwarmAgent(Swarm *swarm, int index);	// Moves the last agent into its slot
+
+void SetSwarmTarget(Swarm *swarm, const Tilemap *map, int tileX, int tileY);	// Rebuilds the flow field when the tile changed
+void UpdateSwarm(Swarm *swarm, const Tilemap *map, JobSystem *jobs, float dt);	// jobs may be NULL to run on the caller
+
+#endif
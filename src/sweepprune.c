@@ -0,0 +1,396 @@
+#include "broadphase.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+
+// Sweep and prune: each axis keeps the proxies' min and max endpoints sorted. A move
+// re-sorts only the moved proxy's endpoints by insertion sort, which is a handful of
+// swaps when bodies move little between ticks, and every swap of a min past a max
+// is exactly a start or end of overlap on that axis. Those events keep a hash set of
+// overlapping pairs current, so finding pairs costs nothing beyond reading it out.
+
+#define SAP_EMPTY 0xffffffffffffffffull
+
+typedef struct SapEndpoint {
+	float value;
+	unsigned int data;	// Proxy << 1 | 1 for a min
+} SapEndpoint;
+
+typedef struct SapProxy {
+	Rectangle rec;
+	int userData;
+	int min[2];	// Endpoint index per axis, -1 in min[0] when the slot is free
+	int max[2];
+} SapProxy;
+
+typedef struct SweepPrune {
+	SapProxy *proxies;
+	int proxyCount;
+	int proxyCapacity;
+	int *freeProxies;
+	int freeCount;
+	SapEndpoint *endpoints[2];
+	int endpointCount;
+	float maxSize[2];	// Largest extent seen per axis, bounds how far back a query scans
+	unsigned long long *pairs;	// Open addressing, lower proxy in the high half
+	int pairCount;
+	int pairCapacity;
+	SweepPruneStats stats;
+} SweepPrune;
+
+static inline int GetEndpointProxy(SapEndpoint e) { return (int)(e.data >> 1); }
+static inline bool IsMinEndpoint(SapEndpoint e) { return e.data & 1; }
+
+// Ties put maxes first so touching proxies do not overlap, as in OverlapBroadPhaseRecs()
+static inline bool IsEndpointBefore(SapEndpoint a, SapEndpoint b)
+{
+	return a.value < b.value || (a.value == b.value && !IsMinEndpoint(a) && IsMinEndpoint(b));
+}
+
+static inline float GetRecMin(Rectangle rec, int axis) { return axis? rec.y : rec.x; }
+static inline float GetRecMax(Rectangle rec, int axis) { return axis? rec.y + rec.height : rec.x + rec.width; }
+
+//----------------------------------------------------------------------------------
+// Pair cache
+//----------------------------------------------------------------------------------
+
+static inline unsigned long long GetPairKey(int a, int b)
+{
+	return (a < b)? ((unsigned long long)a << 32 | (unsigned int)b) : ((unsigned long long)b << 32 | (unsigned int)a);
+}
+
+static inline unsigned int HashPairKey(unsigned long long key)
+{
+	key *= 0x9e3779b97f4a7c15ull;
+	return (unsigned int)(key >> 32);
+}
+
+static void GrowPairCache(SweepPrune *sap)
+{
+	unsigned long long *old = sap->pairs;
+	int oldCapacity = sap->pairCapacity;
+
+	sap->pairCapacity = oldCapacity? oldCapacity*2 : 1024;
+	sap->pairs = malloc((size_t)sap->pairCapacity*sizeof(unsigned long long));
+	memset(sap->pairs, 0xff, (size_t)sap->pairCapacity*sizeof(unsigned long long));
+
+	unsigned int mask = (unsigned int)sap->pairCapacity - 1;
+	for (int i = 0; i < oldCapacity; i++)
+	{
+		if (old[i] == SAP_EMPTY) continue;
+		unsigned int slot = HashPairKey(old[i]) & mask;
+		while (sap->pairs[slot] != SAP_EMPTY) slot = (slot + 1) & mask;
+		sap->pairs[slot] = old[i];
+	}
+	free(old);
+}
+
+static void AddSapPair(SweepPrune *sap, int a, int b)
+{
+	if (2*(sap->pairCount + 1) > sap->pairCapacity) GrowPairCache(sap);
+
+	unsigned long long key = GetPairKey(a, b);
+	unsigned int mask = (unsigned int)sap->pairCapacity - 1;
+	unsigned int slot = HashPairKey(key) & mask;
+	while (sap->pairs[slot] != SAP_EMPTY)
+	{
+		if (sap->pairs[slot] == key) return;	// Already found on the other axis
+		slot = (slot + 1) & mask;
+	}
+
+	sap->pairs[slot] = key;
+	sap->pairCount++;
+	sap->stats.added++;
+}
+
+static void RemoveSapPair(SweepPrune *sap, int a, int b)
+{
+	if (sap->pairCount == 0) return;
+
+	unsigned long long key = GetPairKey(a, b);
+	unsigned int mask = (unsigned int)sap->pairCapacity - 1;
+	unsigned int slot = HashPairKey(key) & mask;
+	while (sap->pairs[slot] != key)
+	{
+		if (sap->pairs[slot] == SAP_EMPTY) return;
+		slot = (slot + 1) & mask;
+	}
+
+	// Shift later entries of the run back so lookups never stop early at the hole
+	unsigned int hole = slot;
+	for (unsigned int next = (hole + 1) & mask; sap->pairs[next] != SAP_EMPTY; next = (next + 1) & mask)
+	{
+		unsigned int home = HashPairKey(sap->pairs[next]) & mask;
+		if (((next - home) & mask) < ((next - hole) & mask)) continue;	// Its home lies after the hole
+		sap->pairs[hole] = sap->pairs[next];
+		hole = next;
+	}
+	sap->pairs[hole] = SAP_EMPTY;
+	sap->pairCount--;
+	sap->stats.removed++;
+}
+
+//----------------------------------------------------------------------------------
+// Endpoints
+//----------------------------------------------------------------------------------
+
+static inline void SetEndpointIndex(SweepPrune *sap, int axis, int index)
+{
+	SapEndpoint e = sap->endpoints[axis][index];
+	SapProxy *p = &sap->proxies[GetEndpointProxy(e)];
+	if (IsMinEndpoint(e)) p->min[axis] = index;
+	else p->max[axis] = index;
+}
+
+// Swaps endpoint `index` with its neighbour `index + 1`, where the first is moving up
+static void SwapSapEndpoints(SweepPrune *sap, int axis, int index)
+{
+	SapEndpoint *list = sap->endpoints[axis];
+	SapEndpoint up = list[index], down = list[index + 1];
+	int a = GetEndpointProxy(up), b = GetEndpointProxy(down);
+
+	if (a != b && IsMinEndpoint(up) != IsMinEndpoint(down))
+	{
+		// A max moving above a min starts an overlap on this axis, a min moving above a max ends one
+		if (IsMinEndpoint(down))
+		{
+			if (OverlapBroadPhaseRecs(sap->proxies[a].rec, sap->proxies[b].rec)) AddSapPair(sap, a, b);
+		}
+		else RemoveSapPair(sap, a, b);
+	}
+
+	list[index] = down;
+	list[index + 1] = up;
+	SetEndpointIndex(sap, axis, index);
+	SetEndpointIndex(sap, axis, index + 1);
+	sap->stats.swaps++;
+}
+
+static void SortSapEndpoint(SweepPrune *sap, int axis, int index)
+{
+	SapEndpoint *list = sap->endpoints[axis];
+	while (index > 0 && IsEndpointBefore(list[index], list[index - 1]))
+	{
+		SwapSapEndpoints(sap, axis, index - 1);
+		index--;
+	}
+	while (index + 1 < sap->endpointCount && IsEndpointBefore(list[index + 1], list[index]))
+	{
+		SwapSapEndpoints(sap, axis, index);
+		index++;
+	}
+}
+
+// A min moving down is sorted before the max and otherwise after it, so a proxy's own
+// endpoints only ever meet when they tie
+static void UpdateSapProxy(SweepPrune *sap, int proxy, Rectangle rec)
+{
+	SapProxy *p = &sap->proxies[proxy];
+	p->rec = rec;
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		SapEndpoint *list = sap->endpoints[axis];
+		float lo = GetRecMin(rec, axis), hi = GetRecMax(rec, axis);
+		bool minDown = lo < list[p->min[axis]].value;
+
+		list[p->min[axis]].value = lo;
+		list[p->max[axis]].value = hi;
+		if (hi - lo > sap->maxSize[axis]) sap->maxSize[axis] = hi - lo;
+
+		if (minDown)
+		{
+			SortSapEndpoint(sap, axis, p->min[axis]);
+			SortSapEndpoint(sap, axis, p->max[axis]);
+		}
+		else
+		{
+			SortSapEndpoint(sap, axis, p->max[axis]);
+			SortSapEndpoint(sap, axis, p->min[axis]);
+		}
+	}
+	sap->stats.updates++;
+}
+
+//----------------------------------------------------------------------------------
+// Broad-phase entry points
+//----------------------------------------------------------------------------------
+
+static const Rectangle farRec = { FLT_MAX, FLT_MAX, 0.0f, 0.0f };	// Sorts after everything and overlaps nothing
+
+static int CreateSapProxy(void *data, Rectangle rec, int userData)
+{
+	SweepPrune *sap = data;
+	int proxy;
+
+	if (sap->freeCount > 0) proxy = sap->freeProxies[--sap->freeCount];
+	else
+	{
+		if (sap->proxyCount == sap->proxyCapacity)
+		{
+			sap->proxyCapacity = sap->proxyCapacity? sap->proxyCapacity*2 : 256;
+			sap->proxies = realloc(sap->proxies, (size_t)sap->proxyCapacity*sizeof(SapProxy));
+			sap->freeProxies = realloc(sap->freeProxies, (size_t)sap->proxyCapacity*sizeof(int));
+			for (int axis = 0; axis < 2; axis++)
+			{
+				sap->endpoints[axis] = realloc(sap->endpoints[axis], (size_t)sap->proxyCapacity*2*sizeof(SapEndpoint));
+			}
+		}
+		proxy = sap->proxyCount++;
+	}
+
+	// Enters past the far end, then sorts down to where it belongs like any move
+	SapProxy *p = &sap->proxies[proxy];
+	*p = (SapProxy){ .rec = farRec, .userData = userData };
+	for (int axis = 0; axis < 2; axis++)
+	{
+		sap->endpoints[axis][sap->endpointCount] = (SapEndpoint){ FLT_MAX, (unsigned int)proxy << 1 | 1 };
+		sap->endpoints[axis][sap->endpointCount + 1] = (SapEndpoint){ FLT_MAX, (unsigned int)proxy << 1 };
+		p->min[axis] = sap->endpointCount;
+		p->max[axis] = sap->endpointCount + 1;
+	}
+	sap->endpointCount += 2;
+
+	UpdateSapProxy(sap, proxy, rec);
+	return proxy;
+}
+
+static void DestroySapProxy(void *data, int proxy)
+{
+	SweepPrune *sap = data;
+	UpdateSapProxy(sap, proxy, farRec);	// Ends all its overlaps
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		// Both endpoints now sit at the end, in either order as they tie
+		SapProxy *p = &sap->proxies[proxy];
+		SapEndpoint *list = sap->endpoints[axis];
+		int first = (p->min[axis] < p->max[axis])? p->min[axis] : p->max[axis];
+		memmove(&list[first], &list[first + 2], (size_t)(sap->endpointCount - first - 2)*sizeof(SapEndpoint));
+		for (int i = first; i < sap->endpointCount - 2; i++) SetEndpointIndex(sap, axis, i);
+	}
+
+	sap->endpointCount -= 2;
+	sap->proxies[proxy].min[0] = -1;
+	sap->freeProxies[sap->freeCount++] = proxy;
+}
+
+static void MoveSapProxy(void *data, int proxy, Rectangle rec, Vector2 displacement)
+{
+	(void)displacement;
+	UpdateSapProxy(data, proxy, rec);
+}
+
+// First endpoint on x at or after `value`
+static int FindSapEndpoint(const SweepPrune *sap, float value)
+{
+	const SapEndpoint *list = sap->endpoints[0];
+	int lo = 0, hi = sap->endpointCount;
+	while (lo < hi)
+	{
+		int mid = (lo + hi)/2;
+		if (list[mid].value < value) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+// Every proxy overlapping [x0, x1] has its min within the largest width before x1
+static int QuerySapRecs(void *data, const Rectangle *recs, int count, BroadPhaseHit *hits, int capacity)
+{
+	SweepPrune *sap = data;
+	const SapEndpoint *list = sap->endpoints[0];
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		Rectangle rec = recs[q];
+		float end = rec.x + rec.width;
+		for (int i = FindSapEndpoint(sap, rec.x - sap->maxSize[0]); i < sap->endpointCount && list[i].value < end; i++)
+		{
+			if (!IsMinEndpoint(list[i])) continue;
+			const SapProxy *p = &sap->proxies[GetEndpointProxy(list[i])];
+			if (!OverlapBroadPhaseRecs(p->rec, rec)) continue;
+			if (found < capacity) hits[found] = (BroadPhaseHit){ q, p->userData, 0.0f };
+			found++;
+		}
+	}
+
+	return found;
+}
+
+static int RaycastSap(void *data, const Vector2 *origins, const Vector2 *deltas, int count, BroadPhaseHit *hits, int capacity)
+{
+	SweepPrune *sap = data;
+	const SapEndpoint *list = sap->endpoints[0];
+	int found = 0;
+
+	for (int q = 0; q < count; q++)
+	{
+		Vector2 o = origins[q], d = deltas[q];
+		float start = (d.x < 0.0f)? o.x + d.x : o.x;
+		float end = (d.x < 0.0f)? o.x : o.x + d.x;
+
+		// Unlike overlaps, a segment touching an edge counts, so the scan includes `end`
+		for (int i = FindSapEndpoint(sap, start - sap->maxSize[0]); i < sap->endpointCount && list[i].value <= end; i++)
+		{
+			if (!IsMinEndpoint(list[i])) continue;
+			const SapProxy *p = &sap->proxies[GetEndpointProxy(list[i])];
+			float time;
+			if (!IntersectSegmentRec(o, d, p->rec, &time)) continue;
+			if (found < capacity) hits[found] = (BroadPhaseHit){ q, p->userData, time };
+			found++;
+		}
+	}
+
+	return found;
+}
+
+static int FindSapPairs(void *data, BroadPhasePair *pairs, int capacity)
+{
+	SweepPrune *sap = data;
+	int found = 0;
+
+	for (int i = 0; i < sap->pairCapacity; i++)
+	{
+		unsigned long long key = sap->pairs[i];
+		if (key == SAP_EMPTY) continue;
+		if (found < capacity) pairs[found] = (BroadPhasePair){ sap->proxies[key >> 32].userData, sap->proxies[key & 0xffffffffu].userData };
+		found++;
+	}
+
+	return found;
+}
+
+static void DestroySap(void *data)
+{
+	SweepPrune *sap = data;
+	free(sap->proxies);
+	free(sap->freeProxies);
+	free(sap->endpoints[0]);
+	free(sap->endpoints[1]);
+	free(sap->pairs);
+	free(sap);
+}
+
+BroadPhase CreateSweepBroadPhase(void)
+{
+	SweepPrune *sap = calloc(1, sizeof(SweepPrune));
+	GrowPairCache(sap);
+
+	return (BroadPhase){
+		"sap", sap,
+		CreateSapProxy, DestroySapProxy, MoveSapProxy,
+		QuerySapRecs, RaycastSap, FindSapPairs, DestroySap,
+	};
+}
+
+SweepPruneStats GetSweepPruneStats(BroadPhase *bp)
+{
+	SweepPrune *sap = bp->data;
+	SweepPruneStats stats = sap->stats;
+	stats.pairs = sap->pairCount;
+	sap->stats = (SweepPruneStats){ 0 };
+	return stats;
+}
@@ -0,0 +1,230 @@
+#include "textcache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_CACHE_MASK (TEXT_CACHE_SLOTS - 1)
+#define TEXT_CACHE_LIMIT (TEXT_CACHE_SLOTS/4*3)	// Keeps the probes short
+#define TEXT_CACHE_CROWDED (TEXT_CACHE_SLOTS/2)	// Leaves room for a frame's worth of new strings
+#define TEXT_CACHE_EVICT_INTERVAL 64	// Frames between sweeps for old layouts
+
+//------------------------------------------------------------------------------------
+// Atlas
+//------------------------------------------------------------------------------------
+
+static TextGlyph GetAtlasGlyph(Font font, int codepoint)
+{
+	TextGlyph glyph = { 0 };
+	if (font.glyphs == NULL || font.recs == NULL || font.glyphCount == 0) return glyph;
+
+	int index = GetGlyphIndex(font, codepoint);
+	Rectangle rec = font.recs[index];
+	float padding = (float)font.glyphPadding;
+
+	glyph.source = (Rectangle){ rec.x - padding, rec.y - padding, rec.width + 2.0f*padding, rec.height + 2.0f*padding };
+	glyph.offsetX = (float)font.glyphs[index].offsetX - padding;
+	glyph.offsetY = (float)font.glyphs[index].offsetY - padding;
+	glyph.advance = (font.glyphs[index].advanceX == 0)? rec.width : (float)font.glyphs[index].advanceX;
+	glyph.visible = (codepoint != ' ');
+	return glyph;
+}
+
+TextAtlas LoadTextAtlas(Font font)
+{
+	TextAtlas atlas = { 0 };
+	atlas.texture = font.texture;
+	atlas.baseSize = (font.baseSize > 0)? (float)font.baseSize : 1.0f;
+
+	for (int i = 0; i < TEXT_CHAR_COUNT; i++) atlas.glyphs[i] = GetAtlasGlyph(font, TEXT_FIRST_CHAR + i);
+	atlas.fallback = atlas.glyphs['?' - TEXT_FIRST_CHAR];
+	return atlas;
+}
+
+//------------------------------------------------------------------------------------
+// Layout
+//------------------------------------------------------------------------------------
+
+static unsigned int HashText(const char *text, float size, float spacing)
+{
+	unsigned int hash = 2166136261u;
+	for (const unsigned char *c = (const unsigned char *)text; *c != '\0'; c++) hash = (hash ^ *c)*16777619u;
+
+	unsigned int bits[2];
+	memcpy(&bits[0], &size, sizeof(float));
+	memcpy(&bits[1], &spacing, sizeof(float));
+	hash = (hash ^ bits[0])*16777619u;
+	hash = (hash ^ bits[1])*16777619u;
+	return hash;
+}
+
+static void LayoutText(const TextAtlas *atlas, TextLayout *layout, const char *text)
+{
+	float scale = layout->size/atlas->baseSize;
+	float x = 0.0f, y = 0.0f, width = 0.0f;
+	int lines = 1;
+	float tw = (atlas->texture.width > 0)? (float)atlas->texture.width : 1.0f, th = (atlas->texture.height > 0)? (float)atlas->texture.height : 1.0f;
+	layout->quadCount = 0;
+
+	for (const unsigned char *c = (const unsigned char *)text; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			if (x - layout->spacing > width) width = x - layout->spacing;
+			x = 0.0f;
+			y += layout->size + TEXT_LINE_SPACING;
+			lines++;
+			continue;
+		}
+		if (*c >= 0x80 && *c < 0xC0) continue;	// UTF-8 continuation, the lead byte drew the '?'
+
+		const TextGlyph *glyph = (*c >= TEXT_FIRST_CHAR && *c < TEXT_FIRST_CHAR + TEXT_CHAR_COUNT)? &atlas->glyphs[*c - TEXT_FIRST_CHAR] : &atlas->fallback;
+		if (*c == '\t') glyph = &atlas->glyphs[0];
+
+		if (glyph->visible)
+		{
+			if (layout->quadCount == layout->quadCapacity)
+			{
+				int capacity = (layout->quadCapacity > 0)? layout->quadCapacity*2 : 16;
+				SpriteQuad *quads = realloc(layout->quads, (size_t)capacity*sizeof(SpriteQuad));
+				if (quads == NULL)
+				{
+					TraceLog(LOG_WARNING, "TEXT: Out of memory, layout cut short");
+					break;
+				}
+				layout->quads = quads;
+				layout->quadCapacity = capacity;
+			}
+
+			layout->quads[layout->quadCount++] = (SpriteQuad){
+				{ x + glyph->offsetX*scale, y + glyph->offsetY*scale, glyph->source.width*scale, glyph->source.height*scale },
+				glyph->source.x/tw, glyph->source.y/th, (glyph->source.x + glyph->source.width)/tw, (glyph->source.y + glyph->source.height)/th,
+				WHITE
+			};
+		}
+		x += glyph->advance*scale + layout->spacing;
+	}
+
+	if (x - layout->spacing > width) width = x - layout->spacing;
+	layout->extent = (Vector2){ (width > 0.0f)? width : 0.0f, lines*layout->size + (lines - 1)*TEXT_LINE_SPACING };
+}
+
+//------------------------------------------------------------------------------------
+// Cache
+//------------------------------------------------------------------------------------
+
+TextCache LoadTextCache(const TextAtlas *atlas)
+{
+	TextCache cache = { 0 };
+	cache.atlas = atlas;
+	cache.slots = calloc(TEXT_CACHE_SLOTS, sizeof(TextLayout));
+	return cache;
+}
+
+static void FreeTextLayout(TextLayout *layout)
+{
+	free(layout->text);
+	free(layout->quads);
+	memset(layout, 0, sizeof(*layout));
+}
+
+void UnloadTextCache(TextCache *cache)
+{
+	if (cache->slots != NULL) for (int i = 0; i < TEXT_CACHE_SLOTS; i++) FreeTextLayout(&cache->slots[i]);
+	free(cache->slots);
+	FreeTextLayout(&cache->scratch);
+	memset(cache, 0, sizeof(*cache));
+}
+
+// Linear probing without tombstones: layouts after the freed slot that would no longer be
+// found from their home slot are shifted back into the gap
+static void RemoveTextLayout(TextCache *cache, int gap)
+{
+	FreeTextLayout(&cache->slots[gap]);
+	cache->count--;
+
+	for (int slot = (gap + 1) & TEXT_CACHE_MASK; cache->slots[slot].text != NULL; slot = (slot + 1) & TEXT_CACHE_MASK)
+	{
+		int home = (int)(cache->slots[slot].hash & TEXT_CACHE_MASK);
+		bool reachable = (gap <= slot)? (home > gap && home <= slot) : (home > gap || home <= slot);
+		if (reachable) continue;
+
+		cache->slots[gap] = cache->slots[slot];
+		memset(&cache->slots[slot], 0, sizeof(TextLayout));
+		gap = slot;
+	}
+}
+
+void BeginTextFrame(TextCache *cache)
+{
+	cache->frame++;
+	cache->stats = (TextCacheStats){ 0 };
+	if (cache->slots == NULL) return;
+
+	// Counters that change every frame fill the table quickly, then only what is still on screen stays
+	int maxAge = TEXT_CACHE_MAX_AGE;
+	if (cache->count >= TEXT_CACHE_CROWDED) maxAge = 1;
+	else if (cache->frame % TEXT_CACHE_EVICT_INTERVAL != 0) return;
+
+	for (int i = 0; i < TEXT_CACHE_SLOTS; i++)
+	{
+		// A shifted layout can land in the slot just freed, so look at it again
+		while (cache->slots[i].text != NULL && cache->frame - cache->slots[i].frame > maxAge)
+		{
+			RemoveTextLayout(cache, i);
+			cache->stats.evictions++;
+		}
+	}
+}
+
+const TextLayout *GetTextLayout(TextCache *cache, const char *text, float size, float spacing)
+{
+	unsigned int hash = HashText(text, size, spacing);
+	int slot = (int)(hash & TEXT_CACHE_MASK);
+
+	if (cache->slots != NULL)
+	{
+		while (cache->slots[slot].text != NULL)
+		{
+			TextLayout *layout = &cache->slots[slot];
+			if (layout->hash == hash && layout->size == size && layout->spacing == spacing && strcmp(layout->text, text) == 0)
+			{
+				layout->frame = cache->frame;
+				cache->stats.hits++;
+				return layout;
+			}
+			slot = (slot + 1) & TEXT_CACHE_MASK;
+		}
+	}
+
+	cache->stats.misses++;
+	TextLayout *layout = &cache->scratch;
+	if (cache->slots != NULL && cache->count < TEXT_CACHE_LIMIT)
+	{
+		char *copy = malloc(strlen(text) + 1);
+		if (copy != NULL)
+		{
+			layout = &cache->slots[slot];
+			layout->text = strcpy(copy, text);
+			cache->count++;
+		}
+	}
+
+	layout->hash = hash;
+	layout->size = size;
+	layout->spacing = spacing;
+	layout->frame = cache->frame;
+	LayoutText(cache->atlas, layout, text);
+	return layout;
+}
+
+Vector2 MeasureTextCached(TextCache *cache, const char *text, float size, float spacing)
+{
+	return GetTextLayout(cache, text, size, spacing)->extent;
+}
+
+void DrawTextCached(TextCache *cache, SpriteBatch *batch, const char *text, Vector2 position, float size, float spacing, Color color)
+{
+	const TextLayout *layout = GetTextLayout(cache, text, size, spacing);
+	PushSpriteQuads(batch, cache->atlas->texture, layout->quads, layout->quadCount, position, color);
+	cache->stats.quads += layout->quadCount;
+}
@@ -0,0 +1,73 @@
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include "raylib.h"
+#include "spritebatch.h"
+
+// HUD and debug text drawn through a sprite batch. The font's glyphs are flattened into a
+// table indexed by character, and each string is laid out once into quads relative to its
+// origin; while the same string is drawn again at the same size the cached quads are just
+// offset into the batch, so unchanged lines skip measuring and glyph lookups entirely.
+// Layouts nobody drew for TEXT_CACHE_MAX_AGE frames are dropped, and once the table is
+// half full so is every layout that was not drawn the frame before.
+// Printable ASCII only, anything else draws as '?', spacing and lines match DrawTextEx().
+
+#define TEXT_FIRST_CHAR 32
+#define TEXT_CHAR_COUNT 95	// ' ' to '~'
+#define TEXT_LINE_SPACING 2	// raylib's default between lines, in pixels
+#define TEXT_CACHE_SLOTS 1024	// Power of two, layouts beyond 3/4 of it are laid out every draw
+#define TEXT_CACHE_MAX_AGE 120	// Frames
+
+typedef struct TextGlyph {
+	Rectangle source;	// Texels, with the padding
+	float offsetX;	// From the pen to the quad, with the padding, at the base size
+	float offsetY;
+	float advance;
+	bool visible;
+} TextGlyph;
+
+typedef struct TextAtlas {
+	Texture2D texture;
+	float baseSize;
+	TextGlyph glyphs[TEXT_CHAR_COUNT];
+	TextGlyph fallback;	// '?'
+} TextAtlas;
+
+typedef struct TextLayout {
+	char *text;	// Own copy, NULL in a free slot
+	unsigned int hash;
+	float size;
+	float spacing;
+	int frame;	// Last drawn
+	SpriteQuad *quads;	// From the origin
+	int quadCount;
+	int quadCapacity;
+	Vector2 extent;
+} TextLayout;
+
+typedef struct TextCacheStats {
+	int hits;
+	int misses;
+	int quads;
+	int evictions;
+} TextCacheStats;
+
+typedef struct TextCache {
+	const TextAtlas *atlas;
+	TextLayout *slots;	// TEXT_CACHE_SLOTS, open addressed
+	int count;
+	int frame;
+	TextLayout scratch;	// Misses that did not fit in the table
+	TextCacheStats stats;	// Since BeginTextFrame()
+} TextCache;
+
+TextAtlas LoadTextAtlas(Font font);	// Keeps using the font's texture, unload the font as usual
+TextCache LoadTextCache(const TextAtlas *atlas);
+void UnloadTextCache(TextCache *cache);
+
+void BeginTextFrame(TextCache *cache);	// Once per frame, ages out old layouts
+const TextLayout *GetTextLayout(TextCache *cache, const char *text, float size, float spacing);	// Valid until the next call
+Vector2 MeasureTextCached(TextCache *cache, const char *text, float size, float spacing);
+void DrawTextCached(TextCache *cache, SpriteBatch *batch, const char *text, Vector2 position, float size, float spacing, Color color);
+
+#endif
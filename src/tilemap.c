@@ -0,0 +1,212 @@
+#include "tilemap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+Tilemap LoadTilemap(const char *fileName)
+{
+	Image image = LoadImage(fileName);
+	Tilemap map = LoadTilemapFromImage(image);
+	UnloadImage(image);
+	return map;
+}
+
+Tilemap GenTilemapEmpty(int width, int height)
+{
+	Tilemap map = { 0 };
+	map.width = width;
+	map.height = height;
+	map.tiles = calloc((size_t)width*height, 1);
+	map.palette[TILE_EMPTY] = BLANK;
+	map.paletteCount = 1;
+	return map;
+}
+
+int AddTilemapColor(Tilemap *map, Color color)
+{
+	if (color.a == 0) return TILE_EMPTY;
+
+	for (int i = 1; i < map->paletteCount; i++)
+	{
+		Color c = map->palette[i];
+		if (c.r == color.r && c.g == color.g && c.b == color.b && c.a == color.a) return i;
+	}
+
+	if (map->paletteCount == TILEMAP_MAX_PALETTE)
+	{
+		TraceLog(LOG_WARNING, "TILEMAP: Palette full, colour treated as empty");
+		return TILE_EMPTY;
+	}
+
+	map->palette[map->paletteCount] = color;
+	return map->paletteCount++;
+}
+
+Tilemap LoadTilemapFromImage(Image image)
+{
+	Tilemap map = GenTilemapEmpty(image.width, image.height);
+	if (image.data == NULL) return map;
+
+	Color *pixels = LoadImageColors(image);
+	int lastIndex = TILE_EMPTY;
+	Color last = BLANK;
+
+	for (int i = 0; i < image.width*image.height; i++)
+	{
+		Color c = pixels[i];
+		// Maps are mostly runs of the same colour, skip the palette search for those
+		if (c.r != last.r || c.g != last.g || c.b != last.b || c.a != last.a)
+		{
+			last = c;
+			lastIndex = AddTilemapColor(&map, c);
+		}
+		map.tiles[i] = (unsigned char)lastIndex;
+	}
+
+	UnloadImageColors(pixels);
+	return map;
+}
+
+void UnloadTilemap(Tilemap map)
+{
+	free(map.tiles);
+}
+
+Image ExportTilemapImage(Tilemap map)
+{
+	Image image = GenImageColor(map.width, map.height, BLANK);
+	Color *pixels = image.data;
+
+	for (int i = 0; i < map.width*map.height; i++) pixels[i] = map.palette[map.tiles[i]];
+
+	return image;
+}
+
+bool CheckCollisionTilemapRec(const Tilemap *map, Rectangle rec)
+{
+	int x0 = (int)floorf(rec.x/TILE_SIZE);
+	int y0 = (int)floorf(rec.y/TILE_SIZE);
+	// Shrink by a hair so a body resting exactly on a tile edge does not touch the next tile
+	int x1 = (int)floorf((rec.x + rec.width - 0.001f)/TILE_SIZE);
+	int y1 = (int)floorf((rec.y + rec.height - 0.001f)/TILE_SIZE);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			if (IsTileSolid(map, x, y)) return true;
+		}
+	}
+
+	return false;
+}
+
+#define SWEEP_EDGE 0.001f	// Same hair as CheckCollisionTilemapRec
+#define SWEEP_TIE 1e-6f
+
+static inline bool IsTileSpanSolid(const Tilemap *map, int fixed, float from, float to, bool column)
+{
+	int first = (int)floorf((from + SWEEP_EDGE)/TILE_SIZE);
+	int last = (int)floorf((to - SWEEP_EDGE)/TILE_SIZE);
+
+	for (int i = first; i <= last; i++)
+	{
+		if (column? IsTileSolid(map, fixed, i) : IsTileSolid(map, i, fixed)) return true;
+	}
+	return false;
+}
+
+TileSweep SweepTilemapRec(const Tilemap *map, Rectangle rec, Vector2 delta)
+{
+	TileSweep hit = { 1.0f, { 0.0f, 0.0f }, { rec.x + delta.x, rec.y + delta.y } };
+	int stepX = (delta.x > 0.0f) - (delta.x < 0.0f);
+	int stepY = (delta.y > 0.0f) - (delta.y < 0.0f);
+
+	// Next column and row the leading edges enter, and the fraction of the motion where they do
+	int col = 0, row = 0;
+	float tMaxX = 2.0f, tMaxY = 2.0f, tDeltaX = 0.0f, tDeltaY = 0.0f;
+	if (stepX != 0)
+	{
+		col = (stepX > 0)? (int)floorf((rec.x + rec.width - SWEEP_EDGE)/TILE_SIZE) + 1 : (int)floorf((rec.x + SWEEP_EDGE)/TILE_SIZE) - 1;
+		float edge = (stepX > 0)? (float)col*TILE_SIZE - (rec.x + rec.width) : (float)(col + 1)*TILE_SIZE - rec.x;
+		tMaxX = fmaxf(edge/delta.x, 0.0f);
+		tDeltaX = TILE_SIZE/fabsf(delta.x);
+	}
+	if (stepY != 0)
+	{
+		row = (stepY > 0)? (int)floorf((rec.y + rec.height - SWEEP_EDGE)/TILE_SIZE) + 1 : (int)floorf((rec.y + SWEEP_EDGE)/TILE_SIZE) - 1;
+		float edge = (stepY > 0)? (float)row*TILE_SIZE - (rec.y + rec.height) : (float)(row + 1)*TILE_SIZE - rec.y;
+		tMaxY = fmaxf(edge/delta.y, 0.0f);
+		tDeltaY = TILE_SIZE/fabsf(delta.y);
+	}
+
+	while (true)
+	{
+		if (tMaxX <= tMaxY)
+		{
+			if (tMaxX > 1.0f) break;
+
+			// Rows spanned when the column is entered. Entering a row at the same moment
+			// (through a corner) must include that row too, the edge test would drop it.
+			float y = rec.y + delta.y*tMaxX;
+			bool solid = IsTileSpanSolid(map, col, y, y + rec.height, true);
+			if (!solid && stepY != 0 && tMaxY - tMaxX <= SWEEP_TIE) solid = IsTileSolid(map, col, row);
+
+			if (solid)
+			{
+				hit.time = tMaxX;
+				hit.normal = (Vector2){ (float)-stepX, 0.0f };
+				hit.position.x = (stepX > 0)? (float)col*TILE_SIZE - rec.width : (float)(col + 1)*TILE_SIZE;
+				hit.position.y = y;
+				return hit;
+			}
+			col += stepX;
+			tMaxX += tDeltaX;
+		}
+		else
+		{
+			if (tMaxY > 1.0f) break;
+
+			float x = rec.x + delta.x*tMaxY;
+			bool solid = IsTileSpanSolid(map, row, x, x + rec.width, false);
+			if (!solid && stepX != 0 && tMaxX - tMaxY <= SWEEP_TIE) solid = IsTileSolid(map, col, row);
+
+			if (solid)
+			{
+				hit.time = tMaxY;
+				hit.normal = (Vector2){ 0.0f, (float)-stepY };
+				hit.position.x = x;
+				hit.position.y = (stepY > 0)? (float)row*TILE_SIZE - rec.height : (float)(row + 1)*TILE_SIZE;
+				return hit;
+			}
+			row += stepY;
+			tMaxY += tDeltaY;
+		}
+	}
+
+	return hit;
+}
+
+void SweepTilemapRecs(const Tilemap *map, Vector2 size, const float *posX, const float *posY,
+	const float *velX, const float *velY, float dt, int count, TileSweep *hits)
+{
+	for (int i = 0; i < count; i++)
+	{
+		Rectangle rec = { posX[i], posY[i], size.x, size.y };
+		hits[i] = SweepTilemapRec(map, rec, (Vector2){ velX[i]*dt, velY[i]*dt });
+	}
+}
+
+void DrawTilemap(Tilemap map)
+{
+	for (int y = 0; y < map.height; y++)
+	{
+		for (int x = 0; x < map.width; x++)
+		{
+			unsigned char tile = map.tiles[y*map.width + x];
+			if (tile == TILE_EMPTY) continue;
+			DrawRectangle(x*TILE_SIZE, y*TILE_SIZE, TILE_SIZE, TILE_SIZE, map.palette[tile]);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include "raylib.h"
+
+#define TILE_SIZE 64
+#define TILE_EMPTY 0
+#define TILEMAP_MAX_PALETTE 64
+
+// Maps are authored as PNGs where every pixel is one tile:
+// transparent pixels are empty space, every distinct opaque colour is a tile type.
+typedef struct Tilemap {
+	int width;
+	int height;
+	unsigned char *tiles;	// palette index per tile, TILE_EMPTY for empty space
+	int paletteCount;
+	Color palette[TILEMAP_MAX_PALETTE];
+} Tilemap;
+
+Tilemap LoadTilemap(const char *fileName);
+Tilemap LoadTilemapFromImage(Image image);
+Tilemap GenTilemapEmpty(int width, int height);
+void UnloadTilemap(Tilemap map);
+Image ExportTilemapImage(Tilemap map);	// Inverse of LoadTilemapFromImage, unload with UnloadImage()
+
+int AddTilemapColor(Tilemap *map, Color color);	// Returns the palette index, TILE_EMPTY if the palette is full
+
+static inline bool IsTileSolid(const Tilemap *map, int x, int y)
+{
+	// Everything outside the map counts as wall so nothing can leave it
+	if (x < 0 || y < 0 || x >= map->width || y >= map->height) return true;
+	return map->tiles[y*map->width + x] != TILE_EMPTY;
+}
+
+bool CheckCollisionTilemapRec(const Tilemap *map, Rectangle rec);
+
+// First contact of a rectangle moving by some delta, found by walking the tiles its
+// leading edges enter in order (Amanatides-Woo traversal), so nothing can tunnel
+typedef struct TileSweep {
+	float time;	// Fraction of the motion before contact, 1 when nothing was hit
+	Vector2 normal;	// Of the face hit, zero when nothing was
+	Vector2 position;	// Where the rectangle stops, flush against the face hit
+} TileSweep;
+
+TileSweep SweepTilemapRec(const Tilemap *map, Rectangle rec, Vector2 delta);	// rec must start clear of walls
+// Batched over bodies of one size moving by vel*dt, arrays laid out as in Entities
+void SweepTilemapRecs(const Tilemap *map, Vector2 size, const float *posX, const float *posY,
+	const float *velX, const float *velY, float dt, int count, TileSweep *hits);
+void DrawTilemap(Tilemap map);
+
+#endif
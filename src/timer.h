@@ -0,0 +1,30 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <time.h>
+
+#if defined(_WIN32)
+	void __stdcall Sleep(unsigned long msTimeout);
+#endif
+
+// Monotonic clock that also works before InitWindow(), where raylib's GetTime() returns 0
+static inline double GetTimerSeconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+// Sleeps without raylib's WaitTime(), which busy waits on GetTime() and never returns headless
+static inline void WaitTimerSeconds(double seconds)
+{
+	if (seconds <= 0.0) return;
+#if defined(_WIN32)
+	Sleep((unsigned long)(seconds*1000.0));
+#else
+	struct timespec ts = { (time_t)seconds, (long)((seconds - (double)(time_t)seconds)*1e9) };
+	nanosleep(&ts, NULL);
+#endif
+}
+
+#endif
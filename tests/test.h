@@ -0,0 +1,40 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+
+// Correctness checks, separate from the bench so they run fast enough for every build
+// and fail it. ctest runs one suite per test (tests --filter fov/); any failed check makes
+// the process exit non-zero.
+
+typedef struct Tests {
+	const char *filter;	// Only run suites whose prefix contains this, or that it names
+	int checks;
+	int failures;
+} Tests;
+
+bool IsTestEnabled(const Tests *tests, const char *prefix);
+// Counts the check and prints "FAIL: <message>" when it did not pass; returns `passed`
+bool CheckTest(Tests *tests, bool passed, const char *format, ...);
+
+// Suites, one per area of the game
+void RunSnapshotTests(Tests *tests);	// Also lz/
+void RunQueueTests(Tests *tests);
+void RunBroadPhaseTests(Tests *tests);
+void RunCollisionTests(Tests *tests);
+void RunFovTests(Tests *tests);
+void RunSwarmTests(Tests *tests);
+void RunMixerTests(Tests *tests);
+void RunTextTests(Tests *tests);
+void RunChunkTests(Tests *tests);
+void RunFramePacerTests(Tests *tests);
+void RunPatternTests(Tests *tests);
+void RunBehaviourTests(Tests *tests);
+void RunEventTests(Tests *tests);
+void RunParallaxTests(Tests *tests);
+void RunLightingTests(Tests *tests);
+void RunMapGenTests(Tests *tests);
+void RunDebugUiTests(Tests *tests);
+void RunReloadTests(Tests *tests);
+
+#endif
@@ -0,0 +1,181 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "behaviour.h"
+
+#define BEHAVIOUR_AGENTS 256
+#define BEHAVIOUR_TICKS 100
+
+typedef struct BehaviourTest {
+	int calls[2];	// count, wait_three
+	float pos[BEHAVIOUR_AGENTS];
+	int shots[BEHAVIOUR_AGENTS];
+	int tick;
+} BehaviourTest;
+
+static BehaviourStatus LeafCount(void *context, int agent, float param)
+{
+	(void)agent;
+	(void)param;
+	((BehaviourTest *)context)->calls[0]++;
+	return BEHAVIOUR_SUCCESS;
+}
+
+static BehaviourStatus LeafWaitThree(void *context, int agent, float param)
+{
+	(void)agent;
+	(void)param;
+	return (++((BehaviourTest *)context)->calls[1]%3 == 0)? BEHAVIOUR_SUCCESS : BEHAVIOUR_RUNNING;
+}
+
+// Agents live on a line and the player at 0
+static BehaviourStatus LeafNear(void *context, int agent, float radius)
+{
+	float pos = ((BehaviourTest *)context)->pos[agent];
+	return (pos < radius && pos > -radius)? BEHAVIOUR_SUCCESS : BEHAVIOUR_FAILURE;
+}
+
+static BehaviourStatus LeafApproach(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourTest *t = context;
+	t->pos[agent] += (t->pos[agent] > 0.0f)? -3.0f : 3.0f;
+	return (t->pos[agent] < 8.0f && t->pos[agent] > -8.0f)? BEHAVIOUR_SUCCESS : BEHAVIOUR_RUNNING;
+}
+
+static BehaviourStatus LeafShoot(void *context, int agent, float param)
+{
+	(void)param;
+	((BehaviourTest *)context)->shots[agent]++;
+	return BEHAVIOUR_SUCCESS;
+}
+
+// Hashed from the agent and tick so the result does not depend on the tick order
+static BehaviourStatus LeafWander(void *context, int agent, float param)
+{
+	(void)param;
+	BehaviourTest *t = context;
+	unsigned int h = (unsigned int)agent*0x9e3779b9u ^ (unsigned int)t->tick*0x85ebca6bu;
+	h ^= h >> 15;
+	t->pos[agent] += (float)(h & 15) - 7.5f;
+	return BEHAVIOUR_SUCCESS;
+}
+
+static void RegisterTestLeaves(BehaviourLibrary *library)
+{
+	RegisterBehaviourLeaf(library, "count", LeafCount);
+	RegisterBehaviourLeaf(library, "wait_three", LeafWaitThree);
+	RegisterBehaviourLeaf(library, "near", LeafNear);
+	RegisterBehaviourLeaf(library, "approach", LeafApproach);
+	RegisterBehaviourLeaf(library, "shoot", LeafShoot);
+	RegisterBehaviourLeaf(library, "wander", LeafWander);
+}
+
+// A sequence resumes its running child instead of starting over, a cooldown holds its
+// child back, and broken sources are refused
+static void CheckComposites(Tests *tests, const BehaviourLibrary *library)
+{
+	BehaviourTest t = { 0 };
+	BehaviourTree tree;
+	int state[BEHAVIOUR_MAX_NODES] = { 0 };
+	if (CheckTest(tests, CompileBehaviourTree("sequence\n\tcount\n\twait_three\n", library, &tree), "behaviour/sequence: tree does not compile"))
+	{
+		for (int tick = 1; tick <= 4; tick++) TickBehaviourAgent(&tree, library, state, 0, tick, &t, NULL);
+		CheckTest(tests, t.calls[0] == 2 && t.calls[1] == 4, "behaviour/sequence: ran count %d and wait_three %d times, expected 2 and 4", t.calls[0], t.calls[1]);
+	}
+
+	memset(state, 0, sizeof(state));
+	t.calls[0] = 0;
+	if (CheckTest(tests, CompileBehaviourTree("cooldown 5\n\tcount\n", library, &tree), "behaviour/cooldown: tree does not compile"))
+	{
+		for (int tick = 1; tick <= 10; tick++) TickBehaviourAgent(&tree, library, state, 0, tick, &t, NULL);
+		CheckTest(tests, t.calls[0] == 2, "behaviour/cooldown: child ran %d times in 10 ticks, expected 2", t.calls[0]);
+	}
+
+	static const char *broken[] = { "", "sequence\n", "count\n\tcount\n", "invert\n\tcount\n\tcount\n", "count\ncount\n", "cooldown\n\tcount\n", "dance\n" };
+	SetTraceLogLevel(LOG_ERROR);
+	for (int i = 0; i < (int)(sizeof(broken)/sizeof(broken[0])); i++)
+	{
+		CheckTest(tests, !CompileBehaviourTree(broken[i], library, &tree), "behaviour/broken: tree %d compiled", i);
+	}
+	SetTraceLogLevel(LOG_WARNING);
+}
+
+static const char *batchSources[2] = {
+	"selector\n"
+	"	sequence\n"
+	"		near 40\n"
+	"		cooldown 4\n"
+	"			shoot\n"
+	"	sequence\n"
+	"		near 400\n"
+	"		approach\n"
+	"	wander\n",
+
+	"selector\n"
+	"	sequence\n"
+	"		invert\n"
+	"			near 100\n"
+	"		approach\n"
+	"	cooldown 3\n"
+	"		shoot\n",
+};
+
+static void ResetBatchWorld(BehaviourTest *t)
+{
+	*t = (BehaviourTest){ 0 };
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++) t->pos[i] = (float)((i*97)%1000) - 500.0f;
+}
+
+// Batches per tree and agents one at a time in spawn order, trees interleaved, end up in
+// the same world
+static void CheckBatches(Tests *tests, const BehaviourLibrary *library)
+{
+	BehaviourTree trees[2];
+	for (int i = 0; i < 2; i++)
+	{
+		if (!CheckTest(tests, CompileBehaviourTree(batchSources[i], library, &trees[i]), "behaviour/batch: tree %d does not compile", i)) return;
+	}
+
+	BehaviourTest *batched = malloc(sizeof(BehaviourTest)), *single = malloc(sizeof(BehaviourTest));
+	ResetBatchWorld(batched);
+	ResetBatchWorld(single);
+
+	BehaviourBatch batches[2] = { LoadBehaviourBatch(&trees[0], BEHAVIOUR_AGENTS), LoadBehaviourBatch(&trees[1], BEHAVIOUR_AGENTS) };
+	int stride = (trees[0].stateSize > trees[1].stateSize)? trees[0].stateSize : trees[1].stateSize;
+	int *states = calloc((size_t)BEHAVIOUR_AGENTS*(stride > 0? stride : 1), sizeof(int));
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++) AddBehaviourAgent(&batches[i%3 == 0], i);
+
+	for (int tick = 1; tick <= BEHAVIOUR_TICKS; tick++)
+	{
+		batched->tick = tick;
+		for (int i = 0; i < 2; i++) TickBehaviourBatch(&batches[i], library, batched);
+		single->tick = tick;
+		for (int i = 0; i < BEHAVIOUR_AGENTS; i++) TickBehaviourAgent(&trees[i%3 == 0], library, &states[i*stride], i, tick, single, NULL);
+	}
+
+	int shots = 0;
+	for (int i = 0; i < BEHAVIOUR_AGENTS; i++) shots += batched->shots[i];
+	CheckTest(tests, shots > 0, "behaviour/batch: no agent ever shot, the trees are not exercised");
+	CheckTest(tests, memcmp(batched->pos, single->pos, sizeof(batched->pos)) == 0 && memcmp(batched->shots, single->shots, sizeof(batched->shots)) == 0,
+		"behaviour/batch: batched ticks differ from ticking agents one at a time");
+
+	UnloadBehaviourBatch(&batches[0]);
+	UnloadBehaviourBatch(&batches[1]);
+	free(states);
+	free(batched);
+	free(single);
+}
+
+void RunBehaviourTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "behaviour/")) return;
+
+	BehaviourLibrary library = { 0 };
+	RegisterTestLeaves(&library);
+	CheckComposites(tests, &library);
+	CheckBatches(tests, &library);
+}
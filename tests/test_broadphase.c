@@ -0,0 +1,254 @@
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "broadphase.h"
+#include "rng.h"
+
+#define BROADPHASE_SEED 39
+#define BROADPHASE_WORLD 4096.0f
+#define BROADPHASE_PROXIES 2000
+#define BROADPHASE_STATICS 400	// The first ones, never moved
+#define BROADPHASE_QUERIES 200
+#define BROADPHASE_CLUSTERS 12
+#define BROADPHASE_CAPACITY (1 << 18)
+#define BROADPHASE_KINDS 3	// Grid, tree, sweep and prune
+#define BROADPHASE_MOVE_TICKS 60
+#define BROADPHASE_JUMP_EVERY 97	// Every this many moving proxies one jumps across the world instead
+
+// Every broad-phase holds the same proxies, the brute force answers come from the recs
+typedef struct BroadPhaseTest {
+	const char *scene;
+	BroadPhase bps[BROADPHASE_KINDS];
+	int proxies[BROADPHASE_KINDS][BROADPHASE_PROXIES];
+	Rectangle recs[BROADPHASE_PROXIES];
+	Vector2 velocities[BROADPHASE_PROXIES];
+	Rectangle queries[BROADPHASE_QUERIES];
+	Vector2 origins[BROADPHASE_QUERIES];
+	Vector2 deltas[BROADPHASE_QUERIES];
+	BroadPhasePair *pairs;
+	BroadPhasePair *expectedPairs;
+	BroadPhaseHit *hits;
+	BroadPhaseHit *expectedHits;
+} BroadPhaseTest;
+
+static Vector2 GetTestPoint(Rng *rng, const Vector2 *centres, float size)
+{
+	const float extent = BROADPHASE_WORLD - size;
+	if (centres == NULL) return (Vector2){ NextRngFloat(rng)*extent, NextRngFloat(rng)*extent };
+
+	const Vector2 centre = centres[NextRng(rng)%BROADPHASE_CLUSTERS];
+	float angle = NextRngFloat(rng)*2.0f*PI, distance = NextRngFloat(rng)*NextRngFloat(rng)*384.0f;
+	return (Vector2){
+		fminf(fmaxf(centre.x + cosf(angle)*distance, 0.0f), extent),
+		fminf(fmaxf(centre.y + sinf(angle)*distance, 0.0f), extent),
+	};
+}
+
+static void FillBroadPhaseTest(BroadPhaseTest *t, const char *scene, bool clustered)
+{
+	Rng rng = SeedRng(BROADPHASE_SEED);
+	Vector2 centres[BROADPHASE_CLUSTERS];
+	for (int i = 0; i < BROADPHASE_CLUSTERS; i++)
+	{
+		centres[i] = (Vector2){ 512.0f + NextRngFloat(&rng)*(BROADPHASE_WORLD - 1024.0f), 512.0f + NextRngFloat(&rng)*(BROADPHASE_WORLD - 1024.0f) };
+	}
+
+	Rectangle bounds = { 0.0f, 0.0f, BROADPHASE_WORLD, BROADPHASE_WORLD };
+	t->scene = scene;
+	t->bps[0] = CreateGridBroadPhase(bounds, 64.0f);
+	t->bps[1] = CreateTreeBroadPhase(8.0f);
+	t->bps[2] = CreateSweepBroadPhase();
+
+	for (int i = 0; i < BROADPHASE_PROXIES; i++)
+	{
+		float size = (i < BROADPHASE_STATICS)? 128.0f : 32.0f;
+		Vector2 p = GetTestPoint(&rng, clustered? centres : NULL, size);
+		float angle = NextRngFloat(&rng)*2.0f*PI, speed = (i < BROADPHASE_STATICS)? 0.0f : NextRngFloat(&rng)*6.0f;
+		t->recs[i] = (Rectangle){ p.x, p.y, size*(0.125f + 0.875f*NextRngFloat(&rng)), size*(0.125f + 0.875f*NextRngFloat(&rng)) };
+		t->velocities[i] = (Vector2){ cosf(angle)*speed, sinf(angle)*speed };
+		for (int k = 0; k < BROADPHASE_KINDS; k++) t->proxies[k][i] = CreateBroadPhaseProxy(&t->bps[k], t->recs[i], i);
+	}
+
+	for (int i = 0; i < BROADPHASE_QUERIES; i++)
+	{
+		Vector2 p = GetTestPoint(&rng, clustered? centres : NULL, 64.0f);
+		float angle = NextRngFloat(&rng)*2.0f*PI;
+		t->queries[i] = (Rectangle){ p.x, p.y, 64.0f, 64.0f };
+		t->origins[i] = p;
+		t->deltas[i] = (Vector2){ cosf(angle)*512.0f, sinf(angle)*512.0f };
+	}
+}
+
+// One tick: moving proxies bounce off the world's edges, a few jump far enough to leave the
+// tree's fat boxes and cross many sweep endpoints at once, and one is destroyed and made again
+static void MoveBroadPhaseTest(BroadPhaseTest *t, int tick)
+{
+	for (int i = BROADPHASE_STATICS; i < BROADPHASE_PROXIES; i++)
+	{
+		Rectangle *rec = &t->recs[i];
+		Vector2 *v = &t->velocities[i];
+		if (rec->x + v->x < 0.0f || rec->x + rec->width + v->x > BROADPHASE_WORLD) v->x = -v->x;
+		if (rec->y + v->y < 0.0f || rec->y + rec->height + v->y > BROADPHASE_WORLD) v->y = -v->y;
+
+		Vector2 d = *v;
+		if ((i + tick)%BROADPHASE_JUMP_EVERY == 0)
+		{
+			d.x = fmodf(rec->x + 1777.0f, BROADPHASE_WORLD - rec->width) - rec->x;
+			d.y = fmodf(rec->y + 2333.0f, BROADPHASE_WORLD - rec->height) - rec->y;
+		}
+		rec->x += d.x;
+		rec->y += d.y;
+		for (int k = 0; k < BROADPHASE_KINDS; k++) MoveBroadPhaseProxy(&t->bps[k], t->proxies[k][i], *rec, d);
+	}
+
+	int remade = BROADPHASE_STATICS + (tick*37)%(BROADPHASE_PROXIES - BROADPHASE_STATICS);
+	for (int k = 0; k < BROADPHASE_KINDS; k++)
+	{
+		DestroyBroadPhaseProxy(&t->bps[k], t->proxies[k][remade]);
+		t->proxies[k][remade] = CreateBroadPhaseProxy(&t->bps[k], t->recs[remade], remade);
+	}
+}
+
+static void UnloadBroadPhaseTest(BroadPhaseTest *t)
+{
+	for (int k = 0; k < BROADPHASE_KINDS; k++) UnloadBroadPhase(&t->bps[k]);
+}
+
+static int ComparePairs(const void *a, const void *b)
+{
+	const BroadPhasePair *x = a, *y = b;
+	if (x->userDataA != y->userDataA) return (x->userDataA > y->userDataA) - (x->userDataA < y->userDataA);
+	return (x->userDataB > y->userDataB) - (x->userDataB < y->userDataB);
+}
+
+static int CompareHits(const void *a, const void *b)
+{
+	const BroadPhaseHit *x = a, *y = b;
+	if (x->query != y->query) return (x->query > y->query) - (x->query < y->query);
+	return (x->userData > y->userData) - (x->userData < y->userData);
+}
+
+// Lowest user data first in each pair, then sorted, so lists from any broad-phase compare directly
+static void SortPairs(BroadPhasePair *pairs, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (pairs[i].userDataA > pairs[i].userDataB)
+		{
+			int a = pairs[i].userDataA;
+			pairs[i].userDataA = pairs[i].userDataB;
+			pairs[i].userDataB = a;
+		}
+	}
+	qsort(pairs, count, sizeof(BroadPhasePair), ComparePairs);
+}
+
+static bool SamePairs(const BroadPhasePair *a, const BroadPhasePair *b, int count)
+{
+	for (int i = 0; i < count; i++) if (ComparePairs(&a[i], &b[i]) != 0) return false;
+	return true;
+}
+
+static bool SameHits(const BroadPhaseHit *a, const BroadPhaseHit *b, int count)
+{
+	for (int i = 0; i < count; i++) if (CompareHits(&a[i], &b[i]) != 0) return false;
+	return true;
+}
+
+// Every broad-phase must report exactly the overlaps and segment hits testing all recs finds
+static void CheckBroadPhaseResults(Tests *tests, BroadPhaseTest *t, const char *when)
+{
+	int expectedPairs = 0;
+	for (int i = 0; i < BROADPHASE_PROXIES; i++)
+	{
+		for (int j = i + 1; j < BROADPHASE_PROXIES; j++)
+		{
+			if (OverlapBroadPhaseRecs(t->recs[i], t->recs[j]) && expectedPairs < BROADPHASE_CAPACITY) t->expectedPairs[expectedPairs++] = (BroadPhasePair){ i, j };
+		}
+	}
+
+	for (int k = 0; k < BROADPHASE_KINDS; k++)
+	{
+		BroadPhase *bp = &t->bps[k];
+		int found = bp->findPairs(bp->data, t->pairs, BROADPHASE_CAPACITY);
+		if (found > BROADPHASE_CAPACITY) found = BROADPHASE_CAPACITY;	// Only what was written can be compared
+		SortPairs(t->pairs, found);
+		CheckTest(tests, found == expectedPairs && SamePairs(t->pairs, t->expectedPairs, found),
+			"broadphase/pairs: %s %s %s found %d pairs, brute force %d", bp->name, t->scene, when, found, expectedPairs);
+	}
+
+	int expectedHits = 0;
+	for (int q = 0; q < BROADPHASE_QUERIES; q++)
+	{
+		for (int i = 0; i < BROADPHASE_PROXIES; i++) if (OverlapBroadPhaseRecs(t->queries[q], t->recs[i]) && expectedHits < BROADPHASE_CAPACITY) t->expectedHits[expectedHits++] = (BroadPhaseHit){ q, i, 0.0f };
+	}
+	for (int k = 0; k < BROADPHASE_KINDS; k++)
+	{
+		BroadPhase *bp = &t->bps[k];
+		int found = bp->queryRecs(bp->data, t->queries, BROADPHASE_QUERIES, t->hits, BROADPHASE_CAPACITY);
+		if (found > BROADPHASE_CAPACITY) found = BROADPHASE_CAPACITY;
+		qsort(t->hits, found, sizeof(BroadPhaseHit), CompareHits);
+		CheckTest(tests, found == expectedHits && SameHits(t->hits, t->expectedHits, found),
+			"broadphase/queries: %s %s %s found %d overlaps, brute force %d", bp->name, t->scene, when, found, expectedHits);
+	}
+
+	expectedHits = 0;
+	for (int q = 0; q < BROADPHASE_QUERIES; q++)
+	{
+		for (int i = 0; i < BROADPHASE_PROXIES; i++)
+		{
+			float time;
+			if (IntersectSegmentRec(t->origins[q], t->deltas[q], t->recs[i], &time) && expectedHits < BROADPHASE_CAPACITY) t->expectedHits[expectedHits++] = (BroadPhaseHit){ q, i, time };
+		}
+	}
+	for (int k = 0; k < BROADPHASE_KINDS; k++)
+	{
+		BroadPhase *bp = &t->bps[k];
+		int found = bp->raycasts(bp->data, t->origins, t->deltas, BROADPHASE_QUERIES, t->hits, BROADPHASE_CAPACITY);
+		if (found > BROADPHASE_CAPACITY) found = BROADPHASE_CAPACITY;
+		qsort(t->hits, found, sizeof(BroadPhaseHit), CompareHits);
+		CheckTest(tests, found == expectedHits && SameHits(t->hits, t->expectedHits, found),
+			"broadphase/raycasts: %s %s %s found %d hits, brute force %d", bp->name, t->scene, when, found, expectedHits);
+	}
+}
+
+void RunBroadPhaseTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "broadphase/")) return;
+
+	static const struct { const char *name; bool clustered; } scenes[] = { { "uniform", false }, { "clustered", true } };
+	for (int s = 0; s < (int)(sizeof(scenes)/sizeof(scenes[0])); s++)
+	{
+		BroadPhaseTest *t = calloc(1, sizeof(BroadPhaseTest));
+		t->pairs = malloc(BROADPHASE_CAPACITY*sizeof(BroadPhasePair));
+		t->expectedPairs = malloc(BROADPHASE_CAPACITY*sizeof(BroadPhasePair));
+		t->hits = malloc(BROADPHASE_CAPACITY*sizeof(BroadPhaseHit));
+		t->expectedHits = malloc(BROADPHASE_CAPACITY*sizeof(BroadPhaseHit));
+		FillBroadPhaseTest(t, scenes[s].name, scenes[s].clustered);
+
+		CheckBroadPhaseResults(tests, t, "as built");
+
+		// What the sweep keeps sorted and cached and the tree refits is only exercised by moving
+		for (int tick = 1; tick <= BROADPHASE_MOVE_TICKS; tick++)
+		{
+			MoveBroadPhaseTest(t, tick);
+			if (tick == 1 || tick == 5 || tick%20 == 0)
+			{
+				char when[32];
+				snprintf(when, sizeof(when), "after %d ticks", tick);
+				CheckBroadPhaseResults(tests, t, when);
+			}
+		}
+
+		UnloadBroadPhaseTest(t);
+		free(t->pairs);
+		free(t->expectedPairs);
+		free(t->hits);
+		free(t->expectedHits);
+		free(t);
+	}
+}
@@ -0,0 +1,77 @@
+#include "test.h"
+
+#include <math.h>
+
+#include "raylib.h"
+#include "chunks.h"
+#include "rng.h"
+
+#define CHUNKS_SEED 36
+#define CHUNKS_WORLD_SIZE 16	// Chunks per side
+#define CHUNKS_TICKS 240
+#define CHUNKS_QUERIES 64	// Random tiles per tick, most of them in chunks far from the focus
+#define CHUNKS_STEP 90.0f	// Pixels per tick, a chunk every few ticks
+
+static const char *chunkFiles[] = { "res/maps/map01.png", "res/maps/map02.png" };
+
+// Walks a focus across the world while querying tiles near it and anywhere else. Every
+// answer must match the source map, whether the chunk was resident, still on its way from
+// the loader or long evicted, and the budget must hold.
+static void CheckStreamQueries(Tests *tests)
+{
+	Tilemap maps[2] = { LoadTilemap(chunkFiles[0]), LoadTilemap(chunkFiles[1]) };
+	unsigned short sources[CHUNKS_WORLD_SIZE*CHUNKS_WORLD_SIZE];
+	Rng rng = SeedRng(CHUNKS_SEED);
+	for (int i = 0; i < CHUNKS_WORLD_SIZE*CHUNKS_WORLD_SIZE; i++) sources[i] = (unsigned short)(NextRng(&rng)%2);
+
+	ChunkStream *stream = CreateChunkStream(chunkFiles, 2, CHUNKS_WORLD_SIZE, CHUNKS_WORLD_SIZE, sources, 1, 0);
+	if (!CheckTest(tests, stream != NULL && maps[0].tiles != NULL && maps[1].tiles != NULL, "chunks/query: could not load %s", chunkFiles[0]))
+	{
+		UnloadTilemap(maps[0]);
+		UnloadTilemap(maps[1]);
+		return;
+	}
+
+	int chunkWidth = maps[0].width, chunkHeight = maps[0].height;
+	int width = CHUNKS_WORLD_SIZE*chunkWidth, height = CHUNKS_WORLD_SIZE*chunkHeight;
+	Rectangle bounds = GetChunkStreamBounds(stream);
+	Vector2 focus = { bounds.width/2, bounds.height/2 };
+	int wrong = 0, overBudget = 0;
+
+	for (int t = 0; t < CHUNKS_TICKS; t++)
+	{
+		// Drifts right so the focus keeps reaching new chunks
+		focus.x = fminf(fmaxf(focus.x + (NextRngFloat(&rng)*2.0f - 0.5f)*CHUNKS_STEP, 0.0f), bounds.width - 1);
+		focus.y = fminf(fmaxf(focus.y + (NextRngFloat(&rng)*2.0f - 1.0f)*CHUNKS_STEP, 0.0f), bounds.height - 1);
+		UpdateChunkStream(stream, focus);
+
+		for (int q = 0; q <= CHUNKS_QUERIES; q++)
+		{
+			int x = (q == 0)? (int)(focus.x/TILE_SIZE) : (int)(NextRng(&rng)%width);
+			int y = (q == 0)? (int)(focus.y/TILE_SIZE) : (int)(NextRng(&rng)%height);
+			const Tilemap *source = &maps[sources[(y/chunkHeight)*CHUNKS_WORLD_SIZE + x/chunkWidth]];
+			wrong += (IsStreamTileSolid(stream, x, y) != IsTileSolid(source, x%chunkWidth, y%chunkHeight));
+		}
+
+		ChunkStreamStats stats = GetChunkStreamStats(stream);
+		overBudget += (stats.resident > 16);	// (2*radius + 2)^2 slots
+	}
+
+	ChunkStreamStats stats = GetChunkStreamStats(stream);
+	CheckTest(tests, wrong == 0, "chunks/query: %d of %d tile queries differ from the source maps", wrong, CHUNKS_TICKS*(CHUNKS_QUERIES + 1));
+	CheckTest(tests, overBudget == 0, "chunks/query: more chunks resident than the budget on %d ticks", overBudget);
+	CheckTest(tests, stats.syncLoads > 0 && stats.evictions > 0 && stats.failures == 0,
+		"chunks/query: %d loads on the spot, %d evictions, %d failures", stats.syncLoads, stats.evictions, stats.failures);
+	CheckTest(tests, IsStreamTileSolid(stream, -1, 0) && IsStreamTileSolid(stream, 0, height), "chunks/query: outside the world is not wall");
+
+	DestroyChunkStream(stream);
+	UnloadTilemap(maps[0]);
+	UnloadTilemap(maps[1]);
+}
+
+void RunChunkTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "chunks/")) return;
+
+	CheckStreamQueries(tests);
+}
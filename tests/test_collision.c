@@ -0,0 +1,226 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "tilemap.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define COLLISION_SEED 38
+#define COLLISION_MAP_SIZE 32
+#define COLLISION_CASES 4000	// Per map
+#define COLLISION_MAX_MOVE 4.0f	// Tiles, as for bullets at full speed
+#define COLLISION_SUBSTEP (1.0f/16.0f)	// Pixels between reference tests
+#define COLLISION_TOLERANCE 0.01f	// Pixels
+#define COLLISION_HAIR 0.002f	// Twice what the overlap test and the sweep shave off at tile edges
+
+// What the sweep got wrong compared with the reference, by kind
+typedef struct SweepErrors {
+	int cases;
+	int tunnels;	// Missed a wall the reference ran into
+	int early;	// Stopped before the reference touched anything
+	int late;	// Stopped after the reference was already inside a wall
+	int overlaps;	// Ended inside a wall
+	int normals;	// Normal is not the face that was hit
+	int positions;	// Ended off the line of motion
+} SweepErrors;
+
+static Rectangle MoveRec(Rectangle rec, float dx, float dy)
+{
+	return (Rectangle){ rec.x + dx, rec.y + dy, rec.width, rec.height };
+}
+
+// Steps along the motion a sixteenth of a pixel at a time with the plain overlap test.
+// Returns the first fraction that overlaps a wall, 2 when none does, and the last clear one.
+static float GetSubstepContact(const Tilemap *map, Rectangle rec, Vector2 delta, float *clear)
+{
+	float length = sqrtf(delta.x*delta.x + delta.y*delta.y);
+	int steps = (int)ceilf(length/COLLISION_SUBSTEP);
+	*clear = 0.0f;
+
+	for (int s = 1; s <= steps; s++)
+	{
+		float t = (float)s/steps;
+		if (CheckCollisionTilemapRec(map, MoveRec(rec, delta.x*t, delta.y*t))) return t;
+		*clear = t;
+	}
+	return 2.0f;
+}
+
+static void CheckSweepCase(SweepErrors *errors, const Tilemap *map, Rectangle rec, Vector2 delta)
+{
+	TileSweep hit = SweepTilemapRec(map, rec, delta);
+	float clear = 0.0f;
+	float contact = GetSubstepContact(map, rec, delta, &clear);
+	float length = sqrtf(delta.x*delta.x + delta.y*delta.y);
+	Rectangle end = { hit.position.x, hit.position.y, rec.width, rec.height };
+	errors->cases++;
+
+	if (length == 0.0f)
+	{
+		errors->positions += (hit.time != 1.0f || hit.normal.x != 0.0f || hit.normal.y != 0.0f || end.x != rec.x || end.y != rec.y);
+		return;
+	}
+
+	errors->overlaps += CheckCollisionTilemapRec(map, end);
+
+	if (hit.time >= 1.0f)
+	{
+		errors->tunnels += (contact <= 1.0f);
+		errors->positions += (fabsf(end.x - (rec.x + delta.x)) > COLLISION_TOLERANCE || fabsf(end.y - (rec.y + delta.y)) > COLLISION_TOLERANCE);
+		return;
+	}
+
+	// Contact lies between the last clear step and the first overlapping one. Touching at the
+	// very end of the motion is a hit too, though it never overlaps. The hair at tile edges is
+	// along the normal, a body barely moving that way takes long to cross it.
+	float across = fabsf((hit.normal.x != 0.0f)? delta.x : delta.y);
+	float slack = COLLISION_TOLERANCE/length + ((across > 0.0f)? COLLISION_HAIR/across : 0.0f);
+	errors->early += (hit.time < clear - slack || (contact > 1.0f && hit.time < 1.0f - slack));
+	errors->late += (contact <= 1.0f && hit.time > contact + slack);
+
+	// The normal opposes the motion, and pushing against it runs into the wall; at an exact
+	// corner only pushing on along the motion does, either face is right then
+	bool opposes = (hit.normal.x != 0.0f)? hit.normal.x == -copysignf(1.0f, delta.x) && delta.x != 0.0f :
+		(hit.normal.y != 0.0f && hit.normal.y == -copysignf(1.0f, delta.y) && delta.y != 0.0f);
+	bool face = CheckCollisionTilemapRec(map, MoveRec(end, -hit.normal.x*COLLISION_TOLERANCE, -hit.normal.y*COLLISION_TOLERANCE));
+	bool onward = CheckCollisionTilemapRec(map, MoveRec(end, delta.x/length*COLLISION_TOLERANCE, delta.y/length*COLLISION_TOLERANCE));
+	bool corner = !face && onward &&
+		!CheckCollisionTilemapRec(map, MoveRec(end, delta.x/length*COLLISION_TOLERANCE*(hit.normal.x != 0.0f), delta.y/length*COLLISION_TOLERANCE*(hit.normal.y != 0.0f)));
+	errors->normals += !(opposes && (face || corner));
+
+	// Along the face it stops where the motion had got to
+	float alongX = rec.x + delta.x*hit.time, alongY = rec.y + delta.y*hit.time;
+	errors->positions += (hit.normal.x != 0.0f)? fabsf(end.y - alongY) > COLLISION_TOLERANCE || fabsf(end.x - alongX) > COLLISION_TOLERANCE + length*slack :
+		fabsf(end.x - alongX) > COLLISION_TOLERANCE || fabsf(end.y - alongY) > COLLISION_TOLERANCE + length*slack;
+}
+
+static void ReportSweepErrors(Tests *tests, const SweepErrors *e, const char *scene)
+{
+	CheckTest(tests, e->tunnels == 0, "collision/%s: %d of %d sweeps passed through a wall", scene, e->tunnels, e->cases);
+	CheckTest(tests, e->early == 0 && e->late == 0, "collision/%s: %d sweeps stopped early and %d late against the substep reference", scene, e->early, e->late);
+	CheckTest(tests, e->overlaps == 0, "collision/%s: %d sweeps ended inside a wall", scene, e->overlaps);
+	CheckTest(tests, e->normals == 0, "collision/%s: %d sweeps reported the wrong normal", scene, e->normals);
+	CheckTest(tests, e->positions == 0, "collision/%s: %d sweeps ended off the line of motion", scene, e->positions);
+}
+
+// Random bodies and moves in open space. A third start with an edge on a tile boundary so
+// they straddle two rows or columns, a quarter move along one axis and a few not at all.
+static void CheckRandomSweeps(Tests *tests, const Tilemap *map, Rng *rng, const char *scene)
+{
+	SweepErrors errors = { 0 };
+	const Vector2 sizes[] = { { 6, 6 }, { 28, 28 }, { 32, 32 }, { 64, 64 }, { 10, 50 } };
+	float extent = (float)COLLISION_MAP_SIZE*TILE_SIZE;
+
+	for (int i = 0; i < COLLISION_CASES; i++)
+	{
+		Vector2 size = sizes[NextRng(rng)%(sizeof(sizes)/sizeof(sizes[0]))];
+		Rectangle rec;
+		int tries = 0;
+		do
+		{
+			rec = (Rectangle){ NextRngFloat(rng)*(extent - size.x), NextRngFloat(rng)*(extent - size.y), size.x, size.y };
+			if (i%3 == 0) rec.y = floorf(rec.y/TILE_SIZE)*TILE_SIZE + ((NextRng(rng)%2)? 0.0f : TILE_SIZE - size.y);
+			if (i%3 == 1) rec.x = floorf(rec.x/TILE_SIZE)*TILE_SIZE + ((NextRng(rng)%2)? 0.0f : TILE_SIZE - size.x);
+		}
+		while (CheckCollisionTilemapRec(map, rec) && ++tries < 1000);
+		if (tries == 1000) continue;
+
+		float angle = NextRngFloat(rng)*2.0f*PI;
+		float distance = NextRngFloat(rng)*COLLISION_MAX_MOVE*TILE_SIZE;
+		Vector2 delta = { cosf(angle)*distance, sinf(angle)*distance };
+		if (i%4 == 0) delta.y = 0.0f;
+		if (i%4 == 1) delta.x = 0.0f;
+		if (i%29 == 0) delta = (Vector2){ 0.0f, 0.0f };
+
+		CheckSweepCase(&errors, map, rec, delta);
+	}
+
+	ReportSweepErrors(tests, &errors, scene);
+}
+
+static bool IsSweep(TileSweep hit, float time, Vector2 normal, Vector2 position)
+{
+	return fabsf(hit.time - time) <= 1e-5f && hit.normal.x == normal.x && hit.normal.y == normal.y &&
+		fabsf(hit.position.x - position.x) <= COLLISION_TOLERANCE && fabsf(hit.position.y - position.y) <= COLLISION_TOLERANCE;
+}
+
+// Cases placed by hand with known answers, each also held against the reference
+static void CheckEdgeCases(Tests *tests)
+{
+	const float T = TILE_SIZE;
+	Tilemap map = GenTilemapEmpty(12, 12);
+	for (int x = 0; x < 12; x++) map.tiles[2*12 + x] = 1;	// A wall along row 2
+	map.tiles[8*12 + 6] = 1;	// A lone block
+	map.tiles[6*12 + 9] = 1;	// Column 9, one tile only
+	SweepErrors errors = { 0 };
+
+	// Flush under the wall row, straddling two columns, sliding along it without catching
+	Rectangle under = { 1.5f*T, 3.0f*T, 32, 32 };
+	TileSweep hit = SweepTilemapRec(&map, under, (Vector2){ 5.0f*T, 0.0f });
+	CheckTest(tests, IsSweep(hit, 1.0f, (Vector2){ 0, 0 }, (Vector2){ 6.5f*T, 3.0f*T }), "collision/edges: slide flush along a wall caught at %.4f", hit.time);
+	CheckSweepCase(&errors, &map, under, (Vector2){ 5.0f*T, 0.0f });
+
+	// Straddling rows 5 and 6 into column 9, which is only solid in row 6
+	Rectangle straddle = { 7.0f*T, 6.0f*T - 16.0f, 32, 32 };
+	hit = SweepTilemapRec(&map, straddle, (Vector2){ 2.0f*T, 0.0f });
+	CheckTest(tests, IsSweep(hit, 0.75f, (Vector2){ -1, 0 }, (Vector2){ 9.0f*T - 32, 6.0f*T - 16.0f }), "collision/edges: straddling body hit at %.4f normal (%.0f, %.0f)", hit.time, hit.normal.x, hit.normal.y);
+	CheckSweepCase(&errors, &map, straddle, (Vector2){ 2.0f*T, 0.0f });
+
+	// Exact corner: the body's corner meets the block's corner halfway through the move
+	Rectangle corner = { 6.0f*T - 32 - 10, 8.0f*T - 32 - 10, 32, 32 };
+	hit = SweepTilemapRec(&map, corner, (Vector2){ 20.0f, 20.0f });
+	bool cornerFace = (hit.normal.x == -1.0f && hit.normal.y == 0.0f) || (hit.normal.x == 0.0f && hit.normal.y == -1.0f);
+	CheckTest(tests, fabsf(hit.time - 0.5f) <= 1e-5f && cornerFace && fabsf(hit.position.x - (6.0f*T - 32)) <= COLLISION_TOLERANCE &&
+		fabsf(hit.position.y - (8.0f*T - 32)) <= COLLISION_TOLERANCE, "collision/edges: corner to corner hit at %.4f normal (%.0f, %.0f)", hit.time, hit.normal.x, hit.normal.y);
+	CheckSweepCase(&errors, &map, corner, (Vector2){ 20.0f, 20.0f });
+
+	// Corners passing with their edges in line never touch
+	Rectangle graze = { 6.0f*T - 32 - 10, 8.0f*T - 32 - 10, 32, 32 };
+	hit = SweepTilemapRec(&map, graze, (Vector2){ 10.0f, 200.0f });
+	CheckTest(tests, IsSweep(hit, 1.0f, (Vector2){ 0, 0 }, (Vector2){ 6.0f*T - 32, 8.0f*T - 42 + 200.0f }), "collision/edges: body sliding past a corner caught at %.4f", hit.time);
+	CheckSweepCase(&errors, &map, graze, (Vector2){ 10.0f, 200.0f });
+
+	// Flush against a face: moving into it stops at once, moving away is free
+	Rectangle flush = { 6.0f*T - 32, 8.0f*T + 8, 32, 32 };
+	hit = SweepTilemapRec(&map, flush, (Vector2){ 30.0f, 5.0f });
+	CheckTest(tests, IsSweep(hit, 0.0f, (Vector2){ -1, 0 }, (Vector2){ flush.x, flush.y }), "collision/edges: flush body moving in hit at %.4f", hit.time);
+	hit = SweepTilemapRec(&map, flush, (Vector2){ -30.0f, 5.0f });
+	CheckTest(tests, IsSweep(hit, 1.0f, (Vector2){ 0, 0 }, (Vector2){ flush.x - 30.0f, flush.y + 5.0f }), "collision/edges: flush body moving away caught at %.4f", hit.time);
+	CheckSweepCase(&errors, &map, flush, (Vector2){ 30.0f, 5.0f });
+	CheckSweepCase(&errors, &map, flush, (Vector2){ -30.0f, 5.0f });
+
+	// Zero-length moves, in the open and flush against walls
+	const Rectangle still[] = { { 4.0f*T + 3, 5.0f*T + 7, 28, 28 }, flush, under, { 0, 3.0f*T, 6, 6 } };
+	int moved = 0;
+	for (int i = 0; i < (int)(sizeof(still)/sizeof(still[0])); i++)
+	{
+		hit = SweepTilemapRec(&map, still[i], (Vector2){ 0.0f, 0.0f });
+		moved += !IsSweep(hit, 1.0f, (Vector2){ 0, 0 }, (Vector2){ still[i].x, still[i].y });
+		CheckSweepCase(&errors, &map, still[i], (Vector2){ 0.0f, 0.0f });
+	}
+	CheckTest(tests, moved == 0, "collision/edges: %d zero-length moves went somewhere or hit", moved);
+
+	ReportSweepErrors(tests, &errors, "edges");
+	UnloadTilemap(map);
+}
+
+void RunCollisionTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "collision/")) return;
+
+	CheckEdgeCases(tests);
+
+	// Caves, and scattered single blocks for many more corners
+	Rng rng = SeedRng(COLLISION_SEED);
+	Tilemap caves = GenTilemapProcedural(NULL, GetDefaultMapGenParams(COLLISION_MAP_SIZE, COLLISION_MAP_SIZE, COLLISION_SEED));
+	CheckRandomSweeps(tests, &caves, &rng, "caves");
+	UnloadTilemap(caves);
+
+	Tilemap scatter = GenTilemapEmpty(COLLISION_MAP_SIZE, COLLISION_MAP_SIZE);
+	for (int i = 0; i < COLLISION_MAP_SIZE*COLLISION_MAP_SIZE; i++) scatter.tiles[i] = (NextRng(&rng)%5 == 0)? 1 : TILE_EMPTY;
+	CheckRandomSweeps(tests, &scatter, &rng, "scatter");
+	UnloadTilemap(scatter);
+}
@@ -0,0 +1,161 @@
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debugui.h"
+
+#define DEBUGUI_WIDGETS 100
+#define DEBUGUI_SLIDERS 60
+#define DEBUGUI_INT_SLIDERS 20
+#define DEBUGUI_GRAPHS 2
+#define DEBUGUI_CHECKBOXES (DEBUGUI_WIDGETS - DEBUGUI_SLIDERS - DEBUGUI_INT_SLIDERS - DEBUGUI_GRAPHS)
+#define DEBUGUI_GRAPH_SAMPLES 120
+#define DEBUGUI_WIDTH 320.0f
+
+// A fixed width font with a solid block in glyph 95 like raylib's default one, CPU side only
+typedef struct DebugUiTest {
+	Font font;
+	GlyphInfo glyphs[96];
+	Rectangle recs[96];
+	TextAtlas atlas;
+	TextCache cache;
+	SpriteBatch batch;
+	DebugUi ui;
+	char labels[DEBUGUI_WIDGETS][32];
+	float values[DEBUGUI_SLIDERS];
+	int ints[DEBUGUI_INT_SLIDERS];
+	bool flags[DEBUGUI_CHECKBOXES];
+	float frameMs[DEBUGUI_GRAPH_SAMPLES];
+	int frameHead;
+	DebugUiInput input;
+	bool rebuildAll;
+} DebugUiTest;
+
+static void LoadTestFont(DebugUiTest *t)
+{
+	for (int i = 0; i < 96; i++)
+	{
+		t->glyphs[i] = (GlyphInfo){ .value = TEXT_FIRST_CHAR + i, .advanceX = 6 };
+		t->recs[i] = (Rectangle){ (float)(1 + (i%16)*8), (float)(1 + (i/16)*12), 5.0f, 10.0f };
+	}
+	t->font = (Font){
+		.baseSize = 10, .glyphCount = 96, .glyphPadding = 1,
+		.texture = { .id = 1, .width = 128, .height = 128, .mipmaps = 1 },
+		.recs = t->recs, .glyphs = t->glyphs,
+	};
+}
+
+static void BuildPanel(DebugUiTest *t)
+{
+	if (t->rebuildAll) for (int i = 0; i < DEBUG_UI_MAX_WIDGETS; i++) t->ui.widgets[i].key = 0;
+
+	BeginTextFrame(&t->cache);
+	BeginSpriteBatch(&t->batch);
+	BeginDebugUi(&t->ui, t->input);
+
+	int w = 0;
+	for (int i = 0; i < DEBUGUI_GRAPHS; i++) DebugGraph(&t->ui, t->labels[w++], t->frameMs, DEBUGUI_GRAPH_SAMPLES, t->frameHead, 33.3f);
+	for (int i = 0; i < DEBUGUI_SLIDERS; i++) DebugSlider(&t->ui, t->labels[w++], &t->values[i], 0.0f, 10.0f);
+	for (int i = 0; i < DEBUGUI_INT_SLIDERS; i++) DebugSliderInt(&t->ui, t->labels[w++], &t->ints[i], 0, 256);
+	for (int i = 0; i < DEBUGUI_CHECKBOXES; i++) DebugCheckbox(&t->ui, t->labels[w++], &t->flags[i]);
+
+	EndDebugUi(&t->ui, &t->batch);
+	EndSpriteBatch(&t->batch);
+}
+
+// A point t of the way along the control of a row below the graphs
+static Vector2 GetTrackPoint(int row, float t)
+{
+	float rowWidth = DEBUGUI_WIDTH - 2.0f*DEBUG_UI_PADDING;
+	float x = DEBUG_UI_PADDING + rowWidth*DEBUG_UI_LABEL_WIDTH;
+	float y = DEBUG_UI_PADDING + (DEBUGUI_GRAPHS*DEBUG_UI_GRAPH_ROWS + row)*DEBUG_UI_ROW_HEIGHT + DEBUG_UI_ROW_HEIGHT/2.0f;
+	return (Vector2){ x + t*rowWidth*(1.0f - DEBUG_UI_LABEL_WIDTH), y };
+}
+
+// Unchanged widgets reuse their quads and those match a full rebuild, and the panel is
+// one draw call
+static void CheckCaching(Tests *tests, DebugUiTest *t)
+{
+	BuildPanel(t);
+	CheckTest(tests, t->ui.stats.rebuilt == DEBUGUI_WIDGETS, "debugui/cache: first frame rebuilt %d widgets, expected %d", t->ui.stats.rebuilt, DEBUGUI_WIDGETS);
+
+	BuildPanel(t);
+	CheckTest(tests, t->ui.stats.rebuilt == 0, "debugui/cache: unchanged panel rebuilt %d widgets", t->ui.stats.rebuilt);
+	CheckTest(tests, t->batch.last.drawCalls == 1, "debugui/cache: panel took %d draw calls, expected 1", t->batch.last.drawCalls);
+
+	t->frameMs[t->frameHead] = 17.5f;
+	t->frameHead = (t->frameHead + 1)%DEBUGUI_GRAPH_SAMPLES;
+	BuildPanel(t);
+	CheckTest(tests, t->ui.stats.rebuilt == DEBUGUI_GRAPHS, "debugui/cache: new frame time rebuilt %d widgets, expected %d", t->ui.stats.rebuilt, DEBUGUI_GRAPHS);
+
+	// Without a window flushing only counts, so the batch still holds the frame's quads
+	BuildPanel(t);
+	int count = t->batch.last.quads;
+	SpriteQuad *cached = malloc((size_t)count*sizeof(SpriteQuad));
+	memcpy(cached, t->batch.quads, (size_t)count*sizeof(SpriteQuad));
+	t->rebuildAll = true;
+	BuildPanel(t);
+	t->rebuildAll = false;
+	CheckTest(tests, t->batch.last.quads == count && memcmp(cached, t->batch.quads, (size_t)count*sizeof(SpriteQuad)) == 0,
+		"debugui/cache: %d cached quads differ from the %d of a rebuild", count, t->batch.last.quads);
+	free(cached);
+}
+
+// Press at three quarters of the first slider, drag past its end, let go and move on;
+// then an int slider and a checkbox
+static void CheckInput(Tests *tests, DebugUiTest *t)
+{
+	t->input = (DebugUiInput){ GetTrackPoint(0, 0.75f), true, true };
+	BuildPanel(t);
+	CheckTest(tests, t->values[0] >= 7.4f && t->values[0] <= 7.6f, "debugui/input: slider pressed at 75%% holds %.2f, expected 7.5", t->values[0]);
+	t->input = (DebugUiInput){ (Vector2){ 2000.0f, 2000.0f }, true, false };
+	BuildPanel(t);
+	CheckTest(tests, t->values[0] == 10.0f, "debugui/input: slider dragged past its end holds %.2f, expected 10", t->values[0]);
+	t->input = (DebugUiInput){ (Vector2){ 2000.0f, 2000.0f }, false, false };
+	BuildPanel(t);
+	t->input = (DebugUiInput){ GetTrackPoint(0, 0.1f), false, false };
+	BuildPanel(t);
+	CheckTest(tests, t->values[0] == 10.0f, "debugui/input: slider moved after release, holds %.2f", t->values[0]);
+
+	int intRow = DEBUGUI_SLIDERS;
+	t->input = (DebugUiInput){ GetTrackPoint(intRow, 0.5f), true, true };
+	BuildPanel(t);
+	CheckTest(tests, t->ints[0] == 128, "debugui/input: int slider pressed at 50%% holds %d, expected 128", t->ints[0]);
+
+	int checkRow = DEBUGUI_SLIDERS + DEBUGUI_INT_SLIDERS;
+	t->input = (DebugUiInput){ GetTrackPoint(checkRow, 0.0f), false, false };
+	BuildPanel(t);
+	CheckTest(tests, !t->flags[0], "debugui/input: checkbox toggled by hovering");
+	t->input.pressed = true;
+	t->input.down = true;
+	BuildPanel(t);
+	CheckTest(tests, t->flags[0], "debugui/input: checkbox not toggled by a click");
+}
+
+void RunDebugUiTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "debugui/")) return;
+
+	DebugUiTest *t = calloc(1, sizeof(DebugUiTest));
+	LoadTestFont(t);
+	t->atlas = LoadTextAtlas(t->font);
+	t->cache = LoadTextCache(&t->atlas);
+	t->batch = LoadSpriteBatch(1024);
+	t->ui = LoadDebugUi(&t->cache, GetDefaultFontSolid(t->font), (Vector2){ 0.0f, 0.0f }, DEBUGUI_WIDTH);
+
+	for (int i = 0; i < DEBUGUI_WIDGETS; i++) snprintf(t->labels[i], sizeof(t->labels[i]), "tunable %d", i);
+	for (int i = 0; i < DEBUGUI_SLIDERS; i++) t->values[i] = (float)(i%10);
+	for (int i = 0; i < DEBUGUI_INT_SLIDERS; i++) t->ints[i] = i*8;
+	for (int i = 0; i < DEBUGUI_GRAPH_SAMPLES; i++) t->frameMs[i] = 16.6f;
+	t->input = (DebugUiInput){ (Vector2){ -1.0f, -1.0f }, false, false };
+
+	CheckCaching(tests, t);
+	CheckInput(tests, t);
+
+	UnloadDebugUi(&t->ui);
+	UnloadSpriteBatch(&t->batch);
+	UnloadTextCache(&t->cache);
+	free(t);
+}
@@ -0,0 +1,53 @@
+#include "test.h"
+
+#include "events.h"
+
+typedef struct EventsTest {
+	EventBus *bus;
+	int nextExpected;
+	int orderErrors;
+	int deferred;
+} EventsTest;
+
+// Shots with a negative shooter are the ones re-emitted while dispatching
+static void CheckOrder(void *user, const void *events, int count)
+{
+	EventsTest *t = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) if (shots[i].shooter >= 0 && shots[i].shooter != t->nextExpected++) t->orderErrors++;
+}
+
+static void EmitShotOnShot(void *user, const void *events, int count)
+{
+	EventsTest *t = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) if (shots[i].shooter >= 0) EmitShotFired(t->bus, (ShotFiredEvent){ -1, shots[i].origin, shots[i].velocity });
+}
+
+static void CountDeferred(void *user, const void *events, int count)
+{
+	EventsTest *t = user;
+	const ShotFiredEvent *shots = events;
+	for (int i = 0; i < count; i++) t->deferred += (shots[i].shooter < 0);
+}
+
+// Events arrive in the order they were emitted, and ones emitted while dispatching wait
+// for the next dispatch
+void RunEventTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "events/")) return;
+
+	EventBus bus = LoadEventBus();
+	EventsTest t = { .bus = &bus };
+	AddEventHandler(&bus, EVENT_SHOT_FIRED, CheckOrder, &t);
+	AddEventHandler(&bus, EVENT_SHOT_FIRED, EmitShotOnShot, &t);
+	AddEventHandler(&bus, EVENT_SHOT_FIRED, CountDeferred, &t);
+
+	for (int i = 0; i < 1000; i++) EmitShotFired(&bus, (ShotFiredEvent){ i, { 0.0f, 0.0f }, { 0.0f, 0.0f } });
+	int first = DispatchEvents(&bus);
+	CheckTest(tests, first == 1000 && t.deferred == 0, "events/defer: first dispatch delivered %d events and %d re-emitted ones, expected 1000 and 0", first, t.deferred);
+	int second = DispatchEvents(&bus);
+	CheckTest(tests, second == 1000 && t.deferred == 1000, "events/defer: second dispatch delivered %d events and %d re-emitted ones, expected 1000 each", second, t.deferred);
+	CheckTest(tests, t.orderErrors == 0, "events/order: %d events dispatched out of order", t.orderErrors);
+	UnloadEventBus(&bus);
+}
@@ -0,0 +1,96 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fov.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define FOV_SEED 42
+#define FOV_MAP_SIZE 256
+#define FOV_RADIUS 16
+#define FOV_WALK_STEPS 2048
+
+// Walks one open tile at a time from a random start, the way the player moves between updates.
+// The incremental update has to leave the same tiles visible as starting from scratch, and
+// everything ever visible along the way explored and drawn with the right fog.
+static void CheckFovWalk(Tests *tests, const Tilemap *map)
+{
+	static const int dirs[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+
+	FieldOfView fov = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+	FieldOfView seen = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+	size_t words = (size_t)fov.wordsPerRow*FOV_MAP_SIZE;
+	int mismatches = 0, unexplored = 0, badFog = 0;
+
+	Rng rng = SeedRng(FOV_SEED);
+	int x, y;
+	do
+	{
+		x = (int)(NextRng(&rng)%FOV_MAP_SIZE);
+		y = (int)(NextRng(&rng)%FOV_MAP_SIZE);
+	} while (IsTileSolid(map, x, y));
+
+	for (int i = 0; i < FOV_WALK_STEPS; i++)
+	{
+		for (int tries = 0; tries < 16; tries++)
+		{
+			const int *d = dirs[NextRng(&rng)%4];
+			if (IsTileSolid(map, x + d[0], y + d[1])) continue;
+			x += d[0];
+			y += d[1];
+			break;
+		}
+		UpdateFieldOfView(&fov, map, x, y);
+
+		// Starting over from scratch at every step
+		FieldOfView fresh = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+		UpdateFieldOfView(&fresh, map, x, y);
+		if (memcmp(fresh.visible, fov.visible, words*sizeof(unsigned long long)) != 0) mismatches++;
+		for (size_t w = 0; w < words; w++) seen.explored[w] |= fresh.visible[w];
+		UnloadFieldOfView(&fresh);
+	}
+
+	for (size_t w = 0; w < words; w++) unexplored += (seen.explored[w] != fov.explored[w]);
+	for (int ty = 0; ty < FOV_MAP_SIZE; ty++)
+	{
+		for (int tx = 0; tx < FOV_MAP_SIZE; tx++)
+		{
+			unsigned char expected = IsTileVisible(&fov, tx, ty)? FOV_FOG_VISIBLE :
+				IsTileExplored(&fov, tx, ty)? FOV_FOG_EXPLORED : FOV_FOG_UNEXPLORED;
+			badFog += (fov.fog[(ty*FOV_MAP_SIZE + tx)*2 + 1] != expected);
+		}
+	}
+
+	CheckTest(tests, mismatches == 0, "fov/walk: %d of %d incremental updates differ from a full one", mismatches, FOV_WALK_STEPS);
+	CheckTest(tests, unexplored == 0, "fov/walk: explored tiles disagree with the visible history in %d words", unexplored);
+	CheckTest(tests, badFog == 0, "fov/walk: fog disagrees with the visible and explored tiles in %d places", badFog);
+
+	UnloadFieldOfView(&seen);
+	UnloadFieldOfView(&fov);
+}
+
+// A viewpoint that does not move is not an update, one that does always is
+static void CheckFovMoves(Tests *tests, const Tilemap *map)
+{
+	FieldOfView fov = LoadFieldOfView(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_RADIUS);
+	int x = FOV_MAP_SIZE/2, y = FOV_MAP_SIZE/2;
+	while (IsTileSolid(map, x, y)) x++;
+
+	CheckTest(tests, UpdateFieldOfView(&fov, map, x, y), "fov/moves: first update reported no change");
+	CheckTest(tests, !UpdateFieldOfView(&fov, map, x, y), "fov/moves: update at the same tile reported a change");
+	CheckTest(tests, IsTileVisible(&fov, x, y) && IsTileExplored(&fov, x, y), "fov/moves: viewpoint tile not visible");
+	CheckTest(tests, !IsTileVisible(&fov, x + FOV_RADIUS + 1, y), "fov/moves: tile past the radius visible");
+	UnloadFieldOfView(&fov);
+}
+
+void RunFovTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "fov/")) return;
+
+	Tilemap map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(FOV_MAP_SIZE, FOV_MAP_SIZE, FOV_SEED));
+	CheckFovWalk(tests, &map);
+	CheckFovMoves(tests, &map);
+	UnloadTilemap(map);
+}
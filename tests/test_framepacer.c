@@ -0,0 +1,133 @@
+#include "test.h"
+
+#include <math.h>
+
+#include "framepacer.h"
+#include "rng.h"
+
+#define PACING_SEED 49
+#define PACING_FPS 60
+#define PACING_FRAMES 600
+#define PACING_WORK_MIN 0.003	// Seconds of update and draw
+#define PACING_WORK_MAX 0.006
+#define PACING_SLEEP_LATE 0.002	// Sleeps wake up to this late, a busy desktop scheduler
+#define PACING_READ_COST 0.5e-6	// Each clock read, so spinning moves the fake time on
+#define PACING_VBLANK (1001.0/60000.0)	// A 59.94 Hz display, a little slower than the target
+
+// Time only moves when the pacer reads or sleeps and when the "game" works or presents
+typedef struct FakeClock {
+	double time;
+	double vblank;	// Refresh period a present waits for, 0 without vsync
+	Rng rng;
+	double slept;
+} FakeClock;
+
+static double ReadFakeClock(void *user)
+{
+	FakeClock *c = user;
+	c->time += PACING_READ_COST;
+	return c->time;
+}
+
+static void SleepFakeClock(void *user, double seconds)
+{
+	FakeClock *c = user;
+	double late = NextRngFloat(&c->rng)*PACING_SLEEP_LATE;
+	c->time += seconds + late;
+	c->slept += seconds + late;
+}
+
+static void SwapFakeClock(FakeClock *c)
+{
+	if (c->vblank > 0.0) c->time = ceil(c->time/c->vblank)*c->vblank;
+	c->time += 20e-6;
+}
+
+static double GetWork(FakeClock *c)
+{
+	return PACING_WORK_MIN + NextRngFloat(&c->rng)*(PACING_WORK_MAX - PACING_WORK_MIN);
+}
+
+static void RunPacedFrame(FramePacer *pacer, FakeClock *c, double work)
+{
+	BeginPacedFrame(pacer);
+	c->time += work;	// Poll, update, draw
+	WaitPresentTime(pacer);
+	SwapFakeClock(c);
+	EndPacedFrame(pacer);
+}
+
+// EndDrawing(): present, wait out what is left of the frame, then poll for the next one
+static double GetEndDrawingLatency(FakeClock *c, int frames)
+{
+	double period = 1.0/PACING_FPS, start = c->time, latency = 0.0;
+	for (int i = 0; i < frames; i++)
+	{
+		double input = c->time;
+		c->time += GetWork(c);
+		SwapFakeClock(c);
+		latency += c->time - input;
+
+		double left = period - (c->time - start);
+		if (left > 0.0) c->time += left;
+		start = c->time;
+	}
+	return latency/frames;
+}
+
+static FramePacer LoadFakePacer(FakeClock *c, double vblank)
+{
+	*c = (FakeClock){ .time = 1000.0, .vblank = vblank, .rng = SeedRng(PACING_SEED) };
+	return LoadFramePacer((FrameClock){ ReadFakeClock, SleepFakeClock, c }, PACING_FPS);
+}
+
+// Presents land on the deadline despite sleeps waking late, and the pacer mostly sleeps
+static void CheckFreeRunning(Tests *tests)
+{
+	double period = 1.0/PACING_FPS;
+	FakeClock c;
+	FramePacer pacer = LoadFakePacer(&c, 0.0);
+	for (int i = 0; i < PACING_FRAMES; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	FramePacerStats stats = GetFramePacerStats(&pacer);
+
+	CheckTest(tests, fabs(stats.frameMean - period) <= 10e-6 && stats.frameStdDev <= 20e-6,
+		"pacing/free_running: frames %.4f ms +- %.4f ms, expected %.4f ms", stats.frameMean*1000.0, stats.frameStdDev*1000.0, period*1000.0);
+	CheckTest(tests, stats.missed == 0 && stats.latencyMax <= period, "pacing/free_running: missed %d presents, latency up to %.2f ms", stats.missed, stats.latencyMax*1000.0);
+	CheckTest(tests, c.slept >= (c.time - 1000.0)/2.0, "pacing/free_running: slept %.0f%% of the time, it should mostly sleep", 100.0*c.slept/(c.time - 1000.0));
+}
+
+// With vsync the swap decides when a frame shows, the pacer has to lock on to it after the
+// first frame or two and read input late enough to beat EndDrawing()'s order. One long
+// frame then misses its present, the estimate backs off and no later frame misses.
+static void CheckVsync(Tests *tests)
+{
+	FakeClock c;
+	FramePacer pacer = LoadFakePacer(&c, PACING_VBLANK);
+	for (int i = 0; i < PACING_FRAMES; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	int startupMissed = pacer.missed;
+	pacer.missed = 0;
+	for (int i = 0; i < PACING_FRAMES; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	FramePacerStats stats = GetFramePacerStats(&pacer);
+	double pacedLatency = stats.latencyMean;
+	double endDrawingLatency = GetEndDrawingLatency(&c, PACING_FRAMES);
+
+	CheckTest(tests, startupMissed <= 2 && stats.missed == 0 && fabs(stats.frameMean - PACING_VBLANK) <= 1e-6,
+		"pacing/vsync: missed %d vblanks starting and %d after, %.4f ms a frame", startupMissed, stats.missed, stats.frameMean*1000.0);
+	CheckTest(tests, pacedLatency <= endDrawingLatency - 0.005,
+		"pacing/vsync: input latency %.2f ms paced, %.2f ms in EndDrawing order", pacedLatency*1000.0, endDrawingLatency*1000.0);
+
+	RunPacedFrame(&pacer, &c, 0.040);
+	for (int i = 0; i < FRAME_PACER_HISTORY*2; i++) RunPacedFrame(&pacer, &c, GetWork(&c));
+	stats = GetFramePacerStats(&pacer);
+	CheckTest(tests, stats.missed == 1, "pacing/long_frame: a 40 ms frame caused %d missed presents, expected 1", stats.missed);
+	CheckTest(tests, fabs(stats.latencyMean - pacedLatency) <= 0.001,
+		"pacing/long_frame: latency %.2f ms after a long frame, %.2f ms before", stats.latencyMean*1000.0, pacedLatency*1000.0);
+}
+
+void RunFramePacerTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "pacing/")) return;
+
+	CheckFreeRunning(tests);
+	CheckVsync(tests);
+}
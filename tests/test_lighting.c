@@ -0,0 +1,82 @@
+#include "test.h"
+
+#include <stddef.h>
+#include <math.h>
+
+#include "lighting.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define LIGHTING_SEED 41
+#define LIGHTING_MAP_SIZE 128
+#define LIGHTING_LIGHTS 32
+#define LIGHTING_RADIUS (6.0f*TILE_SIZE)
+#define LIGHTING_SAMPLES 1000	// Points checked per light against a line of sight test
+
+static bool IsPointInPolygon(const Vector2 *polygon, int count, Vector2 p)
+{
+	bool inside = false;
+	for (int i = 0, j = count - 1; i < count; j = i++)
+	{
+		Vector2 a = polygon[i], c = polygon[j];
+		if ((a.y > p.y) != (c.y > p.y) && p.x < (c.x - a.x)*(p.y - a.y)/(c.y - a.y) + a.x) inside = !inside;
+	}
+	return inside;
+}
+
+static bool HasLineOfSight(const Tilemap *map, Vector2 from, Vector2 to)
+{
+	const int steps = 1024;
+	for (int s = 1; s <= steps; s++)
+	{
+		float t = (float)s/steps;
+		float x = from.x + (to.x - from.x)*t, y = from.y + (to.y - from.y)*t;
+		if (IsTileSolid(map, (int)floorf(x/TILE_SIZE), (int)floorf(y/TILE_SIZE))) return false;
+	}
+	return true;
+}
+
+// Points inside a polygon must be in view of its light and points outside must not.
+// Sampling the line of sight can miss a wall corner it grazes, so points within a
+// pixel of a wall face are left out.
+void RunLightingTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "lighting/")) return;
+
+	Tilemap map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(LIGHTING_MAP_SIZE, LIGHTING_MAP_SIZE, LIGHTING_SEED));
+	Lighting lighting = LoadLighting(&map);
+
+	// Fixtures sit in the middle of open tiles
+	Rng rng = SeedRng(LIGHTING_SEED);
+	while (lighting.lightCount < LIGHTING_LIGHTS)
+	{
+		int x = (int)(NextRng(&rng)%LIGHTING_MAP_SIZE), y = (int)(NextRng(&rng)%LIGHTING_MAP_SIZE);
+		if (IsTileSolid(&map, x, y)) continue;
+		AddLight(&lighting, (Vector2){ (x + 0.5f)*TILE_SIZE, (y + 0.5f)*TILE_SIZE }, LIGHTING_RADIUS, WHITE);
+	}
+	UpdateLights(&lighting);
+
+	int wrong = 0, checked = 0;
+	for (int i = 0; i < lighting.lightCount; i++)
+	{
+		const Light *light = &lighting.lights[i];
+		for (int s = 0; s < LIGHTING_SAMPLES; s++)
+		{
+			Vector2 p = {
+				light->position.x + (NextRngFloat(&rng)*2.0f - 1.0f)*light->radius*0.999f,
+				light->position.y + (NextRngFloat(&rng)*2.0f - 1.0f)*light->radius*0.999f,
+			};
+			float fx = p.x - floorf(p.x/TILE_SIZE)*TILE_SIZE, fy = p.y - floorf(p.y/TILE_SIZE)*TILE_SIZE;
+			if (fx < 1.0f || fx > TILE_SIZE - 1.0f || fy < 1.0f || fy > TILE_SIZE - 1.0f) continue;
+
+			checked++;
+			if (IsPointInPolygon(light->polygon, light->vertexCount, p) != HasLineOfSight(&map, light->position, p)) wrong++;
+		}
+	}
+
+	// Rays grazing a corner within a sample step can still disagree
+	CheckTest(tests, wrong*1000 <= checked, "lighting/polygons: %d of %d points disagree with line of sight", wrong, checked);
+
+	UnloadLighting(&lighting);
+	UnloadTilemap(map);
+}
@@ -0,0 +1,29 @@
+#include "test.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "mapgen.h"
+
+#define MAPGEN_SEED 2024
+
+// Same seed on one thread and on the pool must give the same map, also for sizes that do
+// not split evenly into rows per job
+void RunMapGenTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "mapgen/")) return;
+
+	JobSystem *jobs = CreateJobSystem(0);
+	static const int sizes[][2] = { { 512, 512 }, { 333, 257 } };
+	for (int i = 0; i < (int)(sizeof(sizes)/sizeof(sizes[0])); i++)
+	{
+		MapGenParams params = GetDefaultMapGenParams(sizes[i][0], sizes[i][1], MAPGEN_SEED);
+		Tilemap serial = GenTilemapProcedural(NULL, params);
+		Tilemap parallel = GenTilemapProcedural(jobs, params);
+		CheckTest(tests, memcmp(serial.tiles, parallel.tiles, (size_t)serial.width*serial.height) == 0,
+			"mapgen/threads: %dx%d map depends on the thread count", params.width, params.height);
+		UnloadTilemap(serial);
+		UnloadTilemap(parallel);
+	}
+	DestroyJobSystem(jobs);
+}
@@ -0,0 +1,152 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "mixer.h"
+#include "rng.h"
+
+#define MIXER_TEST_SEED 32
+#define MIXER_TEST_FRAMES 1001	// Not a multiple of 4, so the clip ends inside a group
+#define MIXER_TEST_TAIL 40	// Silence mixed after the clip ends
+#define MIXER_TEST_GAIN 0.5f
+
+// Buffer sizes the device may ask for, cycled through so every remainder mod 4 comes up
+static const int bufferFrames[] = { 1, 2, 3, 5, 7, 13, 64, 127, 4, 6 };
+
+static float *GenTestClip(void)
+{
+	float *samples = calloc((MIXER_TEST_FRAMES + 3) & ~3, sizeof(float));
+	Rng rng = SeedRng(MIXER_TEST_SEED);
+	for (int i = 0; i < MIXER_TEST_FRAMES; i++) samples[i] = NextRngFloat(&rng)*1.6f - 0.8f;
+	return samples;
+}
+
+// The textbook IMA decoder, one bit of the nibble at a time
+static void DecodeAdpcmReference(const unsigned char *block, float *out)
+{
+	static const int steps[89] = {
+		7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+		50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+		253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+		1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+		3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+		11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+	};
+	static const int moves[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+	int predictor = (short)(block[0] | (block[1] << 8)), index = block[2];
+	for (int s = 0; s < ADPCM_BLOCK_SAMPLES; s++)
+	{
+		int nibble = (s & 1)? block[4 + s/2] >> 4 : block[4 + s/2] & 15;
+		int step = steps[index], diff = step >> 3;
+		if (nibble & 4) diff += step;
+		if (nibble & 2) diff += step >> 1;
+		if (nibble & 1) diff += step >> 2;
+		predictor += (nibble & 8)? -diff : diff;
+		predictor = (predictor < -32768)? -32768 : (predictor > 32767)? 32767 : predictor;
+		index += moves[nibble & 7];
+		index = (index < 0)? 0 : (index > 88)? 88 : index;
+		out[s] = (float)predictor/32768.0f;
+	}
+}
+
+// Blocks no encoder made, decoded before anything was encoded in the process, the way clips
+// from the asset cache are. Half start at the top step index, where a nibble moves the
+// predictor further than a short reaches.
+static void CheckAdpcmDecode(Tests *tests)
+{
+	enum { BLOCKS = 64 };
+	unsigned char *blocks = malloc(BLOCKS*ADPCM_BLOCK_BYTES);
+	float *decoded = malloc(BLOCKS*ADPCM_BLOCK_SAMPLES*sizeof(float)), *batched = malloc(BLOCKS*ADPCM_BLOCK_SAMPLES*sizeof(float));
+	const unsigned char *blockPtrs[BLOCKS];
+	float *outs[BLOCKS];
+	Rng rng = SeedRng(MIXER_TEST_SEED);
+	for (int b = 0; b < BLOCKS; b++)
+	{
+		unsigned char *block = blocks + b*ADPCM_BLOCK_BYTES;
+		for (int i = 0; i < ADPCM_BLOCK_BYTES; i++) block[i] = (unsigned char)NextRng(&rng);
+		block[2] = (b & 1)? 88 : (unsigned char)(NextRng(&rng)%89);
+		block[3] = 0;
+		blockPtrs[b] = block;
+		outs[b] = batched + b*ADPCM_BLOCK_SAMPLES;
+		DecodeAdpcmBlock(block, decoded + b*ADPCM_BLOCK_SAMPLES);
+	}
+	DecodeAdpcmBlocks(blockPtrs, outs, BLOCKS);
+
+	int wrong = 0, wrongBatched = 0;
+	float expected[ADPCM_BLOCK_SAMPLES];
+	for (int b = 0; b < BLOCKS; b++)
+	{
+		DecodeAdpcmReference(blockPtrs[b], expected);
+		for (int s = 0; s < ADPCM_BLOCK_SAMPLES; s++)
+		{
+			wrong += (decoded[b*ADPCM_BLOCK_SAMPLES + s] != expected[s]);
+			wrongBatched += (batched[b*ADPCM_BLOCK_SAMPLES + s] != expected[s]);
+		}
+	}
+	CheckTest(tests, wrong == 0, "mixer/adpcm_decode: %d of %d samples differ from the reference decoder", wrong, BLOCKS*ADPCM_BLOCK_SAMPLES);
+	CheckTest(tests, wrongBatched == 0, "mixer/adpcm_decode: %d of %d samples decoded four blocks at a time differ from the reference", wrongBatched, BLOCKS*ADPCM_BLOCK_SAMPLES);
+
+	free(blocks);
+	free(decoded);
+	free(batched);
+}
+
+// Plays the clip once through buffers of odd sizes. Every frame must match `expected` mixed
+// by hand, and the voice must end on the clip's last frame, not before or after.
+static void CheckOddBuffers(Tests *tests, Mixer *mixer, int clip, const float *expected, const char *kind)
+{
+	int total = MIXER_TEST_FRAMES + MIXER_TEST_TAIL;
+	float *out = calloc((size_t)total*2, sizeof(float));
+	float left = MIXER_TEST_GAIN*cosf(PI/4.0f), right = MIXER_TEST_GAIN*sinf(PI/4.0f);
+
+	PlayMixerClip(mixer, clip, MIXER_TEST_GAIN, 0.0f);
+	int wrongVoices = 0;
+	for (int done = 0, i = 0; done < total; i++)
+	{
+		int frames = bufferFrames[i%(sizeof(bufferFrames)/sizeof(bufferFrames[0]))];
+		if (frames > total - done) frames = total - done;
+		MixAudio(mixer, out + 2*done, frames);
+		done += frames;
+		wrongVoices += (mixer->voiceCount != (done < MIXER_TEST_FRAMES));
+	}
+
+	int wrong = 0;
+	for (int i = 0; i < total; i++)
+	{
+		float s = (i < MIXER_TEST_FRAMES)? expected[i] : 0.0f;
+		float l = fminf(fmaxf(s*left, -1.0f), 1.0f), r = fminf(fmaxf(s*right, -1.0f), 1.0f);
+		wrong += (out[2*i] != l || out[2*i + 1] != r);
+	}
+
+	CheckTest(tests, wrong == 0, "mixer/%s: %d of %d frames differ from the clip mixed by hand", kind, wrong, total);
+	CheckTest(tests, wrongVoices == 0, "mixer/%s: voice ended early or late after %d buffers", kind, wrongVoices);
+	free(out);
+}
+
+void RunMixerTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "mixer/")) return;
+
+	CheckAdpcmDecode(tests);
+
+	Mixer *mixer = malloc(sizeof(Mixer));
+	InitMixer(mixer, MIXER_DEFAULT_SAMPLE_RATE);
+	float *samples = GenTestClip();
+	int clip = LoadMixerClipSamples(mixer, GenTestClip(), MIXER_TEST_FRAMES);
+	CheckOddBuffers(tests, mixer, clip, samples, "pcm");
+
+	// Compressed, the voice reads what the encoder kept rather than the source
+	CompressMixerClip(mixer, clip);
+	const AdpcmClip *adpcm = &mixer->clips[clip].adpcm;
+	float *decoded = malloc((size_t)adpcm->blockCount*ADPCM_BLOCK_SAMPLES*sizeof(float));
+	for (int b = 0; b < adpcm->blockCount; b++) DecodeAdpcmBlock(adpcm->blocks + (size_t)b*ADPCM_BLOCK_BYTES, decoded + b*ADPCM_BLOCK_SAMPLES);
+	CheckOddBuffers(tests, mixer, clip, decoded, "adpcm");
+
+	free(decoded);
+	free(samples);
+	UnloadMixer(mixer);
+	free(mixer);
+}
@@ -0,0 +1,119 @@
+#include "test.h"
+
+#include <math.h>
+
+#include "raylib.h"
+#include "parallax.h"
+#include "rng.h"
+
+#define PARALLAX_SEED 50
+#define PARALLAX_STEPS 1000000	// Camera moves for the precision check
+#define PARALLAX_SCREEN_WIDTH 800.0f
+#define PARALLAX_SCREEN_HEIGHT 600.0f
+
+// Ids are all the batch looks at without a window, sizes match the game's layers
+static Parallax LoadTestParallax(void)
+{
+	Parallax parallax = { 0 };
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 1, .width = 800, .height = 600 }, (Vector2){ 0.05f, 0.05f }, (Vector2){ -2.0f, 0.0f }, WHITE, true);
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 2, .width = 512, .height = 512 }, (Vector2){ 0.2f, 0.2f }, (Vector2){ -6.0f, 0.0f }, WHITE, false);
+	AddParallaxLayer(&parallax, (Texture2D){ .id = 3, .width = 400, .height = 300 }, (Vector2){ 0.5f, 0.5f }, (Vector2){ -15.0f, 0.0f }, WHITE, false);
+	return parallax;
+}
+
+// Texel of a mirrored texture under a coordinate, 0..width with the back half reflected
+static double GetMirroredTexel(double u, double width)
+{
+	double t = fmod(u, 2.0*width);
+	return (t < width)? t : 2.0*width - t;
+}
+
+// One quad and one draw call per layer, offsets match a long double reference after a
+// million random camera moves and the UVs stay within a wrap period whatever the distance
+static void CheckScrolling(Tests *tests, SpriteBatch *batch)
+{
+	Rectangle screen = { 0.0f, 0.0f, PARALLAX_SCREEN_WIDTH, PARALLAX_SCREEN_HEIGHT };
+	Parallax parallax = LoadTestParallax();
+	BeginSpriteBatch(batch);
+	DrawParallax(&parallax, batch, screen);
+	EndSpriteBatch(batch);
+	CheckTest(tests, batch->last.quads == parallax.count && batch->last.drawCalls == parallax.count,
+		"parallax/batch: %d layers drew %d quads in %d draw calls", parallax.count, batch->last.quads, batch->last.drawCalls);
+
+	// Moves up to 2^20 px a step put the camera around 10^11 px away, where a float
+	// camera position is off by kilopixels
+	Rng rng = SeedRng(PARALLAX_SEED);
+	long double totalX[PARALLAX_MAX_LAYERS] = { 0 };
+	double camera = 0.0;
+	for (int i = 0; i < PARALLAX_STEPS; i++)
+	{
+		double dx = NextRngFloat(&rng)*1048576.0;
+		ScrollParallax(&parallax, dx, 0.0, 0.0);
+		for (int l = 0; l < parallax.count; l++) totalX[l] += (long double)dx*parallax.layers[l].factor.x;
+		camera += dx;
+	}
+	double worstError = 0.0;
+	for (int l = 0; l < parallax.count; l++)
+	{
+		const ParallaxLayer *layer = &parallax.layers[l];
+		long double period = (long double)layer->texture.width*(layer->mirrored? 2 : 1);
+		long double expected = fmodl(totalX[l], period);
+		double error = fabs((double)(expected - layer->offsetX));
+		error = fmin(error, (double)period - error);	// Either side of the wrap
+		worstError = fmax(worstError, error);
+		CheckTest(tests, layer->offsetX >= 0.0 && layer->offsetX < (double)period, "parallax/precision: layer %d offset %.3f outside its period", l, layer->offsetX);
+	}
+	CheckTest(tests, worstError <= 0.01, "parallax/precision: offsets off by %.6f px after %.3g px of scrolling", worstError, camera);
+
+	BeginSpriteBatch(batch);
+	DrawParallax(&parallax, batch, screen);
+	const SpriteQuad *q = &batch->quads[0];	// The last layer, the others flushed on the texture change
+	Texture2D t = parallax.layers[parallax.count - 1].texture;
+	CheckTest(tests, q->u0 >= 0.0f && q->u0 < 1.0f && fabsf((q->u1 - q->u0)*t.width - PARALLAX_SCREEN_WIDTH) <= 0.001f,
+		"parallax/precision: UVs %.6f..%.6f after %.3g px of scrolling", q->u0, q->u1, camera);
+	EndSpriteBatch(batch);
+}
+
+// Through a few wraps of the mirrored layer, the texel at the screen's edge moves at most
+// as far as the camera pushed it
+static void CheckMirrored(Tests *tests, SpriteBatch *batch)
+{
+	Rectangle screen = { 0.0f, 0.0f, PARALLAX_SCREEN_WIDTH, PARALLAX_SCREEN_HEIGHT };
+	Parallax mirrored = { 0 };
+	AddParallaxLayer(&mirrored, (Texture2D){ .id = 1, .width = 800, .height = 600 }, (Vector2){ 1.0f, 1.0f }, (Vector2){ 0.0f, 0.0f }, WHITE, true);
+	double step = 0.75, last = 0.0, jump = 0.0;
+	for (int i = 0; i < 8000; i++)
+	{
+		ScrollParallax(&mirrored, step, 0.0, 0.0);
+		BeginSpriteBatch(batch);
+		DrawParallax(&mirrored, batch, screen);
+		double texel = GetMirroredTexel((double)batch->quads[0].u0*800.0, 800.0);
+		EndSpriteBatch(batch);
+		if (i > 0) jump = fmax(jump, fabs(texel - last));
+		last = texel;
+	}
+	CheckTest(tests, jump <= step + 0.001, "parallax/mirrored: layer jumped %.3f px scrolling by %.3f px", jump, step);
+}
+
+// Star layers wrap their big stars, so a lit pixel count between the stars and four of
+// each says none were lost off an edge or drawn twice over
+static void CheckStars(Tests *tests)
+{
+	Image stars = GenStarLayerImage(64, 64, 200, PARALLAX_SEED, WHITE);
+	const Color *pixels = stars.data;
+	int lit = 0;
+	for (int i = 0; i < stars.width*stars.height; i++) lit += (pixels[i].a != 0);
+	CheckTest(tests, lit > 0 && lit <= 4*200, "parallax/stars: lit %d pixels for 200 stars", lit);
+	UnloadImage(stars);
+}
+
+void RunParallaxTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "parallax/")) return;
+
+	SpriteBatch batch = LoadSpriteBatch(PARALLAX_MAX_LAYERS);
+	CheckScrolling(tests, &batch);
+	CheckMirrored(tests, &batch);
+	UnloadSpriteBatch(&batch);
+	CheckStars(tests);
+}
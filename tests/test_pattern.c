@@ -0,0 +1,55 @@
+#include "test.h"
+
+#include <math.h>
+
+#include "raylib.h"
+#include "pattern.h"
+
+static const char *spiralSource =
+	"# Four arms turning\n"
+	"set angle 0\n"
+	"repeat\n"
+	"	ring 4 angle 180\n"
+	"	add angle angle 11\n"
+	"	wait 3\n"
+	"end\n";
+
+// A spiral fires four bullets every third tick, the first straight along +x
+static void CheckSpiral(Tests *tests)
+{
+	BulletPattern spiral;
+	if (!CheckTest(tests, CompileBulletPattern(spiralSource, &spiral), "pattern/spiral: does not compile")) return;
+
+	EmitterPool pool = LoadEmitterPool(1);
+	Entities bullets = AllocEntities(256);
+	AddEmitter(&pool, &spiral, (Vector2){ 100.0f, 100.0f });
+	for (int t = 0; t < 30; t++) StepEmitters(&pool, (Vector2){ 0.0f, 0.0f }, &bullets);
+
+	if (CheckTest(tests, bullets.count == 40, "pattern/spiral: spawned %d bullets in 30 ticks, expected 40", bullets.count))
+	{
+		CheckTest(tests, fabsf(bullets.velX[0] - 180.0f) <= 0.01f && fabsf(bullets.velY[0]) <= 0.01f && fabsf(bullets.velY[1] - 180.0f) <= 0.01f,
+			"pattern/spiral: fired (%.2f, %.2f) and (%.2f, %.2f), expected (180, 0) and (0, 180)", bullets.velX[0], bullets.velY[0], bullets.velX[1], bullets.velY[1]);
+	}
+	FreeEntities(&bullets);
+	UnloadEmitterPool(&pool);
+}
+
+static void CheckBrokenPatterns(Tests *tests)
+{
+	static const char *broken[] = { "ring 4 angle 180\n", "repeat\nwait 1\n", "end\n", "set aim 1\n", "wobble 3\n", "fire 0\n" };
+	SetTraceLogLevel(LOG_ERROR);
+	for (int i = 0; i < (int)(sizeof(broken)/sizeof(broken[0])); i++)
+	{
+		BulletPattern pattern;
+		CheckTest(tests, !CompileBulletPattern(broken[i], &pattern), "pattern/broken: pattern %d compiled", i);
+	}
+	SetTraceLogLevel(LOG_WARNING);
+}
+
+void RunPatternTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "pattern/")) return;
+
+	CheckSpiral(tests);
+	CheckBrokenPatterns(tests);
+}
@@ -0,0 +1,141 @@
+#include "test.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "queue.h"
+
+#define QUEUE_MESSAGES 300000
+#define QUEUE_CAPACITY 64	// Small, so producers keep running into a full queue
+#define MPSC_PRODUCERS 3
+
+// Every transfer checks that nothing was lost, reordered or duplicated. Built with
+// GAME_SANITIZE=thread (./build.sh tsan) this is the queues' race test.
+typedef struct Message {
+	unsigned int producer;
+	unsigned int sequence;
+} Message;
+
+typedef struct ProducerArgs {
+	SpscQueue *spsc;
+	MpscQueue *mpsc;
+	unsigned int id;
+} ProducerArgs;
+
+static void *SpscProducer(void *user)
+{
+	ProducerArgs *args = user;
+	for (unsigned int i = 0; i < QUEUE_MESSAGES; i++)
+	{
+		while (!PushSpsc(args->spsc, &i)) sched_yield();
+	}
+	return NULL;
+}
+
+static void *MpscProducer(void *user)
+{
+	ProducerArgs *args = user;
+	for (unsigned int i = 0; i < QUEUE_MESSAGES/MPSC_PRODUCERS; i++)
+	{
+		Message message = { args->id, i };
+		while (!PushMpsc(args->mpsc, &message)) sched_yield();
+	}
+	return NULL;
+}
+
+// Pushes fail exactly when full and pops exactly when empty, across several wraps of the ring
+static void CheckQueueBounds(Tests *tests)
+{
+	SpscQueue spsc;
+	MpscQueue mpsc;
+	InitSpscQueue(&spsc, 5, sizeof(unsigned int));	// Rounds up to 8
+	InitMpscQueue(&mpsc, 5, sizeof(unsigned int));
+	int spscWrong = 0, mpscWrong = 0;
+
+	for (unsigned int round = 0, next = 0, expected = 0; round < 10; round++)
+	{
+		unsigned int value;
+		for (int i = 0; i < 8; i++, next++)
+		{
+			spscWrong += !PushSpsc(&spsc, &next);
+			mpscWrong += !PushMpsc(&mpsc, &next);
+		}
+		spscWrong += PushSpsc(&spsc, &next);
+		mpscWrong += PushMpsc(&mpsc, &next);
+
+		for (int i = 0; i < 8; i++, expected++)
+		{
+			spscWrong += !PopSpsc(&spsc, &value) || value != expected;
+			mpscWrong += !PopMpsc(&mpsc, &value) || value != expected;
+		}
+		spscWrong += PopSpsc(&spsc, &value);
+		mpscWrong += PopMpsc(&mpsc, &value);
+	}
+
+	CheckTest(tests, spscWrong == 0, "queue/bounds: SPSC got %d pushes, pops or values wrong", spscWrong);
+	CheckTest(tests, mpscWrong == 0, "queue/bounds: MPSC got %d pushes, pops or values wrong", mpscWrong);
+	FreeSpscQueue(&spsc);
+	FreeMpscQueue(&mpsc);
+}
+
+static void CheckSpscTransfer(Tests *tests)
+{
+	SpscQueue queue;
+	InitSpscQueue(&queue, QUEUE_CAPACITY, sizeof(unsigned int));
+	ProducerArgs args = { .spsc = &queue };
+	pthread_t thread;
+	pthread_create(&thread, NULL, SpscProducer, &args);
+
+	int wrong = 0;
+	for (unsigned int expected = 0; expected < QUEUE_MESSAGES; expected++)
+	{
+		unsigned int value;
+		while (!PopSpsc(&queue, &value)) sched_yield();
+		wrong += (value != expected);
+	}
+	pthread_join(thread, NULL);
+
+	unsigned int extra;
+	CheckTest(tests, wrong == 0, "queue/spsc: %d of %d messages out of order or corrupted", wrong, QUEUE_MESSAGES);
+	CheckTest(tests, !PopSpsc(&queue, &extra), "queue/spsc: more messages came out than went in");
+	FreeSpscQueue(&queue);
+}
+
+// Each producer's messages must come out in the order it pushed them
+static void CheckMpscTransfer(Tests *tests)
+{
+	MpscQueue queue;
+	InitMpscQueue(&queue, QUEUE_CAPACITY, sizeof(Message));
+	pthread_t threads[MPSC_PRODUCERS];
+	ProducerArgs args[MPSC_PRODUCERS];
+	unsigned int next[MPSC_PRODUCERS] = { 0 };
+
+	for (int i = 0; i < MPSC_PRODUCERS; i++)
+	{
+		args[i] = (ProducerArgs){ .mpsc = &queue, .id = (unsigned int)i };
+		pthread_create(&threads[i], NULL, MpscProducer, &args[i]);
+	}
+
+	int wrong = 0;
+	for (int received = 0; received < (QUEUE_MESSAGES/MPSC_PRODUCERS)*MPSC_PRODUCERS; received++)
+	{
+		Message message;
+		while (!PopMpsc(&queue, &message)) sched_yield();
+		wrong += (message.producer >= MPSC_PRODUCERS || message.sequence != next[message.producer]++);
+	}
+	for (int i = 0; i < MPSC_PRODUCERS; i++) pthread_join(threads[i], NULL);
+
+	Message extra;
+	CheckTest(tests, wrong == 0, "queue/mpsc: %d messages from %d producers out of order or corrupted", wrong, MPSC_PRODUCERS);
+	CheckTest(tests, !PopMpsc(&queue, &extra), "queue/mpsc: more messages came out than went in");
+	FreeMpscQueue(&queue);
+}
+
+void RunQueueTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "queue/")) return;
+
+	CheckQueueBounds(tests);
+	CheckSpscTransfer(tests);
+	CheckMpscTransfer(tests);
+}
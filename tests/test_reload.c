@@ -0,0 +1,99 @@
+#include "test.h"
+
+#include <string.h>
+
+#include "raylib.h"
+#include "gameplay.h"
+#include "module.h"
+#include "replay.h"
+#include "snapshot.h"
+
+#define RELOAD_MAP "res/maps/map01.png"
+#define RELOAD_SEED 2024
+#define RELOAD_TICKS 3600
+#define RELOAD_EVERY 60	// Ticks between swaps
+
+#if defined(GAME_HOT_RELOAD)
+
+static Tilemap LoadReloadMap(void)
+{
+	if (FileExists(RELOAD_MAP)) return LoadTilemap(RELOAD_MAP);
+
+	Tilemap map = GenTilemapEmpty(64, 64);
+	int wall = AddTilemapColor(&map, ORANGE);
+	for (int i = 0; i < 64; i++) map.tiles[i] = map.tiles[63*64 + i] = map.tiles[i*64] = map.tiles[i*64 + 63] = (unsigned char)wall;
+	return map;
+}
+
+// Plays the scripted demo through the module, swapping it every RELOAD_EVERY ticks, and
+// compares the end state with the same ticks run straight through the host's own code
+static void CheckStateSurvivesReloads(Tests *tests, GameModule *module, GameState *state, const GameHost *host)
+{
+	World reference = InitWorldFromTilemap(LoadReloadMap(), RELOAD_SEED);
+	int reloads = 0;
+
+	for (int i = 0; i < RELOAD_TICKS; i++)
+	{
+		if (i%RELOAD_EVERY == 0)
+		{
+			if (!CheckTest(tests, ReloadGameModule(module, state, host), "reload/swap: reload %d failed", reloads)) break;
+			reloads++;
+		}
+
+		PlayerInput input = GetScriptedInput(RELOAD_SEED, (unsigned int)i);
+		module->api->update(state, input);
+		UpdateWorld(&reference, input);
+	}
+
+	Snapshot a = { 0 }, b = { 0 };
+	bool same = EncodeSnapshot(&state->world, NULL, 0, &a) && EncodeSnapshot(&reference, NULL, 0, &b) &&
+		a.rawSize == b.rawSize && memcmp(a.raw, b.raw, a.rawSize) == 0;
+	CheckTest(tests, same, "reload/state: game state diverged across %d module reloads", reloads);
+
+	UnloadSnapshot(&a);
+	UnloadSnapshot(&b);
+	UnloadWorld(&reference);
+}
+
+// A state created under another layout must be refused, leaving the running module in place
+static void CheckLayoutChangeRefused(Tests *tests, GameModule *module, GameState *state, const GameHost *host)
+{
+	const GameplayApi *api = module->api;
+	state->layout ^= 1;
+	SetTraceLogLevel(LOG_ERROR);
+	bool reloaded = ReloadGameModule(module, state, host);
+	SetTraceLogLevel(LOG_WARNING);
+	state->layout ^= 1;
+	CheckTest(tests, !reloaded && module->api == api, "reload/layout: module took over a state with a different layout");
+}
+
+void RunReloadTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "reload/")) return;
+
+	GameModule module;
+	GameHost host = { .seed = RELOAD_SEED };
+	if (!CheckTest(tests, LoadGameModule(&module, GAMEPLAY_MODULE_PATH), "reload/load: could not load %s", GAMEPLAY_MODULE_PATH)) return;
+
+	Arena arena = AllocArena(GAMEPLAY_ARENA_SIZE);
+	GameState *state = module.api->init(&arena, &host, LoadReloadMap());
+	if (CheckTest(tests, state != NULL, "reload/load: module could not create its state"))
+	{
+		CheckStateSurvivesReloads(tests, &module, state, &host);
+		CheckLayoutChangeRefused(tests, &module, state, &host);
+		module.api->unload(state);
+	}
+
+	FreeArena(&arena);
+	UnloadGameModule(&module);
+}
+
+#else
+
+// Linked in, there is nothing to reload
+void RunReloadTests(Tests *tests)
+{
+	(void)tests;
+}
+
+#endif
@@ -0,0 +1,298 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "raylib.h"
+#include "game.h"
+#include "snapshot.h"
+#include "lz.h"
+#include "mapgen.h"
+#include "replay.h"
+#include "jobs.h"
+
+#define SNAPSHOT_SEED 26
+#define SNAPSHOT_MAP_SIZE 64
+#define SNAPSHOT_BASE_TICKS 120	// Scripted ticks before the base snapshot, enough for bullets in flight
+#define SNAPSHOT_DELTA_TICKS 30
+#define SNAPSHOT_ENEMIES 200
+#define SNAPSHOT_SWARM 300
+#define LZ_SIZE 200003	// Odd, so no buffer ends on a word
+
+// A played world with every component in use: the player, bullets from the scripted
+// input, enemies scattered over the open tiles and a swarm chasing the player
+static World GenSnapshotWorld(void)
+{
+	World world = InitWorldFromTilemap(GenTilemapProcedural(NULL, GetDefaultMapGenParams(SNAPSHOT_MAP_SIZE, SNAPSHOT_MAP_SIZE, SNAPSHOT_SEED)), SNAPSHOT_SEED);
+	LoadWorldSwarm(&world, SNAPSHOT_SWARM, SNAPSHOT_SEED);
+	Rng rng = SeedRng(SNAPSHOT_SEED);
+	for (int i = 0; i < SNAPSHOT_ENEMIES; i++)
+	{
+		int x = (int)(NextRng(&rng)%SNAPSHOT_MAP_SIZE), y = (int)(NextRng(&rng)%SNAPSHOT_MAP_SIZE);
+		if (IsTileSolid(&world.map, x, y)) continue;
+		SpawnEntity(&world.entities, ENTITY_ENEMY, (Vector2){ (float)x*TILE_SIZE, (float)y*TILE_SIZE }, (Vector2){ 0.0f, 0.0f });
+	}
+	for (unsigned int t = 0; t < SNAPSHOT_BASE_TICKS; t++) UpdateWorld(&world, GetScriptedInput(SNAPSHOT_SEED, t));
+	return world;
+}
+
+// Moves it on from the base: more ticks, walls knocked out and added, enemies gone and new
+static void ChangeSnapshotWorld(World *world)
+{
+	for (unsigned int t = SNAPSHOT_BASE_TICKS; t < SNAPSHOT_BASE_TICKS + SNAPSHOT_DELTA_TICKS; t++) UpdateWorld(world, GetScriptedInput(SNAPSHOT_SEED, t));
+
+	for (int i = 0; i < world->map.width*world->map.height; i += 97) world->map.tiles[i] = (world->map.tiles[i] == TILE_EMPTY)? 1 : TILE_EMPTY;
+	for (int i = world->entities.count - 1; i > 0; i -= 3) if (world->entities.kind[i] == ENTITY_ENEMY) RemoveEntity(&world->entities, i);
+	for (int i = 0; i < 50; i++) SpawnEntity(&world->entities, ENTITY_ENEMY, (Vector2){ 100.0f + i, 200.0f }, (Vector2){ 1.0f, -1.0f });
+	world->entities.health[0] = 3;
+	for (int i = world->swarm.count - 1; i > 0; i -= 7) RemoveSwarmAgent(&world->swarm, i);
+}
+
+static void CheckSameWorld(Tests *tests, const World *world, const World *source, const char *mode)
+{
+	const Entities *a = &world->entities, *b = &source->entities;
+	size_t n = (size_t)b->count;
+	bool entities = a->count == b->count &&
+		memcmp(a->posX, b->posX, n*sizeof(float)) == 0 && memcmp(a->posY, b->posY, n*sizeof(float)) == 0 &&
+		memcmp(a->velX, b->velX, n*sizeof(float)) == 0 && memcmp(a->velY, b->velY, n*sizeof(float)) == 0 &&
+		memcmp(a->health, b->health, n*sizeof(short)) == 0 && memcmp(a->kind, b->kind, n) == 0;
+	bool tiles = world->map.width == source->map.width && world->map.height == source->map.height &&
+		memcmp(world->map.tiles, source->map.tiles, (size_t)source->map.width*source->map.height) == 0;
+	const Swarm *sa = &world->swarm, *sb = &source->swarm;
+	size_t agents = (size_t)sb->count*sizeof(float);
+	bool swarm = sa->count == sb->count &&
+		memcmp(sa->posX, sb->posX, agents) == 0 && memcmp(sa->posY, sb->posY, agents) == 0 &&
+		memcmp(sa->velX, sb->velX, agents) == 0 && memcmp(sa->velY, sb->velY, agents) == 0;
+
+	CheckTest(tests, entities, "snapshot/%s: %d entities applied, source has %d or their components differ", mode, a->count, b->count);
+	CheckTest(tests, tiles, "snapshot/%s: tiles differ from the source world", mode);
+	CheckTest(tests, swarm, "snapshot/%s: %d swarm agents applied, source has %d or they differ", mode, sa->count, sb->count);
+	CheckTest(tests, world->rng.state == source->rng.state, "snapshot/%s: rng state %08x, source %08x", mode, world->rng.state, source->rng.state);
+	CheckTest(tests, world->frame == source->frame && world->fireCooldown == source->fireCooldown &&
+		world->facing.x == source->facing.x && world->facing.y == source->facing.y, "snapshot/%s: frame, facing or fire cooldown differ", mode);
+}
+
+// Encode the world, decode what was written and apply it over a different world, which then
+// has to match the source exactly. The target's map is another size, so tiles are reallocated.
+static void CheckRoundTrip(Tests *tests, const World *source, const Snapshot *base, int flags, const char *mode)
+{
+	Snapshot encoded = { 0 }, decoded = { 0 };
+	World target = InitWorldFromTilemap(GenTilemapEmpty(16, 16), SNAPSHOT_SEED + 1);
+
+	bool ok = CheckTest(tests, EncodeSnapshot(source, base, flags, &encoded), "snapshot/%s: encode failed", mode) &&
+		CheckTest(tests, DecodeSnapshot(encoded.data, encoded.dataSize, base, &decoded), "snapshot/%s: decode failed", mode) &&
+		CheckTest(tests, decoded.rawSize == encoded.rawSize && memcmp(decoded.raw, encoded.raw, encoded.rawSize) == 0, "snapshot/%s: decoded layout differs from the encoded one", mode) &&
+		CheckTest(tests, ApplySnapshot(&decoded, &target), "snapshot/%s: apply failed", mode);
+	if (ok) CheckSameWorld(tests, &target, source, mode);
+
+	// Any cut short must be refused, not read past
+	int refused = 0, cuts = 0;
+	for (int size = 0; size < encoded.dataSize; size += 1 + encoded.dataSize/61, cuts++)
+	{
+		refused += !DecodeSnapshot(encoded.data, size, base, &decoded);
+	}
+	CheckTest(tests, refused == cuts, "snapshot/%s: %d of %d truncated snapshots decoded", mode, cuts - refused, cuts);
+
+	UnloadWorld(&target);
+	UnloadSnapshot(&encoded);
+	UnloadSnapshot(&decoded);
+}
+
+static void CheckSnapshots(Tests *tests)
+{
+	World world = GenSnapshotWorld();
+	Snapshot base = { 0 }, decodedBase = { 0 };
+	EncodeSnapshot(&world, NULL, 0, &base);
+
+	CheckRoundTrip(tests, &world, NULL, 0, "keyframe");
+	CheckRoundTrip(tests, &world, NULL, SNAPSHOT_LZ, "keyframe_lz");
+	CheckRoundTrip(tests, &world, &base, SNAPSHOT_DELTA, "delta_unchanged");
+
+	ChangeSnapshotWorld(&world);
+	CheckRoundTrip(tests, &world, &base, SNAPSHOT_DELTA, "delta");
+	CheckRoundTrip(tests, &world, &base, SNAPSHOT_DELTA | SNAPSHOT_LZ, "delta_lz");
+
+	// The receiving side only has its own decode of the base, that has to work the same
+	DecodeSnapshot(base.data, base.dataSize, NULL, &decodedBase);
+	CheckRoundTrip(tests, &world, &decodedBase, SNAPSHOT_DELTA | SNAPSHOT_LZ, "delta_lz_decoded_base");
+
+	// A delta decoded against the wrong base must be refused, quietly for once
+	SetTraceLogLevel(LOG_ERROR);
+	Snapshot delta = { 0 }, decoded = { 0 };
+	EncodeSnapshot(&world, &base, SNAPSHOT_DELTA, &delta);
+	Snapshot wrongBase = { 0 };
+	EncodeSnapshot(&world, NULL, 0, &wrongBase);
+	CheckTest(tests, !DecodeSnapshot(delta.data, delta.dataSize, &wrongBase, &decoded), "snapshot/delta: decoded against the wrong base");
+	CheckTest(tests, !DecodeSnapshot(delta.data, delta.dataSize, NULL, &decoded), "snapshot/delta: decoded without a base");
+	SetTraceLogLevel(LOG_WARNING);
+
+	UnloadSnapshot(&delta);
+	UnloadSnapshot(&decoded);
+	UnloadSnapshot(&wrongBase);
+	UnloadSnapshot(&decodedBase);
+	UnloadSnapshot(&base);
+	UnloadWorld(&world);
+}
+
+// A world restored from a snapshot has to carry on exactly like the one it was taken from,
+// which is all a replay relies on. The swarm's flow field is not in the snapshot and gets
+// rebuilt, and the restored world steps it on a job system to show the thread count is moot.
+static void CheckResume(Tests *tests)
+{
+	World world = GenSnapshotWorld();
+	World resumed = InitWorldFromTilemap(GenTilemapEmpty(16, 16), SNAPSHOT_SEED + 1);
+	JobSystem *jobs = CreateJobSystem(0);
+	resumed.jobs = jobs;
+	Snapshot snapshot = { 0 };
+
+	bool restored = EncodeSnapshot(&world, NULL, 0, &snapshot) && ApplySnapshot(&snapshot, &resumed);
+	if (CheckTest(tests, restored, "snapshot/resume: could not restore the world"))
+	{
+		for (unsigned int t = SNAPSHOT_BASE_TICKS; t < SNAPSHOT_BASE_TICKS + SNAPSHOT_DELTA_TICKS; t++)
+		{
+			PlayerInput input = GetScriptedInput(SNAPSHOT_SEED, t);
+			UpdateWorld(&world, input);
+			UpdateWorld(&resumed, input);
+		}
+		CheckSameWorld(tests, &resumed, &world, "resume");
+	}
+
+	UnloadSnapshot(&snapshot);
+	DestroyJobSystem(jobs);
+	UnloadWorld(&resumed);
+	UnloadWorld(&world);
+}
+
+// Field offsets in the headers snapshot.c writes, for corrupting them by hand
+#define FILE_HEADER_SIZE 24
+#define FILE_RAW_SIZE 16
+#define FILE_PAYLOAD_SIZE 20
+#define RAW_ENTITY_COUNT 8
+#define RAW_SWARM_COUNT 28
+
+static void PatchU32(unsigned char *data, int offset, unsigned int value)
+{
+	memcpy(data + offset, &value, sizeof(value));
+}
+
+// Decodes a copy of `data` with one 32 bit field replaced, it has to be refused
+static void CheckCorruptField(Tests *tests, const Snapshot *valid, int offset, unsigned int value, const char *field)
+{
+	unsigned char *data = malloc(valid->dataSize);
+	memcpy(data, valid->data, valid->dataSize);
+	PatchU32(data, offset, value);
+
+	Snapshot decoded = { 0 };
+	CheckTest(tests, !DecodeSnapshot(data, valid->dataSize, NULL, &decoded), "snapshot/corrupt: decoded with %s set to %u", field, value);
+	UnloadSnapshot(&decoded);
+	free(data);
+}
+
+// Truncated files and headers claiming sizes that overflow an int must be refused rather
+// than trusted, whether the sizes sit in the file header or in the raw header inside
+static void CheckCorruptHeaders(Tests *tests)
+{
+	World world = GenSnapshotWorld();
+	Snapshot valid = { 0 };
+	EncodeSnapshot(&world, NULL, 0, &valid);
+	SetTraceLogLevel(LOG_ERROR);
+
+	int refused = 0, sizes = 0;
+	for (int size = 0; size < valid.dataSize; size += (size < 64)? 1 : 97, sizes++)
+	{
+		Snapshot decoded = { 0 };
+		refused += !DecodeSnapshot(valid.data, size, NULL, &decoded);
+		UnloadSnapshot(&decoded);
+	}
+	CheckTest(tests, refused == sizes, "snapshot/corrupt: %d of %d truncated files decoded", sizes - refused, sizes);
+
+	// Payload sizes that wrap a 32 bit sum back under the file size
+	CheckCorruptField(tests, &valid, FILE_PAYLOAD_SIZE, 0xffffffffu, "payloadSize");
+	CheckCorruptField(tests, &valid, FILE_PAYLOAD_SIZE, 0x100000000ull - FILE_HEADER_SIZE, "payloadSize");
+	CheckCorruptField(tests, &valid, FILE_RAW_SIZE, 0x80000000u, "rawSize");
+	CheckCorruptField(tests, &valid, FILE_RAW_SIZE, 0xffffffffu, "rawSize");
+	CheckCorruptField(tests, &valid, FILE_RAW_SIZE, SNAPSHOT_MAX_RAW_SIZE + 8, "rawSize");
+	CheckCorruptField(tests, &valid, FILE_RAW_SIZE, 8, "rawSize");
+
+	// A keyframe's first token holds the raw header as literal words: a varint 0, a u16 count, then the words
+	bool literal = valid.data[FILE_HEADER_SIZE] == 0 && valid.data[FILE_HEADER_SIZE + 1] >= 4;
+	if (CheckTest(tests, literal, "snapshot/corrupt: keyframe does not start with the raw header as literals"))
+	{
+		int rawHeader = FILE_HEADER_SIZE + 3;
+		CheckCorruptField(tests, &valid, rawHeader + RAW_ENTITY_COUNT, 0xffffffffu, "entityCount");
+		CheckCorruptField(tests, &valid, rawHeader + RAW_ENTITY_COUNT, 0x40000000u, "entityCount");
+		CheckCorruptField(tests, &valid, rawHeader + RAW_SWARM_COUNT, 0x80000000u, "swarmCount");
+		CheckCorruptField(tests, &valid, rawHeader + RAW_SWARM_COUNT, 0x10000000u, "swarmCount");
+	}
+
+	// Applying checks the counts against the buffer it was handed as well
+	Snapshot tampered = { 0 };
+	bool decoded = DecodeSnapshot(valid.data, valid.dataSize, NULL, &tampered);
+	World target = InitWorldFromTilemap(GenTilemapEmpty(16, 16), SNAPSHOT_SEED + 1);
+	PatchU32(tampered.raw, RAW_SWARM_COUNT, 0x7fffffffu);
+	CheckTest(tests, decoded && !ApplySnapshot(&tampered, &target), "snapshot/corrupt: applied a swarm count past the snapshot's end");
+	PatchU32(tampered.raw, RAW_SWARM_COUNT, (unsigned int)world.swarm.count);
+	FreeEntities(&target.entities);
+	target.entities = AllocEntities(8);
+	CheckTest(tests, decoded && !ApplySnapshot(&tampered, &target), "snapshot/corrupt: applied %d entities to a world that holds 8", world.entities.count);
+
+	SetTraceLogLevel(LOG_WARNING);
+	UnloadWorld(&target);
+	UnloadSnapshot(&tampered);
+	UnloadSnapshot(&valid);
+	UnloadWorld(&world);
+}
+
+// Compresses, decompresses and compares, and a buffer one byte short must be refused
+static void CheckLzRoundTrip(Tests *tests, const unsigned char *data, int size, const char *kind)
+{
+	int bound = GetLzCompressBound(size);
+	unsigned char *packed = malloc(bound);
+	unsigned char *unpacked = malloc(size + 1);
+
+	int packedSize = CompressLz(data, size, packed);
+	int unpackedSize = DecompressLz(packed, packedSize, unpacked, size);
+	CheckTest(tests, packedSize >= 0 && packedSize <= bound, "lz/%s: %d bytes compressed to %d, bound %d", kind, size, packedSize, bound);
+	CheckTest(tests, unpackedSize == size && memcmp(unpacked, data, size) == 0, "lz/%s: %d bytes came back as %d different ones", kind, size, unpackedSize);
+	if (size > 0) CheckTest(tests, DecompressLz(packed, packedSize, unpacked, size - 1) < 0, "lz/%s: decompressed into a buffer too small", kind);
+
+	free(packed);
+	free(unpacked);
+}
+
+static void CheckLz(Tests *tests)
+{
+	unsigned char *data = malloc(LZ_SIZE);
+	Rng rng = SeedRng(SNAPSHOT_SEED);
+
+	// Short runs of a few symbols, what a delta stream looks like
+	for (int i = 0; i < LZ_SIZE;)
+	{
+		unsigned char symbol = (unsigned char)(NextRng(&rng)%6);
+		int run = 1 + (int)(NextRng(&rng)%12);
+		for (int r = 0; r < run && i < LZ_SIZE; r++) data[i++] = symbol;
+	}
+	CheckLzRoundTrip(tests, data, LZ_SIZE, "random");
+
+	memset(data, 0, LZ_SIZE);
+	CheckLzRoundTrip(tests, data, LZ_SIZE, "zero");
+
+	for (int i = 0; i < LZ_SIZE; i++) data[i] = (unsigned char)(NextRng(&rng) >> 24);
+	CheckLzRoundTrip(tests, data, LZ_SIZE, "incompressible");
+
+	// Sizes around the minimum match and the end of input
+	for (int size = 0; size < 32; size++) CheckLzRoundTrip(tests, data, size, "short");
+
+	free(data);
+}
+
+void RunSnapshotTests(Tests *tests)
+{
+	if (IsTestEnabled(tests, "snapshot/"))
+	{
+		CheckSnapshots(tests);
+		CheckResume(tests);
+		CheckCorruptHeaders(tests);
+	}
+	if (IsTestEnabled(tests, "lz/")) CheckLz(tests);
+}
@@ -0,0 +1,96 @@
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "swarm.h"
+#include "mapgen.h"
+#include "rng.h"
+
+#define SWARM_SEED 43
+#define SWARM_MAP_SIZE 96
+#define SWARM_AGENTS 6000	// Several blocks, so the pool splits the work
+#define SWARM_DT (1.0f/60.0f)
+#define SWARM_WARMUP_TICKS 90
+#define SWARM_CHECK_TICKS 60
+
+static void SaveSwarmState(const Swarm *swarm, float *state)
+{
+	memcpy(state, swarm->posX, swarm->count*sizeof(float));
+	memcpy(state + swarm->count, swarm->posY, swarm->count*sizeof(float));
+	memcpy(state + swarm->count*2, swarm->velX, swarm->count*sizeof(float));
+	memcpy(state + swarm->count*3, swarm->velY, swarm->count*sizeof(float));
+}
+
+static void LoadSwarmState(Swarm *swarm, const float *state)
+{
+	memcpy(swarm->posX, state, swarm->count*sizeof(float));
+	memcpy(swarm->posY, state + swarm->count, swarm->count*sizeof(float));
+	memcpy(swarm->velX, state + swarm->count*2, swarm->count*sizeof(float));
+	memcpy(swarm->velY, state + swarm->count*3, swarm->count*sizeof(float));
+}
+
+// Same start, same ticks: one thread and the pool must agree to the bit in either mode,
+// and no agent may end up inside a wall
+static void CheckSwarmThreads(Tests *tests, Swarm *swarm, const Tilemap *map, JobSystem *jobs, const float *start)
+{
+	size_t size = (size_t)swarm->count*4*sizeof(float);
+	float *serial = malloc(size);
+	float *pooled = malloc(size);
+
+	for (int mode = 0; mode < 2; mode++)
+	{
+		swarm->params.deterministic = (mode == 1);
+		for (int run = 0; run < 2; run++)
+		{
+			LoadSwarmState(swarm, start);
+			for (int t = 0; t < SWARM_CHECK_TICKS; t++) UpdateSwarm(swarm, map, run? jobs : NULL, SWARM_DT);
+			SaveSwarmState(swarm, run? pooled : serial);
+		}
+		CheckTest(tests, memcmp(serial, pooled, size) == 0, "swarm/threads: %s mode depends on the thread count", mode? "deterministic" : "fast");
+
+		int inWalls = 0;
+		for (int i = 0; i < swarm->count; i++)
+		{
+			inWalls += IsTileSolid(map, (int)floorf(swarm->posX[i]/TILE_SIZE), (int)floorf(swarm->posY[i]/TILE_SIZE));
+		}
+		CheckTest(tests, inWalls == 0, "swarm/walls: %d agents inside walls in %s mode", inWalls, mode? "deterministic" : "fast");
+	}
+	swarm->params.deterministic = false;
+
+	free(serial);
+	free(pooled);
+}
+
+void RunSwarmTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "swarm/")) return;
+
+	Tilemap map = GenTilemapProcedural(NULL, GetDefaultMapGenParams(SWARM_MAP_SIZE, SWARM_MAP_SIZE, SWARM_SEED));
+	Swarm swarm = LoadSwarm(&map, SWARM_AGENTS, GetDefaultSwarmParams());
+	JobSystem *jobs = CreateJobSystem(0);
+
+	// Spawned in open tiles all over the map, chasing one in the middle
+	Rng rng = SeedRng(SWARM_SEED);
+	while (swarm.count < SWARM_AGENTS)
+	{
+		int x = (int)(NextRng(&rng)%SWARM_MAP_SIZE), y = (int)(NextRng(&rng)%SWARM_MAP_SIZE);
+		if (IsTileSolid(&map, x, y)) continue;
+		AddSwarmAgent(&swarm, (Vector2){ (x + NextRngFloat(&rng))*TILE_SIZE, (y + NextRngFloat(&rng))*TILE_SIZE }, (Vector2){ 0.0f, 0.0f });
+	}
+	int targetX = SWARM_MAP_SIZE/2, targetY = SWARM_MAP_SIZE/2;
+	while (IsTileSolid(&map, targetX, targetY)) targetX++;
+	SetSwarmTarget(&swarm, &map, targetX, targetY);
+
+	// Bunched up along the corridors first, where neighbour scans see the most agents
+	for (int t = 0; t < SWARM_WARMUP_TICKS; t++) UpdateSwarm(&swarm, &map, jobs, SWARM_DT);
+	float *start = malloc((size_t)SWARM_AGENTS*4*sizeof(float));
+	SaveSwarmState(&swarm, start);
+	CheckSwarmThreads(tests, &swarm, &map, jobs, start);
+
+	free(start);
+	DestroyJobSystem(jobs);
+	UnloadSwarm(&swarm);
+	UnloadTilemap(map);
+}
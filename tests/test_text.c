@@ -0,0 +1,208 @@
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "raylib.h"
+#include "textcache.h"
+#include "spritebatch.h"
+
+#define TEXT_HUD_LINES 300
+#define TEXT_HUD_CHANGING 10	// One line in this many changes every frame
+#define TEXT_HUD_SIZE 20.0f
+#define TEXT_HUD_SPACING 2.0f
+#define TEXT_FONT_SIZE 10
+#define TEXT_FONT_ADVANCE 6
+#define TEXT_FONT_PADDING 1
+
+// A fixed width font laid out like raylib's default one, only the CPU side; the texture
+// never gets uploaded since the tests run without a window
+typedef struct TextTest {
+	Font font;
+	GlyphInfo glyphs[TEXT_CHAR_COUNT];
+	Rectangle recs[TEXT_CHAR_COUNT];
+	TextAtlas atlas;
+	TextCache cache;
+	SpriteBatch batch;
+	char lines[TEXT_HUD_LINES][64];
+	int frame;
+} TextTest;
+
+static void LoadTestFont(TextTest *t)
+{
+	for (int i = 0; i < TEXT_CHAR_COUNT; i++)
+	{
+		t->glyphs[i] = (GlyphInfo){ .value = TEXT_FIRST_CHAR + i, .offsetX = 0, .offsetY = 0, .advanceX = TEXT_FONT_ADVANCE };
+		t->recs[i] = (Rectangle){ (float)(1 + (i%16)*8), (float)(1 + (i/16)*12), (float)(TEXT_FONT_ADVANCE - 1), (float)TEXT_FONT_SIZE };
+	}
+	t->font = (Font){
+		.baseSize = TEXT_FONT_SIZE, .glyphCount = TEXT_CHAR_COUNT, .glyphPadding = TEXT_FONT_PADDING,
+		.texture = { .id = 1, .width = 128, .height = 128, .mipmaps = 1 },
+		.recs = t->recs, .glyphs = t->glyphs,
+	};
+}
+
+// A profiler overlay: most counters hold still from frame to frame, a tenth of them tick
+static void UpdateHudLines(TextTest *t)
+{
+	for (int i = 0; i < TEXT_HUD_LINES; i++)
+	{
+		if (t->frame > 0 && i%TEXT_HUD_CHANGING != t->frame%TEXT_HUD_CHANGING) continue;
+		snprintf(t->lines[i], sizeof(t->lines[i]), "zone %03d  calls %5d  %7.3f ms", i, (i*37)%1000, (float)((i + t->frame)%977)*0.013f);
+	}
+}
+
+static void DrawHudFrame(TextTest *t, int frame)
+{
+	t->frame = frame;
+	UpdateHudLines(t);
+	BeginTextFrame(&t->cache);
+	BeginSpriteBatch(&t->batch);
+	for (int i = 0; i < TEXT_HUD_LINES; i++)
+	{
+		DrawTextCached(&t->cache, &t->batch, t->lines[i], (Vector2){ 10.0f, 10.0f + i*(TEXT_HUD_SIZE + TEXT_LINE_SPACING) }, TEXT_HUD_SIZE, TEXT_HUD_SPACING, GREEN);
+	}
+	EndSpriteBatch(&t->batch);
+}
+
+// The reference: what DrawTextEx() does for every call, into the batch instead of rlgl
+static void DrawTextReference(TextTest *t, const char *text, Vector2 position, float size, float spacing, Color color)
+{
+	Font font = t->font;
+	float scale = size/font.baseSize, padding = (float)font.glyphPadding;
+	float x = 0.0f, y = 0.0f;
+
+	for (const char *c = text; *c != '\0'; c++)
+	{
+		if (*c == '\n')
+		{
+			x = 0.0f;
+			y += size + TEXT_LINE_SPACING;
+			continue;
+		}
+
+		int index = GetGlyphIndex(font, *c);
+		Rectangle rec = font.recs[index];
+		if (*c != ' ' && *c != '\t')
+		{
+			Rectangle source = { rec.x - padding, rec.y - padding, rec.width + 2.0f*padding, rec.height + 2.0f*padding };
+			Rectangle dest = { position.x + x + (font.glyphs[index].offsetX - padding)*scale, position.y + y + (font.glyphs[index].offsetY - padding)*scale, source.width*scale, source.height*scale };
+			PushSpriteQuad(&t->batch, font.texture, source, dest, color);
+		}
+		x += ((font.glyphs[index].advanceX == 0)? rec.width : (float)font.glyphs[index].advanceX)*scale + spacing;
+	}
+}
+
+static int CountVisibleChars(const TextTest *t)
+{
+	int count = 0;
+	for (int i = 0; i < TEXT_HUD_LINES; i++) for (const char *c = t->lines[i]; *c != '\0'; c++) count += (*c != ' ');
+	return count;
+}
+
+// Within rounding, the two add the offsets up in a different order
+static bool SameQuads(const SpriteBatch *a, const SpriteQuad *quads, int count)
+{
+	if (a->count != count) return false;
+	for (int i = 0; i < count; i++)
+	{
+		const SpriteQuad *p = &a->quads[i], *q = &quads[i];
+		if (fabsf(p->dest.x - q->dest.x) > 1e-3f || fabsf(p->dest.y - q->dest.y) > 1e-3f) return false;
+		if (fabsf(p->dest.width - q->dest.width) > 1e-3f || fabsf(p->dest.height - q->dest.height) > 1e-3f) return false;
+		if (fabsf(p->u0 - q->u0) > 1e-6f || fabsf(p->v0 - q->v0) > 1e-6f || fabsf(p->u1 - q->u1) > 1e-6f || fabsf(p->v1 - q->v1) > 1e-6f) return false;
+	}
+	return true;
+}
+
+// The first frame lays out every line, the next only the ones that changed, and the whole
+// HUD goes out as one quad per visible character in as few draw calls as the batch allows
+static void CheckHudFrames(Tests *tests, TextTest *t)
+{
+	int changing = TEXT_HUD_LINES/TEXT_HUD_CHANGING;
+
+	DrawHudFrame(t, 0);
+	CheckTest(tests, t->cache.stats.misses == TEXT_HUD_LINES, "text/hud: first frame missed %d layouts, expected %d", t->cache.stats.misses, TEXT_HUD_LINES);
+
+	DrawHudFrame(t, 1);
+	CheckTest(tests, t->cache.stats.hits == TEXT_HUD_LINES - changing && t->cache.stats.misses == changing,
+		"text/hud: second frame had %d hits and %d misses, expected %d and %d", t->cache.stats.hits, t->cache.stats.misses, TEXT_HUD_LINES - changing, changing);
+
+	int visible = CountVisibleChars(t);
+	CheckTest(tests, t->batch.last.quads == visible && t->cache.stats.quads == visible,
+		"text/hud: %d quads batched and %d emitted, expected %d", t->batch.last.quads, t->cache.stats.quads, visible);
+	int drawCalls = (visible + SPRITE_BATCH_DRAW_QUADS - 1)/SPRITE_BATCH_DRAW_QUADS;
+	CheckTest(tests, t->batch.last.drawCalls == drawCalls, "text/hud: %d quads took %d draw calls, expected %d", visible, t->batch.last.drawCalls, drawCalls);
+}
+
+// Same quads as laying out every call, through the same batch so both come out unflushed
+static void CheckLayout(Tests *tests, TextTest *t)
+{
+	const char *text = "Score: 1234\nHP ?\t~é";
+	SpriteQuad expected[32];
+	BeginSpriteBatch(&t->batch);
+	DrawTextReference(t, "Score: 1234\nHP ?\t~?", (Vector2){ 3.0f, 5.0f }, 30.0f, 3.0f, WHITE);
+	int expectedCount = t->batch.count;
+	memcpy(expected, t->batch.quads, (size_t)expectedCount*sizeof(SpriteQuad));
+	t->batch.count = 0;
+	DrawTextCached(&t->cache, &t->batch, text, (Vector2){ 3.0f, 5.0f }, 30.0f, 3.0f, WHITE);
+	CheckTest(tests, SameQuads(&t->batch, expected, expectedCount), "text/layout: %d cached quads differ from the %d of DrawTextEx", t->batch.count, expectedCount);
+	t->batch.count = 0;
+
+	Vector2 extent = MeasureTextCached(&t->cache, "AB\nC", 20.0f, 2.0f);
+	float width = 2*TEXT_FONT_ADVANCE*2.0f + 2.0f, height = 2*20.0f + TEXT_LINE_SPACING;
+	CheckTest(tests, extent.x == width && extent.y == height, "text/layout: measured %.1fx%.1f, expected %.1fx%.1f", extent.x, extent.y, width, height);
+}
+
+// Layouts that stop being drawn age out without losing the others, counters changing every
+// frame cannot push out the steady lines, and past the load limit strings are laid out on
+// the spot, still correctly
+static void CheckEviction(Tests *tests, TextTest *t)
+{
+	for (int frame = 0; frame < TEXT_CACHE_MAX_AGE*3; frame++) DrawHudFrame(t, 0);
+	CheckTest(tests, t->cache.count == TEXT_HUD_LINES, "text/evict: %d layouts cached after eviction, expected %d", t->cache.count, TEXT_HUD_LINES);
+	CheckTest(tests, t->cache.stats.hits == TEXT_HUD_LINES, "text/evict: %d of %d HUD lines hit after eviction", t->cache.stats.hits, TEXT_HUD_LINES);
+
+	int changing = TEXT_HUD_LINES/TEXT_HUD_CHANGING;
+	int steadyHits = TEXT_HUD_LINES - changing;
+	for (int frame = 1; frame < TEXT_CACHE_SLOTS; frame++)
+	{
+		DrawHudFrame(t, frame);
+		if (t->cache.stats.hits < steadyHits) steadyHits = t->cache.stats.hits;
+	}
+	CheckTest(tests, steadyHits == TEXT_HUD_LINES - changing, "text/evict: as few as %d of %d unchanged HUD lines hit with a full cache", steadyHits, TEXT_HUD_LINES - changing);
+
+	char overflow[32];
+	BeginTextFrame(&t->cache);
+	BeginSpriteBatch(&t->batch);
+	for (int i = 0; i < TEXT_CACHE_SLOTS; i++)
+	{
+		snprintf(overflow, sizeof(overflow), "line %d", i);
+		DrawTextCached(&t->cache, &t->batch, overflow, (Vector2){ 0.0f, 0.0f }, TEXT_HUD_SIZE, TEXT_HUD_SPACING, WHITE);
+	}
+	CheckTest(tests, t->cache.count <= TEXT_CACHE_SLOTS/4*3, "text/evict: cache holds %d layouts, over its limit", t->cache.count);
+	t->batch.count = 0;
+	DrawTextCached(&t->cache, &t->batch, overflow, (Vector2){ 0.0f, 0.0f }, TEXT_HUD_SIZE, TEXT_HUD_SPACING, WHITE);
+	CheckTest(tests, t->batch.count == (int)strlen(overflow) - 1, "text/evict: uncached overflow layout has %d quads, expected %d", t->batch.count, (int)strlen(overflow) - 1);
+	EndSpriteBatch(&t->batch);
+}
+
+void RunTextTests(Tests *tests)
+{
+	if (!IsTestEnabled(tests, "text/")) return;
+
+	TextTest *t = calloc(1, sizeof(TextTest));
+	LoadTestFont(t);
+	t->atlas = LoadTextAtlas(t->font);
+	t->cache = LoadTextCache(&t->atlas);
+	t->batch = LoadSpriteBatch(1024);
+
+	CheckHudFrames(tests, t);
+	CheckLayout(tests, t);
+	CheckEviction(tests, t);
+
+	UnloadSpriteBatch(&t->batch);
+	UnloadTextCache(&t->cache);
+	free(t);
+}
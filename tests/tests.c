@@ -0,0 +1,74 @@
+#include "test.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "raylib.h"
+
+//----------------------------------------------------------------------------------
+// Harness
+//----------------------------------------------------------------------------------
+bool IsTestEnabled(const Tests *tests, const char *prefix)
+{
+	return tests->filter == NULL || strstr(prefix, tests->filter) != NULL || strstr(tests->filter, prefix) != NULL;
+}
+
+bool CheckTest(Tests *tests, bool passed, const char *format, ...)
+{
+	tests->checks++;
+	if (passed) return true;
+
+	tests->failures++;
+	va_list args;
+	va_start(args, format);
+	printf("FAIL: ");
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+	fflush(stdout);
+	return false;
+}
+
+//----------------------------------------------------------------------------------
+// Entry point
+//----------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+	Tests tests = { 0 };
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) tests.filter = argv[++i];
+		else
+		{
+			printf("usage: %s [--filter suite/]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	RunSnapshotTests(&tests);
+	RunQueueTests(&tests);
+	RunBroadPhaseTests(&tests);
+	RunCollisionTests(&tests);
+	RunFovTests(&tests);
+	RunSwarmTests(&tests);
+	RunMixerTests(&tests);
+	RunTextTests(&tests);
+	RunChunkTests(&tests);
+	RunFramePacerTests(&tests);
+	RunPatternTests(&tests);
+	RunBehaviourTests(&tests);
+	RunEventTests(&tests);
+	RunParallaxTests(&tests);
+	RunLightingTests(&tests);
+	RunMapGenTests(&tests);
+	RunDebugUiTests(&tests);
+	RunReloadTests(&tests);
+
+	printf("TESTS: %i checks, %i failed\n", tests.checks, tests.failures);
+	if (tests.checks == 0) printf("TESTS: Nothing matched the filter\n");
+	return (tests.failures > 0 || tests.checks == 0)? 1 : 0;
+}